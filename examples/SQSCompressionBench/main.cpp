@@ -0,0 +1,94 @@
+/*
+ * main.cpp
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <AWS/AWS.h>
+#include <JSON/JSON.h>
+
+// Builds a compact JSON body of given records, alike the test messages.
+String makeBody(int records) {
+	static const char* const names[] = { "alpha", "bravo", "charlie", "delta",
+			"echo", "foxtrot" };
+	REF<JSONObject> body = new JSONObject();
+	body->setProperty("type", new JSONString("report"));
+	body->setProperty("version", new JSONNumber((int32_t) 3));
+	REF<JSONArray> items = new JSONArray();
+	for (int i = 0; i < records; i++) {
+		REF<JSONObject> item = new JSONObject();
+		item->setProperty("id", new JSONNumber((int32_t) (100000 + i * 7)));
+		item->setProperty("name", new JSONString(names[i % 6]));
+		item->setProperty("timestamp",
+				new JSONNumber((int64_t) 1424131200000LL + i * 997));
+		item->setProperty("value", new JSONNumber((float) (i % 113) / 7));
+		item->setProperty("enabled", (i % 3) ? JSONBool::True() : JSONBool::False());
+		items->addElement(item);
+	}
+	body->setProperty("items", items);
+
+	REF<StringWriter> stringWriter = new StringWriter();
+	REF<JSONWriter> jsonWriter = new JSONWriter(stringWriter);
+	jsonWriter->setCompactMode(true);
+	JSONNode::toJSONWriter(jsonWriter, body);
+	stringWriter->flush();
+	return stringWriter->getString();
+}
+
+// Gets the number of 64 KB chunks a request is billed for.
+int getChunks(int size) {
+	return (size + 65535) / 65536;
+}
+
+void usage(const char* program) {
+	printf("Usage: %s [iterations]\n", program);
+	printf("  Measures the CPU time of compressing message bodies of several"
+			" sizes and levels, against the bytes saved.\n");
+}
+
+int main(int argc, char* argv[]) {
+	// Initializes the current auto release pool.
+	REFAutoreleasePool pool;
+
+	if (argc > 1 && atoi(argv[1]) <= 0) {
+		usage(argv[0]);
+		return -1;
+	}
+	int iterations = (argc > 1) ? atoi(argv[1]) : 200;
+
+	static const int recordCounts[] = { 10, 50, 200, 1000, 3000 };
+	static const int levels[] = { 1, 6, 9 };
+	printf("%8s %5s %8s %6s %6s %10s %10s\n", "size", "level", "encoded",
+			"ratio", "chunks", "encode_us", "decode_us");
+	for (int i = 0; i < (int) (sizeof(recordCounts) / sizeof(int)); i++) {
+		String body = makeBody(recordCounts[i]);
+		for (int j = 0; j < (int) (sizeof(levels) / sizeof(int)); j++) {
+			REFAutoreleasePool iterationPool;
+			String encoded;
+			int64_t startTime = Thread::getTickCount();
+			for (int k = 0; k < iterations; k++) {
+				if (!SQSBodyCodec::compress(body, levels[j], encoded))
+					encoded = body;
+			}
+			int64_t encodeTime = Thread::getTickCount() - startTime;
+
+			String decoded;
+			startTime = Thread::getTickCount();
+			for (int k = 0; k < iterations && encoded != body; k++)
+				SQSBodyCodec::decompress(encoded, SQSBodyCodec::ZLIB, decoded);
+			int64_t decodeTime = Thread::getTickCount() - startTime;
+			if (encoded != body && decoded != body) {
+				printf("Round trip failed at %d bytes.\n", body.getLength());
+				return -1;
+			}
+
+			printf("%8d %5d %8d %5.1fx %2d->%-2d %10.1f %10.1f\n",
+					body.getLength(), levels[j], encoded.getLength(),
+					(double) body.getLength() / encoded.getLength(),
+					getChunks(body.getLength()), getChunks(encoded.getLength()),
+					encodeTime * 1000.0 / iterations,
+					decodeTime * 1000.0 / iterations);
+		}
+	}
+	return 0;
+}
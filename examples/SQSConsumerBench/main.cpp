@@ -0,0 +1,111 @@
+/*
+ * main.cpp
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <AWS/AWS.h>
+
+// Simulates some work per message, and counts the messages.
+class BenchHandler: public SQSMessageHandler {
+public:
+	BenchHandler(int workTime) :
+			_workTime(workTime) {
+	}
+	virtual bool handleMessage(const String& queueUrl, SQSMessage* message) {
+		if (_workTime > 0)
+			Thread::sleep(_workTime);
+		return true;
+	}
+
+private:
+	int _workTime;
+};
+
+void usage(const char* program) {
+	printf("Usage: %s endpoint queue_url [messages] [pollers] [handlers]"
+			" [prefetch] [work_ms]\n", program);
+	printf("  e.g. %s http://localhost:9324 http://localhost:9324/queue/bench"
+			" 10000 2 8 40 1\n", program);
+	printf("  The endpoint is usually a local stand-in of SQS, the queue is"
+			" filled with the messages first.\n");
+}
+
+int main(int argc, char* argv[]) {
+	// Initializes the current auto release pool.
+	REFAutoreleasePool pool;
+
+	if (argc < 3) {
+		usage(argv[0]);
+		return -1;
+	}
+	String endpoint = argv[1];
+	String queueUrl = argv[2];
+	int messages = (argc > 3) ? atoi(argv[3]) : 10000;
+	int pollers = (argc > 4) ? atoi(argv[4]) : SQSConsumer::DEFAULT_POLLERS;
+	int handlers = (argc > 5) ? atoi(argv[5]) : SQSConsumer::DEFAULT_HANDLERS;
+	int prefetch = (argc > 6) ? atoi(argv[6]) : SQSConsumer::DEFAULT_PREFETCH;
+	int workTime = (argc > 7) ? atoi(argv[7]) : 0;
+
+	// A local stand-in accepts any credentials.
+	REF<AWSClientFactory> factory = new AWSClientFactory();
+	factory->setRegion(AWSRegion::getRegion("cn-north-1"));
+	SQSClient* client = factory->createSQSClient("my_accessid", "my_secretkey");
+	client->setEndpoint(endpoint);
+
+	// Fills the queue.
+	int64_t startTime = Thread::getTickCount();
+	REF<SQSSendMessageBatcher> batcher = new SQSSendMessageBatcher(client,
+			queueUrl);
+	for (int i = 0; i < messages; i++) {
+		REFAutoreleasePool loopPool;
+		batcher->sendMessage(String::format("message %d", i));
+	}
+	batcher->close();
+	int64_t elapsed = Thread::getTickCount() - startTime;
+	printf("Sent %d messages in %d ms.\n", messages, (int) elapsed);
+
+	// Drains the queue, doubling the handlers halfway to show the tuning at
+	// run time.
+	BenchHandler handler(workTime);
+	REF<SQSConsumer> consumer = new SQSConsumer(client, &handler);
+	consumer->addQueue(queueUrl);
+	consumer->setPollers(pollers);
+	consumer->setHandlers(handlers);
+	consumer->setPrefetch(prefetch);
+	consumer->setWaitTimeSeconds(1);
+	startTime = Thread::getTickCount();
+	if (!consumer->start()) {
+		printf("Unable to start the consumer.\n");
+		return -1;
+	}
+	bool tuned = false;
+	int64_t lastProgress = startTime;
+	int64_t lastHandled = 0;
+	while (consumer->getHandledCount() < messages) {
+		Thread::sleep(100);
+		int64_t handled = consumer->getHandledCount();
+		int64_t now = Thread::getTickCount();
+		if (handled != lastHandled) {
+			lastHandled = handled;
+			lastProgress = now;
+		} else if (now - lastProgress > 10000) {
+			printf("No progress for 10 seconds, giving up.\n");
+			break;
+		}
+		if (!tuned && handled >= messages / 2) {
+			consumer->setHandlers(handlers * 2);
+			tuned = true;
+		}
+	}
+	consumer->stop();
+	elapsed = Thread::getTickCount() - startTime;
+	if (elapsed == 0)
+		elapsed = 1;
+	printf("Handled %d messages, deleted %d, in %d ms: %d messages/s.\n",
+			(int) consumer->getHandledCount(),
+			(int) consumer->getDeletedCount(), (int) elapsed,
+			(int) (consumer->getHandledCount() * 1000 / elapsed));
+
+	return 0;
+}
@@ -0,0 +1,268 @@
+/*
+ * EmulatedQueue.cpp
+ */
+
+#include "EmulatedQueue.h"
+
+#include <stdio.h>
+
+struct EmulatedMessage {
+	String messageId;
+	String md5OfBody;
+	String body;
+	REF<AWSStringMap> attributeTypes;
+	REF<AWSStringMap> attributeValues;
+	int64_t sequence;
+	int slot;
+	int receiveCount;
+	int64_t sentTimestamp;
+	int64_t firstReceiveTimestamp;
+	// The tick count the message becomes visible at, while hidden.
+	int64_t visibleAt;
+	bool hidden;
+	EmulatedMessage* prev;
+	EmulatedMessage* next;
+};
+
+static void listInit(EmulatedMessageList& list) {
+	list.head = list.tail = NULL;
+	list.size = 0;
+}
+
+static void listInsertAfter(EmulatedMessageList& list, EmulatedMessage* after,
+		EmulatedMessage* message) {
+	message->prev = after;
+	message->next = (after != NULL) ? after->next : list.head;
+	if (message->next != NULL)
+		message->next->prev = message;
+	else
+		list.tail = message;
+	if (after != NULL)
+		after->next = message;
+	else
+		list.head = message;
+	list.size++;
+}
+
+static void listRemove(EmulatedMessageList& list, EmulatedMessage* message) {
+	if (message->prev != NULL)
+		message->prev->next = message->next;
+	else
+		list.head = message->next;
+	if (message->next != NULL)
+		message->next->prev = message->prev;
+	else
+		list.tail = message->prev;
+	message->prev = message->next = NULL;
+	list.size--;
+}
+
+EmulatedQueue::EmulatedQueue(const String& name, int visibilityTimeout) :
+		_name(name), _visibilityTimeout(visibilityTimeout), _nextSequence(1), _waiters(
+				0) {
+	listInit(_visible);
+	listInit(_hidden);
+}
+
+EmulatedQueue::~EmulatedQueue() {
+	for (int i = 0; i < _slots.getSize(); i++)
+		delete _slots[i];
+}
+
+String EmulatedQueue::send(const String& body, const String& md5OfBody,
+		AWSStringMap* attributeTypes, AWSStringMap* attributeValues,
+		int delaySeconds) {
+	EmulatedMessage* message = new EmulatedMessage();
+	message->md5OfBody = md5OfBody;
+	message->body = body;
+	message->attributeTypes = attributeTypes;
+	message->attributeValues = attributeValues;
+	message->receiveCount = 0;
+	message->sentTimestamp = UTCClock::currentMilliseconds();
+	message->firstReceiveTimestamp = 0;
+	message->prev = message->next = NULL;
+	int64_t now = Thread::getTickCount();
+
+	MutexHolder holder(&_lock);
+	message->sequence = _nextSequence++;
+	// Looks like a UUID, unique within the emulator.
+	message->messageId = String::format("%08x-0000-4000-8000-%012llx",
+			(unsigned) (uintptr_t) this, (long long) message->sequence);
+	if (_freeSlots.getSize() > 0) {
+		message->slot = _freeSlots[_freeSlots.getSize() - 1];
+		_freeSlots.removeAt(_freeSlots.getSize() - 1);
+		_slots[message->slot] = message;
+	} else {
+		message->slot = _slots.getSize();
+		_slots.add(message);
+	}
+	if (delaySeconds > 0) {
+		message->visibleAt = now + (int64_t) delaySeconds * 1000;
+		hide(message);
+	} else {
+		message->hidden = false;
+		listInsertAfter(_visible, _visible.tail, message);
+		if (_waiters > 0)
+			_event.set();
+	}
+	return message->messageId;
+}
+
+int EmulatedQueue::receive(int maxCount, int visibilityTimeout, int waitTime,
+		ArrayListT<EmulatedDelivery>& deliveries, volatile bool* stopping) {
+	int64_t now = Thread::getTickCount();
+	int64_t deadline = now + waitTime;
+	int count = 0;
+
+	_lock.lock();
+	while (true) {
+		restoreExpired(now);
+		while (count < maxCount && _visible.head != NULL) {
+			EmulatedMessage* message = _visible.head;
+			listRemove(_visible, message);
+			message->receiveCount++;
+			if (message->firstReceiveTimestamp == 0)
+				message->firstReceiveTimestamp =
+						UTCClock::currentMilliseconds();
+			// Hidden even for no timeout, so that the receive doesn't take
+			// it twice.
+			message->visibleAt = now + (int64_t) visibilityTimeout * 1000;
+			hide(message);
+
+			// Copies the message, which may be deleted by another receiver
+			// once the lock is released.
+			EmulatedDelivery delivery;
+			delivery.messageId = message->messageId;
+			delivery.receiptHandle = String::format("%d-%lld-%d",
+					message->slot, (long long) message->sequence,
+					message->receiveCount);
+			delivery.md5OfBody = message->md5OfBody;
+			delivery.body = message->body;
+			delivery.attributeTypes = message->attributeTypes;
+			delivery.attributeValues = message->attributeValues;
+			delivery.receiveCount = message->receiveCount;
+			delivery.sentTimestamp = message->sentTimestamp;
+			delivery.firstReceiveTimestamp = message->firstReceiveTimestamp;
+			deliveries.add(delivery);
+			count++;
+		}
+		if (count > 0 || now >= deadline || *stopping)
+			break;
+
+		// Wakes up no later than the next hidden message reappears.
+		int64_t wakeAt = deadline;
+		if (_hidden.head != NULL && _hidden.head->visibleAt < wakeAt)
+			wakeAt = _hidden.head->visibleAt;
+		_waiters++;
+		_lock.unlock();
+		_event.wait((int) BFX_MAX(wakeAt - now, 1));
+		_lock.lock();
+		_waiters--;
+		now = Thread::getTickCount();
+	}
+	// Each receive wakes the next one up, while there is something to see.
+	if (_waiters > 0 && (_visible.head != NULL || *stopping))
+		_event.set();
+	_lock.unlock();
+	return count;
+}
+
+EmulatedQueue::Status EmulatedQueue::deleteMessage(
+		const String& receiptHandle) {
+	MutexHolder holder(&_lock);
+	Status status;
+	EmulatedMessage* message = findMessage(receiptHandle, status);
+	if (message != NULL) {
+		if (message->hidden)
+			listRemove(_hidden, message);
+		else
+			listRemove(_visible, message);
+		destroy(message);
+	}
+	return (status == NOT_IN_FLIGHT) ? OK : status;
+}
+
+EmulatedQueue::Status EmulatedQueue::changeVisibility(
+		const String& receiptHandle, int visibilityTimeout) {
+	int64_t now = Thread::getTickCount();
+	MutexHolder holder(&_lock);
+	restoreExpired(now);
+	Status status;
+	EmulatedMessage* message = findMessage(receiptHandle, status);
+	if (message == NULL)
+		return status;
+	if (!message->hidden)
+		return NOT_IN_FLIGHT;
+
+	listRemove(_hidden, message);
+	if (visibilityTimeout > 0) {
+		message->visibleAt = now + (int64_t) visibilityTimeout * 1000;
+		hide(message);
+	} else {
+		// Goes to the front, as the one received longest ago.
+		message->hidden = false;
+		listInsertAfter(_visible, NULL, message);
+		if (_waiters > 0)
+			_event.set();
+	}
+	return OK;
+}
+
+void EmulatedQueue::wakeAll() {
+	_event.set();
+}
+
+void EmulatedQueue::getMessageCounts(int& visible, int& hidden) {
+	MutexHolder holder(&_lock);
+	restoreExpired(Thread::getTickCount());
+	visible = _visible.size;
+	hidden = _hidden.size;
+}
+
+EmulatedMessage* EmulatedQueue::findMessage(const String& receiptHandle,
+		Status& status) {
+	int slot;
+	long long sequence;
+	int receiveCount;
+	int length = -1;
+	if (sscanf(receiptHandle.cstr(), "%d-%lld-%d%n", &slot, &sequence,
+			&receiveCount, &length) != 3
+			|| length != receiptHandle.getLength() || slot < 0
+			|| sequence <= 0 || sequence >= _nextSequence) {
+		status = INVALID_HANDLE;
+		return NULL;
+	}
+	// The message has been deleted, or received again since.
+	if (slot >= _slots.getSize() || _slots[slot] == NULL
+			|| _slots[slot]->sequence != sequence
+			|| _slots[slot]->receiveCount != receiveCount) {
+		status = NOT_IN_FLIGHT;
+		return NULL;
+	}
+	status = OK;
+	return _slots[slot];
+}
+
+void EmulatedQueue::hide(EmulatedMessage* message) {
+	// Mostly appends, as the timeouts of a queue are mostly the same.
+	EmulatedMessage* after = _hidden.tail;
+	while (after != NULL && after->visibleAt > message->visibleAt)
+		after = after->prev;
+	message->hidden = true;
+	listInsertAfter(_hidden, after, message);
+}
+
+void EmulatedQueue::restoreExpired(int64_t now) {
+	while (_hidden.head != NULL && _hidden.head->visibleAt <= now) {
+		EmulatedMessage* message = _hidden.head;
+		listRemove(_hidden, message);
+		message->hidden = false;
+		listInsertAfter(_visible, _visible.tail, message);
+	}
+}
+
+void EmulatedQueue::destroy(EmulatedMessage* message) {
+	_slots[message->slot] = NULL;
+	_freeSlots.add(message->slot);
+	delete message;
+}
@@ -0,0 +1,112 @@
+/*
+ * EmulatedQueue.h
+ */
+
+#ifndef EMULATEDQUEUE_H_
+#define EMULATEDQUEUE_H_
+
+#include <AWS/AWS.h>
+
+/// A copy of a message handed out by a receive.
+struct EmulatedDelivery {
+	String messageId;
+	String receiptHandle;
+	String md5OfBody;
+	String body;
+	/// The message attributes, by name, shared by all deliveries.
+	REF<AWSStringMap> attributeTypes;
+	REF<AWSStringMap> attributeValues;
+	int receiveCount;
+	/// Milliseconds since January 1, 1970 UTC.
+	int64_t sentTimestamp;
+	int64_t firstReceiveTimestamp;
+};
+
+struct EmulatedMessage;
+
+/// An intrusive list of messages, which never allocates.
+struct EmulatedMessageList {
+	EmulatedMessage* head;
+	EmulatedMessage* tail;
+	int size;
+};
+
+/// A standard queue held in memory, with the visibility timeout semantics of
+/// SQS: a received message is hidden until it is deleted or its visibility
+/// timeout expires, and each receive hands out a new receipt handle, so that
+/// the outdated ones can't delete or change the message any more. Messages
+/// may be received out of order once they have been received.
+class EmulatedQueue: public REFObject {
+public:
+	enum Status {
+		OK = 0,	/// Success
+		INVALID_HANDLE,	/// The receipt handle is malformed
+		NOT_IN_FLIGHT,	/// The message isn't hidden by a receive
+	};
+
+	EmulatedQueue(const String& name, int visibilityTimeout);
+	virtual ~EmulatedQueue();
+
+	const String& getName() const {
+		return _name;
+	}
+	int getVisibilityTimeout() const {
+		return _visibilityTimeout;
+	}
+
+	/// Appends a message, which becomes visible after given seconds. The
+	/// attribute maps may be NULL, they are shared rather than copied. Returns
+	/// the message ID.
+	String send(const String& body, const String& md5OfBody,
+			AWSStringMap* attributeTypes, AWSStringMap* attributeValues,
+			int delaySeconds);
+	/// Receives up to given number of visible messages, hiding them for the
+	/// visibility timeout in seconds. Waits up to given milliseconds for
+	/// the first one, or until the flag is raised and wakeAll() called.
+	/// Returns the number of messages received.
+	int receive(int maxCount, int visibilityTimeout, int waitTime,
+			ArrayListT<EmulatedDelivery>& deliveries, volatile bool* stopping);
+	/// Deletes the message received with given receipt handle. Deleting by an
+	/// outdated handle succeeds, but the message stays.
+	Status deleteMessage(const String& receiptHandle);
+	/// Changes the visibility timeout of a message being hidden, counting
+	/// from now.
+	Status changeVisibility(const String& receiptHandle,
+			int visibilityTimeout);
+	/// Wakes all the receives up, to see a raised stopping flag.
+	void wakeAll();
+
+	/// Gets the numbers of visible messages, and of hidden ones.
+	void getMessageCounts(int& visible, int& hidden);
+
+private:
+	// Finds the message by a receipt handle, the lock must be held. Returns
+	// NULL if the handle is outdated.
+	EmulatedMessage* findMessage(const String& receiptHandle, Status& status);
+	// Hides a message until its visibleAt, keeping the hidden list sorted.
+	// The lock must be held.
+	void hide(EmulatedMessage* message);
+	// Moves the hidden messages due to the visible list, the lock must be
+	// held.
+	void restoreExpired(int64_t now);
+	// Frees the slot of a message and destroys it, the lock must be held.
+	void destroy(EmulatedMessage* message);
+
+	String _name;
+	int _visibilityTimeout;
+
+	Mutex _lock;
+	// The visible messages in the order to be received, and the hidden ones
+	// by the time they become visible again.
+	EmulatedMessageList _visible;
+	EmulatedMessageList _hidden;
+	// The messages by the slot of their receipt handles, and the free slots.
+	ArrayListT<EmulatedMessage*> _slots;
+	ArrayListT<int> _freeSlots;
+	int64_t _nextSequence;
+	// The number of receives waiting, and the event they wait for.
+	int _waiters;
+	Event _event;
+};
+
+#endif /* EMULATEDQUEUE_H_ */
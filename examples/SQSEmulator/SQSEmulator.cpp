@@ -0,0 +1,1110 @@
+/*
+ * SQSEmulator.cpp
+ */
+
+#include "SQSEmulator.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <openssl/evp.h>
+#include <AWS/HttpUtils.h>
+
+#define LOG_TAG "SQSEmulator"
+
+// The size each connection reads by.
+#define READ_CHUNK_SIZE	65536
+// The maximum size of the head of a request.
+#define MAX_HEAD_SIZE	16384
+
+// A thread accepting the connections of an emulator.
+class EmulatorAcceptor: public Thread {
+public:
+	EmulatorAcceptor(SQSEmulator* emulator) :
+			_emulator(emulator) {
+	}
+
+protected:
+	virtual void run() {
+		_emulator->runAcceptor();
+	}
+
+private:
+	// The emulator stops the thread before being destroyed.
+	SQSEmulator* _emulator;
+};
+
+// A thread serving the requests of a connection, one at a time.
+class EmulatorConnection: public Thread {
+public:
+	EmulatorConnection(SQSEmulator* emulator, int socket) :
+			socket(socket), finished(false), _emulator(emulator) {
+	}
+	virtual ~EmulatorConnection() {
+		// Closed only once the thread is joined, so that the emulator can
+		// shut it down meanwhile.
+		close(socket);
+	}
+
+	int socket;
+	volatile bool finished;
+
+protected:
+	virtual void run() {
+		_emulator->runConnection(this);
+		finished = true;
+	}
+
+private:
+	// The emulator stops the thread before being destroyed.
+	SQSEmulator* _emulator;
+};
+
+//////////////////////////////////////////////////////////////////////////////
+
+// Decodes a URL encoded form field, returns false if malformed.
+static bool urlDecode(const char* data, int size, String& value) {
+	// Mostly nothing to decode in the names.
+	int i = 0;
+	while (i < size && data[i] != '%' && data[i] != '+')
+		i++;
+	if (i == size) {
+		value = String(data, size);
+		return true;
+	}
+
+	BufferT<char> buffer(size + 1);
+	char* decoded = buffer.getBuffer(size + 1);
+	memcpy(decoded, data, i);
+	int length = i;
+	for (; i < size; i++) {
+		char c = data[i];
+		if (c == '+') {
+			c = ' ';
+		} else if (c == '%') {
+			char hex[3] = { 0, 0, 0 };
+			if (i + 2 >= size || !isxdigit(data[i + 1])
+					|| !isxdigit(data[i + 2]))
+				return false;
+			hex[0] = data[i + 1];
+			hex[1] = data[i + 2];
+			c = (char) strtol(hex, NULL, 16);
+			i += 2;
+			// Not allowed in any field.
+			if (c == 0)
+				return false;
+		}
+		decoded[length++] = c;
+	}
+	decoded[length] = 0;
+	value = String(decoded, length);
+	return true;
+}
+
+// Parses a URL encoded form into given map, returns false if malformed.
+static bool parseForm(const char* data, int size, AWSStringMap* params) {
+	const char* end = data + size;
+	while (data < end) {
+		const char* fieldEnd = (const char*) memchr(data, '&', end - data);
+		if (fieldEnd == NULL)
+			fieldEnd = end;
+		const char* equals = (const char*) memchr(data, '=', fieldEnd - data);
+		if (equals == NULL)
+			equals = fieldEnd;
+		String name;
+		String value;
+		if (!urlDecode(data, equals - data, name))
+			return false;
+		if (equals < fieldEnd
+				&& !urlDecode(equals + 1, fieldEnd - equals - 1, value))
+			return false;
+		if (!name.isEmpty())
+			params->set(name, value);
+		data = fieldEnd + 1;
+	}
+	return true;
+}
+
+// Appends a value escaped as XML character data.
+static void appendEscaped(String& out, const String& value) {
+	const char* data = value.cstr();
+	int length = value.getLength();
+	int start = 0;
+	for (int i = 0; i < length; i++) {
+		const char* entity;
+		switch (data[i]) {
+		case '&':
+			entity = "&amp;";
+			break;
+		case '<':
+			entity = "&lt;";
+			break;
+		case '>':
+			entity = "&gt;";
+			break;
+		case '"':
+			entity = "&quot;";
+			break;
+		case '\r':
+			// Or the parser turns it into a line feed.
+			entity = "&#xD;";
+			break;
+		default:
+			continue;
+		}
+		if (i > start)
+			out.append(data + start, i - start);
+		out += entity;
+		start = i + 1;
+	}
+	if (start == 0)
+		out += value;
+	else if (length > start)
+		out.append(data + start, length - start);
+}
+
+// Appends <name>value</name>.
+static void appendElement(String& out, const char* name, const String& value) {
+	out += '<';
+	out += name;
+	out += '>';
+	appendEscaped(out, value);
+	out += "</";
+	out += name;
+	out += '>';
+}
+
+static String makeRequestId() {
+	static volatile long sequence = 0;
+	return String::format("00000000-0000-4000-8000-%012lx",
+			InterlockedIncrement(&sequence));
+}
+
+// Makes the response of an action, or with no result element if NULL.
+static String makeResponse(const char* action, const String* result) {
+	String response = String::format("<%sResponse xmlns=\""
+			"http://queue.amazonaws.com/doc/2012-11-05/\">", action);
+	if (result != NULL) {
+		response += String::format("<%sResult>", action);
+		response += *result;
+		response += String::format("</%sResult>", action);
+	}
+	response += "<ResponseMetadata><RequestId>";
+	response += makeRequestId();
+	response += "</RequestId></ResponseMetadata>";
+	response += String::format("</%sResponse>", action);
+	return response;
+}
+
+static String makeError(const char* code, const String& message) {
+	String response = "<ErrorResponse xmlns=\""
+			"http://queue.amazonaws.com/doc/2012-11-05/\"><Error>"
+			"<Type>Sender</Type>";
+	appendElement(response, "Code", code);
+	appendElement(response, "Message", message);
+	response += "<Detail/></Error><RequestId>";
+	response += makeRequestId();
+	response += "</RequestId></ErrorResponse>";
+	return response;
+}
+
+static String makeBatchError(const String& id, const char* code,
+		const String& message) {
+	String entry = "<BatchResultErrorEntry>";
+	appendElement(entry, "Id", id);
+	entry += "<SenderFault>true</SenderFault>";
+	appendElement(entry, "Code", code);
+	appendElement(entry, "Message", message);
+	entry += "</BatchResultErrorEntry>";
+	return entry;
+}
+
+static const String* getParam(AWSStringMap* params, const String& name) {
+	AWSStringMap::PENTRY entry = params->getEntry(name);
+	return (entry != NULL) ? &entry->value : NULL;
+}
+
+// Gets an integer parameter, or the default value if missing. Returns false
+// if not a number in range.
+static bool getIntParam(AWSStringMap* params, const String& name, int minValue,
+		int maxValue, int defaultValue, int& value) {
+	const String* param = getParam(params, name);
+	if (param == NULL) {
+		value = defaultValue;
+		return true;
+	}
+	char* end;
+	long n = strtol(param->cstr(), &end, 10);
+	if (param->isEmpty() || *end != 0 || n < minValue || n > maxValue)
+		return false;
+	value = (int) n;
+	return true;
+}
+
+static String computeMD5(const String& value) {
+	uint8_t digest[EVP_MAX_MD_SIZE];
+	unsigned int digestSize = 0;
+	EVP_Digest(value.cstr(), value.getLength(), digest, &digestSize,
+			EVP_md5(), NULL);
+	return HttpUtils::toHexString(digest, digestSize);
+}
+
+// Checks the values of a request to send a message, at given prefix of the
+// parameters. Sets the error code and message if invalid.
+static bool parseSendEntry(AWSStringMap* params, const String& prefix,
+		String& body, int& delaySeconds, REF<AWSStringMap>& attributeTypes,
+		REF<AWSStringMap>& attributeValues, const char*& errorCode,
+		String& errorMessage) {
+	const String* param = getParam(params, prefix + "MessageBody");
+	if (param == NULL || param->isEmpty()) {
+		errorCode = "MissingParameter";
+		errorMessage = "The request must contain the parameter MessageBody.";
+		return false;
+	}
+	body = *param;
+	int size = body.getLength();
+	if (!getIntParam(params, prefix + "DelaySeconds", 0, 900, 0,
+			delaySeconds)) {
+		errorCode = "InvalidParameterValue";
+		errorMessage = "Value for parameter DelaySeconds is invalid.";
+		return false;
+	}
+
+	String attributePrefix = prefix + "MessageAttribute.";
+	for (int i = 1;; i++) {
+		String name = attributePrefix + String::format("%d.", i);
+		const String* attributeName = getParam(params, name + "Name");
+		if (attributeName == NULL)
+			break;
+		const String* dataType = getParam(params, name + "Value.DataType");
+		const String* value = getParam(params,
+				name + "Value.StringValue");
+		if (value == NULL)
+			value = getParam(params, name + "Value.BinaryValue");
+		if (dataType == NULL || value == NULL) {
+			errorCode = "InvalidParameterValue";
+			errorMessage = "The message attribute '" + *attributeName
+					+ "' must contain a non-empty value of type "
+							"'String', 'Number' or 'Binary'.";
+			return false;
+		}
+		if (attributeTypes == NULL) {
+			attributeTypes = new AWSStringMap();
+			attributeValues = new AWSStringMap();
+		}
+		attributeTypes->set(*attributeName, *dataType);
+		attributeValues->set(*attributeName, *value);
+		size += attributeName->getLength() + dataType->getLength()
+				+ value->getLength();
+	}
+	if (size > SQSEmulator::MAX_MESSAGE_SIZE) {
+		errorCode = "InvalidParameterValue";
+		errorMessage = String::format("One or more parameters are invalid. "
+				"Reason: Message must be shorter than %d bytes.",
+				SQSEmulator::MAX_MESSAGE_SIZE);
+		return false;
+	}
+	return true;
+}
+
+// Gets the names of a list parameter, e.g. AttributeName.N.
+static void getNames(AWSStringMap* params, const char* prefix,
+		TreeMapT<String, bool>& names) {
+	for (int i = 1;; i++) {
+		const String* name = getParam(params, String::format("%s.%d", prefix,
+				i));
+		if (name == NULL)
+			break;
+		names.set(*name, true);
+	}
+}
+
+static void appendAttribute(String& out, const char* name,
+		const String& value) {
+	out += "<Attribute>";
+	appendElement(out, "Name", name);
+	appendElement(out, "Value", value);
+	out += "</Attribute>";
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+SQSEmulator::SQSEmulator() {
+	_latency = 0;
+	_throttleRatio = 0;
+	_autoCreate = true;
+	_maxRequestRate = 0;
+	_tokens = 0;
+	_lastRefill = 0;
+	_randomState = 2463534242u;
+	_queues.set(new EmulatedQueueMap());
+	_port = 0;
+	_listenSocket = -1;
+	_stopping = false;
+	_requestCount = 0;
+	_throttledCount = 0;
+	_sentCount = 0;
+	_receivedCount = 0;
+	_deletedCount = 0;
+}
+
+SQSEmulator::~SQSEmulator() {
+	stop();
+}
+
+void SQSEmulator::setMaxRequestRate(int maxRequestRate) {
+	SpinLockHolder holder(&_rateLock);
+	_maxRequestRate = maxRequestRate;
+	_tokens = maxRequestRate;
+	_lastRefill = Thread::getTickCount();
+}
+
+EmulatedQueue* SQSEmulator::createQueue(const String& name,
+		int visibilityTimeout) {
+	EmulatedQueue* queue = getQueue(name);
+	if (queue != NULL)
+		return queue;
+
+	// Copies the map, as the readers don't lock it.
+	MutexHolder holder(&_queuesLock);
+	EmulatedQueueMap* queues = _queues.get();
+	EmulatedQueueMap::PENTRY entry = queues->getEntry(name);
+	if (entry != NULL)
+		return entry->value;
+	REF<EmulatedQueueMap> newQueues = new EmulatedQueueMap();
+	for (entry = queues->getFirstEntry(); entry != NULL;
+			entry = queues->getNextEntry(entry))
+		newQueues->set(entry->key, entry->value);
+	REF<EmulatedQueue> newQueue = new EmulatedQueue(name, visibilityTimeout);
+	newQueues->set(name, newQueue);
+	_queues.set(newQueues);
+	return newQueue;
+}
+
+EmulatedQueue* SQSEmulator::getQueue(const String& name) {
+	EmulatedQueueMap::PENTRY entry = _queues.get()->getEntry(name);
+	return (entry != NULL) ? (EmulatedQueue*) entry->value : NULL;
+}
+
+bool SQSEmulator::start(int port) {
+	MutexHolder holder(&_lock);
+	if (_acceptor != NULL)
+		return true;
+
+	_listenSocket = socket(AF_INET, SOCK_STREAM, 0);
+	if (_listenSocket == -1) {
+		LOGE("Unable to create a socket: %s", strerror(errno));
+		return false;
+	}
+	int on = 1;
+	setsockopt(_listenSocket, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+	struct sockaddr_in address;
+	memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	address.sin_port = htons(port);
+	if (bind(_listenSocket, (struct sockaddr*) &address, sizeof(address)) != 0
+			|| listen(_listenSocket, SOMAXCONN) != 0) {
+		LOGE("Unable to listen on port %d: %s", port, strerror(errno));
+		close(_listenSocket);
+		_listenSocket = -1;
+		return false;
+	}
+	socklen_t addressSize = sizeof(address);
+	getsockname(_listenSocket, (struct sockaddr*) &address, &addressSize);
+	_port = ntohs(address.sin_port);
+
+	_stopping = false;
+	REF<EmulatorAcceptor> acceptor = new EmulatorAcceptor(this);
+	if (!acceptor->start()) {
+		LOGE("Unable to start the accepting thread.");
+		close(_listenSocket);
+		_listenSocket = -1;
+		return false;
+	}
+	_acceptor = acceptor;
+	return true;
+}
+
+void SQSEmulator::stop() {
+	REF<EmulatorAcceptor> acceptor;
+	{
+		MutexHolder holder(&_lock);
+		if (_acceptor == NULL)
+			return;
+		acceptor = _acceptor;
+		_acceptor = NULL;
+		_stopping = true;
+		// Wakes the accepting thread up.
+		shutdown(_listenSocket, SHUT_RDWR);
+	}
+	acceptor->join();
+	close(_listenSocket);
+	_listenSocket = -1;
+
+	// No more connections are added, wakes the rest up.
+	EmulatedQueueMap* queues = _queues.get();
+	for (EmulatedQueueMap::PENTRY entry = queues->getFirstEntry();
+			entry != NULL; entry = queues->getNextEntry(entry))
+		entry->value->wakeAll();
+	MutexHolder holder(&_lock);
+	for (int i = 0; i < _connections.getSize(); i++)
+		shutdown(_connections[i]->socket, SHUT_RDWR);
+	for (int i = 0; i < _connections.getSize(); i++)
+		_connections[i]->join();
+	_connections.clear();
+}
+
+String SQSEmulator::getEndpoint() const {
+	return String::format("http://127.0.0.1:%d", _port);
+}
+
+void SQSEmulator::runAcceptor() {
+	while (true) {
+		int connectionSocket = accept(_listenSocket, NULL, NULL);
+		if (connectionSocket == -1) {
+			if (_stopping)
+				break;
+			if (errno != EINTR && errno != ECONNABORTED)
+				LOGW("Unable to accept a connection: %s", strerror(errno));
+			continue;
+		}
+		int on = 1;
+		setsockopt(connectionSocket, IPPROTO_TCP, TCP_NODELAY, &on,
+				sizeof(on));
+
+		REF<EmulatorConnection> connection = new EmulatorConnection(this,
+				connectionSocket);
+		MutexHolder holder(&_lock);
+		// Joins the connections closed meanwhile.
+		for (int i = _connections.getSize() - 1; i >= 0; i--) {
+			if (_connections[i]->finished) {
+				_connections[i]->join();
+				_connections.removeAt(i);
+			}
+		}
+		if (_stopping || !connection->start()) {
+			if (!_stopping)
+				LOGE("Unable to start a connection thread.");
+			continue;
+		}
+		_connections.add(connection);
+	}
+}
+
+void SQSEmulator::runConnection(EmulatorConnection* connection) {
+	BufferT<char> buffer(READ_CHUNK_SIZE);
+	int size = 0;
+	int scanned = 0;
+	while (!_stopping) {
+		// Reads until the end of the head.
+		char* data = buffer.getBuffer(size + 1);
+		data[size] = 0;
+		int headSize = -1;
+		for (int i = BFX_MAX(scanned, 3); i < size; i++) {
+			if (data[i] == '\n' && data[i - 1] == '\r' && data[i - 2] == '\n'
+					&& data[i - 3] == '\r') {
+				headSize = i + 1;
+				break;
+			}
+		}
+		if (headSize == -1) {
+			scanned = size;
+			if (size >= MAX_HEAD_SIZE)
+				break;
+			data = buffer.getBuffer(size + READ_CHUNK_SIZE + 1);
+			int n = recv(connection->socket, data + size, READ_CHUNK_SIZE, 0);
+			if (n <= 0)
+				break;
+			size += n;
+			buffer.releaseBuffer(size);
+			continue;
+		}
+
+		// Parses the request line and the headers needed.
+		char method[16];
+		char target[2048];
+		if (sscanf(data, "%15s %2047s HTTP/1.%*d", method, target) != 2)
+			break;
+		char* requestLineEnd = strstr(data, "\r\n");
+		bool keepAlive = (strncmp(requestLineEnd - 8, "HTTP/1.0", 8) != 0);
+		bool expectContinue = false;
+		long contentLength = 0;
+		String host = "localhost";
+		for (char* line = requestLineEnd + 2; line < data + headSize - 2;
+				line = strstr(line, "\r\n") + 2) {
+			char* lineEnd = strstr(line, "\r\n");
+			if (strncasecmp(line, "Content-Length:", 15) == 0) {
+				contentLength = strtol(line + 15, NULL, 10);
+			} else if (strncasecmp(line, "Host:", 5) == 0) {
+				char* value = line + 5;
+				while (*value == ' ')
+					value++;
+				host = String(value, (int) (lineEnd - value));
+			} else if (strncasecmp(line, "Expect:", 7) == 0) {
+				expectContinue = true;
+			} else if (strncasecmp(line, "Connection:", 11) == 0) {
+				keepAlive = (strstr(line, "close") == NULL
+						|| strstr(line, "close") > lineEnd);
+			}
+		}
+		if (contentLength < 0 || contentLength > MAX_REQUEST_SIZE)
+			break;
+
+		// Reads the content.
+		if (expectContinue && size - headSize < contentLength) {
+			static const char response[] = "HTTP/1.1 100 Continue\r\n\r\n";
+			send(connection->socket, response, sizeof(response) - 1,
+					MSG_NOSIGNAL);
+		}
+		bool closed = false;
+		while (size - headSize < contentLength) {
+			data = buffer.getBuffer(size + READ_CHUNK_SIZE + 1);
+			int n = recv(connection->socket, data + size, READ_CHUNK_SIZE, 0);
+			if (n <= 0) {
+				closed = true;
+				break;
+			}
+			size += n;
+			buffer.releaseBuffer(size);
+		}
+		if (closed)
+			break;
+		data = buffer.getBuffer(size + 1);
+
+		// Handles the request.
+		int status;
+		String content;
+		{
+			REFAutoreleasePool pool;
+			REF<AWSStringMap> params = new AWSStringMap();
+			char* query = strchr(target, '?');
+			if (query != NULL)
+				*query++ = 0;
+			if ((query != NULL && !parseForm(query, strlen(query), params))
+					|| !parseForm(data + headSize, contentLength, params)) {
+				status = 400;
+				content = makeError("MalformedQueryString",
+						"The query string is malformed.");
+			} else {
+				status = handleRequest(host, target, params, content);
+			}
+		}
+		int consumed = headSize + contentLength;
+		buffer.remove(0, consumed);
+		size -= consumed;
+		scanned = 0;
+
+		// Sends the response.
+		if (_latency > 0)
+			Thread::sleep(_latency);
+		String response = String::format("HTTP/1.1 %d %s\r\n"
+				"Content-Type: text/xml\r\nContent-Length: %d\r\n%s\r\n",
+				status, (status == 200) ? "OK" : "Bad Request",
+				content.getLength(), keepAlive ? "" : "Connection: close\r\n");
+		response += content;
+		const char* p = response.cstr();
+		int remaining = response.getLength();
+		while (remaining > 0) {
+			int n = send(connection->socket, p, remaining, MSG_NOSIGNAL);
+			if (n <= 0)
+				break;
+			p += n;
+			remaining -= n;
+		}
+		if (remaining > 0 || !keepAlive)
+			break;
+	}
+	shutdown(connection->socket, SHUT_RDWR);
+}
+
+int SQSEmulator::handleRequest(const String& host, const String& path,
+		AWSStringMap* params, String& content) {
+	InterlockedIncrement(&_requestCount);
+	if (throttle()) {
+		InterlockedIncrement(&_throttledCount);
+		content = makeError("ThrottlingException", "Rate exceeded.");
+		return 400;
+	}
+
+	const String* action = getParam(params, "Action");
+	if (action == NULL) {
+		content = makeError("MissingAction",
+				"The request must contain the parameter Action.");
+		return 400;
+	}
+	if (*action == "CreateQueue")
+		return createQueue(host, params, content);
+	if (*action == "GetQueueUrl")
+		return getQueueUrl(host, params, content);
+	if (*action == "ListQueues")
+		return listQueues(host, params, content);
+
+	int (SQSEmulator::*handler)(EmulatedQueue*, AWSStringMap*, String&);
+	if (*action == "SendMessage")
+		handler = &SQSEmulator::sendMessage;
+	else if (*action == "SendMessageBatch")
+		handler = &SQSEmulator::sendMessageBatch;
+	else if (*action == "ReceiveMessage")
+		handler = &SQSEmulator::receiveMessage;
+	else if (*action == "DeleteMessage")
+		handler = &SQSEmulator::deleteMessage;
+	else if (*action == "DeleteMessageBatch")
+		handler = &SQSEmulator::deleteMessageBatch;
+	else if (*action == "ChangeMessageVisibility")
+		handler = &SQSEmulator::changeMessageVisibility;
+	else if (*action == "ChangeMessageVisibilityBatch")
+		handler = &SQSEmulator::changeMessageVisibilityBatch;
+	else {
+		content = makeError("InvalidAction",
+				"The action " + *action + " is not valid for this endpoint.");
+		return 400;
+	}
+	REF<EmulatedQueue> queue = resolveQueue(path, params, content);
+	if (queue == NULL)
+		return 400;
+	return (this->*handler)(queue, params, content);
+}
+
+bool SQSEmulator::throttle() {
+	if (_throttleRatio <= 0 && _maxRequestRate <= 0)
+		return false;
+
+	SpinLockHolder holder(&_rateLock);
+	if (_throttleRatio > 0) {
+		// xorshift32
+		_randomState ^= _randomState << 13;
+		_randomState ^= _randomState >> 17;
+		_randomState ^= _randomState << 5;
+		if (_randomState < _throttleRatio * 4294967295.0)
+			return true;
+	}
+	if (_maxRequestRate > 0) {
+		int64_t now = Thread::getTickCount();
+		_tokens += (now - _lastRefill) * _maxRequestRate / 1000.0;
+		if (_tokens > _maxRequestRate)
+			_tokens = _maxRequestRate;
+		_lastRefill = now;
+		if (_tokens < 1)
+			return true;
+		_tokens -= 1;
+	}
+	return false;
+}
+
+EmulatedQueue* SQSEmulator::resolveQueue(const String& path,
+		AWSStringMap* params, String& content) {
+	// The queue is the last segment of the URL.
+	const String* queueUrl = getParam(params, "QueueUrl");
+	const String& url = (queueUrl != NULL) ? *queueUrl : path;
+	int slash = url.getLength() - 1;
+	while (slash >= 0 && url[slash] != '/')
+		slash--;
+	String name = url.substring(slash + 1);
+	if (name.isEmpty()) {
+		content = makeError("MissingParameter",
+				"The request must contain the parameter QueueUrl.");
+		return NULL;
+	}
+	EmulatedQueue* queue = _autoCreate ? createQueue(name) : getQueue(name);
+	if (queue == NULL)
+		content = makeError("AWS.SimpleQueueService.NonExistentQueue",
+				"The specified queue does not exist for this wsdl version.");
+	return queue;
+}
+
+String SQSEmulator::getQueueUrl(const String& host, EmulatedQueue* queue) const {
+	return "http://" + host + "/queue/" + queue->getName();
+}
+
+int SQSEmulator::createQueue(const String& host, AWSStringMap* params,
+		String& content) {
+	const String* name = getParam(params, "QueueName");
+	if (name == NULL || name->isEmpty()) {
+		content = makeError("MissingParameter",
+				"The request must contain the parameter QueueName.");
+		return 400;
+	}
+	int visibilityTimeout = DEFAULT_VISIBILITY_TIMEOUT;
+	for (int i = 1;; i++) {
+		const String* attributeName = getParam(params,
+				String::format("Attribute.%d.Name", i));
+		if (attributeName == NULL)
+			break;
+		if (*attributeName == "VisibilityTimeout"
+				&& !getIntParam(params, String::format("Attribute.%d.Value", i),
+						0, 43200, DEFAULT_VISIBILITY_TIMEOUT,
+						visibilityTimeout)) {
+			content = makeError("InvalidAttributeValue",
+					"Invalid value for the parameter VisibilityTimeout.");
+			return 400;
+		}
+	}
+
+	String result;
+	appendElement(result, "QueueUrl",
+			getQueueUrl(host, createQueue(*name, visibilityTimeout)));
+	content = makeResponse("CreateQueue", &result);
+	return 200;
+}
+
+int SQSEmulator::getQueueUrl(const String& host, AWSStringMap* params,
+		String& content) {
+	const String* name = getParam(params, "QueueName");
+	if (name == NULL || name->isEmpty()) {
+		content = makeError("MissingParameter",
+				"The request must contain the parameter QueueName.");
+		return 400;
+	}
+	EmulatedQueue* queue = _autoCreate ? createQueue(*name) : getQueue(*name);
+	if (queue == NULL) {
+		content = makeError("AWS.SimpleQueueService.NonExistentQueue",
+				"The specified queue does not exist for this wsdl version.");
+		return 400;
+	}
+
+	String result;
+	appendElement(result, "QueueUrl", getQueueUrl(host, queue));
+	content = makeResponse("GetQueueUrl", &result);
+	return 200;
+}
+
+int SQSEmulator::listQueues(const String& host, AWSStringMap* params,
+		String& content) {
+	const String* prefix = getParam(params, "QueueNamePrefix");
+	String result;
+	EmulatedQueueMap* queues = _queues.get();
+	for (EmulatedQueueMap::PENTRY entry = queues->getFirstEntry();
+			entry != NULL; entry = queues->getNextEntry(entry)) {
+		if (prefix == NULL || entry->key.startsWith(prefix->cstr()))
+			appendElement(result, "QueueUrl", getQueueUrl(host, entry->value));
+	}
+	content = makeResponse("ListQueues", &result);
+	return 200;
+}
+
+int SQSEmulator::sendMessage(EmulatedQueue* queue, AWSStringMap* params,
+		String& content) {
+	String body;
+	int delaySeconds;
+	REF<AWSStringMap> attributeTypes;
+	REF<AWSStringMap> attributeValues;
+	const char* errorCode;
+	String errorMessage;
+	if (!parseSendEntry(params, String(), body, delaySeconds, attributeTypes,
+			attributeValues, errorCode, errorMessage)) {
+		content = makeError(errorCode, errorMessage);
+		return 400;
+	}
+
+	String md5OfBody = computeMD5(body);
+	String messageId = queue->send(body, md5OfBody, attributeTypes,
+			attributeValues, delaySeconds);
+	InterlockedIncrement(&_sentCount);
+
+	String result;
+	appendElement(result, "MD5OfMessageBody", md5OfBody);
+	appendElement(result, "MessageId", messageId);
+	content = makeResponse("SendMessage", &result);
+	return 200;
+}
+
+int SQSEmulator::sendMessageBatch(EmulatedQueue* queue, AWSStringMap* params,
+		String& content) {
+	String successful;
+	String failed;
+	int count = 0;
+	int sent = 0;
+	for (; count <= MAX_BATCH_ENTRIES; count++) {
+		String prefix = String::format("SendMessageBatchRequestEntry.%d.",
+				count + 1);
+		const String* id = getParam(params, prefix + "Id");
+		if (id == NULL)
+			break;
+		if (count == MAX_BATCH_ENTRIES) {
+			content = makeError(
+					"AWS.SimpleQueueService.TooManyEntriesInBatchRequest",
+					String::format("Maximum number of entries per request are "
+							"%d.", MAX_BATCH_ENTRIES));
+			return 400;
+		}
+
+		String body;
+		int delaySeconds;
+		REF<AWSStringMap> attributeTypes;
+		REF<AWSStringMap> attributeValues;
+		const char* errorCode;
+		String errorMessage;
+		if (!parseSendEntry(params, prefix, body, delaySeconds,
+				attributeTypes, attributeValues, errorCode, errorMessage)) {
+			failed += makeBatchError(*id, errorCode, errorMessage);
+			continue;
+		}
+		String md5OfBody = computeMD5(body);
+		String messageId = queue->send(body, md5OfBody, attributeTypes,
+				attributeValues, delaySeconds);
+		sent++;
+
+		successful += "<SendMessageBatchResultEntry>";
+		appendElement(successful, "Id", *id);
+		appendElement(successful, "MessageId", messageId);
+		appendElement(successful, "MD5OfMessageBody", md5OfBody);
+		successful += "</SendMessageBatchResultEntry>";
+	}
+	if (count == 0) {
+		content = makeError("AWS.SimpleQueueService.EmptyBatchRequest",
+				"There should be at least one SendMessageBatchRequestEntry in "
+						"the request.");
+		return 400;
+	}
+	InterlockedExchangeAdd(&_sentCount, sent);
+
+	successful += failed;
+	content = makeResponse("SendMessageBatch", &successful);
+	return 200;
+}
+
+int SQSEmulator::receiveMessage(EmulatedQueue* queue, AWSStringMap* params,
+		String& content) {
+	int maxCount;
+	int visibilityTimeout;
+	int waitTimeSeconds;
+	if (!getIntParam(params, "MaxNumberOfMessages", 1, MAX_RECEIVE_MESSAGES,
+			1, maxCount)
+			|| !getIntParam(params, "VisibilityTimeout", 0, 43200,
+					queue->getVisibilityTimeout(), visibilityTimeout)
+			|| !getIntParam(params, "WaitTimeSeconds", 0,
+					MAX_WAIT_TIME_SECONDS, 0, waitTimeSeconds)) {
+		content = makeError("InvalidParameterValue",
+				"Value for parameter MaxNumberOfMessages, VisibilityTimeout "
+						"or WaitTimeSeconds is invalid.");
+		return 400;
+	}
+	TreeMapT<String, bool> attributeNames;
+	TreeMapT<String, bool> messageAttributeNames;
+	getNames(params, "AttributeName", attributeNames);
+	getNames(params, "MessageAttributeName", messageAttributeNames);
+	bool allAttributes = attributeNames.containsKey("All");
+	bool senderId = allAttributes || attributeNames.containsKey("SenderId");
+	bool sentTimestamp = allAttributes
+			|| attributeNames.containsKey("SentTimestamp");
+	bool receiveCount = allAttributes
+			|| attributeNames.containsKey("ApproximateReceiveCount");
+	bool firstReceiveTimestamp = allAttributes
+			|| attributeNames.containsKey("ApproximateFirstReceiveTimestamp");
+	bool allMessageAttributes = messageAttributeNames.containsKey("All")
+			|| messageAttributeNames.containsKey(".*");
+
+	ArrayListT<EmulatedDelivery> deliveries(maxCount);
+	int count = queue->receive(maxCount, visibilityTimeout,
+			waitTimeSeconds * 1000, deliveries, &_stopping);
+	InterlockedExchangeAdd(&_receivedCount, count);
+
+	String result;
+	for (int i = 0; i < count; i++) {
+		EmulatedDelivery& delivery = deliveries[i];
+		result += "<Message>";
+		appendElement(result, "MessageId", delivery.messageId);
+		appendElement(result, "ReceiptHandle", delivery.receiptHandle);
+		appendElement(result, "MD5OfBody", delivery.md5OfBody);
+		appendElement(result, "Body", delivery.body);
+		if (senderId)
+			appendAttribute(result, "SenderId", "000000000000");
+		if (sentTimestamp)
+			appendAttribute(result, "SentTimestamp",
+					String::format("%lld",
+							(long long) delivery.sentTimestamp));
+		if (receiveCount)
+			appendAttribute(result, "ApproximateReceiveCount",
+					String::format("%d", delivery.receiveCount));
+		if (firstReceiveTimestamp)
+			appendAttribute(result, "ApproximateFirstReceiveTimestamp",
+					String::format("%lld",
+							(long long) delivery.firstReceiveTimestamp));
+		if (delivery.attributeValues != NULL) {
+			for (AWSStringMap::PENTRY entry =
+					delivery.attributeValues->getFirstEntry(); entry != NULL;
+					entry = delivery.attributeValues->getNextEntry(entry)) {
+				if (!allMessageAttributes
+						&& !messageAttributeNames.containsKey(entry->key))
+					continue;
+				const String& dataType =
+						delivery.attributeTypes->getEntry(entry->key)->value;
+				result += "<MessageAttribute>";
+				appendElement(result, "Name", entry->key);
+				result += "<Value>";
+				appendElement(result,
+						dataType.startsWith("Binary") ?
+								"BinaryValue" : "StringValue", entry->value);
+				appendElement(result, "DataType", dataType);
+				result += "</Value></MessageAttribute>";
+			}
+		}
+		result += "</Message>";
+	}
+	content = makeResponse("ReceiveMessage", &result);
+	return 200;
+}
+
+int SQSEmulator::deleteMessage(EmulatedQueue* queue, AWSStringMap* params,
+		String& content) {
+	const String* receiptHandle = getParam(params, "ReceiptHandle");
+	if (receiptHandle == NULL) {
+		content = makeError("MissingParameter",
+				"The request must contain the parameter ReceiptHandle.");
+		return 400;
+	}
+	if (queue->deleteMessage(*receiptHandle) != EmulatedQueue::OK) {
+		content = makeError("ReceiptHandleIsInvalid",
+				"The input receipt handle is invalid.");
+		return 400;
+	}
+	InterlockedIncrement(&_deletedCount);
+
+	content = makeResponse("DeleteMessage", NULL);
+	return 200;
+}
+
+int SQSEmulator::deleteMessageBatch(EmulatedQueue* queue,
+		AWSStringMap* params, String& content) {
+	String successful;
+	String failed;
+	int count = 0;
+	int deleted = 0;
+	for (; count <= MAX_BATCH_ENTRIES; count++) {
+		String prefix = String::format("DeleteMessageBatchRequestEntry.%d.",
+				count + 1);
+		const String* id = getParam(params, prefix + "Id");
+		if (id == NULL)
+			break;
+		if (count == MAX_BATCH_ENTRIES) {
+			content = makeError(
+					"AWS.SimpleQueueService.TooManyEntriesInBatchRequest",
+					String::format("Maximum number of entries per request are "
+							"%d.", MAX_BATCH_ENTRIES));
+			return 400;
+		}
+
+		const String* receiptHandle = getParam(params,
+				prefix + "ReceiptHandle");
+		if (receiptHandle == NULL
+				|| queue->deleteMessage(*receiptHandle) != EmulatedQueue::OK) {
+			failed += makeBatchError(*id, "ReceiptHandleIsInvalid",
+					"The input receipt handle is invalid.");
+			continue;
+		}
+		deleted++;
+		successful += "<DeleteMessageBatchResultEntry>";
+		appendElement(successful, "Id", *id);
+		successful += "</DeleteMessageBatchResultEntry>";
+	}
+	if (count == 0) {
+		content = makeError("AWS.SimpleQueueService.EmptyBatchRequest",
+				"There should be at least one DeleteMessageBatchRequestEntry "
+						"in the request.");
+		return 400;
+	}
+	InterlockedExchangeAdd(&_deletedCount, deleted);
+
+	successful += failed;
+	content = makeResponse("DeleteMessageBatch", &successful);
+	return 200;
+}
+
+int SQSEmulator::changeMessageVisibility(EmulatedQueue* queue,
+		AWSStringMap* params, String& content) {
+	const String* receiptHandle = getParam(params, "ReceiptHandle");
+	int visibilityTimeout;
+	if (receiptHandle == NULL
+			|| !getParam(params, "VisibilityTimeout")
+			|| !getIntParam(params, "VisibilityTimeout", 0, 43200, 0,
+					visibilityTimeout)) {
+		content = makeError("InvalidParameterValue",
+				"Value for parameter ReceiptHandle or VisibilityTimeout is "
+						"invalid.");
+		return 400;
+	}
+	switch (queue->changeVisibility(*receiptHandle, visibilityTimeout)) {
+	case EmulatedQueue::OK:
+		break;
+	case EmulatedQueue::NOT_IN_FLIGHT:
+		content = makeError("AWS.SimpleQueueService.MessageNotInflight",
+				"The message referred to isn't in flight.");
+		return 400;
+	default:
+		content = makeError("ReceiptHandleIsInvalid",
+				"The input receipt handle is invalid.");
+		return 400;
+	}
+
+	content = makeResponse("ChangeMessageVisibility", NULL);
+	return 200;
+}
+
+int SQSEmulator::changeMessageVisibilityBatch(EmulatedQueue* queue,
+		AWSStringMap* params, String& content) {
+	String successful;
+	String failed;
+	int count = 0;
+	for (; count <= MAX_BATCH_ENTRIES; count++) {
+		String prefix = String::format(
+				"ChangeMessageVisibilityBatchRequestEntry.%d.", count + 1);
+		const String* id = getParam(params, prefix + "Id");
+		if (id == NULL)
+			break;
+		if (count == MAX_BATCH_ENTRIES) {
+			content = makeError(
+					"AWS.SimpleQueueService.TooManyEntriesInBatchRequest",
+					String::format("Maximum number of entries per request are "
+							"%d.", MAX_BATCH_ENTRIES));
+			return 400;
+		}
+
+		const String* receiptHandle = getParam(params,
+				prefix + "ReceiptHandle");
+		int visibilityTimeout;
+		if (receiptHandle == NULL
+				|| !getParam(params, prefix + "VisibilityTimeout")
+				|| !getIntParam(params, prefix + "VisibilityTimeout", 0,
+						43200, 0, visibilityTimeout)) {
+			failed += makeBatchError(*id, "InvalidParameterValue",
+					"Value for parameter ReceiptHandle or VisibilityTimeout "
+							"is invalid.");
+			continue;
+		}
+		switch (queue->changeVisibility(*receiptHandle, visibilityTimeout)) {
+		case EmulatedQueue::OK:
+			successful += "<ChangeMessageVisibilityBatchResultEntry>";
+			appendElement(successful, "Id", *id);
+			successful += "</ChangeMessageVisibilityBatchResultEntry>";
+			break;
+		case EmulatedQueue::NOT_IN_FLIGHT:
+			failed += makeBatchError(*id,
+					"AWS.SimpleQueueService.MessageNotInflight",
+					"The message referred to isn't in flight.");
+			break;
+		default:
+			failed += makeBatchError(*id, "ReceiptHandleIsInvalid",
+					"The input receipt handle is invalid.");
+			break;
+		}
+	}
+	if (count == 0) {
+		content = makeError("AWS.SimpleQueueService.EmptyBatchRequest",
+				"There should be at least one "
+						"ChangeMessageVisibilityBatchRequestEntry in the "
+						"request.");
+		return 400;
+	}
+
+	successful += failed;
+	content = makeResponse("ChangeMessageVisibilityBatch", &successful);
+	return 200;
+}
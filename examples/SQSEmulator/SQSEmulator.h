@@ -0,0 +1,160 @@
+/*
+ * SQSEmulator.h
+ */
+
+#ifndef SQSEMULATOR_H_
+#define SQSEMULATOR_H_
+
+#include "EmulatedQueue.h"
+
+class EmulatorAcceptor;
+class EmulatorConnection;
+
+typedef REFWrapper<TreeMapT<String, REF<EmulatedQueue> > > EmulatedQueueMap;
+
+/// A local stand-in of SQS, serving the query protocol SQSClient speaks over
+/// HTTP/1.1 on loopback, so that pipelines can be load tested without AWS.
+/// It runs in the process which starts it, e.g. next to the client under
+/// test, or standalone by example_SQSEmulator.
+///
+/// Supports CreateQueue, GetQueueUrl, ListQueues, SendMessage(Batch),
+/// ReceiveMessage with long polling, DeleteMessage(Batch) and
+/// ChangeMessageVisibility(Batch) of standard queues, with the visibility
+/// timeout semantics of SQS. Requests aren't authenticated, and queue URLs
+/// look like http://host:port/queue/name. Queues are created on first use
+/// unless disabled.
+///
+/// Each connection is served by its own thread, and each queue has its own
+/// lock, so that the client rather than the emulator is the bottleneck of a
+/// load test. Latency and throttling can be injected to see how the client
+/// copes.
+class SQSEmulator: public REFObject {
+public:
+	enum {
+		DEFAULT_PORT = 9324,	/// Default port to listen on
+		DEFAULT_VISIBILITY_TIMEOUT = 30,	/// Default of new queues
+		MAX_WAIT_TIME_SECONDS = 20,	/// Maximum long-poll duration
+		MAX_RECEIVE_MESSAGES = 10,	/// Maximum number of messages per receive
+		MAX_BATCH_ENTRIES = 10,	/// Maximum number of entries of a batch
+		MAX_MESSAGE_SIZE = 262144,	/// Maximum size of a message body
+		MAX_REQUEST_SIZE = 4194304,	/// Maximum size of a request
+	};
+
+	SQSEmulator();
+	virtual ~SQSEmulator();
+
+	/// Sets the time in milliseconds each response is delayed by.
+	void setLatency(int latency) {
+		_latency = latency;
+	}
+	/// Sets the ratio of requests failed by ThrottlingException, at random.
+	void setThrottleRatio(double throttleRatio) {
+		_throttleRatio = throttleRatio;
+	}
+	/// Sets the maximum number of requests per second, the requests beyond
+	/// are failed by ThrottlingException. 0 for no limit.
+	void setMaxRequestRate(int maxRequestRate);
+	/// Sets whether a queue is created when a request refers to it while it
+	/// doesn't exist.
+	void setAutoCreate(bool autoCreate) {
+		_autoCreate = autoCreate;
+	}
+
+	/// Gets or creates a queue, with given default visibility timeout in
+	/// seconds if created.
+	EmulatedQueue* createQueue(const String& name, int visibilityTimeout =
+			DEFAULT_VISIBILITY_TIMEOUT);
+	/// Gets a queue, or NULL if it doesn't exist.
+	EmulatedQueue* getQueue(const String& name);
+
+	/// Starts serving on given port of the loopback interface.
+	bool start(int port = DEFAULT_PORT);
+	/// Closes all connections, and stops the threads.
+	void stop();
+	/// Gets the endpoint to set on SQSClient.
+	String getEndpoint() const;
+
+	int64_t getRequestCount() const {
+		return _requestCount;
+	}
+	int64_t getThrottledCount() const {
+		return _throttledCount;
+	}
+	int64_t getSentCount() const {
+		return _sentCount;
+	}
+	int64_t getReceivedCount() const {
+		return _receivedCount;
+	}
+	int64_t getDeletedCount() const {
+		return _deletedCount;
+	}
+
+private:
+	friend class EmulatorAcceptor;
+	friend class EmulatorConnection;
+
+	// The loop of the accepting thread.
+	void runAcceptor();
+	// The loop of each connection thread.
+	void runConnection(EmulatorConnection* connection);
+	// Handles a request, returns the HTTP status and sets the XML content.
+	int handleRequest(const String& host, const String& path,
+			AWSStringMap* params, String& content);
+	// Returns true if the request is to be throttled.
+	bool throttle();
+	// Gets the queue a request refers to by its path or QueueUrl, sets the
+	// error content if none.
+	EmulatedQueue* resolveQueue(const String& path, AWSStringMap* params,
+			String& content);
+	String getQueueUrl(const String& host, EmulatedQueue* queue) const;
+
+	int createQueue(const String& host, AWSStringMap* params, String& content);
+	int getQueueUrl(const String& host, AWSStringMap* params, String& content);
+	int listQueues(const String& host, AWSStringMap* params, String& content);
+	int sendMessage(EmulatedQueue* queue, AWSStringMap* params,
+			String& content);
+	int sendMessageBatch(EmulatedQueue* queue, AWSStringMap* params,
+			String& content);
+	int receiveMessage(EmulatedQueue* queue, AWSStringMap* params,
+			String& content);
+	int deleteMessage(EmulatedQueue* queue, AWSStringMap* params,
+			String& content);
+	int deleteMessageBatch(EmulatedQueue* queue, AWSStringMap* params,
+			String& content);
+	int changeMessageVisibility(EmulatedQueue* queue, AWSStringMap* params,
+			String& content);
+	int changeMessageVisibilityBatch(EmulatedQueue* queue,
+			AWSStringMap* params, String& content);
+
+	int _latency;
+	double _throttleRatio;
+	bool _autoCreate;
+
+	// The token bucket limiting the request rate, and the random numbers to
+	// throttle by.
+	SpinLock _rateLock;
+	int _maxRequestRate;
+	double _tokens;
+	int64_t _lastRefill;
+	uint32_t _randomState;
+
+	// The queues by name, replaced as a whole when a queue is created.
+	Mutex _queuesLock;
+	RCUPointerT<EmulatedQueueMap> _queues;
+
+	Mutex _lock;
+	int _port;
+	int _listenSocket;
+	volatile bool _stopping;
+	REF<EmulatorAcceptor> _acceptor;
+	ArrayListT<REF<EmulatorConnection> > _connections;
+
+	volatile long _requestCount;
+	volatile long _throttledCount;
+	volatile long _sentCount;
+	volatile long _receivedCount;
+	volatile long _deletedCount;
+};
+
+#endif /* SQSEMULATOR_H_ */
@@ -0,0 +1,236 @@
+/*
+ * main.cpp
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include "SQSEmulator.h"
+
+static volatile sig_atomic_t stopped = 0;
+
+static void onSignal(int signal) {
+	stopped = 1;
+}
+
+// Sends and then drains its share of the messages by batches, as fast as a
+// client can.
+class BenchThread: public Thread {
+public:
+	BenchThread(const String& endpoint, const String& queueUrl, int messages) :
+			sendTime(0), receiveTime(0), received(0), failures(0), _endpoint(
+					endpoint), _queueUrl(queueUrl), _messages(messages) {
+	}
+
+	int64_t sendTime;
+	int64_t receiveTime;
+	int received;
+	int failures;
+
+	// Waits for the other threads between the phases.
+	static Mutex barrierLock;
+	static Event barrierEvent;
+	static int barrierCount;
+
+protected:
+	virtual void run() {
+		REFAutoreleasePool pool;
+		REF<AWSClientFactory> factory = new AWSClientFactory();
+		factory->setRegion(AWSRegion::getRegion("cn-north-1"));
+		SQSClient* client = factory->createSQSClient("my_accessid",
+				"my_secretkey");
+		client->setEndpoint(_endpoint);
+
+		int64_t startTime = Thread::getTickCount();
+		for (int sent = 0; sent < _messages;) {
+			REFAutoreleasePool loopPool;
+			REF<SQSSendMessageBatchParams> params =
+					new SQSSendMessageBatchParams(_queueUrl);
+			for (int i = 0; i < 10 && sent + i < _messages; i++) {
+				REF<SQSSendMessageBatchRequestEntry> entry =
+						new SQSSendMessageBatchRequestEntry();
+				entry->id = String::format("%d", i);
+				entry->messageBody = String::format("message %d", sent + i);
+				params->getEntries()->addLast(entry);
+			}
+			SQSSendMessageBatchResult* result = client->sendMessageBatch(
+					params);
+			if (result == NULL || !result->getErrorCode().isEmpty()) {
+				failures++;
+				continue;
+			}
+			sent += result->getSuccessful()->getSize();
+		}
+		sendTime = Thread::getTickCount() - startTime;
+
+		bool last;
+		{
+			MutexHolder holder(&barrierLock);
+			last = (--barrierCount == 0);
+		}
+		if (last)
+			barrierEvent.set();
+		else
+			barrierEvent.wait();
+
+		startTime = Thread::getTickCount();
+		while (received < _messages) {
+			REFAutoreleasePool loopPool;
+			REF<SQSReceiveMessageParams> params = new SQSReceiveMessageParams(
+					_queueUrl);
+			params->setMaxNumberOfMessages(10);
+			params->setWaitTimeSeconds(1);
+			SQSReceiveMessageResult* result = client->receiveMessage(params);
+			if (result == NULL || !result->getErrorCode().isEmpty()) {
+				failures++;
+				continue;
+			}
+			SQSMessageList* messages = result->getMessages();
+			if (messages->getSize() == 0)
+				break;
+			REF<SQSDeleteMessageBatchParams> deleteParams =
+					new SQSDeleteMessageBatchParams(_queueUrl);
+			int i = 0;
+			for (SQSMessageList::PENTRY entry = messages->getFirstEntry();
+					entry != NULL; entry = messages->getNextEntry(entry)) {
+				REF<SQSDeleteMessageBatchRequestEntry> deleteEntry =
+						new SQSDeleteMessageBatchRequestEntry();
+				deleteEntry->id = String::format("%d", i++);
+				deleteEntry->receiptHandle = entry->value->receiptHandle;
+				deleteParams->getEntries()->addLast(deleteEntry);
+			}
+			if (client->deleteMessageBatch(deleteParams) == NULL)
+				failures++;
+			received += messages->getSize();
+		}
+		receiveTime = Thread::getTickCount() - startTime;
+	}
+
+private:
+	String _endpoint;
+	String _queueUrl;
+	int _messages;
+};
+
+Mutex BenchThread::barrierLock;
+Event BenchThread::barrierEvent(true);
+int BenchThread::barrierCount = 0;
+
+void usage(const char* program) {
+	printf("Usage: %s [port] [latency_ms] [throttle_ratio]"
+			" [max_requests_per_second]\n", program);
+	printf("  e.g. %s 9324 0 0.01\n", program);
+	printf("  Serves on loopback until interrupted, the queues are created on"
+			" first use, e.g.\n  http://localhost:9324/queue/bench.\n");
+	printf("Usage: %s bench [messages] [threads]\n", program);
+	printf("  Sends and drains the messages through an in-process emulator,"
+			" by batches of\n  10, to show the rate a client can reach.\n");
+}
+
+static int runBench(int messages, int threads) {
+	REF<SQSEmulator> emulator = new SQSEmulator();
+	if (!emulator->start(0)) {
+		printf("Unable to start the emulator.\n");
+		return -1;
+	}
+	String endpoint = emulator->getEndpoint();
+	String queueUrl = endpoint + "/queue/bench";
+
+	BenchThread::barrierCount = threads;
+	ArrayListT<REF<BenchThread> > benchThreads;
+	for (int i = 0; i < threads; i++) {
+		REF<BenchThread> thread = new BenchThread(endpoint, queueUrl,
+				messages / threads + ((i < messages % threads) ? 1 : 0));
+		thread->start();
+		benchThreads.add(thread);
+	}
+	int64_t sendTime = 0;
+	int64_t receiveTime = 0;
+	int received = 0;
+	int failures = 0;
+	for (int i = 0; i < threads; i++) {
+		benchThreads[i]->join();
+		sendTime = BFX_MAX(sendTime, benchThreads[i]->sendTime);
+		receiveTime = BFX_MAX(receiveTime, benchThreads[i]->receiveTime);
+		received += benchThreads[i]->received;
+		failures += benchThreads[i]->failures;
+	}
+	emulator->stop();
+
+	printf("Sent %d messages in %d ms: %d messages/s.\n", messages,
+			(int) sendTime, (int) (messages * 1000LL / BFX_MAX(sendTime, 1)));
+	printf("Received and deleted %d messages in %d ms: %d messages/s.\n",
+			received, (int) receiveTime,
+			(int) (received * 1000LL / BFX_MAX(receiveTime, 1)));
+	printf("Emulator: %lld requests, %lld sent, %lld received, %lld deleted,"
+			" %d failures.\n", (long long) emulator->getRequestCount(),
+			(long long) emulator->getSentCount(),
+			(long long) emulator->getReceivedCount(),
+			(long long) emulator->getDeletedCount(), failures);
+	return 0;
+}
+
+int main(int argc, char* argv[]) {
+	// Initializes the current auto release pool.
+	REFAutoreleasePool pool;
+	// Logging each request would take longer than serving it.
+	log_setlevel(LL_WARN);
+
+	if (argc > 1 && strcmp(argv[1], "bench") == 0) {
+		int messages = (argc > 2) ? atoi(argv[2]) : 200000;
+		int threads = (argc > 3) ? atoi(argv[3]) : 8;
+		if (messages <= 0 || threads <= 0) {
+			usage(argv[0]);
+			return -1;
+		}
+		return runBench(messages, threads);
+	}
+	if (argc > 1 && argv[1][0] == '-') {
+		usage(argv[0]);
+		return -1;
+	}
+	int port = (argc > 1) ? atoi(argv[1]) : SQSEmulator::DEFAULT_PORT;
+	int latency = (argc > 2) ? atoi(argv[2]) : 0;
+	double throttleRatio = (argc > 3) ? atof(argv[3]) : 0;
+	int maxRequestRate = (argc > 4) ? atoi(argv[4]) : 0;
+
+	REF<SQSEmulator> emulator = new SQSEmulator();
+	emulator->setLatency(latency);
+	emulator->setThrottleRatio(throttleRatio);
+	emulator->setMaxRequestRate(maxRequestRate);
+	if (!emulator->start(port)) {
+		printf("Unable to listen on port %d.\n", port);
+		return -1;
+	}
+	printf("Serving on %s, interrupt to stop.\n",
+			emulator->getEndpoint().cstr());
+
+	signal(SIGINT, onSignal);
+	signal(SIGTERM, onSignal);
+	int64_t lastRequests = 0;
+	int64_t lastSent = 0;
+	int64_t lastReceived = 0;
+	int64_t lastDeleted = 0;
+	while (!stopped) {
+		Thread::sleep(1000);
+		int64_t requests = emulator->getRequestCount();
+		int64_t sent = emulator->getSentCount();
+		int64_t received = emulator->getReceivedCount();
+		int64_t deleted = emulator->getDeletedCount();
+		if (requests != lastRequests)
+			printf("%d requests/s, %d sent/s, %d received/s, %d deleted/s,"
+					" %lld throttled in total.\n",
+					(int) (requests - lastRequests), (int) (sent - lastSent),
+					(int) (received - lastReceived),
+					(int) (deleted - lastDeleted),
+					(long long) emulator->getThrottledCount());
+		lastRequests = requests;
+		lastSent = sent;
+		lastReceived = received;
+		lastDeleted = deleted;
+	}
+	emulator->stop();
+
+	return 0;
+}
@@ -0,0 +1,362 @@
+/*
+ * main.cpp
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <AWS/AWS.h>
+#include <AWS/HttpUtils.h>
+#include <JSON/JSON.h>
+
+static const char queueUrl[] =
+		"https://sqs.cn-north-1.amazonaws.com.cn/123456789012/bench-queue";
+
+// The content type libcurl sends with the parameters of a query request.
+static const char queryContentType[] =
+		"Content-Type: application/x-www-form-urlencoded\r\n";
+
+// Makes a body as applications send: JSON text, which both protocols have
+// to escape.
+String makeBody(int index, int bodySize) {
+	String body = String::format("{\"type\":\"report\",\"id\":%d,\"items\":[",
+			100000 + index);
+	for (int i = 0; body.getLength() < bodySize; i++) {
+		body += String::format("{\"name\":\"item %d & co\",\"value\":%d},", i,
+				i * 7);
+	}
+	body += "{}]}";
+	return body;
+}
+
+String escapeXml(const String& value) {
+	String result;
+	for (int i = 0; i < value.getLength(); i++) {
+		switch (value[i]) {
+		case '&':
+			result += "&amp;";
+			break;
+		case '<':
+			result += "&lt;";
+			break;
+		case '>':
+			result += "&gt;";
+			break;
+		case '"':
+			result += "&quot;";
+			break;
+		default:
+			result.append(value[i]);
+		}
+	}
+	return result;
+}
+
+String makeMessageId(int index) {
+	return String::format("5fea7756-0ea4-451a-a703-%012d", index);
+}
+
+String makeReceiptHandle(int index) {
+	return String::format("AQEBzWwaftRI0KuVm4tP+/7q1rGgNqicHq/RNB21ljdMJvkt8o5"
+			"KWcv2ux3Gz4Pf5AGj0wW+9uTdl1B+Q+1yiSLp6LzrgHTpKu7C5iKy0AHjBm1VMs3P"
+			"bE/YbWtmFfFvYQj2IrEc4+hZHOv5Yop6lDwWb8nYOOzZQ1gMyYzN23vRa2Wrc8jLm"
+			"c4fuqHHqEbtd9RfVM1iyHxd40JB5CKnZAupKvmxc2yT/mS4tpCkGDpNLwJb9yhqhB"
+			"QaThkXWtmGfEoo/M4Cd36nsjB5gXZ%06d", index);
+}
+
+String makeTrace(int index) {
+	return String::format("Root=1-54ef1a80-%024d", index);
+}
+
+// Builds the response to SendMessage in each protocol.
+String makeSendMessageXml() {
+	return "<?xml version=\"1.0\"?><SendMessageResponse"
+			" xmlns=\"http://queue.amazonaws.com/doc/2012-11-05/\">"
+			"<SendMessageResult><MessageId>" + makeMessageId(0)
+			+ "</MessageId><MD5OfMessageBody>fafb00f5732ab283681e124bf8747ed1"
+					"</MD5OfMessageBody><MD5OfMessageAttributes>"
+					"bd4ebae1fe86ec6b8e4b1ad6bba3a4b7</MD5OfMessageAttributes>"
+					"</SendMessageResult><ResponseMetadata><RequestId>"
+					"b6633655-283d-45b4-aee4-4e84e0ae6afa</RequestId>"
+					"</ResponseMetadata></SendMessageResponse>";
+}
+
+String makeSendMessageJson() {
+	return "{\"MD5OfMessageAttributes\":\"bd4ebae1fe86ec6b8e4b1ad6bba3a4b7\","
+			"\"MD5OfMessageBody\":\"fafb00f5732ab283681e124bf8747ed1\","
+			"\"MessageId\":\"" + makeMessageId(0) + "\"}";
+}
+
+// Builds the response to ReceiveMessage of given messages in each protocol,
+// with the system attributes and a message attribute as SQS sends them.
+String makeReceiveMessageXml(int messages, int bodySize) {
+	String content = "<?xml version=\"1.0\"?><ReceiveMessageResponse"
+			" xmlns=\"http://queue.amazonaws.com/doc/2012-11-05/\">"
+			"<ReceiveMessageResult>";
+	for (int i = 0; i < messages; i++) {
+		content += "<Message><MessageId>" + makeMessageId(i)
+				+ "</MessageId><ReceiptHandle>" + makeReceiptHandle(i)
+				+ "</ReceiptHandle><MD5OfBody>fafb00f5732ab283681e124bf8747ed1"
+						"</MD5OfBody><Body>" + escapeXml(makeBody(i, bodySize))
+				+ "</Body><Attribute><Name>SenderId</Name>"
+						"<Value>AIDAIENQZJOLO23YVJ4VO</Value></Attribute>"
+						"<Attribute><Name>ApproximateFirstReceiveTimestamp</Name>"
+						"<Value>1424937600000</Value></Attribute>"
+						"<Attribute><Name>ApproximateReceiveCount</Name>"
+						"<Value>1</Value></Attribute>"
+						"<Attribute><Name>SentTimestamp</Name>"
+						"<Value>1424937599871</Value></Attribute>"
+						"<MD5OfMessageAttributes>bd4ebae1fe86ec6b8e4b1ad6bba3a4b7"
+						"</MD5OfMessageAttributes><MessageAttribute>"
+						"<Name>trace</Name><Value><StringValue>" + makeTrace(i)
+				+ "</StringValue><DataType>String</DataType></Value>"
+						"</MessageAttribute></Message>";
+	}
+	content += "</ReceiveMessageResult><ResponseMetadata><RequestId>"
+			"b6633655-283d-45b4-aee4-4e84e0ae6afa</RequestId>"
+			"</ResponseMetadata></ReceiveMessageResponse>";
+	return content;
+}
+
+String makeReceiveMessageJson(int messages, int bodySize) {
+	REF<StringWriter> text = new StringWriter();
+	REF<JSONWriter> writer = new JSONWriter(text);
+	writer->setCompactMode(true);
+	writer->writeObjectBegin();
+	writer->writeString("Messages");
+	writer->writeMemberSeparator();
+	writer->writeStartArray();
+	for (int i = 0; i < messages; i++) {
+		if (i > 0)
+			writer->writeArraySeparator();
+		writer->writeObjectBegin();
+		const char* attributes[][2] = { { "SenderId", "AIDAIENQZJOLO23YVJ4VO" },
+				{ "ApproximateFirstReceiveTimestamp", "1424937600000" },
+				{ "ApproximateReceiveCount", "1" },
+				{ "SentTimestamp", "1424937599871" } };
+		writer->writeString("Attributes");
+		writer->writeMemberSeparator();
+		writer->writeObjectBegin();
+		for (int j = 0; j < 4; j++) {
+			if (j > 0)
+				writer->writeArraySeparator();
+			writer->writeString(attributes[j][0]);
+			writer->writeMemberSeparator();
+			writer->writeString(attributes[j][1]);
+		}
+		writer->writeEndObject();
+		const char* fields[][2] = { { "Body", NULL }, { "MD5OfBody",
+				"fafb00f5732ab283681e124bf8747ed1" }, { "MD5OfMessageAttributes",
+				"bd4ebae1fe86ec6b8e4b1ad6bba3a4b7" } };
+		for (int j = 0; j < 3; j++) {
+			writer->writeArraySeparator();
+			writer->writeString(fields[j][0]);
+			writer->writeMemberSeparator();
+			writer->writeString(
+					(fields[j][1] != NULL) ?
+							String(fields[j][1]) : makeBody(i, bodySize));
+		}
+		writer->writeArraySeparator();
+		writer->writeString("MessageAttributes");
+		writer->writeMemberSeparator();
+		writer->writeObjectBegin();
+		writer->writeString("trace");
+		writer->writeMemberSeparator();
+		writer->writeObjectBegin();
+		writer->writeString("DataType");
+		writer->writeMemberSeparator();
+		writer->writeString("String");
+		writer->writeArraySeparator();
+		writer->writeString("StringValue");
+		writer->writeMemberSeparator();
+		writer->writeString(makeTrace(i));
+		writer->writeEndObject();
+		writer->writeEndObject();
+		writer->writeArraySeparator();
+		writer->writeString("MessageId");
+		writer->writeMemberSeparator();
+		writer->writeString(makeMessageId(i));
+		writer->writeArraySeparator();
+		writer->writeString("ReceiptHandle");
+		writer->writeMemberSeparator();
+		writer->writeString(makeReceiptHandle(i));
+		writer->writeEndObject();
+	}
+	writer->writeEndArray();
+	writer->writeEndObject();
+	return text->getString();
+}
+
+// How a request is made and its response read, in one of the protocols.
+enum BenchProtocol {
+	BP_Query,	// libxml2 reads the responses
+	BP_QueryTokenizer,	// AWSXmlTokenizer reads the responses
+	BP_JSON,
+};
+
+static const char* protocolNames[] = { "query", "query+tokenizer", "json" };
+
+// Marshalls a request as SQSClient does.
+typedef AWSHttpRequest* (*RequestFunction)(BenchProtocol protocol);
+// Unmarshalls a response as SQSClient does, returns the number of items
+// read or -1 on failure.
+typedef int (*ResponseFunction)(BenchProtocol protocol,
+		AWSHttpResponse* response);
+
+// Gets the size of the body sent, encoding the parameters of a query
+// request.
+int getBodySize(AWSHttpRequest* request) {
+	if (request->hasContent())
+		return request->getContent().getSize();
+	return HttpUtils::encodeParameters(request->getParameters()).getLength();
+}
+
+// Gets the size of the headers a protocol adds to a request, the rest of
+// the headers are the same in both.
+int getHeaderSize(AWSHttpRequest* request) {
+	if (!request->hasHeaders())
+		return (int) sizeof(queryContentType) - 1;
+	int size = 0;
+	AWSStringMap* headers = request->getHeaders();
+	for (AWSStringMap::PENTRY header = headers->getFirstEntry();
+			header != NULL; header = headers->getNextEntry(header)) {
+		size += header->key.getLength() + header->value.getLength() + 4;
+	}
+	return size;
+}
+
+static String sendMessageBody;
+
+AWSHttpRequest* requestSendMessage(BenchProtocol protocol) {
+	REF<SQSSendMessageParams> params = new SQSSendMessageParams(queueUrl);
+	params->setMessageBody(sendMessageBody);
+	params->getMessageAttributes()->set("trace", makeTrace(0));
+	return (protocol == BP_JSON) ?
+			SQSJSONParamsMarshaller().marshall(params) :
+			SQSSendMessageParamsMarshaller().marshall(params);
+}
+
+int responseSendMessage(BenchProtocol protocol, AWSHttpResponse* response) {
+	SQSSendMessageResult* result = (protocol == BP_JSON) ?
+			SQSJSONResultUnmarshaller().unmarshallSendMessage(response) :
+			SQSSendMessageResultUnmarshaller().unmarshall(response);
+	return (result != NULL && !result->getMessageId().isEmpty()) ? 1 : -1;
+}
+
+AWSHttpRequest* requestReceiveMessage(BenchProtocol protocol) {
+	REF<SQSReceiveMessageParams> params = new SQSReceiveMessageParams(
+			queueUrl);
+	params->setMaxNumberOfMessages(10);
+	params->setWaitTimeSeconds(20);
+	params->getMessageAttributeNames()->set("1", "All");
+	params->getAttributeNames()->addLast("All");
+	return (protocol == BP_JSON) ?
+			SQSJSONParamsMarshaller().marshall(params) :
+			SQSReceiveMessageParamsMarshaller().marshall(params);
+}
+
+int responseReceiveMessage(BenchProtocol protocol, AWSHttpResponse* response) {
+	SQSReceiveMessageResult* result = (protocol == BP_JSON) ?
+			SQSJSONResultUnmarshaller().unmarshallReceiveMessage(response) :
+			SQSReceiveMessageResultUnmarshaller().unmarshall(response);
+	return (result != NULL) ? result->getMessages()->getSize() : -1;
+}
+
+int responseReceiveMessageBatch(BenchProtocol protocol,
+		AWSHttpResponse* response) {
+	SQSReceiveMessageBatchResult* result = (protocol == BP_JSON) ?
+			SQSJSONResultUnmarshaller().unmarshallReceiveMessageBatch(response) :
+			SQSReceiveMessageBatchResultUnmarshaller().unmarshall(response);
+	return (result != NULL) ? result->getBatch()->getSize() : -1;
+}
+
+// Gets the microseconds of CPU time a request and its response take.
+double measure(BenchProtocol protocol, RequestFunction request,
+		ResponseFunction parse, AWSHttpResponse* response, int iterations,
+		int& items) {
+	AWSResultUnmarshaller::setTokenizerEnabled(protocol == BP_QueryTokenizer);
+	// Warms the parser contexts and buffers of the thread up.
+	getBodySize(request(protocol));
+	items = parse(protocol, response);
+	clock_t startTime = clock();
+	for (int i = 0; i < iterations; i++) {
+		REFAutoreleasePool iterationPool;
+		getBodySize(request(protocol));
+		parse(protocol, response);
+	}
+	clock_t elapsed = clock() - startTime;
+	return (double) elapsed * 1000000 / CLOCKS_PER_SEC / iterations;
+}
+
+void run(const char* name, RequestFunction request, ResponseFunction parse,
+		const String& xmlContent, const String& jsonContent, int iterations) {
+	REF<AWSHttpResponse> xmlResponse = new AWSHttpResponse();
+	xmlResponse->setStatusCode(200);
+	xmlResponse->setContent(xmlContent);
+	REF<AWSHttpResponse> jsonResponse = new AWSHttpResponse();
+	jsonResponse->setStatusCode(200);
+	jsonResponse->setContent(jsonContent);
+
+	double queryTime = 0;
+	for (int protocol = BP_Query; protocol <= BP_JSON; protocol++) {
+		bool json = (protocol == BP_JSON);
+		AWSHttpResponse* response = json ? jsonResponse : xmlResponse;
+		AWSHttpRequest* sample = request((BenchProtocol) protocol);
+		int requestBytes = getBodySize(sample) + getHeaderSize(sample);
+		int responseBytes = response->getContent().getLength();
+		int items;
+		double time = measure((BenchProtocol) protocol, request, parse,
+				response, iterations, items);
+		if (protocol == BP_Query)
+			queryTime = time;
+		printf("%-24s %-16s %9d %9d %6d %10.1f %7.2fx%s\n", name,
+				protocolNames[protocol], requestBytes, responseBytes, items,
+				time, queryTime / BFX_MAX(time, 0.001),
+				(items < 0) ? " FAILED" : "");
+	}
+}
+
+void usage(const char* program) {
+	printf("Usage: %s [iterations]\n", program);
+	printf("  Measures the bytes on the wire and the CPU time of SendMessage"
+			" and ReceiveMessage\n  in the query and in the JSON protocol:"
+			" marshalling the request, encoding its\n  body, and unmarshalling"
+			" the response. The request bytes include the headers\n  the"
+			" protocols differ by.\n");
+}
+
+int main(int argc, char* argv[]) {
+	// Initializes the current auto release pool.
+	REFAutoreleasePool pool;
+	// Logging each token would take longer than reading it.
+	log_setlevel(LL_WARN);
+
+	if (argc > 1 && atoi(argv[1]) <= 0) {
+		usage(argv[0]);
+		return -1;
+	}
+	int iterations = (argc > 1) ? atoi(argv[1]) : 2000;
+
+	printf("%-24s %-16s %9s %9s %6s %10s %8s\n", "operation", "protocol",
+			"req_bytes", "resp_bytes", "items", "cpu_us", "speedup");
+	int bodySizes[] = { 256, 4096, 65536 };
+	for (int i = 0; i < 3; i++) {
+		sendMessageBody = makeBody(0, bodySizes[i]);
+		String name = String::format("SendMessage %dB", bodySizes[i]);
+		run(name, requestSendMessage, responseSendMessage, makeSendMessageXml(),
+				makeSendMessageJson(),
+				BFX_MAX(iterations * 256 / bodySizes[i], 1));
+	}
+	for (int i = 0; i < 3; i++) {
+		String xml = makeReceiveMessageXml(10, bodySizes[i]);
+		String json = makeReceiveMessageJson(10, bodySizes[i]);
+		String name = String::format("ReceiveMessage 10x%dB", bodySizes[i]);
+		run(name, requestReceiveMessage, responseReceiveMessage, xml, json,
+				BFX_MAX(iterations * 256 / bodySizes[i], 1));
+		name = String::format("ReceiveBatch 10x%dB", bodySizes[i]);
+		run(name, requestReceiveMessage, responseReceiveMessageBatch, xml,
+				json, BFX_MAX(iterations * 256 / bodySizes[i], 1));
+	}
+	return 0;
+}
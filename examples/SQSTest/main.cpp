@@ -26,19 +26,12 @@ int main(int argc, char* argv[]) {
 	factory->setRegion(AWSRegion::getRegion("cn-north-1"));
 	SQSClient* client = factory->createSQSClient("my_accessid", "my_secretkey");
 
-	// Get receive queue URL
-	SQSListQueuesResult* lqrst = client->listQueues("my_send_queue_name");
-	if (lqrst == NULL) {
+	// Get receive queue URL, later lookups of the queue are served from cache.
+	String queueUrl = client->resolveQueueUrl("my_send_queue_name");
+	if (queueUrl.isEmpty()) {
 		printf("Error occurs during get queue URL. error code: %d\n", client->getLastError());
 		return -1;
-	} else if (!lqrst->getErrorCode().isEmpty()) {
-		printf("Server returns error, code: %s, message: %s\n", (const char*) lqrst->getErrorCode(), (const char*) lqrst->getErrorMessage());
-		return -1;
-	} else if (!lqrst->hasQueueUrls()) {
-		printf("No matched queue URL found.\n");
-		return -1;
 	}
-	String queueUrl = lqrst->getQueueUrls()->getFirst();
 
 	// Login request.
 	REF<TestMessageHandshakeRequest> message = new TestMessageHandshakeRequest();
@@ -0,0 +1,232 @@
+/*
+ * main.cpp
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <AWS/AWS.h>
+
+// Builds a ReceiveMessage response of given messages, in the shape SQS
+// responds with: escaped JSON bodies, the system attributes and a message
+// attribute.
+String makeReceiveMessage(int messages, int bodySize) {
+	String content = "<?xml version=\"1.0\"?><ReceiveMessageResponse"
+			" xmlns=\"http://queue.amazonaws.com/doc/2012-11-05/\">"
+			"<ReceiveMessageResult>";
+	for (int i = 0; i < messages; i++) {
+		String body = String::format(
+				"{&quot;type&quot;:&quot;report&quot;,&quot;id&quot;:%d,"
+						"&quot;items&quot;:[", 100000 + i);
+		for (int j = 0; body.getLength() < bodySize; j++)
+			body += String::format("{&quot;name&quot;:&quot;item %d &amp; co"
+					"&quot;,&quot;value&quot;:%d},", j, j * 7);
+		body += "{}]}";
+		content += String::format("<Message><MessageId>"
+				"5fea7756-0ea4-451a-a703-%012d</MessageId>"
+				"<ReceiptHandle>AQEBzWwaftRI0KuVm4tP+/7q1rGgNqicHq/RNB21ljd"
+				"MJvkt8o5KWcv2ux3Gz4Pf5AGj0wW+9uTdl1B+Q+1yiSLp6LzrgHTpKu7C5i"
+				"Ky0AHjBm1VMs3PbE/YbWtmFfFvYQj2IrEc4+hZHOv5Yop6lDwWb8nYOOzZQ"
+				"1gMyYzN23vRa2Wrc8jLmc4fuqHHqEbtd9RfVM1iyHxd40JB5CKnZAupKvmx"
+				"c2yT/mS4tpCkGDpNLwJb9yhqhBQaThkXWtmGfEoo/M4Cd36nsjB5gXZ%06d"
+				"</ReceiptHandle><MD5OfBody>fafb00f5732ab283681e124bf8747ed1"
+				"</MD5OfBody><Body>%s</Body>"
+				"<Attribute><Name>SenderId</Name>"
+				"<Value>AIDAIENQZJOLO23YVJ4VO</Value></Attribute>"
+				"<Attribute><Name>ApproximateFirstReceiveTimestamp</Name>"
+				"<Value>1424937600000</Value></Attribute>"
+				"<Attribute><Name>ApproximateReceiveCount</Name>"
+				"<Value>1</Value></Attribute>"
+				"<Attribute><Name>SentTimestamp</Name>"
+				"<Value>1424937599871</Value></Attribute>"
+				"<MD5OfMessageAttributes>bd4ebae1fe86ec6b8e4b1ad6bba3a4b7"
+				"</MD5OfMessageAttributes><MessageAttribute><Name>trace</Name>"
+				"<Value><StringValue>Root=1-54ef1a80-%024d</StringValue>"
+				"<DataType>String</DataType></Value></MessageAttribute>"
+				"</Message>", i, i, body.cstr(), i);
+	}
+	content += "</ReceiveMessageResult><ResponseMetadata><RequestId>"
+			"b6633655-283d-45b4-aee4-4e84e0ae6afa</RequestId>"
+			"</ResponseMetadata></ReceiveMessageResponse>";
+	return content;
+}
+
+// Builds a ListObjects response of given keys, in the shape S3 responds
+// with: the ETags are quoted by entities, and each key has its owner.
+String makeListObjects(int keys) {
+	String content = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+			"<ListBucketResult"
+			" xmlns=\"http://s3.amazonaws.com/doc/2006-03-01/\">"
+			"<Name>example-logs</Name><Prefix>logs/</Prefix><Marker></Marker>"
+			"<MaxKeys>1000</MaxKeys><IsTruncated>true</IsTruncated>";
+	for (int i = 0; i < keys; i++) {
+		content += String::format("<Contents>"
+				"<Key>logs/2015/02/26/host-%03d/part-%05d.gz</Key>"
+				"<LastModified>2015-02-26T08:%02d:%02d.000Z</LastModified>"
+				"<ETag>&quot;%08x0ea4451aa7031e124bf8747e&quot;</ETag>"
+				"<Size>%d</Size><Owner><ID>75aa57f09aa0c8caeab4f8c24e99d10f8e7f"
+				"aeebf76c078efc7c6caea54ba06a</ID><DisplayName>webfile"
+				"</DisplayName></Owner><StorageClass>STANDARD</StorageClass>"
+				"</Contents>", i % 64, i, (i / 60) % 60, i % 60,
+				i * 2654435761U, 1048576 + i * 37);
+	}
+	content += "</ListBucketResult>";
+	return content;
+}
+
+// Reads the keys and sizes of a ListObjects response, as an unmarshaller of
+// its result would.
+class ListObjectsReader: public AWSResultUnmarshaller {
+public:
+	ListObjectsReader() :
+			keys(0), bytes(0) {
+	}
+
+	int keys;
+	int64_t bytes;
+
+	bool read(const String& content) {
+		keys = 0;
+		bytes = 0;
+		_text.clear();
+		return parse(content);
+	}
+
+protected:
+	virtual void onStartElement(const char* localname, const char* prefix,
+			const char* URI, int nb_namespaces, const char** namespaces,
+			int nb_attributes, int nb_defaulted, const char** attributes) {
+		_text.clear();
+	}
+	virtual void onCharacters(const char* value, int len) {
+		_text.append(value, len);
+	}
+	virtual void onEndElement(const char* localname, const char* prefix,
+			const char* URI) {
+		_text.append('\0');
+		if (stringEquals(localname, "Key")) {
+			String key(_text.getRawData(), _text.getSize() - 1);
+			keys++;
+		} else if (stringEquals(localname, "Size")) {
+			bytes += atoll(_text.getRawData());
+		}
+		_text.clear();
+	}
+
+private:
+	BufferT<char> _text;
+};
+
+// Parses a response as the clients do, returns the number of items read or
+// -1 on failure.
+typedef int (*ParseFunction)(AWSHttpResponse* response);
+
+int parseReceiveMessage(AWSHttpResponse* response) {
+	SQSReceiveMessageResult* result =
+			SQSReceiveMessageResultUnmarshaller().unmarshall(response);
+	return (result != NULL) ? result->getMessages()->getSize() : -1;
+}
+
+int parseReceiveMessageBatch(AWSHttpResponse* response) {
+	SQSReceiveMessageBatchResult* result =
+			SQSReceiveMessageBatchResultUnmarshaller().unmarshall(response);
+	return (result != NULL) ? result->getBatch()->getSize() : -1;
+}
+
+int parseListObjects(AWSHttpResponse* response) {
+	ListObjectsReader reader;
+	return reader.read(response->getContent()) ? reader.keys : -1;
+}
+
+// Gets the microseconds each parse takes, by libxml2 or by the tokenizer.
+double measure(ParseFunction parse, AWSHttpResponse* response, int iterations,
+		bool tokenizer, int& items) {
+	AWSResultUnmarshaller::setTokenizerEnabled(tokenizer);
+	// Warms the parser contexts and buffers of the thread up.
+	items = parse(response);
+	int64_t startTime = Thread::getTickCount();
+	for (int i = 0; i < iterations; i++) {
+		REFAutoreleasePool iterationPool;
+		parse(response);
+	}
+	int64_t elapsed = Thread::getTickCount() - startTime;
+	return (double) elapsed * 1000 / iterations;
+}
+
+void run(const char* name, ParseFunction parse, const String& content,
+		int iterations) {
+	REF<AWSHttpResponse> response = new AWSHttpResponse();
+	response->setContent(content);
+	int libxmlItems;
+	int tokenizerItems;
+	double libxmlTime = measure(parse, response, iterations, false,
+			libxmlItems);
+	double tokenizerTime = measure(parse, response, iterations, true,
+			tokenizerItems);
+	printf("%-22s %8d %6d %10.1f %8.1f %10.1f %8.1f %6.2fx%s\n", name,
+			content.getLength(), libxmlItems, libxmlTime,
+			content.getLength() / BFX_MAX(libxmlTime, 0.001), tokenizerTime,
+			content.getLength() / BFX_MAX(tokenizerTime, 0.001),
+			libxmlTime / BFX_MAX(tokenizerTime, 0.001),
+			(libxmlItems != tokenizerItems) ? " MISMATCH" : "");
+}
+
+String readFile(const char* path) {
+	String content;
+	FILE* file = fopen(path, "rb");
+	if (file == NULL)
+		return content;
+	char buffer[65536];
+	size_t size;
+	while ((size = fread(buffer, 1, sizeof(buffer) - 1, file)) > 0) {
+		buffer[size] = '\0';
+		content.append(buffer, (int) size);
+	}
+	fclose(file);
+	return content;
+}
+
+void usage(const char* program) {
+	printf("Usage: %s [iterations] [ReceiveMessage|ListObjects file]...\n",
+			program);
+	printf("  Measures the time of parsing ReceiveMessage and ListObjects"
+			" responses by libxml2\n  and by AWSXmlTokenizer. The files are"
+			" responses recorded from SQS or S3,\n  told apart by their root"
+			" element.\n");
+}
+
+int main(int argc, char* argv[]) {
+	// Initializes the current auto release pool.
+	REFAutoreleasePool pool;
+
+	if (argc > 1 && atoi(argv[1]) <= 0) {
+		usage(argv[0]);
+		return -1;
+	}
+	int iterations = (argc > 1) ? atoi(argv[1]) : 2000;
+
+	printf("%-22s %8s %6s %10s %8s %10s %8s %7s\n", "payload", "bytes",
+			"items", "libxml_us", "MB/s", "tokens_us", "MB/s", "speedup");
+	run("ReceiveMessage 10x1KB", parseReceiveMessage,
+			makeReceiveMessage(10, 1024), iterations);
+	run("ReceiveMessage 10x64KB", parseReceiveMessage,
+			makeReceiveMessage(10, 65536), BFX_MAX(iterations / 20, 1));
+	run("ReceiveBatch 10x1KB", parseReceiveMessageBatch,
+			makeReceiveMessage(10, 1024), iterations);
+	run("ReceiveBatch 10x64KB", parseReceiveMessageBatch,
+			makeReceiveMessage(10, 65536), BFX_MAX(iterations / 20, 1));
+	run("ListObjects 1000 keys", parseListObjects, makeListObjects(1000),
+			BFX_MAX(iterations / 10, 1));
+
+	for (int i = 2; i < argc; i++) {
+		String content = readFile(argv[i]);
+		if (content.isEmpty()) {
+			printf("Unable to read %s.\n", argv[i]);
+			continue;
+		}
+		bool listObjects = (strstr(content.cstr(), "<ListBucketResult") != NULL);
+		run(argv[i], listObjects ? parseListObjects : parseReceiveMessage,
+				content, iterations);
+	}
+	return 0;
+}
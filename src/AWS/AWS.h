@@ -18,6 +18,7 @@ enum AWSError {
 	AWSE_HttpRequestFailed,	/// HTTP request failed
 	AWSE_UnrecognizedSignerType,	/// Unsupported message signer type
 	AWSE_ParseXMLFailed,	/// Invalid XML or message format
+	AWSE_IOFailed,	/// Failed to read or write local data
 };
 
 /// Represents a nullable, and sharable string map.
@@ -26,13 +27,35 @@ typedef REFWrapper<TreeMapT<String, String> > AWSStringMap;
 typedef REFWrapper<LinkedListT<String> > AWSStringList;
 
 #include "AWSClientFactory.h"
+#include "AWSSHA256.h"
 #include "AWSSigner.h"
+#include "AWSCredentialsProvider.h"
 #include "AWSRegion.h"
+#include "AWSChecksum.h"
+#include "AWSHttpClient.h"
 #include "AWSClient.h"
 #include "SQSModel.h"
+#include "SQSMessageBatch.h"
 #include "SQSParams.h"
 #include "SQSResult.h"
+#include "SQSJSONProtocol.h"
+#include "SQSBodyCodec.h"
 #include "SQSClient.h"
+#include "SQSQueueUrlCache.h"
+#include "SQSSendMessageBatcher.h"
+#include "SQSPrefetcher.h"
+#include "SQSAckCoalescer.h"
+#include "SQSVisibilityHeartbeater.h"
+#include "SQSConsumer.h"
+#include "S3MappedFile.h"
+#include "S3Params.h"
+#include "S3Result.h"
+#include "S3DownloadSink.h"
+#include "S3UploadSource.h"
 #include "S3Client.h"
+#include "S3ListObjectsV2Paginator.h"
+#include "S3ParallelDownloader.h"
+#include "S3MultipartUploader.h"
+#include "S3PrefixDeleter.h"
 
 #endif /* TestTest1_AWS_AWS_H_ */
@@ -0,0 +1,194 @@
+/*
+ * AWSChecksum.cpp
+ */
+
+#include "AWS.h"
+#include "HttpUtils.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CRC32C_HARDWARE_SUPPORTED
+#include <nmmintrin.h>
+#endif
+
+#define LOG_TAG "AWSChecksum"
+
+// The reflected CRC-32C (Castagnoli) polynomial.
+static const uint32_t CRC32C_POLY = 0x82F63B78;
+// Block size of each stream when three streams are interleaved.
+static const int CRC32C_BLOCK = 4096;
+
+// Lookup tables, initialized once at load time.
+static struct CRC32CTables {
+	// Slicing-by-8 tables for the software implementation.
+	uint32_t slice[8][256];
+	// Tables that append CRC32C_BLOCK zero bytes to a raw CRC value, used to
+	// combine three interleaved streams.
+	uint32_t shift[4][256];
+	bool hardware;
+
+	CRC32CTables() {
+		for (int i = 0; i < 256; i++) {
+			uint32_t crc = i;
+			for (int j = 0; j < 8; j++)
+				crc = (crc >> 1) ^ ((crc & 1) ? CRC32C_POLY : 0);
+			slice[0][i] = crc;
+		}
+		for (int i = 0; i < 256; i++) {
+			for (int k = 1; k < 8; k++) {
+				uint32_t crc = slice[k - 1][i];
+				slice[k][i] = (crc >> 8) ^ slice[0][crc & 0xff];
+			}
+		}
+
+		// Build the operator matrix of a single zero bit, then square it
+		// until it represents CRC32C_BLOCK zero bytes.
+		uint32_t mat[32];
+		uint32_t square[32];
+		mat[0] = CRC32C_POLY;
+		for (int n = 1; n < 32; n++)
+			mat[n] = 1u << (n - 1);
+		for (int bits = 1; bits < CRC32C_BLOCK * 8; bits *= 2) {
+			for (int n = 0; n < 32; n++)
+				square[n] = times(mat, mat[n]);
+			memcpy(mat, square, sizeof(mat));
+		}
+		for (int k = 0; k < 4; k++) {
+			for (int i = 0; i < 256; i++)
+				shift[k][i] = times(mat, ((uint32_t) i) << (k * 8));
+		}
+
+#ifdef CRC32C_HARDWARE_SUPPORTED
+		// Runs before main(), so the CPU model has to be initialized first.
+		__builtin_cpu_init();
+		hardware = __builtin_cpu_supports("sse4.2");
+#else
+		hardware = false;
+#endif
+	}
+
+	static uint32_t times(const uint32_t* mat, uint32_t vec) {
+		uint32_t sum = 0;
+		for (int n = 0; vec != 0; n++, vec >>= 1) {
+			if (vec & 1)
+				sum ^= mat[n];
+		}
+		return sum;
+	}
+} __tables;
+
+// Appends CRC32C_BLOCK zero bytes to a raw CRC value.
+static inline uint32_t shiftBlock(uint32_t crc) {
+	return __tables.shift[0][crc & 0xff] ^ __tables.shift[1][(crc >> 8) & 0xff]
+			^ __tables.shift[2][(crc >> 16) & 0xff]
+			^ __tables.shift[3][crc >> 24];
+}
+
+static uint32_t softwareExtend(uint32_t crc, const uint8_t* data, int dataSize) {
+	while (dataSize > 0 && ((uintptr_t) data & 7) != 0) {
+		crc = (crc >> 8) ^ __tables.slice[0][(crc ^ *data++) & 0xff];
+		dataSize--;
+	}
+	while (dataSize >= 8) {
+		uint32_t lo = crc ^ ((uint32_t) data[0] | ((uint32_t) data[1] << 8)
+				| ((uint32_t) data[2] << 16) | ((uint32_t) data[3] << 24));
+		crc = __tables.slice[7][lo & 0xff] ^ __tables.slice[6][(lo >> 8) & 0xff]
+				^ __tables.slice[5][(lo >> 16) & 0xff]
+				^ __tables.slice[4][lo >> 24] ^ __tables.slice[3][data[4]]
+				^ __tables.slice[2][data[5]] ^ __tables.slice[1][data[6]]
+				^ __tables.slice[0][data[7]];
+		data += 8;
+		dataSize -= 8;
+	}
+	while (dataSize-- > 0)
+		crc = (crc >> 8) ^ __tables.slice[0][(crc ^ *data++) & 0xff];
+	return crc;
+}
+
+#ifdef CRC32C_HARDWARE_SUPPORTED
+
+__attribute__((target("sse4.2")))
+static inline uint32_t hardwareStream(uint32_t crc, const uint8_t* data,
+		int dataSize) {
+#ifdef __x86_64__
+	uint64_t crc64 = crc;
+	for (; dataSize >= 8; data += 8, dataSize -= 8) {
+		uint64_t word;
+		memcpy(&word, data, sizeof(word));
+		crc64 = _mm_crc32_u64(crc64, word);
+	}
+	crc = (uint32_t) crc64;
+#endif
+	for (; dataSize >= 4; data += 4, dataSize -= 4) {
+		uint32_t word;
+		memcpy(&word, data, sizeof(word));
+		crc = _mm_crc32_u32(crc, word);
+	}
+	while (dataSize-- > 0)
+		crc = _mm_crc32_u8(crc, *data++);
+	return crc;
+}
+
+__attribute__((target("sse4.2")))
+static uint32_t hardwareExtend(uint32_t crc, const uint8_t* data, int dataSize) {
+	// Three independent streams keep the CRC32 unit busy, as the instruction
+	// has a latency of three cycles but a throughput of one per cycle.
+	while (dataSize >= CRC32C_BLOCK * 3) {
+		uint32_t crcA = crc;
+		uint32_t crcB = 0;
+		uint32_t crcC = 0;
+#ifdef __x86_64__
+		uint64_t a = crcA, b = crcB, c = crcC;
+		const uint8_t* pa = data;
+		const uint8_t* pb = data + CRC32C_BLOCK;
+		const uint8_t* pc = data + CRC32C_BLOCK * 2;
+		for (int i = 0; i < CRC32C_BLOCK; i += 8) {
+			uint64_t wa, wb, wc;
+			memcpy(&wa, pa + i, 8);
+			memcpy(&wb, pb + i, 8);
+			memcpy(&wc, pc + i, 8);
+			a = _mm_crc32_u64(a, wa);
+			b = _mm_crc32_u64(b, wb);
+			c = _mm_crc32_u64(c, wc);
+		}
+		crcA = (uint32_t) a;
+		crcB = (uint32_t) b;
+		crcC = (uint32_t) c;
+#else
+		crcA = hardwareStream(crcA, data, CRC32C_BLOCK);
+		crcB = hardwareStream(crcB, data + CRC32C_BLOCK, CRC32C_BLOCK);
+		crcC = hardwareStream(crcC, data + CRC32C_BLOCK * 2, CRC32C_BLOCK);
+#endif
+		// The CRC is linear, so crc(A|B|C) = shift(shift(crcA) ^ crcB) ^ crcC.
+		crc = shiftBlock(shiftBlock(crcA) ^ crcB) ^ crcC;
+		data += CRC32C_BLOCK * 3;
+		dataSize -= CRC32C_BLOCK * 3;
+	}
+	return hardwareStream(crc, data, dataSize);
+}
+
+#endif	// CRC32C_HARDWARE_SUPPORTED
+
+uint32_t AWSCRC32C::extend(uint32_t crc, const uint8_t* data, int dataSize) {
+	BFX_ASSERT(data || dataSize == 0);
+	BFX_ASSERT(dataSize >= 0);
+
+	crc = ~crc;
+#ifdef CRC32C_HARDWARE_SUPPORTED
+	if (__tables.hardware)
+		return ~hardwareExtend(crc, data, dataSize);
+#endif
+	return ~softwareExtend(crc, data, dataSize);
+}
+
+String AWSCRC32C::toBase64(uint32_t crc) {
+	uint8_t bytes[4];
+	bytes[0] = (uint8_t) (crc >> 24);
+	bytes[1] = (uint8_t) (crc >> 16);
+	bytes[2] = (uint8_t) (crc >> 8);
+	bytes[3] = (uint8_t) crc;
+	return HttpUtils::base64Encode(bytes, sizeof(bytes));
+}
+
+bool AWSCRC32C::isHardwareAccelerated() {
+	return __tables.hardware;
+}
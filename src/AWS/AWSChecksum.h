@@ -0,0 +1,53 @@
+/*
+ * AWSChecksum.h
+ */
+
+#ifndef AWS_AWSCHECKSUM_H_
+#define AWS_AWSCHECKSUM_H_
+
+/// Computes CRC-32C (Castagnoli) checksums, as used by the
+/// x-amz-checksum-crc32c header.
+/// Uses the SSE4.2 CRC32 instruction when the CPU supports it, and a
+/// slicing-by-8 lookup table otherwise. The checksum can be fed in pieces, so
+/// it can be computed while the data streams.
+class AWSCRC32C {
+public:
+	AWSCRC32C() :
+			_crc(0) {
+	}
+
+	/// Feeds more data into the running checksum.
+	void update(const uint8_t* data, int dataSize) {
+		_crc = extend(_crc, data, dataSize);
+	}
+	/// Resets the running checksum.
+	void reset() {
+		_crc = 0;
+	}
+	/// Gets the checksum of all data fed so far.
+	uint32_t getValue() const {
+		return _crc;
+	}
+	/// Gets the checksum of all data fed so far, as a base64 encoded big-endian
+	/// value, which is the format of the x-amz-checksum-crc32c header.
+	String toBase64() const {
+		return toBase64(_crc);
+	}
+
+	/// Extends a checksum by given data, returns the new checksum.
+	static uint32_t extend(uint32_t crc, const uint8_t* data, int dataSize);
+	/// Computes the checksum of given data.
+	static uint32_t compute(const uint8_t* data, int dataSize) {
+		return extend(0, data, dataSize);
+	}
+	/// Formats a checksum as base64 encoded big-endian value.
+	static String toBase64(uint32_t crc);
+
+	/// Gets a value indicating whether the hardware CRC32 instruction is used.
+	static bool isHardwareAccelerated();
+
+private:
+	uint32_t _crc;
+};
+
+#endif /* AWS_AWSCHECKSUM_H_ */
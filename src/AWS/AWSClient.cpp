@@ -9,14 +9,49 @@
 
 #define LOG_TAG "AWSClient"
 
+AWSLastError::AWSLastError() {
+	_error = AWSE_NoError;
+	int ret = pthread_key_create(&_key, NULL);
+	_keyCreated = (ret == 0);
+	if (!_keyCreated) {
+		LOGW("Unable to create the key of the last error: %d, it is shared "
+				"by the threads.", ret);
+	}
+}
+
+AWSLastError::~AWSLastError() {
+	if (_keyCreated)
+		pthread_key_delete(_key);
+}
+
+AWSLastError& AWSLastError::operator=(AWSError error) {
+	// The error is stored as the value itself, with nothing to free.
+	if (_keyCreated)
+		pthread_setspecific(_key, (void*) (intptr_t) error);
+	else
+		_error = error;
+	return *this;
+}
+
+AWSLastError::operator AWSError() const {
+	if (_keyCreated)
+		return (AWSError) (intptr_t) pthread_getspecific(_key);
+	return _error;
+}
+
 AWSClient::AWSClient(const String& serviceName, AWSCredentials* credentials,
 		AWSRegion* region) {
-	BFX_ASSERT(!serviceName.isEmpty());
 	BFX_ASSERT(credentials);
-	BFX_ASSERT(region);
 
-	_serviceName = serviceName;
-	_credentials = credentials;
+	REF<AWSCredentialsProvider> credentialsProvider =
+			new AWSStaticCredentialsProvider(credentials);
+	init(serviceName, credentialsProvider);
+	init(region);
+}
+
+AWSClient::AWSClient(const String& serviceName,
+		AWSCredentialsProvider* credentialsProvider, AWSRegion* region) {
+	init(serviceName, credentialsProvider);
 	init(region);
 }
 
@@ -58,7 +93,23 @@ void AWSClient::init(AWSRegion* region) {
 	LOGT("endpoint : '%s'", (const char* )_endpoint);
 }
 
+void AWSClient::init(const String& serviceName,
+		AWSCredentialsProvider* credentialsProvider) {
+	BFX_ASSERT(!serviceName.isEmpty());
+	BFX_ASSERT(credentialsProvider);
+
+	_serviceName = serviceName;
+	_credentialsProvider = credentialsProvider;
+	_lastError = AWSE_NoError;
+	_payloadSigningMode = APSM_Signed;
+}
+
 const String& AWSClient::getEndpoint() const {
 	return _endpoint;
 }
 
+void AWSClient::setEndpoint(const String& endpoint) {
+	BFX_ASSERT(!endpoint.isEmpty());
+	_endpoint = endpoint;
+}
+
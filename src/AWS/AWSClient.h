@@ -8,34 +8,86 @@
 #ifndef TestTest1_AWS_AWSCLIENT_H_
 #define TestTest1_AWS_AWSCLIENT_H_
 
+/// The last error of a client, kept per thread, so that the threads sharing
+/// a client each see the errors of their own calls. Reads and assigns as an
+/// AWSError.
+class AWSLastError {
+public:
+	AWSLastError();
+	~AWSLastError();
+
+	AWSLastError& operator=(AWSError error);
+	AWSLastError& operator=(const AWSLastError& other) {
+		return (*this = (AWSError) other);
+	}
+	operator AWSError() const;
+
+private:
+	AWSLastError(const AWSLastError& other);
+
+	pthread_key_t _key;
+	bool _keyCreated;
+	// Shared by the threads if the key couldn't be created.
+	volatile AWSError _error;
+};
+
 /// Abstract base class for AWS clients.
 class AWSClient: public REFObject {
 public:
 	AWSClient(const String& serviceName, AWSCredentials* credentials,
 			AWSRegion* region);
+	AWSClient(const String& serviceName,
+			AWSCredentialsProvider* credentialsProvider, AWSRegion* region);
 	virtual ~AWSClient();
 
 	const String& getServiceName() const;
 
 	/// Gets the endpoint for this client
 	const String& getEndpoint() const;
+	/// Overrides the endpoint of the region, e.g. to use a local stand-in of
+	/// the service. The endpoint is a URL without path, such as
+	/// "http://localhost:9324".
+	void setEndpoint(const String& endpoint);
+
+	/// Gets the current credentials of this client, without blocking once
+	/// they have been loaded.
+	AWSCredentials* getCredentials() const {
+		return _credentialsProvider->getCredentials();
+	}
 
+	/// Gets the error of the last call of the calling thread which failed,
+	/// or which was made before a request could be sent.
 	const AWSError getLastError() const {
 		return _lastError;
 	}
 
+	/// Gets the payload signing mode of requests which don't specify one.
+	AWSPayloadSigningMode getPayloadSigningMode() const {
+		return _payloadSigningMode;
+	}
+	/// Sets the payload signing mode of requests which don't specify one.
+	/// APSM_Unsigned skips hashing the payload on HTTPS endpoints, and
+	/// protects the payload by a CRC32C checksum instead.
+	void setPayloadSigningMode(AWSPayloadSigningMode payloadSigningMode) {
+		_payloadSigningMode = payloadSigningMode;
+	}
+
 private:
 	/// Sets the region for this client.
 	void init(AWSRegion* region);
+	/// Sets the service name and credentials provider for this client.
+	void init(const String& serviceName,
+			AWSCredentialsProvider* credentialsProvider);
 
 protected:
 	String _serviceName;
 	String _endpoint;
 
-	REF<AWSCredentials> _credentials;
+	REF<AWSCredentialsProvider> _credentialsProvider;
 	REF<AWSSigner> _signer;
 
-	AWSError _lastError;
+	AWSLastError _lastError;
+	AWSPayloadSigningMode _payloadSigningMode;
 };
 
 #endif /* TestTest1_AWS_AWSCLIENT_H_ */
@@ -33,3 +33,32 @@ SQSClient* AWSClientFactory::createSQSClient(
 	client->autorelease();
 	return client;
 }
+
+S3Client* AWSClientFactory::createS3Client(const String& accessKeyId,
+		const String& secretAccessKey) const {
+	BFX_ASSERT(!accessKeyId.isEmpty());
+	BFX_ASSERT(!secretAccessKey.isEmpty());
+
+	REF<S3Client> client = new S3Client(accessKeyId, secretAccessKey,
+			_region);
+	client->autorelease();
+	return client;
+}
+
+SQSClient* AWSClientFactory::createSQSClient(
+		AWSCredentialsProvider* credentialsProvider) const {
+	BFX_ASSERT(credentialsProvider);
+
+	REF<SQSClient> client = new SQSClient(credentialsProvider, _region);
+	client->autorelease();
+	return client;
+}
+
+S3Client* AWSClientFactory::createS3Client(
+		AWSCredentialsProvider* credentialsProvider) const {
+	BFX_ASSERT(credentialsProvider);
+
+	REF<S3Client> client = new S3Client(credentialsProvider, _region);
+	client->autorelease();
+	return client;
+}
@@ -9,8 +9,9 @@
 #define AWSCONNECTIONFACTORY_H_
 
 class SQSClient;
-class AWSS3Client;
+class S3Client;
 class AWSRegion;
+class AWSCredentialsProvider;
 
 class AWSClientFactory: public REFObject {
 public:
@@ -21,9 +22,12 @@ public:
 
 	SQSClient* createSQSClient(const String& accessKeyId,
 			const String& secretAccessKey) const;
+	SQSClient* createSQSClient(
+			AWSCredentialsProvider* credentialsProvider) const;
 
-	AWSS3Client* createS3Client(const String& accessKeyId,
+	S3Client* createS3Client(const String& accessKeyId,
 			const String& secretAccessKey) const;
+	S3Client* createS3Client(AWSCredentialsProvider* credentialsProvider) const;
 
 private:
 	AWSRegion* _region;
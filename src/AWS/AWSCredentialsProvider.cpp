@@ -0,0 +1,331 @@
+/*
+ * AWSCredentialsProvider.cpp
+ */
+
+#include "AWS.h"
+#include "../JSON/JSON.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define LOG_TAG "AWSCredentialsProvider"
+
+AWSStaticCredentialsProvider::AWSStaticCredentialsProvider(
+		AWSCredentials* credentials) {
+	BFX_ASSERT(credentials);
+	_credentials = credentials;
+}
+
+AWSStaticCredentialsProvider::~AWSStaticCredentialsProvider() {
+}
+
+AWSCredentials* AWSStaticCredentialsProvider::getCredentials() {
+	return _credentials;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+// Gets an environment variable, or an empty string if not defined.
+static String getEnvironmentVariable(const char* name) {
+	const char* value = getenv(name);
+	return (value != NULL) ? String(value) : String();
+}
+
+AWSCredentials* AWSEnvironmentCredentialsSource::load() {
+	String accessKeyId = getEnvironmentVariable("AWS_ACCESS_KEY_ID");
+	String secretAccessKey = getEnvironmentVariable("AWS_SECRET_ACCESS_KEY");
+	if (accessKeyId.isEmpty() || secretAccessKey.isEmpty())
+		return NULL;
+
+	REF<AWSCredentials> credentials = new AWSCredentials(accessKeyId,
+			secretAccessKey, getEnvironmentVariable("AWS_SESSION_TOKEN"));
+	credentials->autorelease();
+	return credentials;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+AWSProfileCredentialsSource::AWSProfileCredentialsSource(
+		const String& profileName, const String& fileName) {
+	_profileName = profileName;
+	if (_profileName.isEmpty())
+		_profileName = getEnvironmentVariable("AWS_PROFILE");
+	if (_profileName.isEmpty())
+		_profileName = "default";
+
+	_fileName = fileName;
+	if (_fileName.isEmpty())
+		_fileName = getEnvironmentVariable("AWS_SHARED_CREDENTIALS_FILE");
+	if (_fileName.isEmpty()) {
+#ifdef	_WIN32
+		_fileName = getEnvironmentVariable("USERPROFILE");
+#else
+		_fileName = getEnvironmentVariable("HOME");
+#endif
+		_fileName.append("/.aws/credentials");
+	}
+}
+
+AWSCredentials* AWSProfileCredentialsSource::load() {
+	FILE* file = fopen(_fileName, "r");
+	if (file == NULL)
+		return NULL;
+
+	String accessKeyId;
+	String secretAccessKey;
+	String sessionToken;
+	bool inProfile = false;
+	char line[1024];
+	while (fgets(line, sizeof(line), file) != NULL) {
+		String text = String(line).trim();
+		if (text.isEmpty() || text.startsWith('#') || text.startsWith(';'))
+			continue;
+		if (text.startsWith('[')) {
+			// [profile-name]
+			inProfile = (text.trim("[]").trim() == _profileName);
+			continue;
+		}
+		int pos = text.indexOf('=');
+		if (!inProfile || pos == -1)
+			continue;
+
+		// key = value
+		String key = text.substring(0, pos).trim();
+		String value = text.substring(pos + 1).trim();
+		if (key == "aws_access_key_id")
+			accessKeyId = value;
+		else if (key == "aws_secret_access_key")
+			secretAccessKey = value;
+		else if (key == "aws_session_token")
+			sessionToken = value;
+	}
+	fclose(file);
+
+	if (accessKeyId.isEmpty() || secretAccessKey.isEmpty())
+		return NULL;
+
+	REF<AWSCredentials> credentials = new AWSCredentials(accessKeyId,
+			secretAccessKey, sessionToken);
+	credentials->autorelease();
+	return credentials;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+AWSMetadataCredentialsSource::AWSMetadataCredentialsSource(const String& url) {
+	BFX_ASSERT(!url.isEmpty());
+	_url = url;
+}
+
+AWSCredentials* AWSMetadataCredentialsSource::load() {
+	String url = _url;
+	String body;
+	if (url.endsWith('/')) {
+		// Lists the roles, the credentials are of the first one.
+		if (!fetch(url, body))
+			return NULL;
+		int pos = body.indexOf('\n');
+		String roleName = (pos == -1 ? body : body.substring(0, pos)).trim();
+		if (roleName.isEmpty())
+			return NULL;
+		url.append(roleName);
+	}
+	if (!fetch(url, body))
+		return NULL;
+
+	REF<JSONReader> reader = new JSONReader(body);
+	JSONNode* root = JSONNode::fromJSONReader(reader);
+	if (root == NULL || root->getNodeType() != JSONNode::JNT_Object) {
+		LOGE("Invalid credentials document from '%s'.", url.cstr());
+		return NULL;
+	}
+	JSONObject* object = (JSONObject*) root;
+	String accessKeyId;
+	String secretAccessKey;
+	String sessionToken;
+	String expiration;
+	JSONNode* node;
+	if ((node = object->getProperty("AccessKeyId")) != NULL)
+		JSONTryCast<String>(node, accessKeyId);
+	if ((node = object->getProperty("SecretAccessKey")) != NULL)
+		JSONTryCast<String>(node, secretAccessKey);
+	if ((node = object->getProperty("Token")) != NULL)
+		JSONTryCast<String>(node, sessionToken);
+	if ((node = object->getProperty("Expiration")) != NULL)
+		JSONTryCast<String>(node, expiration);
+	if (accessKeyId.isEmpty() || secretAccessKey.isEmpty()) {
+		LOGE("No credentials found in the document from '%s'.", url.cstr());
+		return NULL;
+	}
+
+	int64_t expirationMilliseconds = 0;
+	if (!expiration.isEmpty()) {
+		DateTime dateTime;
+		if (!dateTime.parseISO8601(expiration)) {
+			LOGE("Invalid expiration: '%s'.", expiration.cstr());
+			return NULL;
+		}
+		expirationMilliseconds = dateTime.getMillisecndsSince1970();
+	}
+
+	REF<AWSCredentials> credentials = new AWSCredentials(accessKeyId,
+			secretAccessKey, sessionToken, expirationMilliseconds);
+	credentials->autorelease();
+	return credentials;
+}
+
+bool AWSMetadataCredentialsSource::fetch(const String& url, String& body) {
+	REF<HttpClient> httpClient = new HttpClient();
+	REF<HttpGet> httpGet = new HttpGet();
+	httpGet->setUrl(url);
+	HttpResponse* httpResponse = httpClient->execute(httpGet);
+	if (httpResponse == NULL) {
+		LOGW("(%d) %s, Failed to get '%s'.", httpClient->getLastError(),
+				httpClient->getLastErrorMessage().cstr(), url.cstr());
+		return false;
+	}
+	if (httpResponse->getStatusCode() != 200) {
+		LOGW("Failed to get '%s', response status code: %d.", url.cstr(),
+				httpResponse->getStatusCode());
+		return false;
+	}
+	const BufferT<uint8_t>& httpBody = httpResponse->getBody();
+	body = String((const char*) httpBody.getRawData(), httpBody.getSize());
+	return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+// The background thread refreshing credentials of a chain.
+class AWSCredentialsRefresher: public Thread {
+public:
+	AWSCredentialsRefresher(AWSCredentialsProviderChain* chain) :
+			_chain(chain) {
+	}
+
+protected:
+	virtual void run() {
+		// Stopping the thread signals the event.
+		while (!_chain->_stopEvent.wait(_chain->getRefreshDelay())) {
+			REFAutoreleasePool pool;
+			_chain->refresh();
+		}
+	}
+
+private:
+	// The chain stops the thread before being destroyed.
+	AWSCredentialsProviderChain* _chain;
+};
+
+AWSCredentialsProviderChain::AWSCredentialsProviderChain() :
+		_stopEvent(true) {
+	_lastRefreshFailed = false;
+	_refreshInterval = DEFAULT_REFRESH_INTERVAL;
+	_refreshMargin = DEFAULT_REFRESH_MARGIN;
+}
+
+AWSCredentialsProviderChain::~AWSCredentialsProviderChain() {
+	stopRefreshing();
+}
+
+AWSCredentialsProviderChain* AWSCredentialsProviderChain::createDefault(
+		const String& metadataUrl) {
+	REF<AWSCredentialsProviderChain> chain = new AWSCredentialsProviderChain();
+	REF<AWSCredentialsSource> source = new AWSEnvironmentCredentialsSource();
+	chain->addSource(source);
+	source = new AWSProfileCredentialsSource();
+	chain->addSource(source);
+	if (!metadataUrl.isEmpty()) {
+		source = new AWSMetadataCredentialsSource(metadataUrl);
+		chain->addSource(source);
+	}
+	chain->autorelease();
+	return chain;
+}
+
+void AWSCredentialsProviderChain::addSource(AWSCredentialsSource* source) {
+	BFX_ASSERT(source);
+	BFX_ASSERT(_refresher == NULL);
+
+	_sources.add(source);
+}
+
+AWSCredentials* AWSCredentialsProviderChain::getCredentials() {
+	AWSCredentials* credentials = _current.get();
+	if (credentials == NULL) {
+		// Loads the credentials once, concurrent callers wait for it.
+		MutexHolder holder(&_refreshLock);
+		credentials = _current.get();
+		if (credentials == NULL && refresh())
+			credentials = _current.get();
+	}
+	return credentials;
+}
+
+bool AWSCredentialsProviderChain::refresh() {
+	MutexHolder holder(&_refreshLock);
+
+	for (int i = 0; i < _sources.getSize(); i++) {
+		AWSCredentials* credentials = _sources[i]->load();
+		if (credentials == NULL)
+			continue;
+
+		// Unchanged credentials are kept, so that signers keep identifying
+		// their cached signing key by the object.
+		AWSCredentials* current = _current.get();
+		if (current == NULL
+				|| current->getAccessKeyId() != credentials->getAccessKeyId()
+				|| current->getSecretAccessKey()
+						!= credentials->getSecretAccessKey()
+				|| current->getSessionToken() != credentials->getSessionToken()
+				|| current->getExpiration() != credentials->getExpiration()) {
+			LOGI("Loaded credentials '%s' from %s.",
+					credentials->getAccessKeyId().cstr(),
+					_sources[i]->getName().cstr());
+			_current.set(credentials);
+		}
+		_lastRefreshFailed = false;
+		return true;
+	}
+
+	LOGE("Unable to load credentials from any source of the chain.");
+	_lastRefreshFailed = true;
+	return false;
+}
+
+bool AWSCredentialsProviderChain::startRefreshing() {
+	if (_refresher != NULL)
+		return false;
+
+	_stopEvent.reset();
+	_refresher = new AWSCredentialsRefresher(this);
+	if (!_refresher->start()) {
+		LOGE("Unable to start the credentials refreshing thread.");
+		_refresher = NULL;
+		return false;
+	}
+	return true;
+}
+
+void AWSCredentialsProviderChain::stopRefreshing() {
+	if (_refresher == NULL)
+		return;
+
+	_stopEvent.set();
+	_refresher->join();
+	_refresher = NULL;
+}
+
+int AWSCredentialsProviderChain::getRefreshDelay() {
+	if (_lastRefreshFailed)
+		return RETRY_INTERVAL;
+
+	AWSCredentials* credentials = _current.get();
+	if (credentials == NULL || credentials->getExpiration() == 0)
+		return _refreshInterval;
+
+	// Refreshes ahead of the expiration, but never more often than retrying.
+	int64_t delay = credentials->getExpiration() - _refreshMargin
+			- UTCClock::currentMilliseconds();
+	return (int) BFX_MIN(BFX_MAX(delay, (int64_t ) RETRY_INTERVAL),
+			(int64_t ) _refreshInterval);
+}
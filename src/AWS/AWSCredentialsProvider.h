@@ -0,0 +1,159 @@
+/*
+ * AWSCredentialsProvider.h
+ */
+
+#ifndef AWS_AWSCREDENTIALSPROVIDER_H_
+#define AWS_AWSCREDENTIALSPROVIDER_H_
+
+/// Abstract base class for objects providing the current credentials.
+class AWSCredentialsProvider: public REFObject {
+public:
+	/// Returns the current credentials, or NULL if not available. It never
+	/// blocks once credentials have been loaded. The object stays valid for
+	/// at least RCUPointerT::DEFAULT_GRACE_PERIOD milliseconds, add a
+	/// reference to keep it any longer.
+	virtual AWSCredentials* getCredentials() = 0;
+};
+
+/// Provides the same credentials all the time.
+class AWSStaticCredentialsProvider: public AWSCredentialsProvider {
+public:
+	AWSStaticCredentialsProvider(AWSCredentials* credentials);
+	virtual ~AWSStaticCredentialsProvider();
+
+	virtual AWSCredentials* getCredentials();
+
+private:
+	REF<AWSCredentials> _credentials;
+};
+
+/// Abstract base class for places credentials are loaded from.
+class AWSCredentialsSource: public REFObject {
+public:
+	/// Loads the credentials, it may block on I/O. Returns an autoreleased
+	/// object, or NULL if the source has no credentials.
+	virtual AWSCredentials* load() = 0;
+	/// Returns the name of the source, used for logging.
+	virtual String getName() const = 0;
+};
+
+/// Loads credentials from the AWS_ACCESS_KEY_ID, AWS_SECRET_ACCESS_KEY and
+/// AWS_SESSION_TOKEN environment variables.
+class AWSEnvironmentCredentialsSource: public AWSCredentialsSource {
+public:
+	virtual AWSCredentials* load();
+	virtual String getName() const {
+		return "environment";
+	}
+};
+
+/// Loads credentials from a profile of the shared credentials file.
+class AWSProfileCredentialsSource: public AWSCredentialsSource {
+public:
+	/// Creates a source of given profile and file. The profile defaults to
+	/// the AWS_PROFILE environment variable or "default", and the file
+	/// defaults to the AWS_SHARED_CREDENTIALS_FILE environment variable or
+	/// "~/.aws/credentials".
+	AWSProfileCredentialsSource(const String& profileName = "",
+			const String& fileName = "");
+
+	virtual AWSCredentials* load();
+	virtual String getName() const {
+		return "profile " + _profileName;
+	}
+
+private:
+	String _profileName;
+	String _fileName;
+};
+
+/// Loads temporary credentials from a local metadata endpoint, which serves
+/// a JSON document having AccessKeyId, SecretAccessKey, Token and Expiration
+/// fields as the EC2 instance metadata service does. If the URL ends with a
+/// slash, the first line it returns is appended as the role name.
+class AWSMetadataCredentialsSource: public AWSCredentialsSource {
+public:
+	AWSMetadataCredentialsSource(const String& url);
+
+	virtual AWSCredentials* load();
+	virtual String getName() const {
+		return "metadata " + _url;
+	}
+
+private:
+	// Gets the body of given URL, returns false on failure.
+	bool fetch(const String& url, String& body);
+
+	String _url;
+};
+
+class AWSCredentialsRefresher;
+
+/// Provides credentials loaded from the first available one of a chain of
+/// sources. The current credentials are published by read-copy-update, so
+/// that readers, e.g. signers of all threads, never take a lock. A
+/// background thread can reload them before they expire.
+class AWSCredentialsProviderChain: public AWSCredentialsProvider {
+public:
+	enum {
+		/// Default time in milliseconds between refreshing credentials which
+		/// never expire
+		DEFAULT_REFRESH_INTERVAL = 300000,
+		/// Default time in milliseconds before expiration to refresh
+		DEFAULT_REFRESH_MARGIN = 300000,
+		/// Time in milliseconds to wait before retrying a failed refresh
+		RETRY_INTERVAL = 10000,
+	};
+
+	/// Creates an empty chain.
+	AWSCredentialsProviderChain();
+	virtual ~AWSCredentialsProviderChain();
+
+	/// Creates a chain of the environment, the default profile, and the
+	/// metadata endpoint if an URL is given. Returns an autoreleased object.
+	static AWSCredentialsProviderChain* createDefault(
+			const String& metadataUrl = "");
+
+	/// Appends a source to the chain, sources must be added before refreshing.
+	void addSource(AWSCredentialsSource* source);
+
+	/// Returns the current credentials. The first call loads them if they
+	/// haven't been loaded yet, all the later ones never block.
+	virtual AWSCredentials* getCredentials();
+
+	/// Loads credentials from the first available source and publishes them.
+	/// Returns false if none of the sources has credentials, the current
+	/// credentials are kept in that case.
+	bool refresh();
+
+	/// Starts a background thread refreshing the credentials periodically,
+	/// and ahead of their expiration.
+	bool startRefreshing();
+	/// Stops the background thread and waits for it to exit.
+	void stopRefreshing();
+
+	void setRefreshInterval(int milliseconds) {
+		_refreshInterval = milliseconds;
+	}
+	void setRefreshMargin(int milliseconds) {
+		_refreshMargin = milliseconds;
+	}
+
+private:
+	friend class AWSCredentialsRefresher;
+
+	// Returns the time in milliseconds until the next refresh is due.
+	int getRefreshDelay();
+
+	ArrayListT<REF<AWSCredentialsSource> > _sources;
+	RCUPointerT<AWSCredentials> _current;
+	Mutex _refreshLock;
+	bool _lastRefreshFailed;
+	int _refreshInterval;
+	int _refreshMargin;
+
+	REF<AWSCredentialsRefresher> _refresher;
+	Event _stopEvent;
+};
+
+#endif /* AWS_AWSCREDENTIALSPROVIDER_H_ */
@@ -95,17 +95,60 @@ HttpRequest* AWSHttpClient::createHttpRequst(AWSHttpRequest* request) {
 
 	LOGI("PARAM: %s", encodedParams.cstr());
 
-	if (request->getHttpMethod() == AHM_POST) {
-		REF<HttpPost> httpPost = new HttpPost();
-		// Sets parameters to post body.
-		httpPost->getBody().append((const uint8_t*) encodedParams.cstr(),
-				encodedParams.getLength());
+	if (request->hasContent()) {
+		// The parameters go to query string, the payload goes to body.
+		REF<HttpPost> httpPost;
+		if (request->getHttpMethod() == AHM_PUT) {
+			httpPost = new HttpPut();
+		} else if (request->getHttpMethod() == AHM_POST) {
+			httpPost = new HttpPost();
+		} else {
+			_lastError = AWSE_UnrecognizedHttpProtocol;
+			LOGE("Unable to send payload with GET request.");
+			return NULL;
+		}
+		// The payload is sent from where it is, the request outlives the
+		// execution of the HTTP one.
+		httpPost->setExternalBody(request->getContentData(),
+				request->getContentSize());
+		if (!encodedParams.isEmpty()) {
+			url.append('?');
+			url.append(encodedParams);
+		}
 		httpRequest = (HttpPost*) httpPost;
 	} else if (request->getHttpMethod() == AHM_POST) {
-		httpRequest = new HttpGet();
+		REF<HttpPost> httpPost = new HttpPost();
+		if (request->isParametersInQuery()) {
+			if (!encodedParams.isEmpty()) {
+				url.append('?');
+				url.append(encodedParams);
+			}
+		} else {
+			// Sets parameters to post body.
+			httpPost->getBody().append((const uint8_t*) encodedParams.cstr(),
+					encodedParams.getLength());
+		}
+		httpRequest = (HttpPost*) httpPost;
+	} else if (request->getHttpMethod() == AHM_PUT) {
+		httpRequest = new HttpPut();
+		if (!encodedParams.isEmpty()) {
+			url.append('?');
+			url.append(encodedParams);
+		}
+	} else if (request->getHttpMethod() == AHM_GET
+			|| request->getHttpMethod() == AHM_DELETE
+			|| request->getHttpMethod() == AHM_HEAD) {
+		if (request->getHttpMethod() == AHM_GET)
+			httpRequest = new HttpGet();
+		else if (request->getHttpMethod() == AHM_DELETE)
+			httpRequest = new HttpDelete();
+		else
+			httpRequest = new HttpHead();
 		// Sets parameters to query string.
-		url.append('?');
-		url.append(encodedParams);
+		if (!encodedParams.isEmpty()) {
+			url.append('?');
+			url.append(encodedParams);
+		}
 	} else {
 		_lastError = AWSE_UnrecognizedHttpProtocol;
 		LOGE("Unrecognized protocol specified...");
@@ -11,6 +11,16 @@
 enum AWSHttpMethod {
 	AHM_GET,	///
 	AHM_POST,	///
+	AHM_PUT,	///
+	AHM_DELETE,	///
+	AHM_HEAD,	///
+};
+
+/// Specifies whether the payload of a request is covered by the signature.
+enum AWSPayloadSigningMode {
+	APSM_Default = 0,	/// Inherits the setting of the client
+	APSM_Signed,	/// Hashes the payload with SHA-256 and signs the hash
+	APSM_Unsigned,	/// Sends UNSIGNED-PAYLOAD, only honored on HTTPS endpoints
 };
 
 /// Represents a request being sent to an Amazon Web Service. including the
@@ -22,6 +32,10 @@ public:
 	AWSHttpRequest(const String& serviceName) {
 		_serviceName = serviceName;
 		_httpMethod = AHM_POST;
+		_externalContent = NULL;
+		_externalContentSize = 0;
+		_payloadSigningMode = APSM_Default;
+		_parametersInQuery = false;
 	}
 	virtual ~AWSHttpRequest() {
 	}
@@ -76,6 +90,61 @@ public:
 	bool hasParameters() const {
 		return ((_parameters != NULL) && (_parameters->getSize() > 0));
 	}
+	/// Sets a value indicating whether the parameters of a POST request
+	/// without payload are sent in the query string rather than as the
+	/// payload, as REST services such as S3 expect.
+	void setParametersInQuery(bool parametersInQuery) {
+		_parametersInQuery = parametersInQuery;
+	}
+	/// Gets a value indicating whether the parameters are always sent in the
+	/// query string.
+	bool isParametersInQuery() const {
+		return _parametersInQuery;
+	}
+
+	/// Gets the binary payload of this request. When a request has no
+	/// payload, a POST request sends its parameters as the payload.
+	const SharedBufferT<uint8_t>& getContent() const {
+		return _content;
+	}
+	/// Sets the binary payload of this request. The parameters of a request
+	/// with payload are always sent in the query string.
+	void setContent(const SharedBufferT<uint8_t>& content) {
+		_content = content;
+		setExternalContent(NULL, 0, NULL);
+	}
+	void setContent(const uint8_t* data, int dataSize) {
+		setContent(SharedBufferT<uint8_t>(data, dataSize));
+	}
+	/// Sets a payload which is neither copied nor owned, e.g. a mapped file,
+	/// and which the given owner, retained by the request, keeps valid.
+	void setExternalContent(const uint8_t* data, int dataSize,
+			REFObject* owner) {
+		BFX_ASSERT(data || dataSize == 0);
+		_externalContent = data;
+		_externalContentSize = dataSize;
+		_contentOwner = owner;
+	}
+	/// Gets the data of the payload, either the buffer or the external one.
+	const uint8_t* getContentData() const {
+		return _externalContent ? _externalContent : _content.getRawData();
+	}
+	int getContentSize() const {
+		return _externalContent ? _externalContentSize : _content.getSize();
+	}
+	/// Gets a value indicating whether this request has a binary payload.
+	bool hasContent() const {
+		return (getContentSize() > 0);
+	}
+
+	/// Gets a value indicating whether the payload is covered by signature.
+	AWSPayloadSigningMode getPayloadSigningMode() const {
+		return _payloadSigningMode;
+	}
+	/// Sets a value indicating whether the payload is covered by signature.
+	void setPayloadSigningMode(AWSPayloadSigningMode payloadSigningMode) {
+		_payloadSigningMode = payloadSigningMode;
+	}
 
 private:
 	String _serviceName;
@@ -85,6 +154,12 @@ private:
 	String _resourcePath;
 	REF<AWSStringMap> _parameters;
 	REF<AWSStringMap> _headers;
+	SharedBufferT<uint8_t> _content;
+	const uint8_t* _externalContent;
+	int _externalContentSize;
+	REF<REFObject> _contentOwner;
+	AWSPayloadSigningMode _payloadSigningMode;
+	bool _parametersInQuery;
 };
 
 #endif /* AWS_AWSREQUEST_H_ */
@@ -32,6 +32,20 @@ public:
 		return _headers;
 	}
 
+	/// Gets the value of given header field, or empty string if not found.
+	/// The header field name is case insensitive.
+	String getHeader(const char* name) const {
+		if (_headers != NULL) {
+			for (AWSStringMap::PENTRY entry = _headers->getFirstEntry();
+					entry != NULL; entry = _headers->getNextEntry(entry)) {
+				if (StringTraitsT<char>::stringCompareIgnore(entry->key, name)
+						== 0)
+					return entry->value;
+			}
+		}
+		return String();
+	}
+
 	void setContent(const String& content) {
 		_content = content;
 	}
@@ -9,41 +9,193 @@
 
 #include "AWSResult.h"
 
+#define LOG_TAG "AWSResultUnmarshaller"
+
 ////////////////////////////////////////////////////////////////////////////////
 
-AWSResultUnmarshaller::AWSResultUnmarshaller() {
-	// Initializes SAX handler.
-	memset(&_xmlSAXHandler, 0, sizeof(_xmlSAXHandler));
-	_xmlSAXHandler.initialized = XML_SAX2_MAGIC;
-	_xmlSAXHandler.startElementNs = AWSResultUnmarshaller::startElementNsCallback;
-	_xmlSAXHandler.characters = AWSResultUnmarshaller::charactersCallback;
-	_xmlSAXHandler.endElementNs = AWSResultUnmarshaller::endElementNsCallback;
+xmlSAXHandler AWSResultUnmarshaller::s_saxHandler;
+pthread_key_t AWSResultUnmarshaller::s_contextKey;
+bool AWSResultUnmarshaller::s_contextKeyCreated = false;
+xmlDictPtr AWSResultUnmarshaller::s_dict = NULL;
+volatile bool AWSResultUnmarshaller::s_tokenizerEnabled = false;
+
+struct AWSResultUnmarshaller::ParserContext {
+	ParserContext() :
+			xml(NULL) {
+	}
+	~ParserContext() {
+		if (xml != NULL)
+			xmlFreeParserCtxt(xml);
+	}
 
-	// Creates XML parser context.
-	_xmlParserCtx = xmlCreatePushParserCtxt(&_xmlSAXHandler, this, NULL, 0, 0);
+	struct Token {
+		AWSXmlTokenizer::TokenType type;
+		int offset;
+		int length;
+	};
+
+	xmlParserCtxtPtr xml;
+	AWSXmlTokenizer tokenizer;
+	// The tokens of a response, all read before the first is dispatched.
+	BufferT<Token> tokens;
+};
+
+AWSResultUnmarshaller::AWSResultUnmarshaller() {
 }
 
 AWSResultUnmarshaller::~AWSResultUnmarshaller() {
-	xmlFreeParserCtxt(_xmlParserCtx);
 }
 
-bool AWSResultUnmarshaller::parse(TextReader* reader) {
-	BFX_ASSERT(reader);
+bool AWSResultUnmarshaller::parse(const String& content) {
+	// Nothing to parse, e.g. the body of an S3 response without error.
+	if (content.isEmpty())
+		return true;
 
-	const int bufSize = 1024;
-	char buf[bufSize];
-	int charsRead;
-	int ret = XML_ERR_OK;
-	while ((charsRead = reader->read(buf, 0, bufSize)) > 0) {
-		ret = xmlParseChunk(_xmlParserCtx, buf, charsRead,
-				(charsRead < bufSize) ? 1 : 0);
-		if (ret != XML_ERR_OK)
-			break;
+	ParserContext* context = acquireParserContext();
+	if (s_tokenizerEnabled && parseTokens(context, content)) {
+		releaseParserContext(context);
+		return true;
+	}
+
+	if (context->xml == NULL)
+		context->xml = createXmlContext();
+	if (context->xml == NULL) {
+		releaseParserContext(context);
+		return false;
+	}
+	context->xml->userData = this;
+	int ret = xmlParseChunk(context->xml, content.cstr(), content.getLength(),
+			1);
+	if (xmlCtxtResetPush(context->xml, NULL, 0, NULL, NULL) != 0) {
+		xmlFreeParserCtxt(context->xml);
+		context->xml = NULL;
 	}
+	releaseParserContext(context);
 
 	return (ret == XML_ERR_OK) ? true : false;
 }
 
+bool AWSResultUnmarshaller::parseTokens(ParserContext* context,
+		const String& content) {
+	AWSXmlTokenizer& tokenizer = context->tokenizer;
+	BufferT<ParserContext::Token>& tokens = context->tokens;
+	tokenizer.reset(content.cstr(), content.getLength());
+	tokens.clear();
+	while (true) {
+		ParserContext::Token token;
+		token.type = tokenizer.next();
+		if (token.type == AWSXmlTokenizer::END_OF_DOCUMENT)
+			break;
+		if (token.type == AWSXmlTokenizer::UNSUPPORTED)
+			return false;
+		token.offset = tokenizer.getOffset();
+		token.length = tokenizer.getLength();
+		tokens.append(token);
+	}
+
+	// The document is well-formed as far as the callbacks can tell.
+	const char* data = tokenizer.getData();
+	for (int i = 0; i < tokens.getSize(); i++) {
+		const ParserContext::Token& token = tokens[i];
+		const char* value = data + token.offset;
+		switch (token.type) {
+		case AWSXmlTokenizer::START_ELEMENT:
+			onStartElement(value, NULL, NULL, 0, NULL, 0, 0, NULL);
+			break;
+		case AWSXmlTokenizer::END_ELEMENT:
+			onEndElement(value, NULL, NULL);
+			break;
+		default:
+			onCharacters(value, token.length);
+			break;
+		}
+	}
+	return true;
+}
+
+void AWSResultUnmarshaller::ensureInitialized() {
+	static volatile bool __initialized = false;
+	static SpinLock __initLock;
+
+	if (!__initialized) {
+		SpinLock::Holder holder(&__initLock);
+		if (!__initialized) {
+			xmlInitParser();
+
+			// Initializes SAX handler.
+			memset(&s_saxHandler, 0, sizeof(s_saxHandler));
+			s_saxHandler.initialized = XML_SAX2_MAGIC;
+			s_saxHandler.startElementNs =
+					AWSResultUnmarshaller::startElementNsCallback;
+			s_saxHandler.characters = AWSResultUnmarshaller::charactersCallback;
+			s_saxHandler.endElementNs =
+					AWSResultUnmarshaller::endElementNsCallback;
+
+			int ret = pthread_key_create(&s_contextKey, freeParserContext);
+			if (ret == 0) {
+				s_contextKeyCreated = true;
+			} else {
+				LOGW("Unable to create the key of parser contexts: %d, each "
+						"response gets a context of its own.", ret);
+			}
+
+			// Interns the names of the static tables, which are all built
+			// by now.
+			s_dict = xmlDictCreate();
+			for (const AWSElementTable* table = AWSElementTable::s_last;
+					table != NULL; table = table->_prev) {
+				for (int i = 0; i < table->_count; i++)
+					xmlDictLookup(s_dict, BAD_CAST table->_names[i], -1);
+			}
+			__initialized = true;
+		}
+	}
+}
+
+AWSResultUnmarshaller::ParserContext* AWSResultUnmarshaller::acquireParserContext() {
+	ensureInitialized();
+
+	if (!s_contextKeyCreated)
+		return new ParserContext();
+	ParserContext* context = (ParserContext*) pthread_getspecific(
+			s_contextKey);
+	if (context != NULL) {
+		pthread_setspecific(s_contextKey, NULL);
+		return context;
+	}
+	return new ParserContext();
+}
+
+xmlParserCtxtPtr AWSResultUnmarshaller::createXmlContext() {
+	xmlParserCtxtPtr context = xmlCreatePushParserCtxt(&s_saxHandler, NULL,
+			NULL, 0, NULL);
+	if (context == NULL)
+		return NULL;
+	// Looks the names up in the shared dictionary before its own one. The
+	// names interned by the context at its creation go with the replaced
+	// dictionary, and are looked up again.
+	xmlDictPtr dict = (s_dict != NULL) ? xmlDictCreateSub(s_dict) : NULL;
+	if (dict != NULL) {
+		xmlDictFree(context->dict);
+		context->dict = dict;
+		context->str_xml = xmlDictLookup(dict, BAD_CAST "xml", 3);
+		context->str_xmlns = xmlDictLookup(dict, BAD_CAST "xmlns", 5);
+		context->str_xml_ns = xmlDictLookup(dict, XML_XML_NAMESPACE, 36);
+	}
+	return context;
+}
+
+void AWSResultUnmarshaller::releaseParserContext(ParserContext* context) {
+	if (s_contextKeyCreated && pthread_getspecific(s_contextKey) == NULL)
+		pthread_setspecific(s_contextKey, context);
+	else
+		delete context;
+}
+
+void AWSResultUnmarshaller::freeParserContext(void* context) {
+	delete (ParserContext*) context;
+}
+
 void AWSResultUnmarshaller::startElementNsCallback(void* ctx,
 		const xmlChar* localname, const xmlChar* prefix, const xmlChar* URI,
 		int nb_namespaces, const xmlChar** namespaces, int nb_attributes,
@@ -72,3 +224,161 @@ void AWSResultUnmarshaller::endElementNsCallback(void* ctx, const xmlChar* local
 	handler->onEndElement((const char*) localname, (const char*) prefix,
 			(const char*) URI);
 }
+
+////////////////////////////////////////////////////////////////////////////////
+
+const AWSElementTable* AWSElementTable::s_last = NULL;
+
+AWSElementTable::AWSElementTable(const char* const * names, int count) :
+		_prev(s_last), _names(names), _count(count), _seed(0), _mask(0), _slots(
+				NULL) {
+	BFX_ASSERT(names != NULL && count > 0);
+
+	// A quarter full table takes a few seeds to find no collision, doubles
+	// it if none of the seeds does.
+	int size = 8;
+	while (size < count * 4)
+		size *= 2;
+	while (_slots == NULL) {
+		short* slots = new short[size];
+		for (uint32_t seed = 1; seed <= 1024; seed++) {
+			memset(slots, 0xff, size * sizeof(short));
+			int i = 0;
+			for (; i < count; i++) {
+				short& slot = slots[hash(names[i], seed) & (size - 1)];
+				if (slot >= 0)
+					break;
+				slot = (short) i;
+			}
+			if (i == count) {
+				_seed = seed;
+				_mask = size - 1;
+				_slots = slots;
+				break;
+			}
+		}
+		if (_slots == NULL) {
+			delete[] slots;
+			size *= 2;
+		}
+	}
+#ifndef NDEBUG
+	for (int i = 0; i < count; i++)
+		BFX_ASSERT(find(names[i]) == i);	// Duplicated names
+#endif
+	s_last = this;
+}
+
+AWSElementTable::~AWSElementTable() {
+	delete[] _slots;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+AWSElementRuleSet::AWSElementRuleSet(const AWSElementTable* elements,
+		const AWSElementRule* rules, int count,
+		const AWSElementRule* commonRules, int commonCount) :
+		_elements(elements) {
+	BFX_ASSERT(elements);
+
+	for (int i = 0; i < elements->getCount(); i++)
+		_first.add(-1);
+	// The common rules go to the end of the chains, to be found last.
+	add(rules, count);
+	add(commonRules, commonCount);
+}
+
+void AWSElementRuleSet::add(const AWSElementRule* rules, int count) {
+	for (int i = 0; i < count; i++) {
+		const AWSElementRule* rule = &rules[i];
+		BFX_ASSERT(rule->element >= 0 && rule->element < _elements->getCount());
+
+		int index = _rules.getSize();
+		_rules.add(rule);
+		_next.add(-1);
+		int* last = &_first[rule->element];
+		while (*last >= 0)
+			last = &_next[*last];
+		*last = index;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+AWSRuleResultUnmarshaller::AWSRuleResultUnmarshaller(
+		const AWSElementRuleSet* rules) :
+		_rules(rules) {
+	BFX_ASSERT(rules);
+}
+
+AWSRuleResultUnmarshaller::~AWSRuleResultUnmarshaller() {
+}
+
+bool AWSRuleResultUnmarshaller::parse(const String& content,
+		REFObject* result) {
+	BFX_ASSERT(result);
+
+	Frame root;
+	root.element = AWSElementRule::ROOT;
+	root.rule = NULL;
+	root.target = result;
+	_frames.add(root);
+	bool retval = AWSResultUnmarshaller::parse(content);
+	_frames.clear();
+	_text.clear();
+
+	return retval;
+}
+
+void AWSRuleResultUnmarshaller::onStartElement(const char* localname,
+		const char* prefix, const char* URI, int numNamespaces,
+		const char** namespaces, int numAttributes, int numDefaulted,
+		const char** attributes) {
+	const Frame& parent = _frames[_frames.getSize() - 1];
+	Frame frame;
+	frame.element = -1;
+	frame.rule = NULL;
+	if (parent.target != NULL) {
+		frame.element = _rules->getElements()->find(localname);
+		if (frame.element >= 0)
+			frame.rule = _rules->find(parent.element, frame.element);
+	}
+	if (frame.rule != NULL) {
+		if (frame.rule->open != NULL)
+			frame.target = frame.rule->open(parent.target);
+		else
+			frame.target = parent.target;
+		if (frame.rule->set != NULL)
+			_text.clear();
+	}
+	_frames.add(frame);
+}
+
+void AWSRuleResultUnmarshaller::onCharacters(const char* value, int len) {
+	const Frame& frame = _frames[_frames.getSize() - 1];
+	if (frame.rule == NULL)
+		return;
+	if (frame.rule->append != NULL)
+		frame.rule->append(frame.target, value, len);
+	else if (frame.rule->set != NULL)
+		_text.append(value, len);
+}
+
+void AWSRuleResultUnmarshaller::onEndElement(const char*localname,
+		const char* prefix, const char* URI) {
+	BFX_ASSERT(_frames.getSize() > 1);
+
+	int index = _frames.getSize() - 1;
+	const Frame& frame = _frames[index];
+	if (frame.rule != NULL) {
+		if (frame.rule->set != NULL) {
+			// NUL-terminates the text, which doesn't count in the string.
+			_text.append('\0');
+			frame.rule->set(frame.target,
+					String(_text.getRawData(), _text.getSize() - 1));
+		}
+		if (frame.rule->close != NULL)
+			frame.rule->close(frame.target, _frames[index - 1].target);
+	}
+	_frames.removeAt(index);
+}
@@ -10,7 +10,10 @@
 
 #include "../Foundation/Foundation.h"
 #include "../IO/IO.h"
+#include "AWSXmlTokenizer.h"
 #include <libxml/globals.h>
+#include <libxml/parser.h>
+#include <pthread.h>
 
 class AWSResultParser;
 
@@ -27,8 +30,20 @@ public:
 	AWSResultUnmarshaller();
 	virtual ~AWSResultUnmarshaller();
 
+	/// Sets whether the responses are read by AWSXmlTokenizer rather than
+	/// libxml2, which still parses those beyond the subset the tokenizer
+	/// supports. Either way the unmarshallers get the same callbacks.
+	static void setTokenizerEnabled(bool enabled) {
+		s_tokenizerEnabled = enabled;
+	}
+	static bool isTokenizerEnabled() {
+		return s_tokenizerEnabled;
+	}
+
 protected:
-	bool parse(TextReader* reader);
+	/// Parses a whole response body at once. The parser context is the one
+	/// of the calling thread, reset rather than created for each response.
+	bool parse(const String& content);
 
 	virtual void onStartElement(const char* localname, const char* prefix,
 			const char* URI, int nb_namespaces, const char** namespaces,
@@ -50,9 +65,190 @@ protected:
 	static void endElementNsCallback(void* ctx, const xmlChar* localname,
 			const xmlChar* prefix, const xmlChar* URI);
 
+private:
+	// The parsers of a thread, kept from one response to the next.
+	struct ParserContext;
+
+	static void ensureInitialized();
+	// Takes the parser context of the calling thread, or creates one if the
+	// thread has none left, e.g. while parsing within a callback.
+	static ParserContext* acquireParserContext();
+	// Resets a parser context and keeps it for the calling thread, or frees
+	// it if the thread has one already.
+	static void releaseParserContext(ParserContext* context);
+	// Frees the parser context of a thread as the thread exits.
+	static void freeParserContext(void* context);
+	// Creates the libxml2 parser of a context, as it is first needed.
+	static xmlParserCtxtPtr createXmlContext();
+	// Parses by the tokenizer of the context. Returns false before any
+	// callback if the content is beyond the subset it supports.
+	bool parseTokens(ParserContext* context, const String& content);
+
+	static xmlSAXHandler s_saxHandler;
+	static pthread_key_t s_contextKey;
+	// Whether the key was created, contexts aren't kept per thread otherwise.
+	static bool s_contextKeyCreated;
+	// The element names of all the tables, shared read-only by the
+	// dictionaries of the parser contexts, so that they are interned once.
+	static xmlDictPtr s_dict;
+	static volatile bool s_tokenizerEnabled;
+};
+
+/// Maps the names of the elements a service responds with to their indexes,
+/// by a perfect hash: the seed is searched for once, as the table is built,
+/// so that each name has a slot of its own and a lookup costs one hash and
+/// one string compare.
+class AWSElementTable {
+public:
+	/// The names are neither copied nor released. The tables are meant to be
+	/// static, their names are shared by the parsers as they start.
+	AWSElementTable(const char* const * names, int count);
+	~AWSElementTable();
+
+	int getCount() const {
+		return _count;
+	}
+	/// Gets the index of a name, -1 if it is unknown.
+	int find(const char* name) const {
+		int index = _slots[hash(name, _seed) & _mask];
+		if (index >= 0 && StringTraitsT<char>::stringCompare(_names[index], name)
+				== 0)
+			return index;
+		return -1;
+	}
+
+private:
+	static uint32_t hash(const char* name, uint32_t seed) {
+		// FNV-1a, folded to spread the upper bits into the slot index.
+		uint32_t h = 2166136261u ^ seed;
+		for (; *name != 0; name++) {
+			h ^= (uint8_t) *name;
+			h *= 16777619u;
+		}
+		return h ^ (h >> 16);
+	}
+
+	friend class AWSResultUnmarshaller;
+
+	// The tables built, from the last one.
+	static const AWSElementTable* s_last;
+	const AWSElementTable* _prev;
+
+	const char* const * _names;
+	int _count;
+	uint32_t _seed;
+	uint32_t _mask;
+	short* _slots;
+};
+
+/// Tells what an unmarshaller does with an element found in another, so that
+/// unmarshalling a response is a table of rules rather than a state machine.
+/// The elements are indexes of an AWSElementTable. Each element has a
+/// target, the object it fills in: the result for the top one, the object
+/// opened by its rule if any, or else the target of the enclosing element.
+/// The elements without a rule are skipped, along with all they enclose.
+struct AWSElementRule {
+	enum {
+		ROOT = -1,	/// The parent of the top element
+		ANY = -2,	/// Matches any parent
+	};
+
+	int parent;
+	int element;
+	/// Creates the target of the element and adds it to the enclosing target,
+	/// or NULL to keep the enclosing one.
+	REFObject* (*open)(REFObject* target);
+	/// Sets the text of the element to the target, or NULL to skip the text.
+	void (*set)(REFObject* target, const String& value);
+	/// Completes the target of the element, given the enclosing target.
+	void (*close)(REFObject* target, REFObject* parentTarget);
+	/// Appends the text of the element to the target as it is parsed, in
+	/// pieces, instead of setting it as a whole.
+	void (*append)(REFObject* target, const char* chars, int numChars);
+
+	/// Sets a String field of the target.
+	template<typename T, String T::*field>
+	static void setField(REFObject* target, const String& value) {
+		static_cast<T*>(target)->*field = value;
+	}
+	/// Sets the target by one of its setters.
+	template<typename T, void (T::*setter)(const String&)>
+	static void setBy(REFObject* target, const String& value) {
+		(static_cast<T*>(target)->*setter)(value);
+	}
+	/// Opens a new entry at the end of a list of the target.
+	template<typename T, typename L, L* (T::*list)() const, typename E>
+	static REFObject* addEntry(REFObject* target) {
+		REF<E> entry = new E();
+		(static_cast<T*>(target)->*list)()->addLast(entry);
+		return entry;
+	}
+};
+
+/// Indexes the rules of an unmarshaller by element, for a lookup to cost one
+/// compare of the parent for most of the elements.
+class AWSElementRuleSet {
+public:
+	/// The rules are neither copied nor released. A common rule applies where
+	/// none of the rules does, e.g. to the error responses of a service.
+	AWSElementRuleSet(const AWSElementTable* elements,
+			const AWSElementRule* rules, int count,
+			const AWSElementRule* commonRules, int commonCount);
+
+	const AWSElementTable* getElements() const {
+		return _elements;
+	}
+	/// Finds the rule of an element in a parent, NULL if there is none.
+	const AWSElementRule* find(int parent, int element) const {
+		for (int i = _first[element]; i >= 0; i = _next[i]) {
+			if (_rules[i]->parent == parent
+					|| _rules[i]->parent == AWSElementRule::ANY)
+				return _rules[i];
+		}
+		return NULL;
+	}
+
+private:
+	void add(const AWSElementRule* rules, int count);
+
+	const AWSElementTable* _elements;
+	// The rules, and by element the first one and the next ones of a chain.
+	ArrayListT<const AWSElementRule*> _rules;
+	ArrayListT<int> _first;
+	ArrayListT<int> _next;
+};
+
+/// Unmarshalls a response by a set of rules, keeping the enclosing elements
+/// on a stack so that the unexpected ones can't confuse it.
+class AWSRuleResultUnmarshaller: public AWSResultUnmarshaller {
+public:
+	AWSRuleResultUnmarshaller(const AWSElementRuleSet* rules);
+	virtual ~AWSRuleResultUnmarshaller();
+
 protected:
-	xmlParserCtxtPtr _xmlParserCtx;
-	xmlSAXHandler _xmlSAXHandler;
+	/// Parses with given result as the target of the top element.
+	bool parse(const String& content, REFObject* result);
+
+	virtual void onStartElement(const char* localname, const char* prefix,
+			const char* URI, int numNamespaces, const char** namespaces,
+			int numAttributes, int numDefaulted, const char** attributes);
+	virtual void onCharacters(const char* value, int len);
+	virtual void onEndElement(const char*localname, const char* prefix,
+			const char* URI);
+
+private:
+	struct Frame {
+		int element;
+		const AWSElementRule* rule;
+		REF<REFObject> target;
+	};
+
+	const AWSElementRuleSet* _rules;
+	ArrayListT<Frame> _frames;
+	// The text of the innermost element, if its rule sets it. The pieces are
+	// appended to a buffer, which unlike a string doesn't look for the end
+	// of each one, that is of the whole body.
+	BufferT<char> _text;
 };
 
 #endif /* TestTest1_AWS_AWSRESULTPARSER_H_ */
@@ -0,0 +1,516 @@
+/*
+ * AWSSHA256.cpp
+ */
+
+#include "AWS.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SHA256_AVX2_SUPPORTED
+#include <immintrin.h>
+#endif
+
+#define LOG_TAG "AWSSHA256"
+
+static const uint32_t SHA256_K[64] = { 0x428a2f98, 0x71374491, 0xb5c0fbcf,
+		0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5, 0xd807aa98,
+		0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7,
+		0xc19bf174, 0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f,
+		0x4a7484aa, 0x5cb0a9dc, 0x76f988da, 0x983e5152, 0xa831c66d, 0xb00327c8,
+		0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967, 0x27b70a85,
+		0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e,
+		0x92722c85, 0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819,
+		0xd6990624, 0xf40e3585, 0x106aa070, 0x19a4c116, 0x1e376c08, 0x2748774c,
+		0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3, 0x748f82ee,
+		0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7,
+		0xc67178f2 };
+
+static const uint32_t SHA256_INIT[8] = { 0x6a09e667, 0xbb67ae85, 0x3c6ef372,
+		0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 };
+
+static struct SHA256Features {
+	bool avx2Supported;
+	// Whether the AVX2 lanes are used, if supported.
+	bool avx2;
+
+	SHA256Features() {
+#ifdef SHA256_AVX2_SUPPORTED
+		// Runs before main(), so the CPU model has to be initialized first.
+		__builtin_cpu_init();
+		avx2Supported = __builtin_cpu_supports("avx2");
+#else
+		avx2Supported = false;
+#endif
+		avx2 = avx2Supported;
+	}
+} __features;
+
+// One message to be hashed, possibly continuing from a saved state.
+struct SHA256Job {
+	uint32_t state[8];
+	const uint8_t* data;
+	int dataSize;
+	// Number of bytes already hashed into the state.
+	uint64_t prefixLength;
+	uint8_t* digest;
+
+	void init(const uint32_t* initState, const uint8_t* data, int dataSize,
+			uint64_t prefixLength, uint8_t* digest) {
+		memcpy(this->state, initState, sizeof(state));
+		this->data = data;
+		this->dataSize = dataSize;
+		this->prefixLength = prefixLength;
+		this->digest = digest;
+	}
+};
+
+static inline uint32_t loadBE32(const uint8_t* p) {
+	return ((uint32_t) p[0] << 24) | ((uint32_t) p[1] << 16)
+			| ((uint32_t) p[2] << 8) | (uint32_t) p[3];
+}
+
+static inline void storeBE32(uint8_t* p, uint32_t v) {
+	p[0] = (uint8_t) (v >> 24);
+	p[1] = (uint8_t) (v >> 16);
+	p[2] = (uint8_t) (v >> 8);
+	p[3] = (uint8_t) v;
+}
+
+static inline uint32_t rotr(uint32_t x, int n) {
+	return (x >> n) | (x << (32 - n));
+}
+
+static void storeDigest(uint8_t* digest, const uint32_t* state) {
+	for (int i = 0; i < 8; i++)
+		storeBE32(digest + i * 4, state[i]);
+}
+
+// Pads the trailing partial block of a message, returns the number of padded
+// blocks (1 or 2) written to the output.
+static int padTail(const uint8_t* tail, int tailSize, uint64_t totalLength,
+		uint8_t out[AWSSHA256::BLOCK_SIZE * 2]) {
+	BFX_ASSERT(tailSize < AWSSHA256::BLOCK_SIZE);
+
+	int blocks = (tailSize + 9 > AWSSHA256::BLOCK_SIZE) ? 2 : 1;
+	int size = blocks * AWSSHA256::BLOCK_SIZE;
+	memcpy(out, tail, tailSize);
+	out[tailSize] = 0x80;
+	memset(out + tailSize + 1, 0, size - tailSize - 1);
+	uint64_t bits = totalLength * 8;
+	for (int i = 0; i < 8; i++)
+		out[size - 1 - i] = (uint8_t) (bits >> (i * 8));
+	return blocks;
+}
+
+static void compress(uint32_t state[8], const uint8_t* block) {
+	uint32_t w[64];
+	for (int t = 0; t < 16; t++)
+		w[t] = loadBE32(block + t * 4);
+	for (int t = 16; t < 64; t++) {
+		uint32_t s0 = rotr(w[t - 15], 7) ^ rotr(w[t - 15], 18) ^ (w[t - 15] >> 3);
+		uint32_t s1 = rotr(w[t - 2], 17) ^ rotr(w[t - 2], 19) ^ (w[t - 2] >> 10);
+		w[t] = w[t - 16] + s0 + w[t - 7] + s1;
+	}
+
+	uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+	uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+	for (int t = 0; t < 64; t++) {
+		uint32_t s1 = rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25);
+		uint32_t ch = (e & f) ^ (~e & g);
+		uint32_t t1 = h + s1 + ch + SHA256_K[t] + w[t];
+		uint32_t s0 = rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22);
+		uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+		uint32_t t2 = s0 + maj;
+		h = g;
+		g = f;
+		f = e;
+		e = d + t1;
+		d = c;
+		c = b;
+		b = a;
+		a = t1 + t2;
+	}
+	state[0] += a;
+	state[1] += b;
+	state[2] += c;
+	state[3] += d;
+	state[4] += e;
+	state[5] += f;
+	state[6] += g;
+	state[7] += h;
+}
+
+static void runJob(SHA256Job& job) {
+	const uint8_t* data = job.data;
+	int dataSize = job.dataSize;
+	for (; dataSize >= AWSSHA256::BLOCK_SIZE; data += AWSSHA256::BLOCK_SIZE, dataSize -=
+			AWSSHA256::BLOCK_SIZE)
+		compress(job.state, data);
+
+	uint8_t tail[AWSSHA256::BLOCK_SIZE * 2];
+	int blocks = padTail(data, dataSize, job.prefixLength + job.dataSize, tail);
+	for (int i = 0; i < blocks; i++)
+		compress(job.state, tail + i * AWSSHA256::BLOCK_SIZE);
+	storeDigest(job.digest, job.state);
+}
+
+#ifdef SHA256_AVX2_SUPPORTED
+
+#define SHA256_LANES	8
+
+#define ROTR8(x, n)	_mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - (n)))
+
+// Compresses one block of each lane, the state is stored word by word, eight
+// lanes per word.
+__attribute__((target("avx2")))
+static void compress8(uint32_t state[8][SHA256_LANES],
+		const uint8_t* blocks[SHA256_LANES]) {
+	const __m256i bswap = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8,
+			15, 14, 13, 12, 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+
+	// Transposes the message words, so that each register holds one word of
+	// all eight blocks.
+	__m256i w[16];
+	for (int half = 0; half < 2; half++) {
+		__m256i r[8];
+		for (int l = 0; l < SHA256_LANES; l++)
+			r[l] = _mm256_loadu_si256((const __m256i*) (blocks[l] + half * 32));
+		__m256i t0 = _mm256_unpacklo_epi32(r[0], r[1]);
+		__m256i t1 = _mm256_unpackhi_epi32(r[0], r[1]);
+		__m256i t2 = _mm256_unpacklo_epi32(r[2], r[3]);
+		__m256i t3 = _mm256_unpackhi_epi32(r[2], r[3]);
+		__m256i t4 = _mm256_unpacklo_epi32(r[4], r[5]);
+		__m256i t5 = _mm256_unpackhi_epi32(r[4], r[5]);
+		__m256i t6 = _mm256_unpacklo_epi32(r[6], r[7]);
+		__m256i t7 = _mm256_unpackhi_epi32(r[6], r[7]);
+		__m256i u0 = _mm256_unpacklo_epi64(t0, t2);
+		__m256i u1 = _mm256_unpackhi_epi64(t0, t2);
+		__m256i u2 = _mm256_unpacklo_epi64(t1, t3);
+		__m256i u3 = _mm256_unpackhi_epi64(t1, t3);
+		__m256i u4 = _mm256_unpacklo_epi64(t4, t6);
+		__m256i u5 = _mm256_unpackhi_epi64(t4, t6);
+		__m256i u6 = _mm256_unpacklo_epi64(t5, t7);
+		__m256i u7 = _mm256_unpackhi_epi64(t5, t7);
+		__m256i* out = w + half * 8;
+		out[0] = _mm256_permute2x128_si256(u0, u4, 0x20);
+		out[1] = _mm256_permute2x128_si256(u1, u5, 0x20);
+		out[2] = _mm256_permute2x128_si256(u2, u6, 0x20);
+		out[3] = _mm256_permute2x128_si256(u3, u7, 0x20);
+		out[4] = _mm256_permute2x128_si256(u0, u4, 0x31);
+		out[5] = _mm256_permute2x128_si256(u1, u5, 0x31);
+		out[6] = _mm256_permute2x128_si256(u2, u6, 0x31);
+		out[7] = _mm256_permute2x128_si256(u3, u7, 0x31);
+		for (int i = 0; i < 8; i++)
+			out[i] = _mm256_shuffle_epi8(out[i], bswap);
+	}
+
+	__m256i a = _mm256_loadu_si256((const __m256i*) state[0]);
+	__m256i b = _mm256_loadu_si256((const __m256i*) state[1]);
+	__m256i c = _mm256_loadu_si256((const __m256i*) state[2]);
+	__m256i d = _mm256_loadu_si256((const __m256i*) state[3]);
+	__m256i e = _mm256_loadu_si256((const __m256i*) state[4]);
+	__m256i f = _mm256_loadu_si256((const __m256i*) state[5]);
+	__m256i g = _mm256_loadu_si256((const __m256i*) state[6]);
+	__m256i h = _mm256_loadu_si256((const __m256i*) state[7]);
+
+	for (int t = 0; t < 64; t++) {
+		__m256i wt;
+		if (t < 16) {
+			wt = w[t];
+		} else {
+			// The message schedule only looks back 16 words, keeps a ring.
+			__m256i w15 = w[(t - 15) & 15];
+			__m256i w2 = w[(t - 2) & 15];
+			__m256i s0 = _mm256_xor_si256(
+					_mm256_xor_si256(ROTR8(w15, 7), ROTR8(w15, 18)),
+					_mm256_srli_epi32(w15, 3));
+			__m256i s1 = _mm256_xor_si256(
+					_mm256_xor_si256(ROTR8(w2, 17), ROTR8(w2, 19)),
+					_mm256_srli_epi32(w2, 10));
+			wt = _mm256_add_epi32(
+					_mm256_add_epi32(w[t & 15], s0),
+					_mm256_add_epi32(w[(t - 7) & 15], s1));
+			w[t & 15] = wt;
+		}
+
+		__m256i s1 = _mm256_xor_si256(_mm256_xor_si256(ROTR8(e, 6), ROTR8(e, 11)),
+				ROTR8(e, 25));
+		__m256i ch = _mm256_xor_si256(_mm256_and_si256(e, f),
+				_mm256_andnot_si256(e, g));
+		__m256i t1 = _mm256_add_epi32(_mm256_add_epi32(h, s1),
+				_mm256_add_epi32(_mm256_add_epi32(ch, wt),
+						_mm256_set1_epi32((int) SHA256_K[t])));
+		__m256i s0 = _mm256_xor_si256(_mm256_xor_si256(ROTR8(a, 2), ROTR8(a, 13)),
+				ROTR8(a, 22));
+		__m256i maj = _mm256_xor_si256(
+				_mm256_xor_si256(_mm256_and_si256(a, b), _mm256_and_si256(a, c)),
+				_mm256_and_si256(b, c));
+		__m256i t2 = _mm256_add_epi32(s0, maj);
+		h = g;
+		g = f;
+		f = e;
+		e = _mm256_add_epi32(d, t1);
+		d = c;
+		c = b;
+		b = a;
+		a = _mm256_add_epi32(t1, t2);
+	}
+
+	__m256i* s = (__m256i*) state;
+	_mm256_storeu_si256(s + 0, _mm256_add_epi32(_mm256_loadu_si256(s + 0), a));
+	_mm256_storeu_si256(s + 1, _mm256_add_epi32(_mm256_loadu_si256(s + 1), b));
+	_mm256_storeu_si256(s + 2, _mm256_add_epi32(_mm256_loadu_si256(s + 2), c));
+	_mm256_storeu_si256(s + 3, _mm256_add_epi32(_mm256_loadu_si256(s + 3), d));
+	_mm256_storeu_si256(s + 4, _mm256_add_epi32(_mm256_loadu_si256(s + 4), e));
+	_mm256_storeu_si256(s + 5, _mm256_add_epi32(_mm256_loadu_si256(s + 5), f));
+	_mm256_storeu_si256(s + 6, _mm256_add_epi32(_mm256_loadu_si256(s + 6), g));
+	_mm256_storeu_si256(s + 7, _mm256_add_epi32(_mm256_loadu_si256(s + 7), h));
+}
+
+// A lane working on one job, feeding it block by block.
+struct SHA256Lane {
+	SHA256Job* job;
+	const uint8_t* data;
+	int fullBlocks;
+	uint8_t tail[AWSSHA256::BLOCK_SIZE * 2];
+	int tailBlocks;
+	int tailIndex;
+
+	bool isDone() const {
+		return (fullBlocks == 0 && tailIndex == tailBlocks);
+	}
+	const uint8_t* nextBlock() {
+		const uint8_t* block;
+		if (fullBlocks > 0) {
+			block = data;
+			data += AWSSHA256::BLOCK_SIZE;
+			fullBlocks--;
+		} else {
+			block = tail + tailIndex * AWSSHA256::BLOCK_SIZE;
+			tailIndex++;
+		}
+		return block;
+	}
+};
+
+// Runs the jobs through eight lanes, a lane picks up the next job as soon as
+// its current one is finished, so messages of different lengths can share the
+// lanes.
+static void runJobs8(SHA256Job* jobs, int count) {
+	static const uint8_t idleBlock[AWSSHA256::BLOCK_SIZE] = { 0 };
+
+	SHA256Lane lanes[SHA256_LANES];
+	uint32_t state[8][SHA256_LANES];
+	int nextJob = 0;
+	int active = 0;
+
+	for (int l = 0; l < SHA256_LANES; l++) {
+		lanes[l].job = NULL;
+	}
+	for (;;) {
+		// Assigns pending jobs to idle lanes.
+		for (int l = 0; l < SHA256_LANES; l++) {
+			SHA256Lane& lane = lanes[l];
+			if (lane.job != NULL || nextJob >= count)
+				continue;
+			SHA256Job* job = &jobs[nextJob++];
+			lane.job = job;
+			lane.data = job->data;
+			lane.fullBlocks = job->dataSize / AWSSHA256::BLOCK_SIZE;
+			lane.tailBlocks = padTail(
+					job->data + lane.fullBlocks * AWSSHA256::BLOCK_SIZE,
+					job->dataSize % AWSSHA256::BLOCK_SIZE,
+					job->prefixLength + job->dataSize, lane.tail);
+			lane.tailIndex = 0;
+			for (int i = 0; i < 8; i++)
+				state[i][l] = job->state[i];
+			active++;
+		}
+		if (active == 0)
+			break;
+
+		const uint8_t* blocks[SHA256_LANES];
+		for (int l = 0; l < SHA256_LANES; l++) {
+			blocks[l] = (lanes[l].job != NULL) ?
+					lanes[l].nextBlock() : idleBlock;
+		}
+		compress8(state, blocks);
+
+		for (int l = 0; l < SHA256_LANES; l++) {
+			SHA256Lane& lane = lanes[l];
+			if (lane.job == NULL || !lane.isDone())
+				continue;
+			for (int i = 0; i < 8; i++)
+				lane.job->state[i] = state[i][l];
+			storeDigest(lane.job->digest, lane.job->state);
+			lane.job = NULL;
+			active--;
+		}
+
+		// A single long message left, no point to drive seven idle lanes.
+		if (active == 1 && nextJob >= count) {
+			for (int l = 0; l < SHA256_LANES; l++) {
+				SHA256Lane& lane = lanes[l];
+				if (lane.job == NULL)
+					continue;
+				for (int i = 0; i < 8; i++)
+					lane.job->state[i] = state[i][l];
+				while (!lane.isDone())
+					compress(lane.job->state, lane.nextBlock());
+				storeDigest(lane.job->digest, lane.job->state);
+			}
+			break;
+		}
+	}
+}
+
+#endif	// SHA256_AVX2_SUPPORTED
+
+static void runJobs(SHA256Job* jobs, int count) {
+#ifdef SHA256_AVX2_SUPPORTED
+	if (__features.avx2 && count > 1) {
+		runJobs8(jobs, count);
+		return;
+	}
+#endif
+	for (int i = 0; i < count; i++)
+		runJob(jobs[i]);
+}
+
+AWSSHA256::AWSSHA256() {
+	reset();
+}
+
+void AWSSHA256::reset() {
+	memcpy(_state, SHA256_INIT, sizeof(_state));
+	_length = 0;
+}
+
+void AWSSHA256::update(const uint8_t* data, int dataSize) {
+	BFX_ASSERT(data || dataSize == 0);
+	BFX_ASSERT(dataSize >= 0);
+
+	int used = (int) (_length % BLOCK_SIZE);
+	_length += dataSize;
+	if (used > 0) {
+		int n = BFX_MIN(dataSize, BLOCK_SIZE - used);
+		memcpy(_block + used, data, n);
+		data += n;
+		dataSize -= n;
+		if (used + n < BLOCK_SIZE)
+			return;
+		compress(_state, _block);
+	}
+	for (; dataSize >= BLOCK_SIZE; data += BLOCK_SIZE, dataSize -= BLOCK_SIZE)
+		compress(_state, data);
+	if (dataSize > 0)
+		memcpy(_block, data, dataSize);
+}
+
+void AWSSHA256::finish(uint8_t digest[DIGEST_SIZE]) {
+	uint8_t tail[BLOCK_SIZE * 2];
+	int blocks = padTail(_block, (int) (_length % BLOCK_SIZE), _length, tail);
+	for (int i = 0; i < blocks; i++)
+		compress(_state, tail + i * BLOCK_SIZE);
+	storeDigest(digest, _state);
+}
+
+void AWSSHA256::compute(const uint8_t* data, int dataSize,
+		uint8_t digest[DIGEST_SIZE]) {
+	BFX_ASSERT(data || dataSize == 0);
+	BFX_ASSERT(dataSize >= 0);
+
+	SHA256Job job;
+	job.init(SHA256_INIT, data, dataSize, 0, digest);
+	runJob(job);
+}
+
+void AWSSHA256::computeBatch(const uint8_t* const * data, const int* dataSizes,
+		int count, uint8_t (*digests)[DIGEST_SIZE]) {
+	BFX_ASSERT(count >= 0);
+	BFX_ASSERT(count == 0 || (data && dataSizes && digests));
+
+	BufferT<SHA256Job> jobBuffer;
+	SHA256Job* jobs = jobBuffer.getBuffer(count);
+	for (int i = 0; i < count; i++)
+		jobs[i].init(SHA256_INIT, data[i], dataSizes[i], 0, digests[i]);
+	runJobs(jobs, count);
+}
+
+bool AWSSHA256::isMultiBufferAccelerated() {
+	return __features.avx2;
+}
+
+void AWSSHA256::setMultiBufferEnabled(bool enabled) {
+	__features.avx2 = enabled && __features.avx2Supported;
+}
+
+AWSHmacSHA256::AWSHmacSHA256() {
+	setKey(NULL, 0);
+}
+
+AWSHmacSHA256::AWSHmacSHA256(const uint8_t* key, int keySize) {
+	setKey(key, keySize);
+}
+
+void AWSHmacSHA256::setKey(const uint8_t* key, int keySize) {
+	BFX_ASSERT(key || keySize == 0);
+	BFX_ASSERT(keySize >= 0);
+
+	// Keys longer than a block are hashed first.
+	uint8_t keyBlock[AWSSHA256::BLOCK_SIZE];
+	memset(keyBlock, 0, sizeof(keyBlock));
+	if (keySize > AWSSHA256::BLOCK_SIZE)
+		AWSSHA256::compute(key, keySize, keyBlock);
+	else if (keySize > 0)
+		memcpy(keyBlock, key, keySize);
+
+	// Computes the states after the inner and outer padded key, which are the
+	// same for every message.
+	uint8_t pad[AWSSHA256::BLOCK_SIZE];
+	for (int i = 0; i < AWSSHA256::BLOCK_SIZE; i++)
+		pad[i] = keyBlock[i] ^ 0x36;
+	memcpy(_inner, SHA256_INIT, sizeof(_inner));
+	compress(_inner, pad);
+	for (int i = 0; i < AWSSHA256::BLOCK_SIZE; i++)
+		pad[i] = keyBlock[i] ^ 0x5c;
+	memcpy(_outer, SHA256_INIT, sizeof(_outer));
+	compress(_outer, pad);
+}
+
+void AWSHmacSHA256::compute(const uint8_t* data, int dataSize,
+		uint8_t mac[MAC_SIZE]) const {
+	BFX_ASSERT(data || dataSize == 0);
+	BFX_ASSERT(dataSize >= 0);
+
+	uint8_t innerDigest[AWSSHA256::DIGEST_SIZE];
+	SHA256Job job;
+	job.init(_inner, data, dataSize, AWSSHA256::BLOCK_SIZE, innerDigest);
+	runJob(job);
+	job.init(_outer, innerDigest, sizeof(innerDigest), AWSSHA256::BLOCK_SIZE,
+			mac);
+	runJob(job);
+}
+
+void AWSHmacSHA256::computeBatch(const AWSHmacSHA256* const * keys,
+		const uint8_t* const * data, const int* dataSizes, int count,
+		uint8_t (*macs)[MAC_SIZE]) {
+	BFX_ASSERT(count >= 0);
+	BFX_ASSERT(count == 0 || (keys && data && dataSizes && macs));
+
+	BufferT<SHA256Job> jobBuffer;
+	SHA256Job* jobs = jobBuffer.getBuffer(count);
+	BufferT<uint8_t> innerBuffer;
+	uint8_t* innerDigests = innerBuffer.getBuffer(
+			count * AWSSHA256::DIGEST_SIZE);
+
+	for (int i = 0; i < count; i++) {
+		jobs[i].init(keys[i]->_inner, data[i], dataSizes[i],
+				AWSSHA256::BLOCK_SIZE, innerDigests + i * AWSSHA256::DIGEST_SIZE);
+	}
+	runJobs(jobs, count);
+	for (int i = 0; i < count; i++) {
+		jobs[i].init(keys[i]->_outer, innerDigests + i * AWSSHA256::DIGEST_SIZE,
+				AWSSHA256::DIGEST_SIZE, AWSSHA256::BLOCK_SIZE, macs[i]);
+	}
+	runJobs(jobs, count);
+}
@@ -0,0 +1,80 @@
+/*
+ * AWSSHA256.h
+ */
+
+#ifndef AWS_AWSSHA256_H_
+#define AWS_AWSSHA256_H_
+
+/// Computes SHA-256 digests.
+/// Besides the usual streaming interface, many independent messages can be
+/// hashed at once. On CPUs supporting AVX2 each of them occupies one of the
+/// eight 32-bit lanes of the vector registers, which is much faster than
+/// hashing them one by one; a scalar implementation is used otherwise.
+class AWSSHA256 {
+public:
+	enum {
+		DIGEST_SIZE = 32,	/// Size of a digest in bytes
+		BLOCK_SIZE = 64,	/// Size of an input block in bytes
+	};
+
+	AWSSHA256();
+
+	/// Resets the running digest.
+	void reset();
+	/// Feeds more data into the running digest.
+	void update(const uint8_t* data, int dataSize);
+	/// Finishes the running digest and stores it into given buffer, the
+	/// instance needs to be reset before it can be used again.
+	void finish(uint8_t digest[DIGEST_SIZE]);
+
+	/// Computes the digest of given data.
+	static void compute(const uint8_t* data, int dataSize,
+			uint8_t digest[DIGEST_SIZE]);
+	/// Computes the digests of many independent messages at once.
+	static void computeBatch(const uint8_t* const * data, const int* dataSizes,
+			int count, uint8_t (*digests)[DIGEST_SIZE]);
+
+	/// Gets a value indicating whether batches are hashed by AVX2 lanes.
+	static bool isMultiBufferAccelerated();
+	/// Enables or disables hashing batches by AVX2 lanes, which is only
+	/// enabled if the CPU supports them, e.g. to check the scalar
+	/// implementation against them. Not meant to be called while hashing.
+	static void setMultiBufferEnabled(bool enabled);
+
+private:
+	friend class AWSHmacSHA256;
+
+	uint32_t _state[8];
+	uint64_t _length;
+	uint8_t _block[BLOCK_SIZE];
+};
+
+/// Computes RFC 2104-compliant HMAC-SHA256 signatures.
+/// The hash states after the inner and outer padded keys are computed once
+/// when the key is set, so that each signature only hashes the message and
+/// the inner digest.
+class AWSHmacSHA256 {
+public:
+	enum {
+		MAC_SIZE = AWSSHA256::DIGEST_SIZE,	/// Size of a signature in bytes
+	};
+
+	AWSHmacSHA256();
+	AWSHmacSHA256(const uint8_t* key, int keySize);
+
+	/// Sets the key used to sign messages.
+	void setKey(const uint8_t* key, int keySize);
+
+	/// Signs given data.
+	void compute(const uint8_t* data, int dataSize, uint8_t mac[MAC_SIZE]) const;
+	/// Signs many independent messages at once, each one by its own key.
+	static void computeBatch(const AWSHmacSHA256* const * keys,
+			const uint8_t* const * data, const int* dataSizes, int count,
+			uint8_t (*macs)[MAC_SIZE]);
+
+private:
+	uint32_t _inner[8];
+	uint32_t _outer[8];
+};
+
+#endif /* AWS_AWSSHA256_H_ */
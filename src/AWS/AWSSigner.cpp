@@ -47,7 +47,8 @@ AWSSigner* AWSSignerFactory::getSignerByType(AWSSignerType signerType,
 		signer = new AWS3Signer();
 		break;
 	case AWSST_Version4:
-		signer = new AWS4Signer();
+		// S3 does not normalize the resource path, don't double URL-encode it.
+		signer = new AWS4Signer(serviceName != "s3");
 		break;
 	}
 	signer->setServiceName(serviceName);
@@ -61,6 +62,14 @@ AWSSigner::AWSSigner() {
 AWSSigner::~AWSSigner() {
 }
 
+bool AWSSigner::presign(const String& endpoint, const String* resourcePaths,
+		int count, int expiresSeconds, AWSCredentials* credentials,
+		String* urls, int64_t signingTime) {
+	_lastErrorMessage = "Presigning is not supported by the signer.";
+	LOGE(_lastErrorMessage);
+	return false;
+}
+
 String AWSSigner::signAndBase64Encode(const String& data, const uint8_t* key,
 		int keySize, AWSSigningAlgorithm algorithm) {
 	return signAndBase64Encode((const uint8_t*) data.cstr(), data.getLength(),
@@ -91,7 +100,7 @@ SharedBufferT<uint8_t> AWSSigner::sign(const uint8_t* data, int dataSize, const
 	const EVP_MD* hf;
 	if (algorithm == AWSSA_HmacSHA1) {
 		hf = EVP_sha1();
-	} if (algorithm == AWSSA_HmacSHA256) {
+	} else if (algorithm == AWSSA_HmacSHA256) {
 		hf = EVP_sha256();
 	} else {
 		_lastErrorMessage = "Unknown signing algorithm.";
@@ -118,15 +127,10 @@ SharedBufferT<uint8_t> AWSSigner::hash(const uint8_t* data, int dataSize) {
 	if (data == NULL)
 		return SharedBufferT<uint8_t>();	// empty result
 
-	uint8_t result[EVP_MAX_MD_SIZE];
-	unsigned int resultSize = 0;
-
-	EVP_MD_CTX evpCtx;
-	EVP_DigestInit(&evpCtx, EVP_sha256());
-	EVP_DigestUpdate(&evpCtx, data, dataSize);
-	EVP_DigestFinal(&evpCtx, result, &resultSize);
+	uint8_t result[AWSSHA256::DIGEST_SIZE];
+	AWSSHA256::compute(data, dataSize, result);
 
-	return SharedBufferT<uint8_t>(result, resultSize);
+	return SharedBufferT<uint8_t>(result, sizeof(result));
 }
 
 String AWSSigner::getCanonicalizedResourcePath(const String& resourcePath,
@@ -152,11 +156,16 @@ String AWSSigner::getCanonicalizedQueryString(AWSHttpRequest* request) {
     // not in the actual query string.
     //
 
-	if (request->getHttpMethod() == AHM_POST/* && request->getContent() == NULL*/)
+	if (isParametersInPayload(request))
 		return ""; // use payload for query parameters
 	return HttpUtils::encodeParameters(request->getParameters());
 }
 
+bool AWSSigner::isParametersInPayload(AWSHttpRequest* request) {
+	return (request->getHttpMethod() == AHM_POST) && !request->hasContent()
+			&& !request->isParametersInQuery();
+}
+
 void AWSSigner::dbgHexPrint(const uint8_t* data, int dataSize) {
 #ifdef _DEBUG
 	String hexString = "[";
@@ -187,12 +196,25 @@ bool AWS3Signer::sign(AWSHttpRequest* request, AWSCredentials* credentials) {
 
 const String AWS4Signer::AWS4_TERMINATOR = "aws4_request";
 const String AWS4Signer::AWS4_SIGNING_ALGORITHM = "AWS4-HMAC-SHA256";
+const String AWS4Signer::UNSIGNED_PAYLOAD = "UNSIGNED-PAYLOAD";
 
 class AWS4SignerRequestParams {
 public:
 	AWS4SignerRequestParams(AWSHttpRequest* request, const String& regionName,
 			const String& serviceName) {
 		BFX_ASSERT(request);
+
+		// The stamps are formatted once per second and shared by all signers.
+		UTCClock::Stamp stamp;
+		UTCClock::now(stamp);
+		init(request, regionName, serviceName, stamp);
+	}
+	AWS4SignerRequestParams(AWSHttpRequest* request, const String& regionName,
+			const String& serviceName, const UTCClock::Stamp& stamp) {
+		init(request, regionName, serviceName, stamp);
+	}
+	void init(AWSHttpRequest* request, const String& regionName,
+			const String& serviceName, const UTCClock::Stamp& stamp) {
 		BFX_ASSERT(!regionName.isEmpty());
 		BFX_ASSERT(!serviceName.isEmpty());
 
@@ -200,15 +222,14 @@ public:
 		_regionName = regionName;
 		_serviceName = serviceName;
 
-		DateTime time = DateTime().toUTC();
-		_signingDateTimeMilli = time.getMillisecndsSince1970();
+		_signingDateTimeMilli = stamp.milliseconds;
 		LOGT("_signingDateTimeMilli=%lld", _signingDateTimeMilli);
 		// yyyyMMdd
-		_formattedSigningDate = time.format("%04d%02d%02d");
+		_formattedSigningDate = stamp.date;
 		_scope = generateScope(request, _formattedSigningDate, _serviceName,
 				_regionName);
 		// yyyyMMdd'T'HHmmss'Z'
-		_formattedSigningDateTime = time.format("%04d%02d%02dT%02d%02d%02dZ");
+		_formattedSigningDateTime = stamp.dateTime;
 	}
 	String generateScope(AWSHttpRequest* request, const String& dateStamp,
 			const String& serviceName, const String& regionName) {
@@ -231,6 +252,24 @@ public:
 	String _scope;
 };
 
+// A derived signing key, which stays valid for a whole day. It's immutable
+// and shared by all threads signing by the same signer.
+class AWS4SigningKey: public REFObject {
+public:
+	AWS4SigningKey(AWSCredentials* credentials, const String& name,
+			int64_t days, const SharedBufferT<uint8_t>& key) :
+			_credentials(credentials), _name(name), _days(days), _key(key),
+			_hmac(key.getRawData(), key.getSize()) {
+	}
+
+	// Keeps the credentials alive, so that they are identified by address.
+	REF<AWSCredentials> _credentials;
+	String _name;
+	int64_t _days;
+	SharedBufferT<uint8_t> _key;
+	AWSHmacSHA256 _hmac;
+};
+
 AWS4Signer::AWS4Signer(bool doubleUrlEncode) :
 		_doubleUrlEncode(doubleUrlEncode) {
 }
@@ -246,22 +285,17 @@ bool AWS4Signer::sign(AWSHttpRequest* request, AWSCredentials* credentials) {
 
 	AWS4SignerRequestParams signerParams(request, _regionName, _serviceName);
 
-	// AWS4 requires that we sign the Host header so we have to have it in the
-	// request by the time we sign.
-	request->getHeaders()->set("Host",
-			getHostFromUrlString(request->getEndpoint()));
-	request->getHeaders()->set("X-Amz-Date",
-			signerParams._formattedSigningDateTime);
-
+	addSigningHeaders(request, credentials, signerParams);
 	String contentSha256 = calculateContentHash(request);
-	// request->getHeaders().set("x-amz-content-sha256", contentSha256);
+	addContentHeaders(request, contentSha256);
+
 	String canonicalRequest = createCanonicalRequest(request, contentSha256);
 	String stringToSign = createStringToSign(canonicalRequest, signerParams);
 
-	SharedBufferT<uint8_t> signingKey = deriveSigningKey(credentials,
-			signerParams);
+	AWS4SigningKey* signingKey = deriveSigningKey(credentials, signerParams);
 	SharedBufferT<uint8_t> signature = computeSignature(stringToSign,
-			signingKey.getRawData(), signingKey.getSize(), signerParams);
+			signingKey->_key.getRawData(), signingKey->_key.getSize(),
+			signerParams);
 
 	request->getHeaders()->set("Authorization",
 			buildAuthorizationHeader(request, signature.getRawData(),
@@ -269,6 +303,233 @@ bool AWS4Signer::sign(AWSHttpRequest* request, AWSCredentials* credentials) {
 	return true;
 }
 
+bool AWS4Signer::signBatch(AWSHttpRequest* const * requests, int count,
+		AWSCredentials* credentials) {
+	BFX_ASSERT(requests || count == 0);
+
+	if (credentials == NULL || count == 0)
+		return true;		// anonymous credentials, don't sign
+
+	// All requests share the same signing time, scope and key.
+	AWS4SignerRequestParams signerParams(requests[0], _regionName,
+			_serviceName);
+
+	ArrayListT<String> texts;
+	BufferT<const uint8_t*> dataBuffer;
+	BufferT<int> dataSizeBuffer;
+	BufferT<uint8_t> digestBuffer;
+	const uint8_t** data = dataBuffer.getBuffer(count);
+	int* dataSizes = dataSizeBuffer.getBuffer(count);
+	uint8_t (*digests)[AWSSHA256::DIGEST_SIZE] =
+			(uint8_t (*)[AWSSHA256::DIGEST_SIZE]) digestBuffer.getBuffer(
+					count * AWSSHA256::DIGEST_SIZE);
+
+	// Hashes the payloads, except the unsigned ones.
+	static const uint8_t emptyPayload[1] = { 0 };
+	int hashCount = 0;
+	for (int i = 0; i < count; i++) {
+		AWSHttpRequest* request = requests[i];
+		BFX_ASSERT(request);
+		addSigningHeaders(request, credentials, signerParams);
+		if (isParametersInPayload(request)) {
+			// use payload for query parameters
+			texts.add(HttpUtils::encodeParameters(request->getParameters()));
+			data[hashCount] = (const uint8_t*) texts[texts.getSize() - 1].cstr();
+			dataSizes[hashCount] = texts[texts.getSize() - 1].getLength();
+		} else if (isPayloadUnsigned(request)) {
+			continue;
+		} else if (request->hasContent()) {
+			data[hashCount] = request->getContentData();
+			dataSizes[hashCount] = request->getContentSize();
+		} else {
+			data[hashCount] = emptyPayload;
+			dataSizes[hashCount] = 0;
+		}
+		hashCount++;
+	}
+	AWSSHA256::computeBatch(data, dataSizes, hashCount, digests);
+	hashCount = 0;
+	for (int i = 0; i < count; i++) {
+		AWSHttpRequest* request = requests[i];
+		String contentSha256;
+		if (!isParametersInPayload(request) && isPayloadUnsigned(request)) {
+			contentSha256 = UNSIGNED_PAYLOAD;
+		} else {
+			contentSha256 = HttpUtils::toHexString(digests[hashCount++],
+					AWSSHA256::DIGEST_SIZE);
+		}
+		addContentHeaders(request, contentSha256);
+		texts.add(createCanonicalRequest(request, contentSha256));
+	}
+
+	// Hashes the canonical requests.
+	int textBase = texts.getSize() - count;
+	for (int i = 0; i < count; i++) {
+		data[i] = (const uint8_t*) texts[textBase + i].cstr();
+		dataSizes[i] = texts[textBase + i].getLength();
+	}
+	AWSSHA256::computeBatch(data, dataSizes, count, digests);
+	for (int i = 0; i < count; i++) {
+		texts.add(createStringToSign(digests[i], AWSSHA256::DIGEST_SIZE,
+				signerParams));
+	}
+
+	// Signs the strings by the precomputed HMAC key of the signing key.
+	AWS4SigningKey* signingKey = deriveSigningKey(credentials, signerParams);
+	BufferT<const AWSHmacSHA256*> keyBuffer;
+	const AWSHmacSHA256** keys = keyBuffer.getBuffer(count);
+	textBase = texts.getSize() - count;
+	for (int i = 0; i < count; i++) {
+		keys[i] = &signingKey->_hmac;
+		data[i] = (const uint8_t*) texts[textBase + i].cstr();
+		dataSizes[i] = texts[textBase + i].getLength();
+	}
+	AWSHmacSHA256::computeBatch(keys, data, dataSizes, count, digests);
+
+	for (int i = 0; i < count; i++) {
+		requests[i]->getHeaders()->set("Authorization",
+				buildAuthorizationHeader(requests[i], digests[i],
+						AWSHmacSHA256::MAC_SIZE, credentials, signerParams));
+	}
+	return true;
+}
+
+bool AWS4Signer::presign(const String& endpoint, const String* resourcePaths,
+		int count, int expiresSeconds, AWSCredentials* credentials,
+		String* urls, int64_t signingTime) {
+	BFX_ASSERT(resourcePaths || count == 0);
+	BFX_ASSERT(urls || count == 0);
+
+	if (credentials == NULL) {
+		LOGE("Presigning requires credentials.");
+		return false;
+	}
+	if (expiresSeconds < 1 || expiresSeconds > MAX_PRESIGN_EXPIRES) {
+		LOGE("The expiration: %d seconds is out of range.", expiresSeconds);
+		return false;
+	}
+	if (count == 0)
+		return true;
+
+	UTCClock::Stamp stamp;
+	if (signingTime < 0)
+		UTCClock::now(stamp);
+	else
+		UTCClock::format(signingTime, stamp);
+	AWS4SignerRequestParams signerParams(NULL, _regionName, _serviceName,
+			stamp);
+
+	// Everything but the resource path is shared by the whole batch.
+	//
+	// Refer to:
+	// http://docs.aws.amazon.com/AmazonS3/latest/API/sigv4-query-string-auth.html
+	String query = "X-Amz-Algorithm=" + AWS4_SIGNING_ALGORITHM;
+	query.append("&X-Amz-Credential=");
+	query.append(
+			HttpUtils::urlEncode(
+					credentials->getAccessKeyId() + "/" + signerParams._scope));
+	query.append("&X-Amz-Date=");
+	query.append(signerParams._formattedSigningDateTime);
+	query.append("&X-Amz-Expires=");
+	query.append(String::format("%d", expiresSeconds));
+	if (!credentials->getSessionToken().isEmpty()) {
+		query.append("&X-Amz-Security-Token=");
+		query.append(HttpUtils::urlEncode(credentials->getSessionToken()));
+	}
+	query.append("&X-Amz-SignedHeaders=host");
+
+	String canonicalRequestSuffix = "\n" + query;
+	canonicalRequestSuffix.append("\nhost:");
+	canonicalRequestSuffix.append(getHostFromUrlString(endpoint));
+	canonicalRequestSuffix.append("\n\nhost\n");
+	canonicalRequestSuffix.append(UNSIGNED_PAYLOAD);
+
+	String baseUrl = endpoint;
+	if (baseUrl.endsWith('/'))
+		baseUrl = baseUrl.substring(0, baseUrl.getLength() - 1);
+
+	ArrayListT<String> paths;
+	ArrayListT<String> texts;
+	BufferT<const uint8_t*> dataBuffer;
+	BufferT<int> dataSizeBuffer;
+	BufferT<uint8_t> digestBuffer;
+	const uint8_t** data = dataBuffer.getBuffer(count);
+	int* dataSizes = dataSizeBuffer.getBuffer(count);
+	uint8_t (*digests)[AWSSHA256::DIGEST_SIZE] =
+			(uint8_t (*)[AWSSHA256::DIGEST_SIZE]) digestBuffer.getBuffer(
+					count * AWSSHA256::DIGEST_SIZE);
+
+	// Hashes the canonical requests.
+	for (int i = 0; i < count; i++) {
+		String path = HttpUtils::appendUri("/", resourcePaths[i], false);
+		String canonicalRequest = "GET\n";
+		canonicalRequest.append(
+				getCanonicalizedResourcePath(path, _doubleUrlEncode));
+		canonicalRequest.append(canonicalRequestSuffix);
+		paths.add(path);
+		texts.add(canonicalRequest);
+		data[i] = (const uint8_t*) texts[i].cstr();
+		dataSizes[i] = texts[i].getLength();
+	}
+	AWSSHA256::computeBatch(data, dataSizes, count, digests);
+
+	// Signs the strings by the precomputed HMAC key of the signing key.
+	for (int i = 0; i < count; i++) {
+		texts[i] = createStringToSign(digests[i], AWSSHA256::DIGEST_SIZE,
+				signerParams);
+		data[i] = (const uint8_t*) texts[i].cstr();
+		dataSizes[i] = texts[i].getLength();
+	}
+	AWS4SigningKey* signingKey = deriveSigningKey(credentials, signerParams);
+	BufferT<const AWSHmacSHA256*> keyBuffer;
+	const AWSHmacSHA256** keys = keyBuffer.getBuffer(count);
+	for (int i = 0; i < count; i++)
+		keys[i] = &signingKey->_hmac;
+	AWSHmacSHA256::computeBatch(keys, data, dataSizes, count, digests);
+
+	for (int i = 0; i < count; i++) {
+		String url = baseUrl;
+		url.append(paths[i]);
+		url.append('?');
+		url.append(query);
+		url.append("&X-Amz-Signature=");
+		url.append(HttpUtils::toHexString(digests[i], AWSHmacSHA256::MAC_SIZE));
+		urls[i] = url;
+	}
+	return true;
+}
+
+void AWS4Signer::addSigningHeaders(AWSHttpRequest* request,
+		AWSCredentials* credentials, AWS4SignerRequestParams& signerParams) {
+	// AWS4 requires that we sign the Host header so we have to have it in the
+	// request by the time we sign.
+	request->getHeaders()->set("Host",
+			getHostFromUrlString(request->getEndpoint()));
+	request->getHeaders()->set("X-Amz-Date",
+			signerParams._formattedSigningDateTime);
+	// Temporary credentials are only valid along with their session token.
+	if (!credentials->getSessionToken().isEmpty()) {
+		request->getHeaders()->set("X-Amz-Security-Token",
+				credentials->getSessionToken());
+	}
+}
+
+void AWS4Signer::addContentHeaders(AWSHttpRequest* request,
+		const String& contentSha256) {
+	if (!isParametersInPayload(request)) {
+		request->getHeaders()->set("x-amz-content-sha256", contentSha256);
+	}
+	if (contentSha256 == UNSIGNED_PAYLOAD && request->hasContent()
+			&& !request->getHeaders()->contains("x-amz-checksum-crc32c")) {
+		// The payload is not covered by the signature, protects the integrity
+		// by a checksum instead, which is far cheaper than SHA-256.
+		request->getHeaders()->set("x-amz-checksum-crc32c",
+				AWSCRC32C::toBase64(
+						AWSCRC32C::compute(request->getContentData(),
+								request->getContentSize())));
+	}
+}
+
 String AWS4Signer::getHostFromUrlString(const String& url) {
 	String host = url;
 	int pos = host.indexOf("://");
@@ -285,8 +546,7 @@ String AWS4Signer::getHostFromUrlString(const String& url) {
 }
 
 String AWS4Signer::calculateContentHash(AWSHttpRequest* request) {
-	if (request->getHttpMethod() == AHM_POST
-			/* && request->getContent() == NULL*/) {
+	if (isParametersInPayload(request)) {
 		// use payload for query parameters
 
 		String payloadStr = HttpUtils::encodeParameters(
@@ -298,9 +558,31 @@ String AWS4Signer::calculateContentHash(AWSHttpRequest* request) {
 		LOGT("AWS4 Content Hash: \n\"%s\"", (const char* )contentSha256);
 		return contentSha256;
 	}
-	// TODO: get binary request payload stream without query parameters
-	BFX_ASSERT(false);
-	return "";
+	if (isPayloadUnsigned(request)) {
+		return UNSIGNED_PAYLOAD;
+	}
+
+	static const uint8_t emptyPayload[1] = { 0 };
+	SharedBufferT<uint8_t> hashBytes = request->hasContent() ?
+			hash(request->getContentData(), request->getContentSize()) :
+			hash(emptyPayload, 0);
+	String contentSha256 = HttpUtils::toHexString(hashBytes.getRawData(),
+			hashBytes.getSize());
+
+	LOGT("AWS4 Content Hash: \n\"%s\"", (const char* )contentSha256);
+	return contentSha256;
+}
+
+bool AWS4Signer::isPayloadUnsigned(AWSHttpRequest* request) {
+	if (request->getPayloadSigningMode() != APSM_Unsigned)
+		return false;
+	// Without TLS, the signature is the only thing protecting the payload.
+	if (!request->getEndpoint().startsWith("https://")) {
+		LOGW("Unsigned payload requires HTTPS endpoint, signing the payload"
+				" of request to '%s'.", (const char* )request->getEndpoint());
+		return false;
+	}
+	return true;
 }
 
 String AWS4Signer::createCanonicalRequest(AWSHttpRequest* request,
@@ -315,7 +597,24 @@ String AWS4Signer::createCanonicalRequest(AWSHttpRequest* request,
 	String path = HttpUtils::appendUri("/",	// request->getEndpoint()
 			request->getResourcePath(), false);
 	// TODO More HTTP methods support.
-    String canonicalRequest = (request->getHttpMethod() == AHM_POST) ? "POST" : "GET";
+    String canonicalRequest;
+    switch (request->getHttpMethod()) {
+    case AHM_POST:
+    	canonicalRequest = "POST";
+    	break;
+    case AHM_PUT:
+    	canonicalRequest = "PUT";
+    	break;
+    case AHM_DELETE:
+    	canonicalRequest = "DELETE";
+    	break;
+    case AHM_HEAD:
+    	canonicalRequest = "HEAD";
+    	break;
+    default:
+    	canonicalRequest = "GET";
+    	break;
+    }
     canonicalRequest.append("\n");
     // This would optionally double URL-encode the resource path
     canonicalRequest.append(getCanonicalizedResourcePath(path, _doubleUrlEncode));
@@ -338,31 +637,33 @@ String AWS4Signer::createStringToSign(const String& canonicalRequest,
 	//
 	// Refer to:
 	// http://docs.aws.amazon.com/general/latest/gr/sigv4-create-string-to-sign.html.
+	SharedBufferT<uint8_t> bytes = hash(canonicalRequest);
+	return createStringToSign(bytes.getRawData(), bytes.getSize(),
+			signerParams);
+}
+
+String AWS4Signer::createStringToSign(const uint8_t* canonicalRequestHash,
+		int canonicalRequestHashSize, AWS4SignerRequestParams& signerParams) {
 	String stringToSign = AWS4_SIGNING_ALGORITHM;
 	stringToSign.append("\n");
 	stringToSign.append(signerParams._formattedSigningDateTime);
 	stringToSign.append("\n");
 	stringToSign.append(signerParams._scope);
 	stringToSign.append("\n");
-
-	SharedBufferT<uint8_t> bytes = hash(canonicalRequest);
-	stringToSign += HttpUtils::toHexString(bytes.getRawData(), bytes.getSize());
+	stringToSign += HttpUtils::toHexString(canonicalRequestHash,
+			canonicalRequestHashSize);
 
 	LOGT("AWS4 String to Sign: \n\"%s\"", (const char* )stringToSign);
 	return stringToSign;
 }
 
-SharedBufferT<uint8_t> AWS4Signer::deriveSigningKey(AWSCredentials* credentials,
-            AWS4SignerRequestParams& signerRequestParams) {
+AWS4SigningKey* AWS4Signer::deriveSigningKey(AWSCredentials* credentials,
+		AWS4SignerRequestParams& signerRequestParams) {
 	// Step 3 of the AWS Signature version 4 calculation. It involves deriving
 	// the signing key and computing the signature.
 	//
 	// Refer to:
 	// http://docs.aws.amazon.com/general/latest/gr/sigv4-calculate-signature.html
-#if 0
-	// Cache key
-	const String cacheKey = computeSigningCacheKeyName(credentials,
-			signerRequestParams);
 
 	// Cache expiration
 	const int64_t MillisPerSecond = 1000;
@@ -370,23 +671,38 @@ SharedBufferT<uint8_t> AWS4Signer::deriveSigningKey(AWSCredentials* credentials,
 
 	int64_t daysSinceEpochSigningDate =
 			signerRequestParams._signingDateTimeMilli / MillisPerDay;
-#endif
 
-	// TODO Get cached signing key if possible.
+	// The cached key is read without locking, and is usually derived from the
+	// very same credentials object.
+	AWS4SigningKey* signingKey = _signingKey.get();
+	if (signingKey != NULL && signingKey->_days == daysSinceEpochSigningDate
+			&& signingKey->_credentials == credentials) {
+		return signingKey;
+	}
+
+	// Cache key
+	const String cacheKey = computeSigningCacheKeyName(credentials,
+			signerRequestParams);
+	if (signingKey != NULL && signingKey->_days == daysSinceEpochSigningDate
+			&& signingKey->_name == cacheKey) {
+		return signingKey;
+	}
 
 	LOGT("Generating a new signing key as the signing key not available in the"
 			" cache for the date : %lld",
 			signerRequestParams._signingDateTimeMilli);
 
-	SharedBufferT<uint8_t> signingKey = newSigningKey(credentials,
+	SharedBufferT<uint8_t> key = newSigningKey(credentials,
 			signerRequestParams._formattedSigningDate,
 			signerRequestParams._regionName, signerRequestParams._serviceName);
-
-	// TODO Put the signing key back to cache.
-
-	dbgHexPrint(signingKey.getRawData(), signingKey.getSize());
-
-	return signingKey;
+	dbgHexPrint(key.getRawData(), key.getSize());
+
+	// Rotated credentials replace the key of the old ones, which is released
+	// after the grace period.
+	REF<AWS4SigningKey> newKey = new AWS4SigningKey(credentials, cacheKey,
+			daysSinceEpochSigningDate, key);
+	_signingKey.set(newKey);
+	return newKey;
 }
 
 SharedBufferT<uint8_t> AWS4Signer::computeSignature(const String& stringToSign,
@@ -9,12 +9,16 @@
 #define TestTest1_AWS_AWSSIGNER_H_
 
 /// A credentials object provides access key ID and secret access key used for
-/// accessing AWS services
+/// accessing AWS services, and the session token of temporary credentials.
+/// It's immutable, credentials are rotated by replacing the whole object.
 class AWSCredentials: public REFObject {
 public:
-	AWSCredentials(const String& accessKeyId, const String& secretAccessKey) {
+	AWSCredentials(const String& accessKeyId, const String& secretAccessKey,
+			const String& sessionToken = "", int64_t expiration = 0) {
 		_accessKeyId = accessKeyId;
 		_secretAccessKey = secretAccessKey;
+		_sessionToken = sessionToken;
+		_expiration = expiration;
 	}
 
 	/// Returns the AWS access key ID
@@ -27,9 +31,22 @@ public:
 		return _secretAccessKey;
 	}
 
+	/// Returns the session token of temporary credentials, or an empty string
+	const String& getSessionToken() const {
+		return _sessionToken;
+	}
+
+	/// Returns the expiration time in milliseconds since January 1, 1970 UTC,
+	/// or 0 if the credentials never expire
+	int64_t getExpiration() const {
+		return _expiration;
+	}
+
 private:
 	String _accessKeyId;
 	String _secretAccessKey;
+	String _sessionToken;
+	int64_t _expiration;
 };
 
 enum AWSSignerType {
@@ -70,6 +87,15 @@ public:
 	/// Sign the given request with the given set of credentials.
 	virtual bool sign(AWSHttpRequest* request, AWSCredentials* credentials) = 0;
 
+	/// Creates presigned URLs, which grant GET access to given resources of an
+	/// endpoint for given seconds without any further credentials. The URLs
+	/// are stored into the given array, which must hold count elements. The
+	/// signing time is in milliseconds since January 1, 1970 UTC, or -1 to
+	/// use the current time. Not all signers support presigning.
+	virtual bool presign(const String& endpoint, const String* resourcePaths,
+			int count, int expiresSeconds, AWSCredentials* credentials,
+			String* urls, int64_t signingTime = -1);
+
 	/// Configure this signer with the name of the service it will be used to
 	/// sign requests for.
 	virtual void setServiceName(const String& value) = 0;
@@ -105,6 +131,9 @@ protected:
 
 	String getCanonicalizedResourcePath(const String& resourcePath,
 			bool urlEncode);
+	/// Gets a value indicating whether the parameters of given request are
+	/// sent as the payload, instead of the query string.
+	static bool isParametersInPayload(AWSHttpRequest* request);
 	String getCanonicalizedQueryString(AWSHttpRequest* request);
 
 	void dbgHexPrint(const uint8_t* data, int dataSize);
@@ -135,6 +164,7 @@ public:
 };
 
 class AWS4SignerRequestParams;
+class AWS4SigningKey;
 
 /// Signer implementation that signs requests with the AWS4 signing protocol.
 class AWS4Signer : public AWSSigner {
@@ -145,6 +175,21 @@ public:
 	/// Sign the given request with the given set of credentials.
 	virtual bool sign(AWSHttpRequest* request, AWSCredentials* credentials);
 
+	/// Signs many requests at once with the given set of credentials.
+	/// The results are the same as signing the requests one by one, but the
+	/// payloads, canonical requests and signatures of all requests are hashed
+	/// together by the multi-buffer SHA-256 engine.
+	bool signBatch(AWSHttpRequest* const * requests, int count,
+			AWSCredentials* credentials);
+
+	/// Creates presigned URLs by using query string authentication. Only the
+	/// resource path, the hashes and the signature are computed per URL, the
+	/// canonical query string, the credential scope and the signing key are
+	/// shared by the whole batch.
+	virtual bool presign(const String& endpoint, const String* resourcePaths,
+			int count, int expiresSeconds, AWSCredentials* credentials,
+			String* urls, int64_t signingTime = -1);
+
 	/// Configure this signer with the name of the service it will be used to
 	/// sign requests for.
 	virtual void setServiceName(const String& serviceName) {
@@ -158,17 +203,29 @@ public:
 	}
 
 protected:
+	// Adds the headers which have to be signed, except the content hash.
+	void addSigningHeaders(AWSHttpRequest* request, AWSCredentials* credentials,
+			AWS4SignerRequestParams& signerParams);
+	// Adds the content hash, and the checksum of an unsigned payload.
+	void addContentHeaders(AWSHttpRequest* request,
+			const String& contentSha256);
 	// Calculate the hash of the request's payload
 	String calculateContentHash(AWSHttpRequest* request);
+	// Gets a value indicating whether the payload of given request is left out
+	// of the signature.
+	bool isPayloadUnsigned(AWSHttpRequest* request);
 	// Step 1 of the AWS Signature version 4 calculation.
 	String createCanonicalRequest(AWSHttpRequest* request,
 			const String& contentSha256);
 	// Step 2 of the AWS Signature version 4 calculation
 	String createStringToSign(const String& canonicalRequest,
 			AWS4SignerRequestParams& signerParams);
+	String createStringToSign(const uint8_t* canonicalRequestHash,
+			int canonicalRequestHashSize, AWS4SignerRequestParams& signerParams);
 	// Step 3 of the AWS Signature version 4 calculation. It involves deriving
-	// the signing key and computing the signature.
-	SharedBufferT<uint8_t> deriveSigningKey(AWSCredentials* credentials,
+	// the signing key and computing the signature. The key stays valid for
+	// the grace period of the cache.
+	AWS4SigningKey* deriveSigningKey(AWSCredentials* credentials,
 			AWS4SignerRequestParams& signerRequestParams);
 	// Step 3 of the AWS Signature version 4 calculation. It involves deriving
 	// the signing key and computing the signature.
@@ -196,6 +253,9 @@ protected:
 public:
 	static const String AWS4_TERMINATOR;
 	static const String AWS4_SIGNING_ALGORITHM;
+	static const String UNSIGNED_PAYLOAD;
+	/// The longest validity of a presigned URL, in seconds (7 days).
+	static const int MAX_PRESIGN_EXPIRES = 604800;
 protected:
 
 	// Whether double URL-encode the resource path when constructing the
@@ -203,6 +263,11 @@ protected:
 	bool _doubleUrlEncode;
 	String _serviceName;
 	String _regionName;
+
+	// The most recently derived signing key, read without locking. Rotated
+	// credentials derive and publish a new key, the replaced one is released
+	// after the grace period.
+	RCUPointerT<AWS4SigningKey> _signingKey;
 };
 
 #endif /* TestTest1_AWS_AWSSIGNER_H_ */
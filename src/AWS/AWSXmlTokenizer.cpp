@@ -0,0 +1,472 @@
+/*
+ * AWSXmlTokenizer.cpp
+ */
+
+#include <string.h>
+#include <strings.h>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "AWSXmlTokenizer.h"
+
+// Finds the first of given bytes from p, or returns end. The blocks are
+// loaded unaligned and never past end, the rest is scanned byte by byte.
+static inline char* findAny(char* p, char* end, char c1, char c2, char c3,
+		char c4) {
+#if defined(__AVX2__)
+	const __m256i v1 = _mm256_set1_epi8(c1);
+	const __m256i v2 = _mm256_set1_epi8(c2);
+	const __m256i v3 = _mm256_set1_epi8(c3);
+	const __m256i v4 = _mm256_set1_epi8(c4);
+	for (; end - p >= 32; p += 32) {
+		__m256i block = _mm256_loadu_si256((const __m256i*) p);
+		__m256i match = _mm256_or_si256(
+				_mm256_or_si256(_mm256_cmpeq_epi8(block, v1),
+						_mm256_cmpeq_epi8(block, v2)),
+				_mm256_or_si256(_mm256_cmpeq_epi8(block, v3),
+						_mm256_cmpeq_epi8(block, v4)));
+		unsigned mask = (unsigned) _mm256_movemask_epi8(match);
+		if (mask != 0)
+			return p + __builtin_ctz(mask);
+	}
+#endif
+#if defined(__SSE2__)
+	const __m128i w1 = _mm_set1_epi8(c1);
+	const __m128i w2 = _mm_set1_epi8(c2);
+	const __m128i w3 = _mm_set1_epi8(c3);
+	const __m128i w4 = _mm_set1_epi8(c4);
+	for (; end - p >= 16; p += 16) {
+		__m128i block = _mm_loadu_si128((const __m128i*) p);
+		__m128i match = _mm_or_si128(
+				_mm_or_si128(_mm_cmpeq_epi8(block, w1),
+						_mm_cmpeq_epi8(block, w2)),
+				_mm_or_si128(_mm_cmpeq_epi8(block, w3),
+						_mm_cmpeq_epi8(block, w4)));
+		unsigned mask = (unsigned) _mm_movemask_epi8(match);
+		if (mask != 0)
+			return p + __builtin_ctz(mask);
+	}
+#endif
+	for (; p < end; p++) {
+		if (*p == c1 || *p == c2 || *p == c3 || *p == c4)
+			return p;
+	}
+	return end;
+}
+
+// Checks that a text is UTF-8 of the characters XML allows, as libxml2 would.
+// The blocks of printable ASCII are skipped by SSE2.
+static bool isValidText(const char* p, const char* end) {
+	while (p < end) {
+#if defined(__SSE2__)
+		// The bytes below 0x20 or from 0x80 compare as less, being signed.
+		const __m128i limit = _mm_set1_epi8(0x20);
+		for (; end - p >= 16; p += 16) {
+			__m128i block = _mm_loadu_si128((const __m128i*) p);
+			if (_mm_movemask_epi8(_mm_cmplt_epi8(block, limit)) != 0)
+				break;
+		}
+#endif
+		const char* stop = BFX_MIN(p + 16, end);
+		while (p < stop) {
+			unsigned char c = (unsigned char) *p;
+			if (c < 0x80) {
+				if (c < 0x20 && c != '\t' && c != '\n' && c != '\r')
+					return false;
+				p++;
+				continue;
+			}
+			int count;
+			uint32_t code;
+			if (c >= 0xc2 && c <= 0xdf) {
+				count = 1;
+				code = c & 0x1f;
+			} else if (c >= 0xe0 && c <= 0xef) {
+				count = 2;
+				code = c & 0x0f;
+			} else if (c >= 0xf0 && c <= 0xf4) {
+				count = 3;
+				code = c & 0x07;
+			} else {
+				return false;
+			}
+			if (end - p <= count)
+				return false;
+			for (int i = 1; i <= count; i++) {
+				if ((p[i] & 0xc0) != 0x80)
+					return false;
+				code = (code << 6) | (p[i] & 0x3f);
+			}
+			// Overlong, a surrogate, or beyond Unicode.
+			if ((count == 2 && code < 0x800)
+					|| (count == 3 && (code < 0x10000 || code > 0x10ffff))
+					|| (code >= 0xd800 && code <= 0xdfff) || code == 0xfffe
+					|| code == 0xffff)
+				return false;
+			p += count + 1;
+		}
+	}
+	return true;
+}
+
+static inline bool isSpace(char c) {
+	return (c == ' ' || c == '\t' || c == '\n' || c == '\r');
+}
+
+// Prefixes and non-ASCII names are beyond the subset, ':' isn't a name
+// character here.
+static inline bool isNameStart(char c) {
+	return ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_');
+}
+
+static inline bool isNameChar(char c) {
+	return (isNameStart(c) || (c >= '0' && c <= '9') || c == '-' || c == '.');
+}
+
+// Reads a whitespace, then given name with its quoted value, as in the XML
+// declaration. Returns the position past the value, or NULL.
+static const char* readPseudoAttribute(const char* p, const char* end,
+		const char* name, const char*& value, int& length) {
+	const char* spaces = p;
+	while (p < end && isSpace(*p))
+		p++;
+	int nameLength = strlen(name);
+	if (p == spaces || end - p < nameLength || memcmp(p, name, nameLength) != 0)
+		return NULL;
+	p += nameLength;
+	while (p < end && isSpace(*p))
+		p++;
+	if (p >= end || *p != '=')
+		return NULL;
+	p++;
+	while (p < end && isSpace(*p))
+		p++;
+	if (p >= end || (*p != '"' && *p != '\''))
+		return NULL;
+	const char* close = (const char*) memchr(p + 1, *p, end - p - 1);
+	if (close == NULL)
+		return NULL;
+	value = p + 1;
+	length = close - value;
+	return close + 1;
+}
+
+// Decodes the entity at p into out, sets the number of bytes decoded and
+// returns the length of the entity, or 0 if it isn't one of the predefined
+// or numeric ones.
+static int decodeEntity(const char* p, const char* end, char* out,
+		int& outLength) {
+	const char* semicolon = (const char*) memchr(p, ';',
+			BFX_MIN(end - p, 12));
+	if (semicolon == NULL)
+		return 0;
+	const char* name = p + 1;
+	int nameLength = semicolon - name;
+	int length = nameLength + 2;
+
+	outLength = 1;
+	if (nameLength == 2 && name[1] == 't'
+			&& (name[0] == 'l' || name[0] == 'g')) {
+		out[0] = (name[0] == 'l') ? '<' : '>';
+		return length;
+	}
+	if (nameLength == 3 && memcmp(name, "amp", 3) == 0) {
+		out[0] = '&';
+		return length;
+	}
+	if (nameLength == 4 && memcmp(name, "quot", 4) == 0) {
+		out[0] = '"';
+		return length;
+	}
+	if (nameLength == 4 && memcmp(name, "apos", 4) == 0) {
+		out[0] = '\'';
+		return length;
+	}
+	if (nameLength < 2 || name[0] != '#')
+		return 0;
+
+	bool hex = (name[1] == 'x');
+	const char* digit = name + (hex ? 2 : 1);
+	if (digit == semicolon)
+		return 0;
+	uint32_t code = 0;
+	for (; digit < semicolon; digit++) {
+		char c = *digit;
+		int value;
+		if (c >= '0' && c <= '9')
+			value = c - '0';
+		else if (hex && c >= 'a' && c <= 'f')
+			value = c - 'a' + 10;
+		else if (hex && c >= 'A' && c <= 'F')
+			value = c - 'A' + 10;
+		else
+			return 0;
+		code = code * (hex ? 16 : 10) + value;
+		if (code > 0x10ffff)
+			return 0;
+	}
+	// The characters XML allows.
+	if ((code < 0x20 && code != 0x9 && code != 0xa && code != 0xd)
+			|| (code >= 0xd800 && code <= 0xdfff) || code == 0xfffe
+			|| code == 0xffff)
+		return 0;
+
+	if (code < 0x80) {
+		out[0] = (char) code;
+	} else if (code < 0x800) {
+		out[0] = (char) (0xc0 | (code >> 6));
+		out[1] = (char) (0x80 | (code & 0x3f));
+		outLength = 2;
+	} else if (code < 0x10000) {
+		out[0] = (char) (0xe0 | (code >> 12));
+		out[1] = (char) (0x80 | ((code >> 6) & 0x3f));
+		out[2] = (char) (0x80 | (code & 0x3f));
+		outLength = 3;
+	} else {
+		out[0] = (char) (0xf0 | (code >> 18));
+		out[1] = (char) (0x80 | ((code >> 12) & 0x3f));
+		out[2] = (char) (0x80 | ((code >> 6) & 0x3f));
+		out[3] = (char) (0x80 | (code & 0x3f));
+		outLength = 4;
+	}
+	return length;
+}
+
+AWSXmlTokenizer::AWSXmlTokenizer() :
+		_data(NULL), _pos(NULL), _end(NULL), _offset(0), _length(0), _tagPending(
+				false), _emptyElement(false), _rootRead(false), _failed(true) {
+}
+
+AWSXmlTokenizer::~AWSXmlTokenizer() {
+}
+
+void AWSXmlTokenizer::reset(const char* data, int size) {
+	BFX_ASSERT(data != NULL || size == 0);
+
+	// The terminator ends the last text, if any.
+	_data = _buffer.getBuffer(size + 1);
+	memcpy(_data, data, size);
+	_data[size] = '\0';
+	_buffer.releaseBuffer(size + 1);
+	_pos = _data;
+	_end = _data + size;
+
+	_openElements.clear();
+	_offset = size;
+	_length = 0;
+	_tagPending = false;
+	_emptyElement = false;
+	_rootRead = false;
+	_failed = false;
+}
+
+AWSXmlTokenizer::TokenType AWSXmlTokenizer::next() {
+	if (_failed)
+		return UNSUPPORTED;
+	if (_emptyElement) {
+		// Ends by the name it started by.
+		_emptyElement = false;
+		_openElements.remove(_openElements.getSize() - 1);
+		return END_ELEMENT;
+	}
+
+	while (true) {
+		if (!_tagPending) {
+			if (_pos >= _end) {
+				if (!_rootRead || !_openElements.isEmpty())
+					return fail();
+				_offset = _end - _data;
+				_length = 0;
+				return END_OF_DOCUMENT;
+			}
+			if (*_pos != '<') {
+				bool inRoot = !_openElements.isEmpty();
+				TokenType type = readText(_pos);
+				if (type != TEXT || inRoot)
+					return type;
+				// Only whitespace is allowed around the root element.
+				for (int i = 0; i < _length; i++) {
+					if (!isSpace(_data[_offset + i]))
+						return fail();
+				}
+				continue;
+			}
+			_pos++;
+		}
+		_tagPending = false;
+		if (_pos < _end && *_pos == '?') {
+			if (!skipDeclaration())
+				return fail();
+			continue;
+		}
+		return readTag();
+	}
+}
+
+AWSXmlTokenizer::TokenType AWSXmlTokenizer::readText(char* start) {
+	// Decodes by moving the text down over the entities as they are read,
+	// the write position never passes the read one.
+	char* w = start;
+	char* p = start;
+	while (true) {
+		char* q = findAny(p, _end, '<', '>', '&', '\r');
+		if (w != p)
+			memmove(w, p, q - p);
+		w += q - p;
+		p = q;
+		if (p >= _end || *p == '<')
+			break;
+		if (*p == '>') {
+			// Ending a CDATA section which hasn't started.
+			if (w - start >= 2 && w[-1] == ']' && w[-2] == ']')
+				return fail();
+			*w++ = *p++;
+			continue;
+		}
+		if (*p == '\r') {
+			// CRLF and CR alone read as LF.
+			*w++ = '\n';
+			p++;
+			if (p < _end && *p == '\n')
+				p++;
+			continue;
+		}
+		char decoded[4];
+		int decodedLength;
+		int length = decodeEntity(p, _end, decoded, decodedLength);
+		if (length == 0)
+			return fail();
+		memcpy(w, decoded, decodedLength);
+		w += decodedLength;
+		p += length;
+	}
+
+	if (p < _end) {
+		// The terminator may overwrite the '<'.
+		_tagPending = true;
+		_pos = p + 1;
+	} else {
+		_pos = _end;
+	}
+	*w = '\0';
+	if (!isValidText(start, w))
+		return fail();
+	_offset = start - _data;
+	_length = w - start;
+	return TEXT;
+}
+
+AWSXmlTokenizer::TokenType AWSXmlTokenizer::readTag() {
+	char* p = _pos;
+	if (p >= _end)
+		return fail();
+	if (*p == '/')
+		return readEndTag();
+	// A comment, CDATA or DOCTYPE, or a second root.
+	if (!isNameStart(*p) || (_rootRead && _openElements.isEmpty()))
+		return fail();
+
+	char* name = p;
+	while (p < _end && isNameChar(*p))
+		p++;
+	char* nameEnd = p;
+	// Skips the attributes, e.g. xmlns.
+	while (true) {
+		char* spaces = p;
+		while (p < _end && isSpace(*p))
+			p++;
+		if (p >= _end)
+			return fail();
+		if (*p == '>')
+			break;
+		if (*p == '/') {
+			if (p + 1 >= _end || p[1] != '>')
+				return fail();
+			_emptyElement = true;
+			p++;
+			break;
+		}
+		if (p == spaces || !isNameStart(*p))
+			return fail();
+		while (p < _end && (isNameChar(*p) || *p == ':'))
+			p++;
+		while (p < _end && isSpace(*p))
+			p++;
+		if (p >= _end || *p != '=')
+			return fail();
+		p++;
+		while (p < _end && isSpace(*p))
+			p++;
+		if (p >= _end || (*p != '"' && *p != '\''))
+			return fail();
+		char* close = findAny(p + 1, _end, *p, '<', '&', *p);
+		if (close >= _end || *close != *p || !isValidText(p + 1, close))
+			return fail();
+		p = close + 1;
+	}
+
+	*nameEnd = '\0';
+	_pos = p + 1;
+	_rootRead = true;
+	_openElements.append((int) (name - _data));
+	_offset = name - _data;
+	_length = nameEnd - name;
+	return START_ELEMENT;
+}
+
+AWSXmlTokenizer::TokenType AWSXmlTokenizer::readEndTag() {
+	char* name = _pos + 1;
+	char* p = name;
+	while (p < _end && isNameChar(*p))
+		p++;
+	int length = p - name;
+	while (p < _end && isSpace(*p))
+		p++;
+	if (p >= _end || *p != '>' || _openElements.isEmpty())
+		return fail();
+
+	// The name of the start tag has been terminated already.
+	int start = _openElements[_openElements.getSize() - 1];
+	if (length == 0 || memcmp(_data + start, name, length) != 0
+			|| _data[start + length] != '\0')
+		return fail();
+	_openElements.remove(_openElements.getSize() - 1);
+	_pos = p + 1;
+	_offset = start;
+	_length = length;
+	return END_ELEMENT;
+}
+
+bool AWSXmlTokenizer::skipDeclaration() {
+	// Only the XML declaration, which can only come first.
+	if (_pos - 1 != _data || _end - _pos < 4 || memcmp(_pos, "?xml", 4) != 0)
+		return false;
+	const char* p = _pos + 4;
+	const char* value;
+	int length;
+	p = readPseudoAttribute(p, _end, "version", value, length);
+	if (p == NULL || length != 3 || memcmp(value, "1.0", 3) != 0)
+		return false;
+	const char* q = readPseudoAttribute(p, _end, "encoding", value, length);
+	if (q != NULL) {
+		if (length != 5 || strncasecmp(value, "UTF-8", 5) != 0)
+			return false;
+		p = q;
+	}
+	q = readPseudoAttribute(p, _end, "standalone", value, length);
+	if (q != NULL) {
+		if (!(length == 3 && memcmp(value, "yes", 3) == 0)
+				&& !(length == 2 && memcmp(value, "no", 2) == 0))
+			return false;
+		p = q;
+	}
+	while (p < _end && isSpace(*p))
+		p++;
+	if (_end - p < 2 || p[0] != '?' || p[1] != '>')
+		return false;
+	_pos = (char*) p + 2;
+	return true;
+}
@@ -0,0 +1,88 @@
+/*
+ * AWSXmlTokenizer.h
+ */
+
+#ifndef AWS_AWSXMLTOKENIZER_H_
+#define AWS_AWSXMLTOKENIZER_H_
+
+#include "../Foundation/Foundation.h"
+
+/// A pull tokenizer of the XML subset the AWS query protocol responds with:
+/// an optional UTF-8 declaration, then elements without namespace prefixes,
+/// attributes which are skipped, and text with the predefined and numeric
+/// entities. Anything else, e.g. a comment, CDATA, a DOCTYPE or an unknown
+/// entity, reads as UNSUPPORTED, for the caller to parse the document by
+/// libxml2 instead. So does a malformed document, as far as its tags and
+/// entities go, so that libxml2 reports the error.
+///
+/// The document is copied once into a buffer kept from one document to the
+/// next, and decoded there in place: the names and the texts the tokens
+/// point at are NUL-terminated, and the line ends of the texts normalized,
+/// as libxml2 would. The delimiters are scanned for by SSE2, or AVX2 if the
+/// compiler targets it, so that reading a document allocates nothing once
+/// the buffers have grown to its size.
+class AWSXmlTokenizer {
+public:
+	enum TokenType {
+		END_OF_DOCUMENT = 0,	/// The root element has been closed
+		START_ELEMENT,	/// The value is the name
+		END_ELEMENT,	/// The value is the name
+		TEXT,	/// The value is the decoded text, within the root element
+		UNSUPPORTED,	/// Beyond the subset, or malformed
+	};
+
+	AWSXmlTokenizer();
+	virtual ~AWSXmlTokenizer();
+
+	/// Starts reading a copy of given document.
+	void reset(const char* data, int size);
+	/// Reads the next token. Once END_OF_DOCUMENT or UNSUPPORTED has been
+	/// read, it is read again.
+	TokenType next();
+
+	/// Gets the value of the last token, NUL-terminated, which stays valid
+	/// until the next reset().
+	const char* getValue() const {
+		return _data + _offset;
+	}
+	int getLength() const {
+		return _length;
+	}
+	/// Gets the offset of the value of the last token within the decoded
+	/// document, see getData().
+	int getOffset() const {
+		return _offset;
+	}
+	const char* getData() const {
+		return _data;
+	}
+
+private:
+	TokenType readText(char* start);
+	TokenType readTag();
+	TokenType readEndTag();
+	bool skipDeclaration();
+	TokenType fail() {
+		_failed = true;
+		return UNSUPPORTED;
+	}
+
+	// The decoded copy of the document, and the position being read.
+	BufferT<char> _buffer;
+	char* _data;
+	char* _pos;
+	char* _end;
+	// The offsets of the names of the elements open.
+	BufferT<int> _openElements;
+	// The last token.
+	int _offset;
+	int _length;
+	// Whether the '<' at _pos - 1 has been overwritten by the end of a text.
+	bool _tagPending;
+	// Whether the element started last is empty, to be ended next.
+	bool _emptyElement;
+	bool _rootRead;
+	bool _failed;
+};
+
+#endif /* AWS_AWSXMLTOKENIZER_H_ */
@@ -94,6 +94,7 @@ HttpClient::HttpRequestContext::HttpRequestContext(HttpClient* client,
 	LOGT("Begin HTTP request context : %p.", this);
 
 	_headerFieldsEnded = false;
+	_interimResponse = false;
 	_client = client;
 	_request = request;
 
@@ -123,22 +124,38 @@ HttpClient::HttpRequestContext::HttpRequestContext(HttpClient* client,
 	//
 	if (request->getMethod() == HTTPM_Get) {
 		// Specify we want to GET data
+		curl_easy_setopt(_client->_curlCtx, CURLOPT_CUSTOMREQUEST, NULL);
 		curl_easy_setopt(_client->_curlCtx, CURLOPT_HTTPGET, 1L);
+	} else if (request->getMethod() == HTTPM_Delete) {
+		// A DELETE request has no body, same as a GET one.
+		curl_easy_setopt(_client->_curlCtx, CURLOPT_HTTPGET, 1L);
+		curl_easy_setopt(_client->_curlCtx, CURLOPT_CUSTOMREQUEST, "DELETE");
+	} else if (request->getMethod() == HTTPM_Head) {
+		// Skips the body the headers describe, the next GET or POST request
+		// of the handle resets it.
+		curl_easy_setopt(_client->_curlCtx, CURLOPT_CUSTOMREQUEST, NULL);
+		curl_easy_setopt(_client->_curlCtx, CURLOPT_NOBODY, 1L);
 	} else {
-		BFX_ASSERT(request->getMethod() == HTTPM_Post);
+		BFX_ASSERT(request->getMethod() == HTTPM_Post
+				|| request->getMethod() == HTTPM_Put);
 
-		// Specify we want to POST data
+		// Specify we want to POST data, a PUT request sends its body the same
+		// way, but overrides the method name.
 		curl_easy_setopt(_client->_curlCtx, CURLOPT_HTTPGET, 0L);
 		curl_easy_setopt(_client->_curlCtx, CURLOPT_POST, 1L);
+		curl_easy_setopt(_client->_curlCtx, CURLOPT_CUSTOMREQUEST,
+				(request->getMethod() == HTTPM_Put) ? "PUT" : NULL);
 
 		//
 		// Update post body
 		//
 		HttpPost* post = (HttpPost*) request;
-		BufferT<uint8_t>& data = post->getBody();
-		curl_easy_setopt(_client->_curlCtx, CURLOPT_POSTFIELDS, data.getRawData());
+		// NOTE A NULL body makes CURL read the body from stdin.
+		curl_easy_setopt(_client->_curlCtx, CURLOPT_POSTFIELDS,
+				(post->getBodySize() == 0) ?
+						(const void*) "" : (const void*) post->getBodyData());
 		curl_easy_setopt(_client->_curlCtx, CURLOPT_POSTFIELDSIZE,
-				(long ) data.getSize());
+				(long ) post->getBodySize());
 	}
 }
 
@@ -215,6 +232,11 @@ OnNewLine:
 		headerLine = headerLine.trim();
 		startPos = curPos;
 		if (headerLine.isEmpty()) {
+			if (_interimResponse) {
+				// The header fields of the final response follow.
+				_interimResponse = false;
+				continue;
+			}
 			// empty line meaning header fields ended;
 			_headerFieldsEnded = true;
 			return (curPos + 1);
@@ -233,6 +255,10 @@ void HttpClient::HttpRequestContext::parseHeaderLine(const String& headerLine) {
 	int pos = headerLine.indexOf(':');
 	if (pos <= 0) {
 		LOGT("STATUS_LINE=%s", (const char* ) headerLine);
+		// e.g. HTTP/1.1 100 Continue, sent before the body of a large PUT.
+		int codePos = headerLine.indexOf(' ');
+		_interimResponse = (codePos > 0 && codePos + 1 < headerLine.getLength()
+				&& headerLine[codePos + 1] == '1');
 		return;	// Status line, ignored.
 	}
 
@@ -28,6 +28,9 @@ enum HttpClientError {
 enum HttpMethod {
 	HTTPM_Get = 0, ///
 	HTTPM_Post = 1, ///
+	HTTPM_Put = 2, ///
+	HTTPM_Delete = 3, ///
+	HTTPM_Head = 4, ///
 };
 
 class HttpClient;
@@ -83,7 +86,8 @@ public:
 class HttpPost: public HttpRequest {
 public:
 	/// Initializes a new instance.
-	HttpPost() {
+	HttpPost() :
+			_externalBody(NULL), _externalBodySize(0) {
 	}
 	virtual ~HttpPost() {
 	}
@@ -96,9 +100,70 @@ public:
 	BufferT<uint8_t>& getBody() {
 		return _body;
 	}
+	/// Sends given region as the body instead, without copying it. The region
+	/// is not owned, and must stay valid until the request has been executed.
+	void setExternalBody(const uint8_t* data, int dataSize) {
+		BFX_ASSERT(data || dataSize == 0);
+		_externalBody = data;
+		_externalBodySize = dataSize;
+	}
+	/// Gets the data of the body to send, either region.
+	const uint8_t* getBodyData() const {
+		return _externalBody ? _externalBody : _body.getRawData();
+	}
+	int getBodySize() const {
+		return _externalBody ? _externalBodySize : _body.getSize();
+	}
 
 protected:
 	BufferT<uint8_t> _body;
+	const uint8_t* _externalBody;
+	int _externalBodySize;
+};
+
+/// The HTTP put request message
+class HttpPut: public HttpPost {
+public:
+	/// Initializes a new instance.
+	HttpPut() {
+	}
+	virtual ~HttpPut() {
+	}
+
+	/// Gets the HTTP method
+	virtual HttpMethod getMethod() const {
+		return HTTPM_Put;
+	}
+};
+
+/// The HTTP delete request message
+class HttpDelete: public HttpRequest {
+public:
+	/// Initializes a new instance.
+	HttpDelete() {
+	}
+	virtual ~HttpDelete() {
+	}
+
+	/// Gets the HTTP method
+	virtual HttpMethod getMethod() const {
+		return HTTPM_Delete;
+	}
+};
+
+/// The HTTP head request message, the response of which has no body
+class HttpHead: public HttpRequest {
+public:
+	/// Initializes a new instance.
+	HttpHead() {
+	}
+	virtual ~HttpHead() {
+	}
+
+	/// Gets the HTTP method
+	virtual HttpMethod getMethod() const {
+		return HTTPM_Head;
+	}
 };
 
 /// The HTTP response message from a client to a server includes.
@@ -187,6 +252,9 @@ protected:
 		HttpRequest* _request;
 		REF<HttpResponse> _response;
 		bool _headerFieldsEnded;
+		// Whether the header fields being read are of an interim response,
+		// e.g. 100 Continue, which the final one follows.
+		bool _interimResponse;
 	};
 
 private:
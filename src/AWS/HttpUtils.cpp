@@ -7,8 +7,6 @@
 
 #include "HttpUtils.h"
 #include "AWS.h"
-#include <openssl/bio.h>
-#include <openssl/evp.h>
 
 #define LOG_TAG "HttpUtils"
 
@@ -23,33 +21,24 @@ String HttpUtils::urlEncode(const String& value, bool path) {
 }
 
 bool HttpUtils::isAllowedUrlChar(int c) {
-	// RFC 2396 states:
-	// Data characters that are allowed in a URI but do not have a
-	// reserved purpose are called unreserved. These include upper
-	// and lower case letters, decimal digits, and a limited set of
-	// punctuation marks and symbols.
+	// RFC 3986 states:
+	// Characters that are allowed in a URI but do not have a reserved
+	// purpose are called unreserved. These include uppercase and lowercase
+	// letters, decimal digits, hyphen, period, underscore, and tilde.
 	//
-	// unreserved  = alphanum | mark
+	// unreserved  = ALPHA / DIGIT / "-" / "." / "_" / "~"
 	//
-	// mark        = "-" | "_" | "." | "!" | "~" | "*" | "'" | "(" | ")"
-	//
-	// Unreserved characters can be escaped without changing the
-	// semantics of the URI, but this should not be done unless the
-	// URI is being used in a context that does not allow the
-	// unescaped character to appear.
-	if (isalnum(c))
+	// AWS Signature Version 4 requires every other character to be escaped,
+	// including the marks that RFC 2396 used to leave alone, otherwise the
+	// canonical request doesn't match the one computed by the service.
+	if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9'))
 		return true;
 	else {
 		switch (c) {
 		case '-':
 		case '_':
 		case '.':
-		case '!':
 		case '~':
-		case '*':
-		case '\'':
-		case '(':
-		case ')':
 			return true;
 		}
 	}
@@ -79,6 +68,42 @@ String HttpUtils::urlEncode(const String& value) {
 	return result;
 }
 
+static int hexValue(char c) {
+	if (c >= '0' && c <= '9')
+		return c - '0';
+	if (c >= 'a' && c <= 'f')
+		return c - 'a' + 10;
+	if (c >= 'A' && c <= 'F')
+		return c - 'A' + 10;
+	return -1;
+}
+
+int HttpUtils::urlDecode(char* text, int length) {
+	int decoded = 0;
+	for (int i = 0; i < length; i++) {
+		char c = text[i];
+		if (c == '+') {
+			c = ' ';
+		} else if (c == '%' && i + 2 < length && hexValue(text[i + 1]) >= 0
+				&& hexValue(text[i + 2]) >= 0) {
+			c = (char) (hexValue(text[i + 1]) * 16 + hexValue(text[i + 2]));
+			i += 2;
+		}
+		text[decoded++] = c;
+	}
+	return decoded;
+}
+
+String HttpUtils::urlDecode(const String& value) {
+	if (value.isEmpty())
+		return value;
+
+	BufferT<char> buffer(value.cstr(), value.getLength());
+	int length = urlDecode(buffer.getBuffer(buffer.getSize()),
+			buffer.getSize());
+	return String(buffer.getRawData(), length);
+}
+
 String HttpUtils::appendUri(const String& baseUri, const String& path,
 		bool escapeDoubleSlash) {
 	String resultUri = baseUri;
@@ -121,24 +146,47 @@ String HttpUtils::encodeParameters(const AWSStringMap* params) {
 	return result;
 }
 
+// The alphabet of base64, and the value of each character of it, or -1.
+static const char __base64Chars[] =
+		"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+static int8_t __base64Values[256];
+
+static bool initBase64Values() {
+	memset(__base64Values, -1, sizeof(__base64Values));
+	for (int i = 0; i < 64; i++)
+		__base64Values[(uint8_t) __base64Chars[i]] = (int8_t) i;
+	return true;
+}
+static bool __base64ValuesInitialized = initBase64Values();
+
 String HttpUtils::base64Encode(const uint8_t* inBuf, int inBufSize) {
 	if (inBuf == NULL || inBufSize == 0)
 		return String();
 
-	// initialization for base64 encoding stuff
-	BIO* bmem = BIO_new(BIO_s_mem());
-	BIO* b64 = BIO_new(BIO_f_base64());
-	BIO_set_flags(b64, BIO_FLAGS_BASE64_NO_NL);
-	bmem = BIO_push(b64, bmem);
-
-	BIO_write(bmem, inBuf, inBufSize);
-	inBufSize = BIO_flush(bmem);
-
-	char* outBuf;
-	int outBufSize = BIO_get_mem_data(bmem, &outBuf);
+	// Encodes by table, three bytes into four characters at a time.
+	int outBufSize = (inBufSize + 2) / 3 * 4;
+	char* outBuf = new char[outBufSize];
+	char* out = outBuf;
+	int i = 0;
+	for (; i + 3 <= inBufSize; i += 3) {
+		uint32_t bits = (inBuf[i] << 16) | (inBuf[i + 1] << 8) | inBuf[i + 2];
+		out[0] = __base64Chars[bits >> 18];
+		out[1] = __base64Chars[(bits >> 12) & 0x3f];
+		out[2] = __base64Chars[(bits >> 6) & 0x3f];
+		out[3] = __base64Chars[bits & 0x3f];
+		out += 4;
+	}
+	if (i < inBufSize) {
+		uint32_t bits = inBuf[i] << 16;
+		if (i + 1 < inBufSize)
+			bits |= inBuf[i + 1] << 8;
+		out[0] = __base64Chars[bits >> 18];
+		out[1] = __base64Chars[(bits >> 12) & 0x3f];
+		out[2] = (i + 1 < inBufSize) ? __base64Chars[(bits >> 6) & 0x3f] : '=';
+		out[3] = '=';
+	}
 	String result(outBuf, outBufSize);
-
-	BIO_free_all(bmem);
+	delete[] outBuf;
 
 	return result;
 }
@@ -147,31 +195,54 @@ SharedBufferT<uint8_t> HttpUtils::base64Decode(const String& str) {
 	if (str.isEmpty())
 		return SharedBufferT<uint8_t>();
 
-	BIO *bio, *b64;
-	const int inbufsize = 1024;
-	uint8_t inbuf[inbufsize];
-	int inlen;
-
-	b64 = BIO_new(BIO_f_base64());
-	BIO_set_flags(b64, BIO_FLAGS_BASE64_NO_NL);
-	bio = BIO_new_mem_buf((void*)str.cstr(), str.getLength());
-	bio = BIO_push(b64, bio);
-
-	SharedBufferT<uint8_t> result(str.getLength());
-	while((inlen = BIO_read(bio, inbuf, inbufsize)) > 0) {
-		result.append(inbuf, inlen);
+	SharedBufferT<uint8_t> result(str.getLength() / 4 * 3 + 3);
+	uint8_t outBuf[768];
+	int outLength = 0;
+	uint32_t bits = 0;
+	int numBits = 0;
+	const char* in = str.cstr();
+	for (int i = 0; i < str.getLength(); i++) {
+		int value = __base64Values[(uint8_t) in[i]];
+		if (value == -1) {
+			if (in[i] == '=')
+				break;
+			if (isspace((uint8_t) in[i]))
+				continue;
+			LOGW("Invalid base64 character '%c'.", in[i]);
+			return SharedBufferT<uint8_t>();
+		}
+		bits = (bits << 6) | value;
+		numBits += 6;
+		if (numBits >= 8) {
+			numBits -= 8;
+			outBuf[outLength++] = (uint8_t) (bits >> numBits);
+			if (outLength == (int) sizeof(outBuf)) {
+				result.append(outBuf, outLength);
+				outLength = 0;
+			}
+		}
 	}
-	BIO_free_all(bio);
+	result.append(outBuf, outLength);
 
 	return result;
 }
 
 String HttpUtils::toHexString(const uint8_t* inBuf, int inBufSize) {
-	String result; // capacity = inBufSize * 2
+	static const char digits[] = "0123456789abcdef";
 
-	for (int i = 0; i < inBufSize; i++) {
-		String hex = String::format("%02x", inBuf[i]);
-		result.append(hex);
+	String result;
+	if (inBufSize <= 0)
+		return result;
+
+	char buf[129];
+	for (int i = 0; i < inBufSize;) {
+		int n = 0;
+		for (; i < inBufSize && n < (int) sizeof(buf) - 1; i++) {
+			buf[n++] = digits[inBuf[i] >> 4];
+			buf[n++] = digits[inBuf[i] & 0xf];
+		}
+		buf[n] = '\0';
+		result.append(buf, n);
 	}
 
 	return result;
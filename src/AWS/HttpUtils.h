@@ -20,6 +20,10 @@ private:
 public:
 	static String urlEncode(const String& value, bool path);
 	static String urlEncode(const String& value);
+	/// Decodes the escapes, and the pluses as spaces, in place. Returns the
+	/// length decoded, which is never longer.
+	static int urlDecode(char* text, int length);
+	static String urlDecode(const String& value);
 
 	static String appendUri(const String& baseUri, const String& path,
 			bool escapeDoubleSlash);
@@ -7,13 +7,418 @@
 
 #include "AWS.h"
 
+#define LOG_TAG "S3Client"
+
+S3Client::S3Client(const String& accessKeyId, const String& secretAccessKey,
+		AWSRegion* region) :
+		AWSClient("s3", new AWSCredentials(accessKeyId, secretAccessKey),
+				region) {
+	// Initializes the first web client, and the HTTP library by the way.
+	REF<AWSHttpClient> webClient = new AWSHttpClient();
+	releaseWebClient(webClient);
+}
+
 S3Client::S3Client(AWSCredentials* credentials, AWSRegion* region) :
 		AWSClient("s3", credentials, region) {
-	// TODO Auto-generated constructor stub
+	// Initializes the first web client, and the HTTP library by the way.
+	REF<AWSHttpClient> webClient = new AWSHttpClient();
+	releaseWebClient(webClient);
+}
 
+S3Client::S3Client(AWSCredentialsProvider* credentialsProvider,
+		AWSRegion* region) :
+		AWSClient("s3", credentialsProvider, region) {
+	// Initializes the first web client, and the HTTP library by the way.
+	REF<AWSHttpClient> webClient = new AWSHttpClient();
+	releaseWebClient(webClient);
 }
 
 S3Client::~S3Client() {
-	// TODO Auto-generated destructor stub
 }
 
+S3PutObjectResult* S3Client::putObject(const String& bucketName,
+		const String& key, const uint8_t* data, int dataSize) {
+	REF<S3PutObjectParams> params = new S3PutObjectParams(bucketName, key);
+	params->setContent(SharedBufferT<uint8_t>(data, dataSize));
+	return putObject(params);
+}
+
+S3PutObjectResult* S3Client::putObject(const S3PutObjectParams* params) {
+	BFX_ASSERT(params);
+	AWSHttpRequest* request = S3PutObjectParamsMarshaller().marshall(params);
+	if (request == NULL) {
+		_lastError = AWSE_InvalidArguments;
+		LOGE("Failed to initialize request, invalid argument(s).");
+		return NULL;
+	}
+
+	AWSHttpResponse* response = invoke(request);
+	if (response == NULL) {
+		return NULL;	// NOTE The error code already been set.
+	}
+
+	S3PutObjectResult* result = S3PutObjectResultUnmarshaller().unmarshall(
+			response);
+	if (result == NULL) {
+		_lastError = AWSE_ParseXMLFailed;
+		LOGE("Error occurs during parse response body.");
+	}
+
+	return result;
+}
+
+S3PutObjectResult* S3Client::putObjectFromFile(const String& bucketName,
+		const String& key, const String& fileName, const String& contentType) {
+	REF<S3MappedFile> mappedFile = new S3MappedFile(fileName);
+	if (!mappedFile->isOpen()) {
+		_lastError = AWSE_IOFailed;
+		return NULL;
+	}
+	REF<S3PutObjectParams> params = new S3PutObjectParams(bucketName, key);
+	params->setMappedFile(mappedFile);
+	params->setContentType(contentType);
+	return putObject(params);
+}
+
+S3GetObjectResult* S3Client::getObject(const String& bucketName,
+		const String& key) {
+	REF<S3GetObjectParams> params = new S3GetObjectParams(bucketName, key);
+	return getObject(params);
+}
+
+S3GetObjectResult* S3Client::getObject(const S3GetObjectParams* params) {
+	BFX_ASSERT(params);
+	AWSHttpRequest* request = S3GetObjectParamsMarshaller().marshall(params);
+	if (request == NULL) {
+		_lastError = AWSE_InvalidArguments;
+		LOGE("Failed to initialize request, invalid argument(s).");
+		return NULL;
+	}
+
+	AWSHttpResponse* response = invoke(request);
+	if (response == NULL) {
+		return NULL;	// NOTE The error code already been set.
+	}
+
+	S3GetObjectResult* result = S3GetObjectResultUnmarshaller().unmarshall(
+			response);
+	if (result == NULL) {
+		_lastError = AWSE_ParseXMLFailed;
+		LOGE("Error occurs during parse response body.");
+	}
+
+	return result;
+}
+
+S3HeadObjectResult* S3Client::headObject(const String& bucketName,
+		const String& key) {
+	REF<S3HeadObjectParams> params = new S3HeadObjectParams(bucketName, key);
+	return headObject(params);
+}
+
+S3HeadObjectResult* S3Client::headObject(const S3HeadObjectParams* params) {
+	BFX_ASSERT(params);
+	AWSHttpRequest* request = S3HeadObjectParamsMarshaller().marshall(params);
+	if (request == NULL) {
+		_lastError = AWSE_InvalidArguments;
+		LOGE("Failed to initialize request, invalid argument(s).");
+		return NULL;
+	}
+
+	AWSHttpResponse* response = invoke(request);
+	if (response == NULL) {
+		return NULL;	// NOTE The error code already been set.
+	}
+
+	return S3HeadObjectResultUnmarshaller().unmarshall(response);
+}
+
+S3DownloadResult* S3Client::downloadParallel(const String& bucketName,
+		const String& key, S3DownloadSink* sink) {
+	REF<S3DownloadParams> params = new S3DownloadParams(bucketName, key);
+	return downloadParallel(params, sink);
+}
+
+S3DownloadResult* S3Client::downloadParallel(const S3DownloadParams* params,
+		S3DownloadSink* sink, const S3DownloadResult* resumeFrom) {
+	BFX_ASSERT(params);
+	BFX_ASSERT(sink);
+	REF<S3ParallelDownloader> downloader = new S3ParallelDownloader(this,
+			params, sink);
+	return downloader->download(resumeFrom);
+}
+
+S3CreateMultipartUploadResult* S3Client::createMultipartUpload(
+		const S3CreateMultipartUploadParams* params) {
+	BFX_ASSERT(params);
+	AWSHttpRequest* request =
+			S3CreateMultipartUploadParamsMarshaller().marshall(params);
+	if (request == NULL) {
+		_lastError = AWSE_InvalidArguments;
+		LOGE("Failed to initialize request, invalid argument(s).");
+		return NULL;
+	}
+
+	AWSHttpResponse* response = invoke(request);
+	if (response == NULL) {
+		return NULL;	// NOTE The error code already been set.
+	}
+
+	return S3CreateMultipartUploadResultUnmarshaller().unmarshall(response);
+}
+
+S3UploadPartResult* S3Client::uploadPart(const S3UploadPartParams* params) {
+	BFX_ASSERT(params);
+	AWSHttpRequest* request = S3UploadPartParamsMarshaller().marshall(params);
+	if (request == NULL) {
+		_lastError = AWSE_InvalidArguments;
+		LOGE("Failed to initialize request, invalid argument(s).");
+		return NULL;
+	}
+
+	AWSHttpResponse* response = invoke(request);
+	if (response == NULL) {
+		return NULL;	// NOTE The error code already been set.
+	}
+
+	return S3UploadPartResultUnmarshaller().unmarshall(response);
+}
+
+S3CompleteMultipartUploadResult* S3Client::completeMultipartUpload(
+		const S3CompleteMultipartUploadParams* params) {
+	BFX_ASSERT(params);
+	AWSHttpRequest* request =
+			S3CompleteMultipartUploadParamsMarshaller().marshall(params);
+	if (request == NULL) {
+		_lastError = AWSE_InvalidArguments;
+		LOGE("Failed to initialize request, invalid argument(s).");
+		return NULL;
+	}
+
+	AWSHttpResponse* response = invoke(request);
+	if (response == NULL) {
+		return NULL;	// NOTE The error code already been set.
+	}
+
+	return S3CompleteMultipartUploadResultUnmarshaller().unmarshall(response);
+}
+
+S3AbortMultipartUploadResult* S3Client::abortMultipartUpload(
+		const S3AbortMultipartUploadParams* params) {
+	BFX_ASSERT(params);
+	AWSHttpRequest* request =
+			S3AbortMultipartUploadParamsMarshaller().marshall(params);
+	if (request == NULL) {
+		_lastError = AWSE_InvalidArguments;
+		LOGE("Failed to initialize request, invalid argument(s).");
+		return NULL;
+	}
+
+	AWSHttpResponse* response = invoke(request);
+	if (response == NULL) {
+		return NULL;	// NOTE The error code already been set.
+	}
+
+	return S3AbortMultipartUploadResultUnmarshaller().unmarshall(response);
+}
+
+S3UploadResult* S3Client::uploadMultipart(const String& bucketName,
+		const String& key, S3UploadSource* source) {
+	REF<S3UploadParams> params = new S3UploadParams(bucketName, key);
+	return uploadMultipart(params, source);
+}
+
+S3UploadResult* S3Client::uploadMultipart(const S3UploadParams* params,
+		S3UploadSource* source) {
+	BFX_ASSERT(params);
+	BFX_ASSERT(source);
+	REF<S3MultipartUploader> uploader = new S3MultipartUploader(this, params,
+			source);
+	return uploader->upload();
+}
+
+S3DeleteObjectResult* S3Client::deleteObject(const String& bucketName,
+		const String& key) {
+	REF<S3DeleteObjectParams> params = new S3DeleteObjectParams(bucketName,
+			key);
+	return deleteObject(params);
+}
+
+S3DeleteObjectResult* S3Client::deleteObject(
+		const S3DeleteObjectParams* params) {
+	BFX_ASSERT(params);
+	AWSHttpRequest* request = S3DeleteObjectParamsMarshaller().marshall(params);
+	if (request == NULL) {
+		_lastError = AWSE_InvalidArguments;
+		LOGE("Failed to initialize request, invalid argument(s).");
+		return NULL;
+	}
+
+	AWSHttpResponse* response = invoke(request);
+	if (response == NULL) {
+		return NULL;	// NOTE The error code already been set.
+	}
+
+	S3DeleteObjectResult* result = S3DeleteObjectResultUnmarshaller().unmarshall(
+			response);
+	if (result == NULL) {
+		_lastError = AWSE_ParseXMLFailed;
+		LOGE("Error occurs during parse response body.");
+	}
+
+	return result;
+}
+
+S3DeleteObjectsResult* S3Client::deleteObjects(
+		const S3DeleteObjectsParams* params) {
+	BFX_ASSERT(params);
+	AWSHttpRequest* request = S3DeleteObjectsParamsMarshaller().marshall(
+			params);
+	if (request == NULL) {
+		_lastError = AWSE_InvalidArguments;
+		LOGE("Failed to initialize request, invalid argument(s).");
+		return NULL;
+	}
+
+	AWSHttpResponse* response = invoke(request);
+	if (response == NULL) {
+		return NULL;	// NOTE The error code already been set.
+	}
+
+	S3DeleteObjectsResult* result =
+			S3DeleteObjectsResultUnmarshaller().unmarshall(response);
+	if (result == NULL) {
+		_lastError = AWSE_ParseXMLFailed;
+		LOGE("Error occurs during parse response body.");
+	}
+
+	return result;
+}
+
+S3DeletePrefixResult* S3Client::deletePrefix(const String& bucketName,
+		const String& prefix) {
+	REF<S3DeletePrefixParams> params = new S3DeletePrefixParams(bucketName,
+			prefix);
+	return deletePrefix(params);
+}
+
+S3DeletePrefixResult* S3Client::deletePrefix(
+		const S3DeletePrefixParams* params) {
+	BFX_ASSERT(params);
+	REF<S3PrefixDeleter> deleter = new S3PrefixDeleter(this, params);
+	return deleter->deletePrefix();
+}
+
+S3ListObjectsV2Result* S3Client::listObjectsV2(const String& bucketName,
+		const String& prefix) {
+	REF<S3ListObjectsV2Params> params = new S3ListObjectsV2Params(bucketName);
+	params->setPrefix(prefix);
+	return listObjectsV2(params);
+}
+
+S3ListObjectsV2Result* S3Client::listObjectsV2(
+		const S3ListObjectsV2Params* params) {
+	BFX_ASSERT(params);
+	AWSHttpRequest* request = S3ListObjectsV2ParamsMarshaller().marshall(
+			params);
+	if (request == NULL) {
+		_lastError = AWSE_InvalidArguments;
+		LOGE("Failed to initialize request, invalid argument(s).");
+		return NULL;
+	}
+
+	AWSHttpResponse* response = invoke(request);
+	if (response == NULL) {
+		return NULL;	// NOTE The error code already been set.
+	}
+
+	S3ListObjectsV2Result* result =
+			S3ListObjectsV2ResultUnmarshaller().unmarshall(response);
+	if (result == NULL) {
+		_lastError = AWSE_ParseXMLFailed;
+		LOGE("Error occurs during parse response body.");
+	}
+
+	return result;
+}
+
+String S3Client::presignGetObject(const String& bucketName,
+		const String& key, int expiresSeconds) {
+	String url;
+	if (!presignGetObjects(bucketName, &key, 1, expiresSeconds, &url))
+		return String();
+	return url;
+}
+
+bool S3Client::presignGetObjects(const String& bucketName, const String* keys,
+		int count, int expiresSeconds, String* urls) {
+	BFX_ASSERT(keys || count == 0);
+	BFX_ASSERT(urls || count == 0);
+
+	if (bucketName.isEmpty()) {
+		_lastError = AWSE_InvalidArguments;
+		LOGE("Failed to presign URLs, invalid argument(s).");
+		return false;
+	}
+
+	// Path-style resource paths, same as the requests.
+	ArrayListT<String> resourcePaths;
+	for (int i = 0; i < count; i++) {
+		String resourcePath = "/" + bucketName;
+		resourcePath.append('/');
+		resourcePath.append(keys[i]);
+		resourcePaths.add(resourcePath);
+	}
+	const String* paths = (count > 0) ? &resourcePaths[0] : NULL;
+	if (!_signer->presign(getEndpoint(), paths, count, expiresSeconds,
+			getCredentials(), urls)) {
+		_lastError = AWSE_SignFailed;
+		LOGE("Failed to presign URLs.");
+		return false;
+	}
+	return true;
+}
+
+AWSHttpResponse* S3Client::invoke(AWSHttpRequest* request) {
+	request->setEndpoint(getEndpoint());
+	if (request->getPayloadSigningMode() == APSM_Default) {
+		request->setPayloadSigningMode(_payloadSigningMode);
+	}
+	// Keeps the credentials alive during retries, even if they are rotated.
+	REF<AWSCredentials> credentials = getCredentials();
+	REF<AWSHttpClient> webClient = acquireWebClient();
+	webClient->setCredentials(credentials);
+	webClient->setSigner(_signer);
+	AWSHttpResponse* response = webClient->execute(request);
+	if (response == NULL) {
+		_lastError = webClient->getLastError();
+		LOGE("Failed to send request.");
+		releaseWebClient(webClient);
+		return NULL;
+	}
+	releaseWebClient(webClient);
+
+	return response;
+}
+
+AWSHttpClient* S3Client::acquireWebClient() {
+	MutexHolder holder(&_webClientsLock);
+
+	int count = _idleWebClients.getSize();
+	if (count == 0) {
+		REF<AWSHttpClient> webClient = new AWSHttpClient();
+		webClient->autorelease();
+		return webClient;
+	}
+	REF<AWSHttpClient> webClient = _idleWebClients[count - 1];
+	_idleWebClients.removeAt(count - 1);
+	webClient->autorelease();
+	return webClient;
+}
+
+void S3Client::releaseWebClient(AWSHttpClient* webClient) {
+	BFX_ASSERT(webClient);
+
+	MutexHolder holder(&_webClientsLock);
+	_idleWebClients.add(webClient);
+}
@@ -8,10 +8,127 @@
 #ifndef AWS_S3CLIENT_H_
 #define AWS_S3CLIENT_H_
 
+#include "AWSHttpClient.h"
+
+/// Providers a client for accessing S3 service
+/// Refer to:
+/// http://docs.aws.amazon.com/AmazonS3/latest/API/APIRest.html
 class S3Client: public AWSClient {
 public:
+	/// Creates a new instance by using given access key id, secret key and region
+	S3Client(const String& accessKeyId, const String& secretAccessKey,
+			AWSRegion* region);
+	/// Creates a new instance by using given credentials and region
 	S3Client(AWSCredentials* credentials, AWSRegion* region);
+	/// Creates a new instance by using given credentials provider and region
+	S3Client(AWSCredentialsProvider* credentialsProvider, AWSRegion* region);
 	virtual ~S3Client();
+
+	/// Adds an object to a bucket.
+	S3PutObjectResult* putObject(const String& bucketName, const String& key,
+			const uint8_t* data, int dataSize);
+	S3PutObjectResult* putObject(const S3PutObjectParams* params);
+	/// Adds an object to a bucket from a file, which is mapped into memory
+	/// and sent from there, hashed and sent without being copied. Suits
+	/// files up to a few hundred megabytes, see uploadMultipart() for larger
+	/// ones. Returns NULL if the file couldn't be mapped.
+	S3PutObjectResult* putObjectFromFile(const String& bucketName,
+			const String& key, const String& fileName,
+			const String& contentType = String());
+
+	/// Retrieves an object from a bucket.
+	S3GetObjectResult* getObject(const String& bucketName, const String& key);
+	S3GetObjectResult* getObject(const S3GetObjectParams* params);
+
+	/// Retrieves the size, type and entity tag of an object, without its
+	/// data.
+	S3HeadObjectResult* headObject(const String& bucketName,
+			const String& key);
+	S3HeadObjectResult* headObject(const S3HeadObjectParams* params);
+
+	/// Downloads a large object by ranged GETs of its parts, fetched at once
+	/// and written at their offsets into given sink. Returns NULL if the
+	/// object couldn't be looked up or the sink couldn't be opened, otherwise
+	/// a result telling whether the download is complete, and if not which
+	/// parts to resume from. See S3ParallelDownloader.
+	S3DownloadResult* downloadParallel(const String& bucketName,
+			const String& key, S3DownloadSink* sink);
+	S3DownloadResult* downloadParallel(const S3DownloadParams* params,
+			S3DownloadSink* sink, const S3DownloadResult* resumeFrom = NULL);
+
+	/// Starts a multipart upload, whose ID the parts are sent with.
+	S3CreateMultipartUploadResult* createMultipartUpload(
+			const S3CreateMultipartUploadParams* params);
+	/// Sends a part of a multipart upload.
+	S3UploadPartResult* uploadPart(const S3UploadPartParams* params);
+	/// Assembles the parts sent into the object.
+	S3CompleteMultipartUploadResult* completeMultipartUpload(
+			const S3CompleteMultipartUploadParams* params);
+	/// Discards a multipart upload and the parts sent.
+	S3AbortMultipartUploadResult* abortMultipartUpload(
+			const S3AbortMultipartUploadParams* params);
+
+	/// Uploads a large object from given source, read once into a bounded
+	/// pool of part buffers, by the parts of a multipart upload sent at once.
+	/// Returns NULL if the source couldn't be read or the upload couldn't be
+	/// sent, otherwise a result telling the error of S3 if any. A failed
+	/// upload is aborted. See S3MultipartUploader.
+	S3UploadResult* uploadMultipart(const String& bucketName,
+			const String& key, S3UploadSource* source);
+	S3UploadResult* uploadMultipart(const S3UploadParams* params,
+			S3UploadSource* source);
+
+	/// Removes an object from a bucket. Deleting an object which doesn't
+	/// exist succeeds as well.
+	S3DeleteObjectResult* deleteObject(const String& bucketName,
+			const String& key);
+	S3DeleteObjectResult* deleteObject(const S3DeleteObjectParams* params);
+	/// Removes up to 1000 objects of a bucket by one request. The result
+	/// tells the keys S3 failed to delete, along with the deleted ones unless
+	/// the request is quiet.
+	S3DeleteObjectsResult* deleteObjects(const S3DeleteObjectsParams* params);
+	/// Removes all the objects whose keys start with given prefix, by batches
+	/// deleted at once while the keys are being listed. Returns NULL if a
+	/// request couldn't be sent, otherwise a result telling the number of
+	/// objects deleted and the keys failed. See S3PrefixDeleter.
+	S3DeletePrefixResult* deletePrefix(const String& bucketName,
+			const String& prefix);
+	S3DeletePrefixResult* deletePrefix(const S3DeletePrefixParams* params);
+
+	/// Lists a page of the objects of a bucket, up to 1000 of them. See
+	/// S3ListObjectsV2Paginator to list them all.
+	S3ListObjectsV2Result* listObjectsV2(const String& bucketName,
+			const String& prefix = String());
+	S3ListObjectsV2Result* listObjectsV2(const S3ListObjectsV2Params* params);
+
+	/// Creates a presigned URL, which grants GET access to an object for given
+	/// seconds without any further credentials. Returns an empty string on
+	/// failure.
+	String presignGetObject(const String& bucketName, const String& key,
+			int expiresSeconds);
+	/// Creates presigned URLs for many objects of a bucket at once, the URLs
+	/// are stored into the given array, which must hold count elements.
+	bool presignGetObjects(const String& bucketName, const String* keys,
+			int count, int expiresSeconds, String* urls);
+
+protected:
+	friend class S3ListObjectsV2Paginator;
+	friend class S3ParallelDownloader;
+	friend class S3MultipartUploader;
+	friend class S3PrefixDeleter;
+
+	// Invokes a request and returns a response. Requests may be invoked by
+	// many threads at once, each one uses a web client of its own.
+	AWSHttpResponse* invoke(AWSHttpRequest* request);
+
+private:
+	// Takes an idle web client, or creates a new one.
+	AWSHttpClient* acquireWebClient();
+	// Returns a web client to the idle ones.
+	void releaseWebClient(AWSHttpClient* webClient);
+
+	ArrayListT<REF<AWSHttpClient> > _idleWebClients;
+	Mutex _webClientsLock;
 };
 
 #endif /* AWS_S3CLIENT_H_ */
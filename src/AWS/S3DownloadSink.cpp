@@ -0,0 +1,89 @@
+/*
+ * S3DownloadSink.cpp
+ */
+
+#include "AWS.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+#define LOG_TAG "S3DownloadSink"
+
+S3FileDownloadSink::S3FileDownloadSink(const String& fileName) :
+		_fd(-1) {
+	BFX_ASSERT(!fileName.isEmpty());
+	_fileName = fileName;
+}
+
+S3FileDownloadSink::~S3FileDownloadSink() {
+	if (_fd >= 0)
+		::close(_fd);
+}
+
+bool S3FileDownloadSink::open(int64_t size) {
+	if (_fd < 0) {
+		// Not truncated, the parts written before are kept for a resume.
+		_fd = ::open(_fileName, O_WRONLY | O_CREAT, 0644);
+		if (_fd < 0) {
+			LOGE("Unable to open '%s': %s", _fileName.cstr(), strerror(errno));
+			return false;
+		}
+	}
+	if (ftruncate(_fd, (off_t) size) != 0) {
+		LOGE("Unable to size '%s': %s", _fileName.cstr(), strerror(errno));
+		return false;
+	}
+	return true;
+}
+
+bool S3FileDownloadSink::write(int64_t offset, const uint8_t* data,
+		int size) {
+	BFX_ASSERT(_fd >= 0);
+
+	while (size > 0) {
+		ssize_t written = pwrite(_fd, data, size, (off_t) offset);
+		if (written < 0) {
+			if (errno == EINTR)
+				continue;
+			LOGE("Unable to write '%s': %s", _fileName.cstr(),
+					strerror(errno));
+			return false;
+		}
+		data += written;
+		offset += written;
+		size -= (int) written;
+	}
+	return true;
+}
+
+bool S3FileDownloadSink::close() {
+	if (_fd < 0)
+		return true;
+
+	bool synced = (fsync(_fd) == 0);
+	if (!synced)
+		LOGE("Unable to flush '%s': %s", _fileName.cstr(), strerror(errno));
+	::close(_fd);
+	_fd = -1;
+	return synced;
+}
+
+bool S3MemoryDownloadSink::open(int64_t size) {
+	if (size > _regionSize) {
+		LOGE("The region of %lld bytes can't hold %lld.",
+				(long long) _regionSize, (long long) size);
+		return false;
+	}
+	_size = size;
+	return true;
+}
+
+bool S3MemoryDownloadSink::write(int64_t offset, const uint8_t* data,
+		int size) {
+	BFX_ASSERT(offset >= 0 && offset + size <= _size);
+
+	memcpy(_region + offset, data, size);
+	return true;
+}
@@ -0,0 +1,63 @@
+/*
+ * S3DownloadSink.h
+ */
+
+#ifndef AWS_S3DOWNLOADSINK_H_
+#define AWS_S3DOWNLOADSINK_H_
+
+/// Receives the parts of an object downloaded by S3Client::downloadParallel(),
+/// each one written at its offset as it arrives, by many threads at once.
+class S3DownloadSink: public REFObject {
+public:
+	virtual ~S3DownloadSink() {
+	}
+
+	/// Prepares for an object of given size, keeping the parts written before
+	/// so that a download can be resumed.
+	virtual bool open(int64_t size) = 0;
+	/// Writes a part at its offset, may be called by many threads at once.
+	virtual bool write(int64_t offset, const uint8_t* data, int size) = 0;
+	/// Completes the object once all the parts have been written.
+	virtual bool close() {
+		return true;
+	}
+};
+
+/// Writes the parts into a file by pwrite(), which needs no lock between the
+/// threads. The file is created if it doesn't exist, and sized to the object
+/// up front.
+class S3FileDownloadSink: public S3DownloadSink {
+public:
+	S3FileDownloadSink(const String& fileName);
+	virtual ~S3FileDownloadSink();
+
+	virtual bool open(int64_t size);
+	virtual bool write(int64_t offset, const uint8_t* data, int size);
+	/// Flushes the file to disk and closes it.
+	virtual bool close();
+
+private:
+	String _fileName;
+	int _fd;
+};
+
+/// Copies the parts into a memory region, e.g. a file mapped by mmap(), which
+/// must be as large as the object.
+class S3MemoryDownloadSink: public S3DownloadSink {
+public:
+	/// The region is neither copied nor released.
+	S3MemoryDownloadSink(uint8_t* region, int64_t regionSize) :
+			_region(region), _regionSize(regionSize), _size(0) {
+		BFX_ASSERT(region || regionSize == 0);
+	}
+
+	virtual bool open(int64_t size);
+	virtual bool write(int64_t offset, const uint8_t* data, int size);
+
+private:
+	uint8_t* _region;
+	int64_t _regionSize;
+	int64_t _size;
+};
+
+#endif /* AWS_S3DOWNLOADSINK_H_ */
@@ -0,0 +1,204 @@
+/*
+ * S3ListObjectsV2Paginator.cpp
+ */
+
+#include "AWS.h"
+
+#define LOG_TAG "S3ListObjectsV2Paginator"
+
+// A thread sending the requests of a paginator.
+class S3PageFetcher: public Thread {
+public:
+	S3PageFetcher(S3ListObjectsV2Paginator* paginator) :
+			_paginator(paginator) {
+	}
+
+protected:
+	virtual void run() {
+		_paginator->runFetcher();
+	}
+
+private:
+	// The paginator stops the thread before being destroyed.
+	S3ListObjectsV2Paginator* _paginator;
+};
+
+// Requests the next page as soon as its token is parsed.
+class S3PageUnmarshaller: public S3ListObjectsV2ResultUnmarshaller {
+public:
+	S3PageUnmarshaller(S3ListObjectsV2Paginator* paginator) :
+			_paginator(paginator), _nextRequested(false) {
+	}
+
+protected:
+	virtual void onNextContinuationToken(const String& token) {
+		MutexHolder holder(&_paginator->_lock);
+		if (!token.isEmpty() && !_nextRequested && !_paginator->_stopped) {
+			_paginator->requestPage(token);
+			_nextRequested = true;
+		}
+	}
+
+private:
+	S3ListObjectsV2Paginator* _paginator;
+	bool _nextRequested;
+};
+
+S3ListObjectsV2Paginator::S3ListObjectsV2Paginator(S3Client* client,
+		const S3ListObjectsV2Params* params) :
+		_requestEvent(false), _responseEvent(false) {
+	BFX_ASSERT(client);
+	BFX_ASSERT(params);
+
+	_client = client;
+	_bucketName = params->getBucketName();
+	_prefix = params->getPrefix();
+	_delimiter = params->getDelimiter();
+	_maxKeys = params->getMaxKeys();
+	_startAfter = params->getStartAfter();
+	_encodingType = params->getEncodingType();
+	_continuationToken = params->getContinuationToken();
+	_requested = false;
+	_responded = false;
+	_lastError = AWSE_NoError;
+	_finished = false;
+	_stopped = false;
+}
+
+S3ListObjectsV2Paginator::~S3ListObjectsV2Paginator() {
+	stop();
+}
+
+S3ListObjectsV2Result* S3ListObjectsV2Paginator::nextPage() {
+	// Releases the page handed out before, to make room for the next one.
+	_page = NULL;
+
+	_lock.lock();
+	if (_finished) {
+		_lock.unlock();
+		return NULL;
+	}
+	if (_fetcher == NULL) {
+		REF<S3PageFetcher> fetcher = new S3PageFetcher(this);
+		if (!fetcher->start()) {
+			_lastError = AWSE_HttpRequestFailed;
+			_finished = true;
+			_lock.unlock();
+			LOGE("Unable to start the fetching thread.");
+			return NULL;
+		}
+		_fetcher = fetcher;
+		requestPage(_continuationToken);
+	}
+	while (!_responded) {
+		_lock.unlock();
+		_responseEvent.wait();
+		_lock.lock();
+	}
+	_responded = false;
+	REF<AWSHttpResponse> response = _response;
+	_response = NULL;
+	if (response == NULL) {
+		_finished = true;
+		_lock.unlock();
+		return NULL;	// NOTE The error code already been set.
+	}
+	_lock.unlock();
+
+	{
+		// The page is held by the paginator alone, whatever the pool of
+		// the caller.
+		REFAutoreleasePool pool;
+		_page = S3PageUnmarshaller(this).unmarshall(response);
+	}
+	response = NULL;
+
+	MutexHolder holder(&_lock);
+	if (_page == NULL) {
+		_lastError = AWSE_ParseXMLFailed;
+		_finished = true;
+		LOGE("Error occurs during parse response body.");
+		return NULL;
+	}
+	// A truncated page without a token can't be followed either.
+	if (!_page->getErrorCode().isEmpty() || !_page->isTruncated()
+			|| _page->getNextContinuationToken().isEmpty())
+		_finished = true;
+	return _page;
+}
+
+bool S3ListObjectsV2Paginator::hasMorePages() {
+	MutexHolder holder(&_lock);
+	return !_finished;
+}
+
+AWSError S3ListObjectsV2Paginator::getLastError() {
+	MutexHolder holder(&_lock);
+	return _lastError;
+}
+
+void S3ListObjectsV2Paginator::stop() {
+	{
+		MutexHolder holder(&_lock);
+		_stopped = true;
+		_finished = true;
+		_requestEvent.set();
+	}
+	if (_fetcher != NULL) {
+		_fetcher->join();
+		_fetcher = NULL;
+	}
+	_response = NULL;
+	_responded = false;
+}
+
+void S3ListObjectsV2Paginator::requestPage(const String& continuationToken) {
+	BFX_ASSERT(!_requested);
+
+	_requested = true;
+	_requestedToken = continuationToken;
+	_requestEvent.set();
+}
+
+void S3ListObjectsV2Paginator::runFetcher() {
+	_lock.lock();
+	while (true) {
+		while (!_requested && !_stopped) {
+			_lock.unlock();
+			_requestEvent.wait();
+			_lock.lock();
+		}
+		if (_stopped)
+			break;
+		REF<S3ListObjectsV2Params> params = new S3ListObjectsV2Params(
+				_bucketName);
+		params->setPrefix(_prefix);
+		params->setDelimiter(_delimiter);
+		params->setMaxKeys(_maxKeys);
+		params->setStartAfter(_startAfter);
+		params->setEncodingType(_encodingType);
+		params->setContinuationToken(_requestedToken);
+		_lock.unlock();
+
+		REFAutoreleasePool pool;
+		AWSError error = AWSE_InvalidArguments;
+		AWSHttpResponse* response = NULL;
+		AWSHttpRequest* request = S3ListObjectsV2ParamsMarshaller().marshall(
+				params);
+		if (request != NULL) {
+			response = _client->invoke(request);
+			error = _client->getLastError();
+		}
+		if (response == NULL)
+			LOGE("Failed to list a page of bucket '%s'.", _bucketName.cstr());
+
+		_lock.lock();
+		_requested = false;
+		_response = response;
+		_responded = true;
+		if (response == NULL)
+			_lastError = error;
+		_responseEvent.set();
+	}
+	_lock.unlock();
+}
@@ -0,0 +1,81 @@
+/*
+ * S3ListObjectsV2Paginator.h
+ */
+
+#ifndef AWS_S3LISTOBJECTSV2PAGINATOR_H_
+#define AWS_S3LISTOBJECTSV2PAGINATOR_H_
+
+class S3PageFetcher;
+class S3PageUnmarshaller;
+
+/// Lists all the objects of a bucket page by page, fetching each page while
+/// the one before is consumed. A background thread sends the request of the
+/// next page as soon as the continuation token has been parsed, which S3
+/// sends ahead of the objects of a page, so that the network time of a page
+/// overlaps with parsing and consuming the one before.
+///
+/// At most two pages are held: the one handed out, and the response of the
+/// next one. The next page is requested no sooner than the one handed out
+/// is being replaced.
+class S3ListObjectsV2Paginator: public REFObject {
+public:
+	/// Creates a paginator listing the objects given parameters select, from
+	/// the page of their continuation token if any.
+	S3ListObjectsV2Paginator(S3Client* client,
+			const S3ListObjectsV2Params* params);
+	virtual ~S3ListObjectsV2Paginator();
+
+	/// Gets the next page, or NULL once all the pages have been listed or if
+	/// a request failed, see getLastError(). A page S3 failed to list is
+	/// returned with its error code, and ends the listing. The page stays
+	/// valid until the next call, which releases it unless it is retained.
+	/// Pages are meant to be taken by one thread at a time.
+	S3ListObjectsV2Result* nextPage();
+	/// Gets a value indicating whether nextPage() may return another page.
+	bool hasMorePages();
+	/// Gets the error of the request which ended the listing, if any.
+	AWSError getLastError();
+
+	/// Stops fetching ahead, and waits for the request being sent if any.
+	/// The listing ends.
+	void stop();
+
+private:
+	friend class S3PageFetcher;
+	friend class S3PageUnmarshaller;
+
+	// Asks the fetcher for the page of given token, the lock must be held.
+	void requestPage(const String& continuationToken);
+	// The loop of the fetching thread.
+	void runFetcher();
+
+	REF<S3Client> _client;
+	// The parameters of the pages, read by the fetcher without the lock.
+	String _bucketName;
+	String _prefix;
+	String _delimiter;
+	int _maxKeys;
+	String _startAfter;
+	String _encodingType;
+	String _continuationToken;
+
+	Mutex _lock;
+	REF<S3PageFetcher> _fetcher;
+	// Whether a page is requested and not responded yet.
+	bool _requested;
+	String _requestedToken;
+	// The response of the page requested, NULL if the request failed.
+	REF<AWSHttpResponse> _response;
+	bool _responded;
+	AWSError _lastError;
+	bool _finished;
+	bool _stopped;
+	// Signaled when a page is requested, or on stop.
+	Event _requestEvent;
+	// Signaled when the page requested has been responded.
+	Event _responseEvent;
+	// The page handed out.
+	REF<S3ListObjectsV2Result> _page;
+};
+
+#endif /* AWS_S3LISTOBJECTSV2PAGINATOR_H_ */
@@ -0,0 +1,50 @@
+/*
+ * S3MappedFile.cpp
+ */
+
+#include "AWS.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define LOG_TAG "S3MappedFile"
+
+S3MappedFile::S3MappedFile(const String& fileName) :
+		_data(NULL), _size(0), _open(false) {
+	int fd = ::open(fileName, O_RDONLY);
+	if (fd < 0) {
+		LOGE("Unable to open '%s': %s", fileName.cstr(), strerror(errno));
+		return;
+	}
+	struct stat st;
+	if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+		LOGE("'%s' is not a regular file.", fileName.cstr());
+		::close(fd);
+		return;
+	}
+	_size = st.st_size;
+	if (_size > 0) {
+		void* data = mmap(NULL, (size_t) _size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (data == MAP_FAILED) {
+			LOGE("Unable to map '%s': %s", fileName.cstr(), strerror(errno));
+			::close(fd);
+			_size = 0;
+			return;
+		}
+		_data = (uint8_t*) data;
+		// Read ahead aggressively, the pages are only walked forward.
+		madvise(_data, (size_t) _size, MADV_SEQUENTIAL);
+	}
+	// The mapping stays valid without the descriptor.
+	::close(fd);
+	_open = true;
+}
+
+S3MappedFile::~S3MappedFile() {
+	if (_data != NULL)
+		munmap(_data, (size_t) _size);
+}
@@ -0,0 +1,36 @@
+/*
+ * S3MappedFile.h
+ */
+
+#ifndef AWS_S3MAPPEDFILE_H_
+#define AWS_S3MAPPEDFILE_H_
+
+/// A file mapped read-only into memory, to be sent as the payload of a
+/// request without being copied, see S3Client::putObjectFromFile(). The
+/// mapping is advised to be read sequentially, once to hash it and once to
+/// send it, and is unmapped on destruction.
+class S3MappedFile: public REFObject {
+public:
+	/// Maps given file, see isOpen().
+	S3MappedFile(const String& fileName);
+	virtual ~S3MappedFile();
+
+	/// Gets a value indicating whether the file has been mapped. An empty
+	/// file is open, with no data.
+	bool isOpen() const {
+		return _open;
+	}
+	const uint8_t* getData() const {
+		return _data;
+	}
+	int64_t getSize() const {
+		return _size;
+	}
+
+private:
+	uint8_t* _data;
+	int64_t _size;
+	bool _open;
+};
+
+#endif /* AWS_S3MAPPEDFILE_H_ */
@@ -0,0 +1,427 @@
+/*
+ * S3MultipartUploader.cpp
+ */
+
+#include "AWS.h"
+
+#define LOG_TAG "S3MultipartUploader"
+
+// The bytes read from the source at a time, small enough for the checksum to
+// be computed while they are still in the cache.
+#define READ_CHUNK_SIZE	(256 * 1024)
+
+// A thread sending parts while the one calling upload() reads them.
+class S3UploadWorker: public Thread {
+public:
+	S3UploadWorker(S3MultipartUploader* uploader) :
+			_uploader(uploader) {
+	}
+
+protected:
+	virtual void run() {
+		_uploader->runWorker();
+	}
+
+private:
+	// The uploader joins the thread before returning.
+	S3MultipartUploader* _uploader;
+};
+
+S3MultipartUploader::S3MultipartUploader(S3Client* client,
+		const S3UploadParams* params, S3UploadSource* source) :
+		_partEvent(false), _bufferEvent(false) {
+	BFX_ASSERT(client);
+	BFX_ASSERT(params);
+	BFX_ASSERT(source);
+
+	_client = client;
+	_params = const_cast<S3UploadParams*>(params);
+	_source = source;
+	_objectSize = -1;
+	_bufferCount = 0;
+	_readDone = false;
+	_failed = false;
+	_error = AWSE_NoError;
+}
+
+S3MultipartUploader::~S3MultipartUploader() {
+}
+
+int S3MultipartUploader::getPartSize(int64_t objectSize, int partNumber) {
+	const int64_t MiB = 1024 * 1024;
+	int64_t partSize;
+	if (objectSize >= 0) {
+		partSize = (objectSize + S3UploadParams::MAX_PART_COUNT - 1)
+				/ S3UploadParams::MAX_PART_COUNT;
+		partSize = (partSize + MiB - 1) / MiB * MiB;
+		partSize = BFX_MAX(partSize, (int64_t ) S3UploadParams::MIN_PART_SIZE);
+	} else {
+		int shift = BFX_MIN((partNumber - 1) / 1000, 8);
+		partSize = (int64_t) S3UploadParams::MIN_PART_SIZE << shift;
+	}
+	return (int) BFX_MIN(partSize, (int64_t ) S3UploadParams::MAX_PART_SIZE);
+}
+
+int S3MultipartUploader::getPartSize(int partNumber) const {
+	if (_params->getPartSize() > 0)
+		return _params->getPartSize();
+	return getPartSize(_objectSize, partNumber);
+}
+
+S3UploadResult* S3MultipartUploader::upload() {
+	_objectSize = _source->getSize();
+	if (_objectSize > (int64_t) getPartSize(1) * S3UploadParams::MAX_PART_COUNT) {
+		_client->_lastError = AWSE_InvalidArguments;
+		LOGE("Object '%s' doesn't fit in %d parts.", _params->getKey().cstr(),
+				S3UploadParams::MAX_PART_COUNT);
+		return NULL;
+	}
+
+	// The first part tells whether a single PutObject will do.
+	_result = new S3UploadResult();
+	SharedBufferT<uint8_t> buffer;
+	String checksumCRC32C;
+	_bufferCount = 1;
+	int partSize = getPartSize(1);
+	int count = readPart(buffer, partSize, checksumCRC32C);
+	if (count < 0) {
+		_client->_lastError = AWSE_IOFailed;
+		LOGE("Unable to read the source of '%s'.", _params->getKey().cstr());
+		_result = NULL;
+		return NULL;
+	}
+	_result->setSize(count);
+	if (count < partSize || count == _objectSize)
+		return putObject(buffer);
+
+	REF<S3CreateMultipartUploadParams> createParams =
+			new S3CreateMultipartUploadParams(_params->getBucketName(),
+					_params->getKey());
+	createParams->setContentType(_params->getContentType());
+	createParams->setChecksumAlgorithm("CRC32C");
+	S3CreateMultipartUploadResult* created = _client->createMultipartUpload(
+			createParams);
+	if (created == NULL) {
+		_result = NULL;
+		return NULL;	// NOTE The error code already been set.
+	}
+	if (!created->getErrorCode().isEmpty()) {
+		fail(AWSE_NoError, created);
+	} else if (created->getUploadId().isEmpty()) {
+		_client->_lastError = AWSE_ParseXMLFailed;
+		LOGE("No upload ID for '%s'.", _params->getKey().cstr());
+		_result = NULL;
+		return NULL;
+	}
+	if (_failed) {
+		S3UploadResult* result = _result;
+		result->autorelease();
+		_result = NULL;
+		return result;
+	}
+	_uploadId = created->getUploadId();
+	_result->setUploadId(_uploadId);
+
+	{
+		Part first;
+		first.data = buffer;
+		first.checksumCRC32C = checksumCRC32C;
+		_parts.add(first);
+		_queue.add(0);
+	}
+	// The part holds the buffer alone, to be reused once sent.
+	buffer = SharedBufferT<uint8_t>();
+	_readDone = false;
+
+	ArrayListT<REF<S3UploadWorker> > workers;
+	for (int i = 0; i < _params->getConcurrency(); i++) {
+		REF<S3UploadWorker> worker = new S3UploadWorker(this);
+		if (!worker->start()) {
+			LOGW("Unable to start a sending thread.");
+			break;
+		}
+		workers.add(worker);
+	}
+	if (workers.isEmpty()) {
+		MutexHolder holder(&_lock);
+		LOGE("No thread to send the parts of '%s'.", _params->getKey().cstr());
+		fail(AWSE_HttpRequestFailed, NULL);
+	}
+
+	// Reads the parts into the buffers freed by the workers.
+	for (int partNumber = 2;; partNumber++) {
+		SharedBufferT<uint8_t> partBuffer;
+		if (!takeBuffer(partBuffer))
+			break;
+		partSize = getPartSize(partNumber);
+		count = readPart(partBuffer, partSize, checksumCRC32C);
+
+		MutexHolder holder(&_lock);
+		if (count < 0) {
+			LOGE("Unable to read part %d of '%s'.", partNumber,
+					_params->getKey().cstr());
+			fail(AWSE_IOFailed, NULL);
+		} else if (count > 0 && partNumber > S3UploadParams::MAX_PART_COUNT) {
+			LOGE("Object '%s' doesn't fit in %d parts.",
+					_params->getKey().cstr(), S3UploadParams::MAX_PART_COUNT);
+			fail(AWSE_InvalidArguments, NULL);
+		} else if (count > 0) {
+			Part part;
+			part.data = partBuffer;
+			part.checksumCRC32C = checksumCRC32C;
+			_parts.add(part);
+			_queue.add(_parts.getSize() - 1);
+			_result->setSize(_result->getSize() + count);
+			_partEvent.set();
+		} else {
+			_freeBuffers.add(partBuffer);
+		}
+		if (_failed || count < partSize)
+			break;
+	}
+	{
+		MutexHolder holder(&_lock);
+		_readDone = true;
+		_partEvent.set();
+	}
+	for (int i = 0; i < workers.getSize(); i++)
+		workers[i]->join();
+	_freeBuffers.clear();
+
+	if (!_failed)
+		completeUpload();
+	if (_failed) {
+		abortUpload();
+		if (_error != AWSE_NoError) {
+			_client->_lastError = _error;
+			_result = NULL;
+			return NULL;
+		}
+	}
+
+	S3UploadResult* result = _result;
+	result->autorelease();
+	_result = NULL;
+	return result;
+}
+
+S3UploadResult* S3MultipartUploader::putObject(
+		const SharedBufferT<uint8_t>& data) {
+	REF<S3PutObjectParams> params = new S3PutObjectParams(
+			_params->getBucketName(), _params->getKey());
+	params->setContent(data);
+	params->setContentType(_params->getContentType());
+	params->setPayloadSigningMode(_params->getPayloadSigningMode());
+
+	for (int attempt = 0;; attempt++) {
+		S3PutObjectResult* result = _client->putObject(params);
+		if (result != NULL && !result->getErrorCode().isEmpty()
+				&& !result->isRetryable()) {
+			fail(AWSE_NoError, result);
+			break;
+		} else if (result != NULL && result->getErrorCode().isEmpty()) {
+			_result->setETag(result->getETag());
+			_result->setPartCount(1);
+			break;
+		} else if (attempt >= _params->getMaxRetries()) {
+			LOGE("Failed to put '%s' after %d attempts.",
+					_params->getKey().cstr(), attempt + 1);
+			if (result == NULL) {
+				_result = NULL;
+				return NULL;	// NOTE The error code already been set.
+			}
+			fail(AWSE_NoError, result);
+			break;
+		}
+		Thread::sleep(RETRY_INTERVAL << BFX_MIN(attempt, 5));
+	}
+
+	S3UploadResult* result = _result;
+	result->autorelease();
+	_result = NULL;
+	return result;
+}
+
+int S3MultipartUploader::readPart(SharedBufferT<uint8_t>& buffer, int size,
+		String& checksumCRC32C) {
+	uint8_t* data = buffer.getBuffer(size);
+	AWSCRC32C crc;
+	int count = 0;
+	while (count < size) {
+		int read = _source->read(data + count,
+				BFX_MIN(size - count, READ_CHUNK_SIZE));
+		if (read < 0) {
+			buffer.releaseBuffer(0);
+			return -1;
+		}
+		if (read == 0)
+			break;
+		crc.update(data + count, read);
+		count += read;
+	}
+	buffer.releaseBuffer(count);
+	checksumCRC32C = crc.toBase64();
+	return count;
+}
+
+bool S3MultipartUploader::takeBuffer(SharedBufferT<uint8_t>& buffer) {
+	MutexHolder holder(&_lock);
+	// One buffer is read into while the others are sent.
+	while (!_failed && _freeBuffers.isEmpty()
+			&& _bufferCount > _params->getConcurrency()) {
+		_lock.unlock();
+		_bufferEvent.wait();
+		_lock.lock();
+	}
+	if (_failed)
+		return false;
+	if (_freeBuffers.isEmpty()) {
+		_bufferCount++;
+		return true;
+	}
+	buffer = _freeBuffers[_freeBuffers.getSize() - 1];
+	_freeBuffers.removeAt(_freeBuffers.getSize() - 1);
+	return true;
+}
+
+void S3MultipartUploader::runWorker() {
+	_lock.lock();
+	while (true) {
+		while (_queue.isEmpty() && !_readDone && !_failed) {
+			_lock.unlock();
+			_partEvent.wait();
+			_lock.lock();
+		}
+		if (_failed || _queue.isEmpty())
+			break;
+		int index = _queue[0];
+		_queue.removeAt(0);
+		// The buffer goes back to the pool once sent, held by no one else.
+		SharedBufferT<uint8_t> data = _parts[index].data;
+		_parts[index].data = SharedBufferT<uint8_t>();
+		String checksumCRC32C = _parts[index].checksumCRC32C;
+		if (!_queue.isEmpty())
+			_partEvent.set();
+		_lock.unlock();
+
+		bool uploaded;
+		{
+			REFAutoreleasePool pool;
+			uploaded = uploadPart(index, data, checksumCRC32C);
+		}
+
+		_lock.lock();
+		if (!uploaded)
+			break;
+		_freeBuffers.add(data);
+		data = SharedBufferT<uint8_t>();
+		_bufferEvent.set();
+	}
+	// Wakes the next worker to see the end too.
+	_partEvent.set();
+	_lock.unlock();
+}
+
+bool S3MultipartUploader::uploadPart(int index,
+		const SharedBufferT<uint8_t>& data, const String& checksumCRC32C) {
+	REF<S3UploadPartParams> params = new S3UploadPartParams(
+			_params->getBucketName(), _params->getKey(), _uploadId, index + 1);
+	params->setContent(data);
+	params->setChecksumCRC32C(checksumCRC32C);
+	params->setPayloadSigningMode(_params->getPayloadSigningMode());
+
+	for (int attempt = 0;; attempt++) {
+		S3UploadPartResult* result = _client->uploadPart(params);
+		AWSError error = AWSE_NoError;
+		if (result == NULL) {
+			// The last error is kept per thread, this one is of the request.
+			error = _client->getLastError();
+		} else if (!result->getErrorCode().isEmpty()) {
+			if (!result->isRetryable()) {
+				LOGE("Failed to upload part %d of '%s': %s", index + 1,
+						_params->getKey().cstr(),
+						result->getErrorCode().cstr());
+				MutexHolder holder(&_lock);
+				fail(AWSE_NoError, result);
+				return false;
+			}
+		} else if (!result->getETag().isEmpty()) {
+			MutexHolder holder(&_lock);
+			_parts[index].eTag = result->getETag();
+			return true;
+		} else {
+			// No entity tag to complete the upload with, e.g. a broken proxy.
+			error = AWSE_HttpRequestFailed;
+		}
+
+		{
+			MutexHolder holder(&_lock);
+			if (_failed)
+				return false;
+			if (attempt >= _params->getMaxRetries()) {
+				LOGE("Failed to upload part %d of '%s' after %d attempts.",
+						index + 1, _params->getKey().cstr(), attempt + 1);
+				fail(error, result);
+				return false;
+			}
+		}
+		Thread::sleep(RETRY_INTERVAL << BFX_MIN(attempt, 5));
+	}
+}
+
+void S3MultipartUploader::fail(AWSError error, S3Result* result) {
+	if (_failed)
+		return;
+	_failed = true;
+	_error = error;
+	if (result != NULL && !result->getErrorCode().isEmpty()) {
+		_result->setErrorCode(result->getErrorCode());
+		_result->setErrorMessage(result->getErrorMessage());
+		_result->setRequestId(result->getRequestId());
+	}
+	_partEvent.set();
+	_bufferEvent.set();
+}
+
+bool S3MultipartUploader::completeUpload() {
+	REF<S3CompleteMultipartUploadParams> params =
+			new S3CompleteMultipartUploadParams(_params->getBucketName(),
+					_params->getKey(), _uploadId);
+	for (int i = 0; i < _parts.getSize(); i++)
+		params->addPart(i + 1, _parts[i].eTag, _parts[i].checksumCRC32C);
+
+	for (int attempt = 0;; attempt++) {
+		S3CompleteMultipartUploadResult* result =
+				_client->completeMultipartUpload(params);
+		// Read on this thread, so that it's the error of this request.
+		AWSError error = (result == NULL) ?
+				_client->getLastError() : AWSE_NoError;
+		if (result != NULL && result->getErrorCode().isEmpty()) {
+			_result->setETag(result->getETag());
+			_result->setPartCount(_parts.getSize());
+			return true;
+		}
+		if ((result != NULL && !result->isRetryable())
+				|| attempt >= _params->getMaxRetries()) {
+			LOGE("Failed to complete the upload of '%s'.",
+					_params->getKey().cstr());
+			fail(error, result);
+			return false;
+		}
+		Thread::sleep(RETRY_INTERVAL << BFX_MIN(attempt, 5));
+	}
+}
+
+void S3MultipartUploader::abortUpload() {
+	AWSError lastError = _client->getLastError();
+	REF<S3AbortMultipartUploadParams> params =
+			new S3AbortMultipartUploadParams(_params->getBucketName(),
+					_params->getKey(), _uploadId);
+	S3AbortMultipartUploadResult* result = _client->abortMultipartUpload(
+			params);
+	if (result == NULL || !result->getErrorCode().isEmpty()) {
+		LOGW("Unable to abort the upload of '%s', its parts are kept.",
+				_params->getKey().cstr());
+	}
+	_client->_lastError = lastError;
+}
@@ -0,0 +1,99 @@
+/*
+ * S3MultipartUploader.h
+ */
+
+#ifndef AWS_S3MULTIPARTUPLOADER_H_
+#define AWS_S3MULTIPARTUPLOADER_H_
+
+class S3UploadWorker;
+
+/// Uploads an object from a source read once, in order, as the parts of a
+/// multipart upload sent at once over the connections of the pool of a
+/// client. The calling thread reads the parts, computing the CRC-32C
+/// checksum of each as its data arrives, into a fixed pool of buffers, one
+/// more than the parts sent at once, so that the memory used is bounded
+/// whatever the size of the object.
+///
+/// The buffer of a part is kept until the part has been sent, so that a part
+/// failing for network or server errors is retried without reading the
+/// source again. The other failures, and running out of retries, abort the
+/// upload. A source which fits in a single part is sent by PutObject. See
+/// S3Client::uploadMultipart().
+class S3MultipartUploader: public REFObject {
+public:
+	enum {
+		/// Time in milliseconds to wait before the first retry of a part,
+		/// doubled for each further one
+		RETRY_INTERVAL = 200,
+	};
+
+	S3MultipartUploader(S3Client* client, const S3UploadParams* params,
+			S3UploadSource* source);
+	virtual ~S3MultipartUploader();
+
+	/// Uploads the object. Returns NULL if the source couldn't be read or
+	/// the upload couldn't be created, see the last error of the client.
+	S3UploadResult* upload();
+
+	/// Gets the size of given part, counted from 1, of an object of given
+	/// size, or -1 if unknown. Parts of known objects are of the same size,
+	/// the smallest to fit the object in 10000 parts. Parts of unknown ones
+	/// start from 8 MiB and double every 1000 parts, so that up to 5 TiB fit.
+	static int getPartSize(int64_t objectSize, int partNumber);
+
+private:
+	friend class S3UploadWorker;
+
+	struct Part {
+		SharedBufferT<uint8_t> data;
+		String checksumCRC32C;
+		String eTag;
+	};
+
+	// Gets the size of given part, by the parameters if set.
+	int getPartSize(int partNumber) const;
+	// Sends the source by a single PutObject.
+	S3UploadResult* putObject(const SharedBufferT<uint8_t>& data);
+	// Reads up to given bytes into a buffer and computes their checksum.
+	// Returns the number read, less only at the end of the source, or -1.
+	int readPart(SharedBufferT<uint8_t>& buffer, int size,
+			String& checksumCRC32C);
+	// Takes a buffer of the pool, waiting for one to be freed if all are in
+	// use. Returns false if the upload has failed meanwhile.
+	bool takeBuffer(SharedBufferT<uint8_t>& buffer);
+	// The loop of each thread sending parts.
+	void runWorker();
+	// Sends a part, retrying on network and server errors.
+	bool uploadPart(int index, const SharedBufferT<uint8_t>& data,
+			const String& checksumCRC32C);
+	// Ends the upload on the failure of a part, the lock must be held.
+	void fail(AWSError error, S3Result* result);
+	// Completes the upload by the parts sent, retrying on network and server
+	// errors.
+	bool completeUpload();
+	// Discards the parts sent, keeping the last error of the client.
+	void abortUpload();
+
+	REF<S3Client> _client;
+	REF<S3UploadParams> _params;
+	REF<S3UploadSource> _source;
+	int64_t _objectSize;
+	String _uploadId;
+
+	Mutex _lock;
+	// Signaled as parts are queued, and as the last one is.
+	Event _partEvent;
+	// Signaled as buffers are freed, and on failure.
+	Event _bufferEvent;
+	ArrayListT<Part> _parts;
+	// The indexes of the parts read, but not yet taken by a worker.
+	ArrayListT<int> _queue;
+	ArrayListT<SharedBufferT<uint8_t> > _freeBuffers;
+	int _bufferCount;
+	bool _readDone;
+	bool _failed;
+	AWSError _error;
+	REF<S3UploadResult> _result;
+};
+
+#endif /* AWS_S3MULTIPARTUPLOADER_H_ */
@@ -0,0 +1,212 @@
+/*
+ * S3ParallelDownloader.cpp
+ */
+
+#include "AWS.h"
+
+#define LOG_TAG "S3ParallelDownloader"
+
+// A thread fetching parts along with the one calling download().
+class S3DownloadWorker: public Thread {
+public:
+	S3DownloadWorker(S3ParallelDownloader* downloader) :
+			_downloader(downloader) {
+	}
+
+protected:
+	virtual void run() {
+		_downloader->runWorker();
+	}
+
+private:
+	// The downloader joins the thread before returning.
+	S3ParallelDownloader* _downloader;
+};
+
+S3ParallelDownloader::S3ParallelDownloader(S3Client* client,
+		const S3DownloadParams* params, S3DownloadSink* sink) {
+	BFX_ASSERT(client);
+	BFX_ASSERT(params);
+	BFX_ASSERT(sink);
+
+	_client = client;
+	_params = const_cast<S3DownloadParams*>(params);
+	_sink = sink;
+	_nextPart = 0;
+	_failed = false;
+	_error = AWSE_NoError;
+}
+
+S3ParallelDownloader::~S3ParallelDownloader() {
+}
+
+S3DownloadResult* S3ParallelDownloader::download(
+		const S3DownloadResult* resumeFrom) {
+	REF<S3HeadObjectParams> headParams = new S3HeadObjectParams(
+			_params->getBucketName(), _params->getKey());
+	S3HeadObjectResult* head = _client->headObject(headParams);
+	if (head == NULL)
+		return NULL;	// NOTE The error code already been set.
+
+	_result = new S3DownloadResult(head->getETag(), head->getContentLength(),
+			_params->getPartSize());
+	if (!head->getErrorCode().isEmpty()) {
+		_result->setErrorCode(head->getErrorCode());
+		_result->setRequestId(head->getRequestId());
+		S3DownloadResult* result = _result;
+		result->autorelease();
+		_result = NULL;
+		return result;
+	}
+	// The parts written before are only kept for the same version.
+	if (resumeFrom != NULL && !resumeFrom->getETag().isEmpty()
+			&& resumeFrom->getETag() == _result->getETag()
+			&& resumeFrom->getObjectSize() == _result->getObjectSize()
+			&& resumeFrom->getPartSize() == _result->getPartSize()) {
+		for (int i = 0; i < _result->getPartCount(); i++) {
+			if (resumeFrom->isPartCompleted(i))
+				_result->setPartCompleted(i);
+		}
+	}
+	if (!_sink->open(_result->getObjectSize())) {
+		_client->_lastError = AWSE_IOFailed;
+		LOGE("Unable to open the sink of '%s'.", _params->getKey().cstr());
+		_result = NULL;
+		return NULL;
+	}
+
+	// Each worker holds the response of one part at a time.
+	int remaining = 0;
+	for (int i = 0; i < _result->getPartCount(); i++) {
+		if (!_result->isPartCompleted(i))
+			remaining++;
+	}
+	int64_t byBytes = _params->getMaxInFlightBytes() / _params->getPartSize();
+	int workerCount = (int) BFX_MIN((int64_t ) _params->getConcurrency(),
+			BFX_MAX(byBytes, (int64_t ) 1));
+	workerCount = BFX_MIN(workerCount, remaining);
+
+	_nextPart = 0;
+	_failed = false;
+	_error = AWSE_NoError;
+	ArrayListT<REF<S3DownloadWorker> > workers;
+	for (int i = 1; i < workerCount; i++) {
+		REF<S3DownloadWorker> worker = new S3DownloadWorker(this);
+		if (!worker->start()) {
+			LOGW("Unable to start a fetching thread.");
+			break;
+		}
+		workers.add(worker);
+	}
+	runWorker();
+	for (int i = 0; i < workers.getSize(); i++)
+		workers[i]->join();
+
+	if (_failed) {
+		if (_error != AWSE_NoError)
+			_client->_lastError = _error;
+	} else if (!_sink->close()) {
+		_client->_lastError = AWSE_IOFailed;
+		LOGE("Unable to close the sink of '%s'.", _params->getKey().cstr());
+		_result = NULL;
+		return NULL;
+	}
+
+	S3DownloadResult* result = _result;
+	result->autorelease();
+	_result = NULL;
+	return result;
+}
+
+void S3ParallelDownloader::runWorker() {
+	while (true) {
+		int index = -1;
+		{
+			MutexHolder holder(&_lock);
+			while (_nextPart < _result->getPartCount()
+					&& _result->isPartCompleted(_nextPart))
+				_nextPart++;
+			if (_failed || _nextPart >= _result->getPartCount())
+				break;
+			index = _nextPart++;
+		}
+
+		REFAutoreleasePool pool;
+		if (downloadPart(index)) {
+			MutexHolder holder(&_lock);
+			_result->setPartCompleted(index);
+		}
+	}
+}
+
+bool S3ParallelDownloader::downloadPart(int index) {
+	int64_t offset = (int64_t) index * _result->getPartSize();
+	int length = _result->getPartLength(index);
+	REF<S3GetObjectParams> params = new S3GetObjectParams(
+			_params->getBucketName(), _params->getKey());
+	params->setRange(offset, offset + length - 1);
+	params->setIfMatch(_result->getETag());
+
+	for (int attempt = 0;; attempt++) {
+		S3GetObjectResult* result = _client->getObject(params);
+		AWSError error = AWSE_NoError;
+		if (result == NULL) {
+			// The last error is kept per thread, this one is of the request.
+			error = _client->getLastError();
+		} else if (!result->getErrorCode().isEmpty()) {
+			if (!result->isRetryable()) {
+				LOGE("Failed to get part %d of '%s': %s", index,
+						_params->getKey().cstr(),
+						result->getErrorCode().cstr());
+				MutexHolder holder(&_lock);
+				fail(AWSE_NoError, result);
+				return false;
+			}
+		} else if (!result->getETag().isEmpty()
+				&& result->getETag() != _result->getETag()) {
+			// Tells a changed object even if If-Match has been ignored.
+			LOGE("Part %d of '%s' is of another version.", index,
+					_params->getKey().cstr());
+			result->setErrorCode("PreconditionFailed");
+			MutexHolder holder(&_lock);
+			fail(AWSE_NoError, result);
+			return false;
+		} else if (result->getContent().getLength() == length) {
+			if (!_sink->write(offset,
+					(const uint8_t*) result->getContent().cstr(), length)) {
+				MutexHolder holder(&_lock);
+				fail(AWSE_IOFailed, NULL);
+				return false;
+			}
+			return true;
+		} else {
+			// A short read, e.g. a connection cut while a proxy streamed.
+			error = AWSE_HttpRequestFailed;
+		}
+
+		{
+			MutexHolder holder(&_lock);
+			if (_failed)
+				return false;
+			if (attempt >= _params->getMaxRetries()) {
+				LOGE("Failed to get part %d of '%s' after %d attempts.", index,
+						_params->getKey().cstr(), attempt + 1);
+				fail(error, result);
+				return false;
+			}
+		}
+		Thread::sleep(RETRY_INTERVAL << BFX_MIN(attempt, 5));
+	}
+}
+
+void S3ParallelDownloader::fail(AWSError error, S3Result* result) {
+	if (_failed)
+		return;
+	_failed = true;
+	_error = error;
+	if (result != NULL && !result->getErrorCode().isEmpty()) {
+		_result->setErrorCode(result->getErrorCode());
+		_result->setErrorMessage(result->getErrorMessage());
+		_result->setRequestId(result->getRequestId());
+	}
+}
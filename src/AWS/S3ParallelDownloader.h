@@ -0,0 +1,61 @@
+/*
+ * S3ParallelDownloader.h
+ */
+
+#ifndef AWS_S3PARALLELDOWNLOADER_H_
+#define AWS_S3PARALLELDOWNLOADER_H_
+
+class S3DownloadWorker;
+
+/// Downloads an object by ranged GETs of its parts, fetched at once over the
+/// connections of the pool of a client, and written at their offsets into a
+/// sink as they arrive. Each GET requires the entity tag the object had on
+/// HEAD, so that the parts all come from the same version of the object.
+///
+/// The number of parts fetched at once is bounded by the concurrency and by
+/// the in-flight bytes of the parameters, the response of each part being
+/// held in memory until it is written. A part failing for network or server
+/// errors is retried, the other failures end the download, which tells the
+/// parts written to resume from. See S3Client::downloadParallel().
+class S3ParallelDownloader: public REFObject {
+public:
+	enum {
+		/// Time in milliseconds to wait before the first retry of a part,
+		/// doubled for each further one
+		RETRY_INTERVAL = 200,
+	};
+
+	S3ParallelDownloader(S3Client* client, const S3DownloadParams* params,
+			S3DownloadSink* sink);
+	virtual ~S3ParallelDownloader();
+
+	/// Downloads the object, except for the parts a previous download of the
+	/// same version of the object has completed, if given. Returns NULL if
+	/// the object couldn't be looked up or the sink couldn't be opened or
+	/// closed, see the last error of the client.
+	S3DownloadResult* download(const S3DownloadResult* resumeFrom = NULL);
+
+private:
+	friend class S3DownloadWorker;
+
+	// The loop of each thread fetching parts, the calling one included.
+	void runWorker();
+	// Fetches a part and writes it to the sink, retrying on network and
+	// server errors.
+	bool downloadPart(int index);
+	// Ends the download on the failure of a part, the lock must be held.
+	void fail(AWSError error, S3Result* result);
+
+	REF<S3Client> _client;
+	REF<S3DownloadParams> _params;
+	REF<S3DownloadSink> _sink;
+
+	Mutex _lock;
+	REF<S3DownloadResult> _result;
+	// The next part to look at, those completed are skipped.
+	int _nextPart;
+	bool _failed;
+	AWSError _error;
+};
+
+#endif /* AWS_S3PARALLELDOWNLOADER_H_ */
@@ -0,0 +1,250 @@
+/*
+ * S3Params.cpp
+ */
+
+#include "AWS.h"
+#include "HttpUtils.h"
+
+#include <limits.h>
+#include <openssl/evp.h>
+
+AWSHttpRequest* S3ParamsMarshaller::createHttpRequest(AWSHttpMethod httpMethod,
+		const String& bucketName, const String& key) {
+	REF<AWSHttpRequest> request = new AWSHttpRequest("AmazonS3");
+	request->setHttpMethod(httpMethod);
+	// Uses path-style addressing, which works for any bucket name.
+	String resourcePath = "/" + bucketName;
+	if (!key.isEmpty()) {
+		resourcePath.append('/');
+		resourcePath.append(key);
+	}
+	request->setResourcePath(resourcePath);
+	request->autorelease();
+	return request;
+}
+
+AWSHttpRequest* S3PutObjectParamsMarshaller::marshall(
+		const S3PutObjectParams* params) {
+	BFX_ASSERT(params);
+	AWSHttpRequest* request = createHttpRequest(AHM_PUT,
+			params->getBucketName(), params->getKey());
+	if (request == NULL)
+		return NULL;
+	S3MappedFile* mappedFile = params->getMappedFile();
+	if (mappedFile != NULL) {
+		// The payload size of a request is an int.
+		if (mappedFile->getSize() > INT_MAX)
+			return NULL;
+		request->setExternalContent(mappedFile->getData(),
+				(int) mappedFile->getSize(), mappedFile);
+	} else {
+		request->setContent(params->getContent());
+	}
+	request->setPayloadSigningMode(params->getPayloadSigningMode());
+	if (!params->getContentType().isEmpty()) {
+		request->getHeaders()->set("Content-Type", params->getContentType());
+	}
+	return request;
+}
+
+AWSHttpRequest* S3GetObjectParamsMarshaller::marshall(
+		const S3GetObjectParams* params) {
+	BFX_ASSERT(params);
+	AWSHttpRequest* request = createHttpRequest(AHM_GET,
+			params->getBucketName(), params->getKey());
+	if (request == NULL)
+		return NULL;
+	if (params->hasRange()) {
+		request->getHeaders()->set("Range",
+				String::format("bytes=%lld-%lld",
+						(long long) params->getRangeFirst(),
+						(long long) params->getRangeLast()));
+	}
+	if (!params->getIfMatch().isEmpty())
+		request->getHeaders()->set("If-Match", params->getIfMatch());
+	return request;
+}
+
+AWSHttpRequest* S3CreateMultipartUploadParamsMarshaller::marshall(
+		const S3CreateMultipartUploadParams* params) {
+	BFX_ASSERT(params);
+	AWSHttpRequest* request = createHttpRequest(AHM_POST,
+			params->getBucketName(), params->getKey());
+	if (request == NULL)
+		return NULL;
+	request->setParametersInQuery(true);
+	request->getParameters()->set("uploads", "");
+	// Otherwise the type of the form the empty body would be is stored.
+	request->getHeaders()->set("Content-Type",
+			params->getContentType().isEmpty() ?
+					String("binary/octet-stream") : params->getContentType());
+	if (!params->getChecksumAlgorithm().isEmpty()) {
+		request->getHeaders()->set("x-amz-checksum-algorithm",
+				params->getChecksumAlgorithm());
+	}
+	return request;
+}
+
+AWSHttpRequest* S3UploadPartParamsMarshaller::marshall(
+		const S3UploadPartParams* params) {
+	BFX_ASSERT(params);
+	AWSHttpRequest* request = createHttpRequest(AHM_PUT,
+			params->getBucketName(), params->getKey());
+	if (request == NULL)
+		return NULL;
+	request->getParameters()->set("partNumber",
+			String::format("%d", params->getPartNumber()));
+	request->getParameters()->set("uploadId", params->getUploadId());
+	request->setContent(params->getContent());
+	request->setPayloadSigningMode(params->getPayloadSigningMode());
+	// The signer leaves a checksum given alone.
+	if (!params->getChecksumCRC32C().isEmpty()) {
+		request->getHeaders()->set("x-amz-checksum-crc32c",
+				params->getChecksumCRC32C());
+	}
+	return request;
+}
+
+// Escapes the characters of XML text, e.g. the quotes of an ETag, and the
+// tabs and line breaks of a key, which the parser would normalize otherwise.
+// The other control characters can't be in XML 1.0, see
+// S3DeleteObjectsParams::isKeyBatchable().
+static String escapeXmlText(const String& text) {
+	String result;
+	for (int i = 0; i < text.getLength(); i++) {
+		char c = text[i];
+		if (c == '&')
+			result.append("&amp;");
+		else if (c == '<')
+			result.append("&lt;");
+		else if (c == '>')
+			result.append("&gt;");
+		else if (c == '"')
+			result.append("&quot;");
+		else if (c == '\t' || c == '\n' || c == '\r')
+			result.append(String::format("&#%d;", c));
+		else
+			result.append(c);
+	}
+	return result;
+}
+
+AWSHttpRequest* S3CompleteMultipartUploadParamsMarshaller::marshall(
+		const S3CompleteMultipartUploadParams* params) {
+	BFX_ASSERT(params);
+	AWSHttpRequest* request = createHttpRequest(AHM_POST,
+			params->getBucketName(), params->getKey());
+	if (request == NULL)
+		return NULL;
+	request->getParameters()->set("uploadId", params->getUploadId());
+
+	String content = "<CompleteMultipartUpload>";
+	for (int i = 0; i < params->getPartCount(); i++) {
+		content.append("<Part><PartNumber>");
+		content.append(String::format("%d", params->getPartNumber(i)));
+		content.append("</PartNumber><ETag>");
+		content.append(escapeXmlText(params->getPartETag(i)));
+		content.append("</ETag>");
+		if (!params->getPartChecksumCRC32C(i).isEmpty()) {
+			content.append("<ChecksumCRC32C>");
+			content.append(params->getPartChecksumCRC32C(i));
+			content.append("</ChecksumCRC32C>");
+		}
+		content.append("</Part>");
+	}
+	content.append("</CompleteMultipartUpload>");
+	request->setContent((const uint8_t*) content.cstr(), content.getLength());
+	request->getHeaders()->set("Content-Type", "application/xml");
+	return request;
+}
+
+AWSHttpRequest* S3AbortMultipartUploadParamsMarshaller::marshall(
+		const S3AbortMultipartUploadParams* params) {
+	BFX_ASSERT(params);
+	AWSHttpRequest* request = createHttpRequest(AHM_DELETE,
+			params->getBucketName(), params->getKey());
+	if (request == NULL)
+		return NULL;
+	request->getParameters()->set("uploadId", params->getUploadId());
+	return request;
+}
+
+AWSHttpRequest* S3HeadObjectParamsMarshaller::marshall(
+		const S3HeadObjectParams* params) {
+	BFX_ASSERT(params);
+	return createHttpRequest(AHM_HEAD, params->getBucketName(),
+			params->getKey());
+}
+
+AWSHttpRequest* S3DeleteObjectParamsMarshaller::marshall(
+		const S3DeleteObjectParams* params) {
+	BFX_ASSERT(params);
+	return createHttpRequest(AHM_DELETE, params->getBucketName(),
+			params->getKey());
+}
+
+AWSHttpRequest* S3DeleteObjectsParamsMarshaller::marshall(
+		const S3DeleteObjectsParams* params) {
+	BFX_ASSERT(params);
+	if (params->getKeyCount() == 0)
+		return NULL;
+	for (int i = 0; i < params->getKeyCount(); i++) {
+		if (!S3DeleteObjectsParams::isKeyBatchable(params->getKey(i)))
+			return NULL;
+	}
+	AWSHttpRequest* request = createHttpRequest(AHM_POST,
+			params->getBucketName(), String());
+	if (request == NULL)
+		return NULL;
+	request->getParameters()->set("delete", "");
+
+	String content = "<Delete>";
+	if (params->isQuiet())
+		content.append("<Quiet>true</Quiet>");
+	for (int i = 0; i < params->getKeyCount(); i++) {
+		content.append("<Object><Key>");
+		content.append(escapeXmlText(params->getKey(i)));
+		content.append("</Key></Object>");
+	}
+	content.append("</Delete>");
+	request->setContent((const uint8_t*) content.cstr(), content.getLength());
+	request->getHeaders()->set("Content-Type", "application/xml");
+
+	// S3 requires the digest of the payload of DeleteObjects.
+	uint8_t md5[EVP_MAX_MD_SIZE];
+	unsigned int md5Size = 0;
+	if (!EVP_Digest(content.cstr(), content.getLength(), md5, &md5Size,
+			EVP_md5(), NULL))
+		return NULL;
+	request->getHeaders()->set("Content-MD5",
+			HttpUtils::base64Encode(md5, (int) md5Size));
+	return request;
+}
+
+AWSHttpRequest* S3ListObjectsV2ParamsMarshaller::marshall(
+		const S3ListObjectsV2Params* params) {
+	BFX_ASSERT(params);
+	AWSHttpRequest* request = createHttpRequest(AHM_GET,
+			params->getBucketName(), String());
+	if (request == NULL)
+		return NULL;
+	AWSStringMap* parameters = request->getParameters();
+	parameters->set("list-type", "2");
+	if (!params->getPrefix().isEmpty())
+		parameters->set("prefix", params->getPrefix());
+	if (!params->getDelimiter().isEmpty())
+		parameters->set("delimiter", params->getDelimiter());
+	if (params->getMaxKeys() > 0) {
+		parameters->set("max-keys",
+				String::format("%d", params->getMaxKeys()));
+	}
+	if (!params->getContinuationToken().isEmpty()) {
+		parameters->set("continuation-token",
+				params->getContinuationToken());
+	}
+	if (!params->getStartAfter().isEmpty())
+		parameters->set("start-after", params->getStartAfter());
+	if (!params->getEncodingType().isEmpty())
+		parameters->set("encoding-type", params->getEncodingType());
+	return request;
+}
@@ -0,0 +1,877 @@
+/*
+ * S3Params.h
+ */
+
+#ifndef AWS_S3PARAMS_H_
+#define AWS_S3PARAMS_H_
+
+class S3Params: public REFObject {
+public:
+};
+
+class S3PutObjectParams: public S3Params {
+public:
+	S3PutObjectParams(const String& bucketName, const String& key) {
+		setBucketName(bucketName);
+		setKey(key);
+		_payloadSigningMode = APSM_Default;
+	}
+	/// Sets the name of the bucket to which the object is added.
+	void setBucketName(const String& bucketName) {
+		BFX_ASSERT(!bucketName.isEmpty());
+		_bucketName = bucketName;
+	}
+	/// Gets the name of the bucket to which the object is added.
+	const String& getBucketName() const {
+		return _bucketName;
+	}
+	/// Sets the key of the object.
+	void setKey(const String& key) {
+		BFX_ASSERT(!key.isEmpty());
+		_key = key;
+	}
+	/// Gets the key of the object.
+	const String& getKey() const {
+		return _key;
+	}
+	/// Sets the data of the object.
+	void setContent(const SharedBufferT<uint8_t>& content) {
+		_content = content;
+	}
+	/// Gets the data of the object.
+	const SharedBufferT<uint8_t>& getContent() const {
+		return _content;
+	}
+	/// Sets a mapped file as the data of the object instead, which is sent
+	/// from the mapping without being copied.
+	void setMappedFile(S3MappedFile* mappedFile) {
+		BFX_ASSERT(mappedFile == NULL || mappedFile->isOpen());
+		_mappedFile = mappedFile;
+	}
+	S3MappedFile* getMappedFile() const {
+		return _mappedFile;
+	}
+	/// Sets a standard MIME type describing the format of the object data.
+	void setContentType(const String& contentType) {
+		_contentType = contentType;
+	}
+	/// Gets a standard MIME type describing the format of the object data.
+	const String& getContentType() const {
+		return _contentType;
+	}
+	/// Sets a value indicating whether the object data is covered by the
+	/// signature. By default, the setting of the client applies.
+	void setPayloadSigningMode(AWSPayloadSigningMode payloadSigningMode) {
+		_payloadSigningMode = payloadSigningMode;
+	}
+	/// Gets a value indicating whether the object data is covered by the
+	/// signature.
+	AWSPayloadSigningMode getPayloadSigningMode() const {
+		return _payloadSigningMode;
+	}
+
+private:
+	String _bucketName;
+	String _key;
+	SharedBufferT<uint8_t> _content;
+	REF<S3MappedFile> _mappedFile;
+	String _contentType;
+	AWSPayloadSigningMode _payloadSigningMode;
+};
+
+class S3GetObjectParams: public S3Params {
+public:
+	S3GetObjectParams(const String& bucketName, const String& key) {
+		setBucketName(bucketName);
+		setKey(key);
+		_rangeFirst = _rangeLast = -1;
+	}
+	/// Sets the name of the bucket containing the object.
+	void setBucketName(const String& bucketName) {
+		BFX_ASSERT(!bucketName.isEmpty());
+		_bucketName = bucketName;
+	}
+	/// Gets the name of the bucket containing the object.
+	const String& getBucketName() const {
+		return _bucketName;
+	}
+	/// Sets the key of the object.
+	void setKey(const String& key) {
+		BFX_ASSERT(!key.isEmpty());
+		_key = key;
+	}
+	/// Gets the key of the object.
+	const String& getKey() const {
+		return _key;
+	}
+	/// Sets the range of bytes to retrieve, both offsets included.
+	void setRange(int64_t first, int64_t last) {
+		BFX_ASSERT(first >= 0 && last >= first);
+		_rangeFirst = first;
+		_rangeLast = last;
+	}
+	/// Gets a value indicating whether a range of bytes is retrieved rather
+	/// than the whole object.
+	bool hasRange() const {
+		return _rangeFirst >= 0;
+	}
+	int64_t getRangeFirst() const {
+		return _rangeFirst;
+	}
+	int64_t getRangeLast() const {
+		return _rangeLast;
+	}
+	/// Sets the entity tag the object must have, otherwise S3 fails the
+	/// request with PreconditionFailed.
+	void setIfMatch(const String& eTag) {
+		_ifMatch = eTag;
+	}
+	/// Gets the entity tag the object must have.
+	const String& getIfMatch() const {
+		return _ifMatch;
+	}
+
+private:
+	String _bucketName;
+	String _key;
+	int64_t _rangeFirst;
+	int64_t _rangeLast;
+	String _ifMatch;
+};
+
+class S3HeadObjectParams: public S3Params {
+public:
+	S3HeadObjectParams(const String& bucketName, const String& key) {
+		setBucketName(bucketName);
+		setKey(key);
+	}
+	/// Sets the name of the bucket containing the object.
+	void setBucketName(const String& bucketName) {
+		BFX_ASSERT(!bucketName.isEmpty());
+		_bucketName = bucketName;
+	}
+	/// Gets the name of the bucket containing the object.
+	const String& getBucketName() const {
+		return _bucketName;
+	}
+	/// Sets the key of the object.
+	void setKey(const String& key) {
+		BFX_ASSERT(!key.isEmpty());
+		_key = key;
+	}
+	/// Gets the key of the object.
+	const String& getKey() const {
+		return _key;
+	}
+
+private:
+	String _bucketName;
+	String _key;
+};
+
+/// The parameters of S3Client::downloadParallel().
+class S3DownloadParams: public S3Params {
+public:
+	enum {
+		DEFAULT_PART_SIZE = 8 * 1024 * 1024,	/// Default bytes per ranged GET
+		DEFAULT_CONCURRENCY = 4,	/// Default number of parts fetched at once
+		/// Default bound of the bytes of the parts being fetched
+		DEFAULT_MAX_IN_FLIGHT_BYTES = 64 * 1024 * 1024,
+		DEFAULT_MAX_RETRIES = 3,	/// Default retries of a failed part
+	};
+
+	S3DownloadParams(const String& bucketName, const String& key) {
+		setBucketName(bucketName);
+		setKey(key);
+		_partSize = DEFAULT_PART_SIZE;
+		_concurrency = DEFAULT_CONCURRENCY;
+		_maxInFlightBytes = DEFAULT_MAX_IN_FLIGHT_BYTES;
+		_maxRetries = DEFAULT_MAX_RETRIES;
+	}
+	/// Sets the name of the bucket containing the object.
+	void setBucketName(const String& bucketName) {
+		BFX_ASSERT(!bucketName.isEmpty());
+		_bucketName = bucketName;
+	}
+	/// Gets the name of the bucket containing the object.
+	const String& getBucketName() const {
+		return _bucketName;
+	}
+	/// Sets the key of the object.
+	void setKey(const String& key) {
+		BFX_ASSERT(!key.isEmpty());
+		_key = key;
+	}
+	/// Gets the key of the object.
+	const String& getKey() const {
+		return _key;
+	}
+	/// Sets the number of bytes each ranged GET retrieves.
+	void setPartSize(int partSize) {
+		BFX_ASSERT(partSize > 0);
+		_partSize = partSize;
+	}
+	int getPartSize() const {
+		return _partSize;
+	}
+	/// Sets the number of parts fetched at once, each over a connection of
+	/// the pool of the client.
+	void setConcurrency(int concurrency) {
+		BFX_ASSERT(concurrency > 0);
+		_concurrency = concurrency;
+	}
+	int getConcurrency() const {
+		return _concurrency;
+	}
+	/// Sets the bound of the bytes of the parts being fetched at once, which
+	/// lowers the concurrency if needed. A single part is fetched at a time
+	/// at least.
+	void setMaxInFlightBytes(int64_t maxInFlightBytes) {
+		BFX_ASSERT(maxInFlightBytes > 0);
+		_maxInFlightBytes = maxInFlightBytes;
+	}
+	int64_t getMaxInFlightBytes() const {
+		return _maxInFlightBytes;
+	}
+	/// Sets the number of times a part is retried after a network or a
+	/// server error.
+	void setMaxRetries(int maxRetries) {
+		BFX_ASSERT(maxRetries >= 0);
+		_maxRetries = maxRetries;
+	}
+	int getMaxRetries() const {
+		return _maxRetries;
+	}
+
+private:
+	String _bucketName;
+	String _key;
+	int _partSize;
+	int _concurrency;
+	int64_t _maxInFlightBytes;
+	int _maxRetries;
+};
+
+class S3DeleteObjectParams: public S3Params {
+public:
+	S3DeleteObjectParams(const String& bucketName, const String& key) {
+		setBucketName(bucketName);
+		setKey(key);
+	}
+	/// Sets the name of the bucket containing the object.
+	void setBucketName(const String& bucketName) {
+		BFX_ASSERT(!bucketName.isEmpty());
+		_bucketName = bucketName;
+	}
+	/// Gets the name of the bucket containing the object.
+	const String& getBucketName() const {
+		return _bucketName;
+	}
+	/// Sets the key of the object.
+	void setKey(const String& key) {
+		BFX_ASSERT(!key.isEmpty());
+		_key = key;
+	}
+	/// Gets the key of the object.
+	const String& getKey() const {
+		return _key;
+	}
+
+private:
+	String _bucketName;
+	String _key;
+};
+
+class S3DeleteObjectsParams: public S3Params {
+public:
+	enum {
+		MAX_KEY_COUNT = 1000,	/// The most keys a request may delete
+	};
+
+	S3DeleteObjectsParams(const String& bucketName) {
+		setBucketName(bucketName);
+		_quiet = true;
+	}
+	/// Sets the name of the bucket containing the objects.
+	void setBucketName(const String& bucketName) {
+		BFX_ASSERT(!bucketName.isEmpty());
+		_bucketName = bucketName;
+	}
+	/// Gets the name of the bucket containing the objects.
+	const String& getBucketName() const {
+		return _bucketName;
+	}
+	/// Adds the key of an object to delete, up to 1000 of them. The request
+	/// is refused if a key isn't batchable, see isKeyBatchable().
+	void addKey(const String& key) {
+		BFX_ASSERT(!key.isEmpty());
+		BFX_ASSERT(_keys.getSize() < MAX_KEY_COUNT);
+		_keys.add(key);
+	}
+	int getKeyCount() const {
+		return _keys.getSize();
+	}
+	const String& getKey(int index) const {
+		return _keys[index];
+	}
+	/// Gets a value indicating whether given key may be deleted in a batch.
+	/// XML 1.0 can't carry the control characters but tab, line feed and
+	/// carriage return, whose keys are to be deleted one by one.
+	static bool isKeyBatchable(const String& key) {
+		for (int i = 0; i < key.getLength(); i++) {
+			unsigned char c = (unsigned char) key[i];
+			if (c < 0x20 && c != '\t' && c != '\n' && c != '\r')
+				return false;
+		}
+		return true;
+	}
+	/// Sets a value indicating whether the response only tells the keys
+	/// which failed to be deleted, rather than all of them. True by default.
+	void setQuiet(bool quiet) {
+		_quiet = quiet;
+	}
+	bool isQuiet() const {
+		return _quiet;
+	}
+
+private:
+	String _bucketName;
+	ArrayListT<String> _keys;
+	bool _quiet;
+};
+
+/// The parameters of S3Client::deletePrefix().
+class S3DeletePrefixParams: public S3Params {
+public:
+	enum {
+		DEFAULT_CONCURRENCY = 8,	/// Default most batches deleted at once
+		DEFAULT_MAX_RETRIES = 5,	/// Default retries of a throttled batch
+	};
+
+	S3DeletePrefixParams(const String& bucketName, const String& prefix) {
+		setBucketName(bucketName);
+		setPrefix(prefix);
+		_concurrency = DEFAULT_CONCURRENCY;
+		_maxRetries = DEFAULT_MAX_RETRIES;
+	}
+	/// Sets the name of the bucket containing the objects.
+	void setBucketName(const String& bucketName) {
+		BFX_ASSERT(!bucketName.isEmpty());
+		_bucketName = bucketName;
+	}
+	/// Gets the name of the bucket containing the objects.
+	const String& getBucketName() const {
+		return _bucketName;
+	}
+	/// Sets the prefix of the keys of the objects to delete. An empty prefix
+	/// deletes all the objects of the bucket.
+	void setPrefix(const String& prefix) {
+		_prefix = prefix;
+	}
+	const String& getPrefix() const {
+		return _prefix;
+	}
+	/// Sets the most batches of keys deleted at once, which is lowered while
+	/// S3 throttles the requests.
+	void setConcurrency(int concurrency) {
+		BFX_ASSERT(concurrency > 0);
+		_concurrency = concurrency;
+	}
+	int getConcurrency() const {
+		return _concurrency;
+	}
+	/// Sets the number of times a batch, or the keys of it which failed for
+	/// transient errors, is retried.
+	void setMaxRetries(int maxRetries) {
+		BFX_ASSERT(maxRetries >= 0);
+		_maxRetries = maxRetries;
+	}
+	int getMaxRetries() const {
+		return _maxRetries;
+	}
+
+private:
+	String _bucketName;
+	String _prefix;
+	int _concurrency;
+	int _maxRetries;
+};
+
+class S3ListObjectsV2Params: public S3Params {
+public:
+	S3ListObjectsV2Params(const String& bucketName) {
+		setBucketName(bucketName);
+		_maxKeys = 0;
+	}
+	/// Sets the name of the bucket to list.
+	void setBucketName(const String& bucketName) {
+		BFX_ASSERT(!bucketName.isEmpty());
+		_bucketName = bucketName;
+	}
+	/// Gets the name of the bucket to list.
+	const String& getBucketName() const {
+		return _bucketName;
+	}
+	/// Sets the prefix the listed keys begin with.
+	void setPrefix(const String& prefix) {
+		_prefix = prefix;
+	}
+	/// Gets the prefix the listed keys begin with.
+	const String& getPrefix() const {
+		return _prefix;
+	}
+	/// Sets the character keys are grouped by, the keys containing it after
+	/// the prefix are rolled up into common prefixes.
+	void setDelimiter(const String& delimiter) {
+		_delimiter = delimiter;
+	}
+	/// Gets the character keys are grouped by.
+	const String& getDelimiter() const {
+		return _delimiter;
+	}
+	/// Sets the maximum number of keys of a page, 1000 at most. 0 uses the
+	/// default of S3, which is 1000 as well.
+	void setMaxKeys(int maxKeys) {
+		BFX_ASSERT(maxKeys >= 0);
+		_maxKeys = maxKeys;
+	}
+	/// Gets the maximum number of keys of a page.
+	int getMaxKeys() const {
+		return _maxKeys;
+	}
+	/// Sets the token of the page to list, as returned with the previous one.
+	void setContinuationToken(const String& continuationToken) {
+		_continuationToken = continuationToken;
+	}
+	/// Gets the token of the page to list.
+	const String& getContinuationToken() const {
+		return _continuationToken;
+	}
+	/// Sets the key the listing starts after.
+	void setStartAfter(const String& startAfter) {
+		_startAfter = startAfter;
+	}
+	/// Gets the key the listing starts after.
+	const String& getStartAfter() const {
+		return _startAfter;
+	}
+	/// Sets how S3 encodes the keys of the response, "url" to escape the
+	/// characters XML 1.0 can't carry. The keys of the result are decoded.
+	void setEncodingType(const String& encodingType) {
+		_encodingType = encodingType;
+	}
+	/// Gets how S3 encodes the keys of the response.
+	const String& getEncodingType() const {
+		return _encodingType;
+	}
+
+private:
+	String _bucketName;
+	String _prefix;
+	String _delimiter;
+	int _maxKeys;
+	String _continuationToken;
+	String _startAfter;
+	String _encodingType;
+};
+
+class S3CreateMultipartUploadParams: public S3Params {
+public:
+	S3CreateMultipartUploadParams(const String& bucketName,
+			const String& key) {
+		setBucketName(bucketName);
+		setKey(key);
+	}
+	/// Sets the name of the bucket containing the object.
+	void setBucketName(const String& bucketName) {
+		BFX_ASSERT(!bucketName.isEmpty());
+		_bucketName = bucketName;
+	}
+	/// Gets the name of the bucket containing the object.
+	const String& getBucketName() const {
+		return _bucketName;
+	}
+	/// Sets the key of the object.
+	void setKey(const String& key) {
+		BFX_ASSERT(!key.isEmpty());
+		_key = key;
+	}
+	/// Gets the key of the object.
+	const String& getKey() const {
+		return _key;
+	}
+	/// Sets a standard MIME type describing the format of the object data.
+	void setContentType(const String& contentType) {
+		_contentType = contentType;
+	}
+	/// Gets a standard MIME type describing the format of the object data.
+	const String& getContentType() const {
+		return _contentType;
+	}
+	/// Sets the algorithm of the checksums the parts are sent with, e.g.
+	/// CRC32C, which S3 then checks each part against.
+	void setChecksumAlgorithm(const String& checksumAlgorithm) {
+		_checksumAlgorithm = checksumAlgorithm;
+	}
+	/// Gets the algorithm of the checksums the parts are sent with.
+	const String& getChecksumAlgorithm() const {
+		return _checksumAlgorithm;
+	}
+
+private:
+	String _bucketName;
+	String _key;
+	String _contentType;
+	String _checksumAlgorithm;
+};
+
+class S3UploadPartParams: public S3Params {
+public:
+	S3UploadPartParams(const String& bucketName, const String& key,
+			const String& uploadId, int partNumber) {
+		setBucketName(bucketName);
+		setKey(key);
+		setUploadId(uploadId);
+		setPartNumber(partNumber);
+		_payloadSigningMode = APSM_Default;
+	}
+	/// Sets the name of the bucket containing the object.
+	void setBucketName(const String& bucketName) {
+		BFX_ASSERT(!bucketName.isEmpty());
+		_bucketName = bucketName;
+	}
+	/// Gets the name of the bucket containing the object.
+	const String& getBucketName() const {
+		return _bucketName;
+	}
+	/// Sets the key of the object.
+	void setKey(const String& key) {
+		BFX_ASSERT(!key.isEmpty());
+		_key = key;
+	}
+	/// Gets the key of the object.
+	const String& getKey() const {
+		return _key;
+	}
+	/// Sets the ID of the multipart upload.
+	void setUploadId(const String& uploadId) {
+		BFX_ASSERT(!uploadId.isEmpty());
+		_uploadId = uploadId;
+	}
+	/// Gets the ID of the multipart upload.
+	const String& getUploadId() const {
+		return _uploadId;
+	}
+	/// Sets the number of the part, from 1 to 10000.
+	void setPartNumber(int partNumber) {
+		BFX_ASSERT(partNumber >= 1 && partNumber <= 10000);
+		_partNumber = partNumber;
+	}
+	/// Gets the number of the part.
+	int getPartNumber() const {
+		return _partNumber;
+	}
+	/// Sets the data of the part, which is shared rather than copied.
+	void setContent(const SharedBufferT<uint8_t>& content) {
+		_content = content;
+	}
+	/// Gets the data of the part.
+	const SharedBufferT<uint8_t>& getContent() const {
+		return _content;
+	}
+	/// Sets the CRC-32C checksum of the part, base64 encoded, if it has
+	/// been computed as the data was read. Otherwise it is computed on
+	/// sending, unless the payload is signed.
+	void setChecksumCRC32C(const String& checksumCRC32C) {
+		_checksumCRC32C = checksumCRC32C;
+	}
+	/// Gets the CRC-32C checksum of the part.
+	const String& getChecksumCRC32C() const {
+		return _checksumCRC32C;
+	}
+	/// Sets a value indicating whether the data of the part is covered by the
+	/// signature. By default, the setting of the client applies.
+	void setPayloadSigningMode(AWSPayloadSigningMode payloadSigningMode) {
+		_payloadSigningMode = payloadSigningMode;
+	}
+	/// Gets a value indicating whether the data of the part is covered by
+	/// the signature.
+	AWSPayloadSigningMode getPayloadSigningMode() const {
+		return _payloadSigningMode;
+	}
+
+private:
+	String _bucketName;
+	String _key;
+	String _uploadId;
+	int _partNumber;
+	SharedBufferT<uint8_t> _content;
+	String _checksumCRC32C;
+	AWSPayloadSigningMode _payloadSigningMode;
+};
+
+class S3CompleteMultipartUploadParams: public S3Params {
+public:
+	S3CompleteMultipartUploadParams(const String& bucketName,
+			const String& key, const String& uploadId) {
+		setBucketName(bucketName);
+		setKey(key);
+		setUploadId(uploadId);
+	}
+	/// Sets the name of the bucket containing the object.
+	void setBucketName(const String& bucketName) {
+		BFX_ASSERT(!bucketName.isEmpty());
+		_bucketName = bucketName;
+	}
+	/// Gets the name of the bucket containing the object.
+	const String& getBucketName() const {
+		return _bucketName;
+	}
+	/// Sets the key of the object.
+	void setKey(const String& key) {
+		BFX_ASSERT(!key.isEmpty());
+		_key = key;
+	}
+	/// Gets the key of the object.
+	const String& getKey() const {
+		return _key;
+	}
+	/// Sets the ID of the multipart upload.
+	void setUploadId(const String& uploadId) {
+		BFX_ASSERT(!uploadId.isEmpty());
+		_uploadId = uploadId;
+	}
+	/// Gets the ID of the multipart upload.
+	const String& getUploadId() const {
+		return _uploadId;
+	}
+	/// Adds an uploaded part, in the order of the part numbers. The checksum
+	/// is needed if the upload has been created with a checksum algorithm.
+	void addPart(int partNumber, const String& eTag,
+			const String& checksumCRC32C = String()) {
+		BFX_ASSERT(!eTag.isEmpty());
+		Part part;
+		part.partNumber = partNumber;
+		part.eTag = eTag;
+		part.checksumCRC32C = checksumCRC32C;
+		_parts.add(part);
+	}
+	int getPartCount() const {
+		return _parts.getSize();
+	}
+	int getPartNumber(int index) const {
+		return _parts[index].partNumber;
+	}
+	const String& getPartETag(int index) const {
+		return _parts[index].eTag;
+	}
+	const String& getPartChecksumCRC32C(int index) const {
+		return _parts[index].checksumCRC32C;
+	}
+
+private:
+	struct Part {
+		int partNumber;
+		String eTag;
+		String checksumCRC32C;
+	};
+
+	String _bucketName;
+	String _key;
+	String _uploadId;
+	ArrayListT<Part> _parts;
+};
+
+class S3AbortMultipartUploadParams: public S3Params {
+public:
+	S3AbortMultipartUploadParams(const String& bucketName, const String& key,
+			const String& uploadId) {
+		setBucketName(bucketName);
+		setKey(key);
+		setUploadId(uploadId);
+	}
+	/// Sets the name of the bucket containing the object.
+	void setBucketName(const String& bucketName) {
+		BFX_ASSERT(!bucketName.isEmpty());
+		_bucketName = bucketName;
+	}
+	/// Gets the name of the bucket containing the object.
+	const String& getBucketName() const {
+		return _bucketName;
+	}
+	/// Sets the key of the object.
+	void setKey(const String& key) {
+		BFX_ASSERT(!key.isEmpty());
+		_key = key;
+	}
+	/// Gets the key of the object.
+	const String& getKey() const {
+		return _key;
+	}
+	/// Sets the ID of the multipart upload.
+	void setUploadId(const String& uploadId) {
+		BFX_ASSERT(!uploadId.isEmpty());
+		_uploadId = uploadId;
+	}
+	/// Gets the ID of the multipart upload.
+	const String& getUploadId() const {
+		return _uploadId;
+	}
+
+private:
+	String _bucketName;
+	String _key;
+	String _uploadId;
+};
+
+/// The parameters of S3Client::uploadMultipart().
+class S3UploadParams: public S3Params {
+public:
+	enum {
+		/// The smallest part size, which the part sizes picked start from
+		MIN_PART_SIZE = 8 * 1024 * 1024,
+		/// The largest part size, the buffers being indexed by int
+		MAX_PART_SIZE = 2040 * 1024 * 1024,
+		MAX_PART_COUNT = 10000,	/// The most parts an upload may have
+		DEFAULT_CONCURRENCY = 4,	/// Default number of parts sent at once
+		DEFAULT_MAX_RETRIES = 3,	/// Default retries of a failed part
+	};
+
+	S3UploadParams(const String& bucketName, const String& key) {
+		setBucketName(bucketName);
+		setKey(key);
+		_partSize = 0;
+		_concurrency = DEFAULT_CONCURRENCY;
+		_maxRetries = DEFAULT_MAX_RETRIES;
+		_payloadSigningMode = APSM_Default;
+	}
+	/// Sets the name of the bucket containing the object.
+	void setBucketName(const String& bucketName) {
+		BFX_ASSERT(!bucketName.isEmpty());
+		_bucketName = bucketName;
+	}
+	/// Gets the name of the bucket containing the object.
+	const String& getBucketName() const {
+		return _bucketName;
+	}
+	/// Sets the key of the object.
+	void setKey(const String& key) {
+		BFX_ASSERT(!key.isEmpty());
+		_key = key;
+	}
+	/// Gets the key of the object.
+	const String& getKey() const {
+		return _key;
+	}
+	/// Sets a standard MIME type describing the format of the object data.
+	void setContentType(const String& contentType) {
+		_contentType = contentType;
+	}
+	/// Gets a standard MIME type describing the format of the object data.
+	const String& getContentType() const {
+		return _contentType;
+	}
+	/// Sets the number of bytes of each part but the last one, 0 to pick it
+	/// by the size of the source. Only 10000 parts are allowed.
+	void setPartSize(int partSize) {
+		BFX_ASSERT(partSize == 0 || (partSize >= 5 * 1024 * 1024
+				&& partSize <= MAX_PART_SIZE));
+		_partSize = partSize;
+	}
+	int getPartSize() const {
+		return _partSize;
+	}
+	/// Sets the number of parts sent at once, each over a connection of the
+	/// pool of the client. One more part buffer is read into meanwhile.
+	void setConcurrency(int concurrency) {
+		BFX_ASSERT(concurrency > 0);
+		_concurrency = concurrency;
+	}
+	int getConcurrency() const {
+		return _concurrency;
+	}
+	/// Sets the number of times a part is retried after a network or a
+	/// server error.
+	void setMaxRetries(int maxRetries) {
+		BFX_ASSERT(maxRetries >= 0);
+		_maxRetries = maxRetries;
+	}
+	int getMaxRetries() const {
+		return _maxRetries;
+	}
+	/// Sets a value indicating whether the data of the parts is covered by
+	/// the signature. By default, the setting of the client applies.
+	void setPayloadSigningMode(AWSPayloadSigningMode payloadSigningMode) {
+		_payloadSigningMode = payloadSigningMode;
+	}
+	AWSPayloadSigningMode getPayloadSigningMode() const {
+		return _payloadSigningMode;
+	}
+
+private:
+	String _bucketName;
+	String _key;
+	String _contentType;
+	int _partSize;
+	int _concurrency;
+	int _maxRetries;
+	AWSPayloadSigningMode _payloadSigningMode;
+};
+
+class S3ParamsMarshaller {
+protected:
+	AWSHttpRequest* createHttpRequest(AWSHttpMethod httpMethod,
+			const String& bucketName, const String& key);
+};
+
+class S3PutObjectParamsMarshaller: public S3ParamsMarshaller {
+public:
+	AWSHttpRequest* marshall(const S3PutObjectParams* params);
+};
+
+class S3GetObjectParamsMarshaller: public S3ParamsMarshaller {
+public:
+	AWSHttpRequest* marshall(const S3GetObjectParams* params);
+};
+
+class S3HeadObjectParamsMarshaller: public S3ParamsMarshaller {
+public:
+	AWSHttpRequest* marshall(const S3HeadObjectParams* params);
+};
+
+class S3CreateMultipartUploadParamsMarshaller: public S3ParamsMarshaller {
+public:
+	AWSHttpRequest* marshall(const S3CreateMultipartUploadParams* params);
+};
+
+class S3UploadPartParamsMarshaller: public S3ParamsMarshaller {
+public:
+	AWSHttpRequest* marshall(const S3UploadPartParams* params);
+};
+
+class S3CompleteMultipartUploadParamsMarshaller: public S3ParamsMarshaller {
+public:
+	AWSHttpRequest* marshall(const S3CompleteMultipartUploadParams* params);
+};
+
+class S3AbortMultipartUploadParamsMarshaller: public S3ParamsMarshaller {
+public:
+	AWSHttpRequest* marshall(const S3AbortMultipartUploadParams* params);
+};
+
+class S3DeleteObjectParamsMarshaller: public S3ParamsMarshaller {
+public:
+	AWSHttpRequest* marshall(const S3DeleteObjectParams* params);
+};
+
+class S3DeleteObjectsParamsMarshaller: public S3ParamsMarshaller {
+public:
+	AWSHttpRequest* marshall(const S3DeleteObjectsParams* params);
+};
+
+class S3ListObjectsV2ParamsMarshaller: public S3ParamsMarshaller {
+public:
+	AWSHttpRequest* marshall(const S3ListObjectsV2Params* params);
+};
+
+#endif /* AWS_S3PARAMS_H_ */
@@ -0,0 +1,333 @@
+/*
+ * S3PrefixDeleter.cpp
+ */
+
+#include "AWS.h"
+
+#define LOG_TAG "S3PrefixDeleter"
+
+// A thread deleting batches while the one calling deletePrefix() lists them.
+class S3DeleteWorker: public Thread {
+public:
+	S3DeleteWorker(S3PrefixDeleter* deleter) :
+			_deleter(deleter) {
+	}
+
+protected:
+	virtual void run() {
+		_deleter->runWorker();
+	}
+
+private:
+	// The deleter joins the thread before returning.
+	S3PrefixDeleter* _deleter;
+};
+
+S3PrefixDeleter::S3PrefixDeleter(S3Client* client,
+		const S3DeletePrefixParams* params) :
+		_batchEvent(false), _queueEvent(false) {
+	BFX_ASSERT(client);
+	BFX_ASSERT(params);
+
+	_client = client;
+	_params = const_cast<S3DeletePrefixParams*>(params);
+	_pending = 0;
+	_active = 0;
+	_limit = params->getConcurrency();
+	_successes = 0;
+	_generation = 0;
+	_listDone = false;
+	_failed = false;
+	_error = AWSE_NoError;
+}
+
+S3PrefixDeleter::~S3PrefixDeleter() {
+}
+
+S3DeletePrefixResult* S3PrefixDeleter::deletePrefix() {
+	_result = new S3DeletePrefixResult();
+
+	REF<S3ListObjectsV2Params> listParams = new S3ListObjectsV2Params(
+			_params->getBucketName());
+	listParams->setPrefix(_params->getPrefix());
+	// The keys XML can't carry would fail the listing otherwise.
+	listParams->setEncodingType("url");
+	REF<S3ListObjectsV2Paginator> paginator = new S3ListObjectsV2Paginator(
+			_client, listParams);
+
+	ArrayListT<REF<S3DeleteWorker> > workers;
+	for (int i = 0; i < _params->getConcurrency(); i++) {
+		REF<S3DeleteWorker> worker = new S3DeleteWorker(this);
+		if (!worker->start()) {
+			LOGW("Unable to start a deleting thread.");
+			break;
+		}
+		workers.add(worker);
+	}
+	if (workers.isEmpty()) {
+		MutexHolder holder(&_lock);
+		LOGE("No thread to delete the objects of '%s'.",
+				_params->getPrefix().cstr());
+		fail(AWSE_HttpRequestFailed, NULL);
+	}
+
+	// Splits the pages into batches, each page being listed meanwhile.
+	bool queued = !workers.isEmpty();
+	while (queued) {
+		S3ListObjectsV2Result* page = paginator->nextPage();
+		if (page == NULL) {
+			if (paginator->getLastError() != AWSE_NoError) {
+				MutexHolder holder(&_lock);
+				LOGE("Failed to list the objects of '%s'.",
+						_params->getPrefix().cstr());
+				fail(paginator->getLastError(), NULL);
+			}
+			break;
+		}
+		if (!page->getErrorCode().isEmpty()) {
+			MutexHolder holder(&_lock);
+			LOGE("Failed to list the objects of '%s': %s",
+					_params->getPrefix().cstr(), page->getErrorCode().cstr());
+			fail(AWSE_NoError, page);
+			break;
+		}
+
+		S3ObjectList* objects = page->getObjects();
+		REF<S3DeleteObjectsParams> batch;
+		for (int i = 0; queued && i < objects->getSize(); i++) {
+			String key(objects->getKey(i), objects->getKeyLength(i));
+			if (!S3DeleteObjectsParams::isKeyBatchable(key)) {
+				queued = deleteKey(key);
+				continue;
+			}
+			if (batch == NULL)
+				batch = new S3DeleteObjectsParams(_params->getBucketName());
+			batch->addKey(key);
+			if (batch->getKeyCount() == S3DeleteObjectsParams::MAX_KEY_COUNT) {
+				queued = queueBatch(batch);
+				batch = NULL;
+			}
+		}
+		if (queued && batch != NULL)
+			queued = queueBatch(batch);
+	}
+	{
+		MutexHolder holder(&_lock);
+		_listDone = true;
+		_batchEvent.set();
+	}
+	for (int i = 0; i < workers.getSize(); i++)
+		workers[i]->join();
+	paginator->stop();
+	_queue.clear();
+
+	if (_failed && _error != AWSE_NoError) {
+		_client->_lastError = _error;
+		_result = NULL;
+		return NULL;
+	}
+
+	S3DeletePrefixResult* result = _result;
+	result->autorelease();
+	_result = NULL;
+	return result;
+}
+
+bool S3PrefixDeleter::queueBatch(S3DeleteObjectsParams* params) {
+	MutexHolder holder(&_lock);
+	// A few batches wait for the workers, the next page is listed meanwhile.
+	while (!_failed && _queue.getSize() >= _params->getConcurrency()) {
+		_lock.unlock();
+		_queueEvent.wait();
+		_lock.lock();
+	}
+	if (_failed)
+		return false;
+	Batch batch;
+	batch.params = params;
+	batch.attempt = 0;
+	_queue.add(batch);
+	_pending++;
+	_batchEvent.set();
+	return true;
+}
+
+void S3PrefixDeleter::runWorker() {
+	_lock.lock();
+	while (true) {
+		while (!_failed && !(_listDone && _pending == 0)
+				&& (_queue.isEmpty() || _active >= _limit)) {
+			_lock.unlock();
+			_batchEvent.wait();
+			_lock.lock();
+		}
+		if (_failed || (_listDone && _pending == 0))
+			break;
+		Batch batch = _queue[0];
+		_queue.removeAt(0);
+		_active++;
+		int generation = _generation;
+		if (!_queue.isEmpty() && _active < _limit)
+			_batchEvent.set();
+		_queueEvent.set();
+		_lock.unlock();
+
+		REF<S3DeleteObjectsParams> retry;
+		{
+			REFAutoreleasePool pool;
+			retry = deleteBatch(batch, generation);
+		}
+
+		_lock.lock();
+		_active--;
+		if (retry == NULL) {
+			_pending--;
+			_batchEvent.set();
+			continue;
+		}
+		// The slot is given to another batch during the backoff.
+		_batchEvent.set();
+		_lock.unlock();
+		Thread::sleep(RETRY_INTERVAL << BFX_MIN(batch.attempt, 5));
+		batch.params = retry;
+		batch.attempt++;
+		_lock.lock();
+		_queue.insertAt(0, batch);
+		_batchEvent.set();
+	}
+	// Wakes the next worker to see the end too.
+	_batchEvent.set();
+	_lock.unlock();
+}
+
+S3DeleteObjectsParams* S3PrefixDeleter::deleteBatch(Batch& batch,
+		int generation) {
+	S3DeleteObjectsResult* result = _client->deleteObjects(batch.params);
+	// The last error is kept per thread, this one is of the request.
+	AWSError error = (result == NULL) ?
+			_client->getLastError() : AWSE_NoError;
+
+	MutexHolder holder(&_lock);
+	// The objects deleted count even once the deletion has failed.
+	bool canRetry = !_failed && batch.attempt < _params->getMaxRetries();
+	if (result == NULL || !result->getErrorCode().isEmpty()) {
+		if (_failed)
+			return NULL;
+		if (result != NULL && result->isRetryable()) {
+			if (result->getErrorCode() == "SlowDown"
+					|| result->getErrorCode() == "HTTP503") {
+				_result->setThrottledCount(_result->getThrottledCount() + 1);
+				onThrottled(generation);
+			}
+		} else if (result != NULL) {
+			canRetry = false;
+		}
+		if (canRetry)
+			return batch.params;
+		LOGE("Failed to delete a batch of '%s' after %d attempts.",
+				_params->getPrefix().cstr(), batch.attempt + 1);
+		fail(error, result);
+		return NULL;
+	}
+
+	// The keys failed for transient errors are retried as a smaller batch.
+	REF<S3DeleteObjectsParams> retry;
+	bool throttled = false;
+	for (int i = 0; i < result->getFailedKeyCount(); i++) {
+		const String& errorCode = result->getFailedKeyErrorCode(i);
+		if (errorCode == "SlowDown")
+			throttled = true;
+		if (canRetry && S3Result::isRetryableError(errorCode)) {
+			if (retry == NULL)
+				retry = new S3DeleteObjectsParams(_params->getBucketName());
+			retry->addKey(result->getFailedKey(i));
+		} else {
+			_result->addFailedKey(result->getFailedKey(i), errorCode,
+					result->getFailedKeyErrorMessage(i));
+		}
+	}
+	_result->setDeletedCount(
+			_result->getDeletedCount() + batch.params->getKeyCount()
+					- result->getFailedKeyCount());
+	if (throttled) {
+		_result->setThrottledCount(_result->getThrottledCount() + 1);
+		onThrottled(generation);
+	} else {
+		onSucceeded();
+	}
+
+	if (retry == NULL)
+		return NULL;
+	S3DeleteObjectsParams* params = retry;
+	params->autorelease();
+	return params;
+}
+
+bool S3PrefixDeleter::deleteKey(const String& key) {
+	for (int attempt = 0;; attempt++) {
+		REFAutoreleasePool pool;
+		S3DeleteObjectResult* result = _client->deleteObject(
+				_params->getBucketName(), key);
+		AWSError error = (result == NULL) ?
+				_client->getLastError() : AWSE_NoError;
+
+		MutexHolder holder(&_lock);
+		if (_failed)
+			return false;
+		if (result != NULL && result->getErrorCode().isEmpty()) {
+			_result->setDeletedCount(_result->getDeletedCount() + 1);
+			return true;
+		}
+		bool retryable = (result == NULL || result->isRetryable());
+		if (retryable && attempt < _params->getMaxRetries()) {
+			_lock.unlock();
+			Thread::sleep(RETRY_INTERVAL << BFX_MIN(attempt, 5));
+			_lock.lock();
+			continue;
+		}
+		// Only this key is lost, unless no request could be sent at all.
+		if (result == NULL) {
+			LOGE("Failed to delete an object of '%s' after %d attempts.",
+					_params->getPrefix().cstr(), attempt + 1);
+			fail(error, NULL);
+			return false;
+		}
+		_result->addFailedKey(key, result->getErrorCode(),
+				result->getErrorMessage());
+		return true;
+	}
+}
+
+void S3PrefixDeleter::fail(AWSError error, S3Result* result) {
+	if (_failed)
+		return;
+	_failed = true;
+	_error = error;
+	if (result != NULL && !result->getErrorCode().isEmpty()) {
+		_result->setErrorCode(result->getErrorCode());
+		_result->setErrorMessage(result->getErrorMessage());
+		_result->setRequestId(result->getRequestId());
+	}
+	_batchEvent.set();
+	_queueEvent.set();
+}
+
+void S3PrefixDeleter::onThrottled(int generation) {
+	// The requests sent at the limit already halved are throttled alike.
+	if (generation != _generation)
+		return;
+	_limit = BFX_MAX(_limit / 2, 1);
+	_generation++;
+	_successes = 0;
+	LOGI("Throttled, deleting %d batches at once.", _limit);
+}
+
+void S3PrefixDeleter::onSucceeded() {
+	if (_limit >= _params->getConcurrency())
+		return;
+	if (++_successes >= _limit) {
+		_limit++;
+		_successes = 0;
+		_batchEvent.set();
+	}
+}
@@ -0,0 +1,89 @@
+/*
+ * S3PrefixDeleter.h
+ */
+
+#ifndef AWS_S3PREFIXDELETER_H_
+#define AWS_S3PREFIXDELETER_H_
+
+class S3DeleteWorker;
+
+/// Deletes the objects of a bucket whose keys start with a prefix, by
+/// DeleteObjects batches of up to 1000 keys sent at once while the keys are
+/// being listed. The calling thread takes the pages of a paginator, whose
+/// next page is fetched meanwhile, and queues their keys as batches, a few
+/// of them ahead of the threads deleting them.
+///
+/// The number of batches deleted at once adapts to throttling by additive
+/// increase and multiplicative decrease: it is halved when S3 answers
+/// SlowDown, once for the requests sent at the same limit, and raised by one
+/// after as many batches have succeeded as the limit. A throttled batch, and
+/// the keys of a batch which failed for transient errors, are retried after
+/// a backoff. The keys which failed otherwise are collected into the result.
+/// The keys XML can't carry are deleted one by one by the calling thread.
+/// See S3Client::deletePrefix().
+class S3PrefixDeleter: public REFObject {
+public:
+	enum {
+		/// Time in milliseconds to wait before the first retry of a batch,
+		/// doubled for each further one
+		RETRY_INTERVAL = 200,
+	};
+
+	S3PrefixDeleter(S3Client* client, const S3DeletePrefixParams* params);
+	virtual ~S3PrefixDeleter();
+
+	/// Deletes the objects. Returns NULL if a request couldn't be sent, see
+	/// the last error of the client.
+	S3DeletePrefixResult* deletePrefix();
+
+private:
+	friend class S3DeleteWorker;
+
+	struct Batch {
+		REF<S3DeleteObjectsParams> params;
+		int attempt;
+	};
+
+	// Queues a batch of keys, waiting for room. Returns false if the
+	// deletion has failed meanwhile.
+	bool queueBatch(S3DeleteObjectsParams* params);
+	// The loop of each thread deleting batches.
+	void runWorker();
+	// Sends a batch, returns the keys to retry if any, the lock must not be
+	// held.
+	S3DeleteObjectsParams* deleteBatch(Batch& batch, int generation);
+	// Deletes the object of a key which can't be batched, retrying as a
+	// batch does. Returns false if the deletion has failed.
+	bool deleteKey(const String& key);
+	// Ends the deletion, the lock must be held.
+	void fail(AWSError error, S3Result* result);
+	// Adapts the limit to a request throttled or succeeded, the lock must be
+	// held.
+	void onThrottled(int generation);
+	void onSucceeded();
+
+	REF<S3Client> _client;
+	REF<S3DeletePrefixParams> _params;
+
+	Mutex _lock;
+	// Signaled as a batch may be taken, and as the deletion ends.
+	Event _batchEvent;
+	// Signaled as there is room for a batch, and on failure.
+	Event _queueEvent;
+	ArrayListT<Batch> _queue;
+	// The batches queued or being deleted, retries included.
+	int _pending;
+	// The batches being sent, and the most allowed.
+	int _active;
+	int _limit;
+	// The batches succeeded since the limit last changed.
+	int _successes;
+	// Counts the decreases of the limit, to tell the requests sent before.
+	int _generation;
+	bool _listDone;
+	bool _failed;
+	AWSError _error;
+	REF<S3DeletePrefixResult> _result;
+};
+
+#endif /* AWS_S3PREFIXDELETER_H_ */
@@ -0,0 +1,536 @@
+/*
+ * S3Result.cpp
+ */
+
+#include "AWS.h"
+#include "HttpUtils.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+////////////////////////////////////////////////////////////////////////////////
+
+S3ObjectList::S3ObjectList(int capacity) :
+		_text(NULL), _length(0), _capacity(0), _start(0) {
+	BFX_ASSERT(capacity >= 0);
+
+	if (capacity > 0) {
+		_text = new char[capacity];
+		_capacity = capacity;
+	}
+}
+
+S3ObjectList::~S3ObjectList() {
+	delete[] _text;
+}
+
+void S3ObjectList::addObject() {
+	Object object;
+	object.key.offset = object.eTag.offset = -1;
+	object.key.length = object.eTag.length = 0;
+	object.size = 0;
+	object.lastModified = 0;
+	_objects.add(object);
+	_start = _length;
+}
+
+void S3ObjectList::appendText(const char* chars, int length) {
+	// Keeps room for the terminating NUL, which is rarely needed as the
+	// capacity is the size of the response.
+	if (_length + length + 1 > _capacity) {
+		int capacity = BFX_MAX(_capacity * 2, 256);
+		while (capacity < _length + length + 1)
+			capacity *= 2;
+		char* text = new char[capacity];
+		if (_length > 0)
+			memcpy(text, _text, _length);
+		delete[] _text;
+		_text = text;
+		_capacity = capacity;
+	}
+	memcpy(_text + _length, chars, length);
+	_length += length;
+}
+
+void S3ObjectList::endKey() {
+	BFX_ASSERT(getSize() > 0);
+	_objects[getSize() - 1].key = endText();
+}
+
+void S3ObjectList::endETag() {
+	BFX_ASSERT(getSize() > 0);
+	_objects[getSize() - 1].eTag = endText();
+}
+
+void S3ObjectList::decodeKeys() {
+	for (int i = 0; i < getSize(); i++) {
+		Slice& key = _objects[i].key;
+		if (key.offset < 0)
+			continue;
+		key.length = HttpUtils::urlDecode(_text + key.offset, key.length);
+		_text[key.offset + key.length] = 0;
+	}
+}
+
+S3ObjectList::Slice S3ObjectList::endText() {
+	Slice slice;
+	slice.offset = _start;
+	slice.length = _length - _start;
+	appendText("", 0);
+	_text[_length++] = 0;
+	_start = _length;
+	return slice;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// The elements of the S3 responses, by their indexes in s3ElementNames.
+enum S3Element {
+	E_Error,
+	E_Code,
+	E_Message,
+	E_RequestId,
+	E_InitiateMultipartUploadResult,
+	E_UploadId,
+	E_CompleteMultipartUploadResult,
+	E_Location,
+	E_ETag,
+	E_DeleteResult,
+	E_Deleted,
+	E_Key,
+	E_ListBucketResult,
+	E_Contents,
+	E_Size,
+	E_LastModified,
+	E_CommonPrefixes,
+	E_Prefix,
+	E_IsTruncated,
+	E_NextContinuationToken,
+	E_EncodingType,
+	E_Count
+};
+
+static const char* const s3ElementNames[] = {
+	"Error",
+	"Code",
+	"Message",
+	"RequestId",
+	"InitiateMultipartUploadResult",
+	"UploadId",
+	"CompleteMultipartUploadResult",
+	"Location",
+	"ETag",
+	"DeleteResult",
+	"Deleted",
+	"Key",
+	"ListBucketResult",
+	"Contents",
+	"Size",
+	"LastModified",
+	"CommonPrefixes",
+	"Prefix",
+	"IsTruncated",
+	"NextContinuationToken",
+	"EncodingType",
+};
+
+typedef char S3ElementNamesCheck[
+		(sizeof(s3ElementNames) / sizeof(s3ElementNames[0]) == E_Count) ?
+				1 : -1];
+
+static const AWSElementTable s3Elements(s3ElementNames, E_Count);
+
+#define S3_RULE_COUNT(rules)	((int) (sizeof(rules) / sizeof(rules[0])))
+
+// The rules of the error responses, which S3 sends with a status of 200 too,
+// e.g. on CompleteMultipartUpload.
+static const AWSElementRule commonRules[] = {
+	{ AWSElementRule::ROOT, E_Error, NULL, NULL, NULL },
+	{ E_Error, E_Code, NULL,
+			&AWSElementRule::setBy<S3Result, &S3Result::setErrorCode>, NULL },
+	{ E_Error, E_Message, NULL,
+			&AWSElementRule::setBy<S3Result, &S3Result::setErrorMessage>, NULL },
+	{ E_Error, E_RequestId, NULL,
+			&AWSElementRule::setBy<S3Result, &S3Result::setRequestId>, NULL },
+};
+
+#define S3_RULE_SET(name, rules)	\
+	static const AWSElementRuleSet name(&s3Elements, rules,	\
+			S3_RULE_COUNT(rules), commonRules, S3_RULE_COUNT(commonRules))
+
+////////////////////////////////////////////////////////////////////////////////
+
+// The responses without a body but on error.
+static const AWSElementRuleSet errorRuleSet(&s3Elements, NULL, 0, commonRules,
+		S3_RULE_COUNT(commonRules));
+
+bool S3ResultUnmarshaller::unmarshaller(AWSHttpResponse* response,
+		S3Result* result) {
+	return parse(response->getContent(), result);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+S3PutObjectResultUnmarshaller::S3PutObjectResultUnmarshaller() :
+		S3ResultUnmarshaller(&errorRuleSet) {
+}
+
+S3PutObjectResult* S3PutObjectResultUnmarshaller::unmarshall(
+		AWSHttpResponse* response) {
+	REF<S3PutObjectResult> result = new S3PutObjectResult();
+	if (unmarshaller(response, result)) {
+		result->setETag(response->getHeader("ETag"));
+		result->autorelease();
+	} else {
+		result = NULL;
+	}
+
+	return result;
+}
+
+S3GetObjectResultUnmarshaller::S3GetObjectResultUnmarshaller() :
+		S3ResultUnmarshaller(&errorRuleSet) {
+}
+
+S3GetObjectResult* S3GetObjectResultUnmarshaller::unmarshall(
+		AWSHttpResponse* response) {
+	REF<S3GetObjectResult> result = new S3GetObjectResult();
+	// The body of a successful response is the object data, only errors are
+	// in XML.
+	if (response->getStatusCode() / 100 == 2) {
+		result->setContent(response->getContent());
+		result->setContentType(response->getHeader("Content-Type"));
+		result->setETag(response->getHeader("ETag"));
+		result->autorelease();
+	} else if (unmarshaller(response, result)) {
+		// Tells the error from an empty object, even without error details.
+		if (result->getErrorCode().isEmpty()) {
+			result->setErrorCode(
+					String::format("HTTP%d", response->getStatusCode()));
+		}
+		result->autorelease();
+	} else {
+		result = NULL;
+	}
+
+	return result;
+}
+
+S3HeadObjectResultUnmarshaller::S3HeadObjectResultUnmarshaller() :
+		S3ResultUnmarshaller(&errorRuleSet) {
+}
+
+S3HeadObjectResult* S3HeadObjectResultUnmarshaller::unmarshall(
+		AWSHttpResponse* response) {
+	REF<S3HeadObjectResult> result = new S3HeadObjectResult();
+	// A response to HEAD has no body, not even on error.
+	if (response->getStatusCode() / 100 == 2) {
+		result->setContentLength(
+				strtoll(response->getHeader("Content-Length").cstr(), NULL,
+						10));
+		result->setContentType(response->getHeader("Content-Type"));
+		result->setETag(response->getHeader("ETag"));
+	} else {
+		result->setErrorCode(
+				String::format("HTTP%d", response->getStatusCode()));
+		result->setRequestId(response->getHeader("x-amz-request-id"));
+	}
+	result->autorelease();
+	return result;
+}
+
+static const AWSElementRule createMultipartUploadRules[] = {
+	{ AWSElementRule::ROOT, E_InitiateMultipartUploadResult, NULL, NULL,
+			NULL },
+	{ E_InitiateMultipartUploadResult, E_UploadId, NULL,
+			&AWSElementRule::setBy<S3CreateMultipartUploadResult,
+					&S3CreateMultipartUploadResult::setUploadId>, NULL },
+};
+S3_RULE_SET(createMultipartUploadRuleSet, createMultipartUploadRules);
+
+S3CreateMultipartUploadResultUnmarshaller::S3CreateMultipartUploadResultUnmarshaller() :
+		S3ResultUnmarshaller(&createMultipartUploadRuleSet) {
+}
+
+S3CreateMultipartUploadResult* S3CreateMultipartUploadResultUnmarshaller::unmarshall(
+		AWSHttpResponse* response) {
+	REF<S3CreateMultipartUploadResult> result =
+			new S3CreateMultipartUploadResult();
+	if (unmarshaller(response, result))
+		result->autorelease();
+	else
+		result = NULL;
+
+	return result;
+}
+
+S3UploadPartResultUnmarshaller::S3UploadPartResultUnmarshaller() :
+		S3ResultUnmarshaller(&errorRuleSet) {
+}
+
+S3UploadPartResult* S3UploadPartResultUnmarshaller::unmarshall(
+		AWSHttpResponse* response) {
+	REF<S3UploadPartResult> result = new S3UploadPartResult();
+	if (unmarshaller(response, result)) {
+		result->setETag(response->getHeader("ETag"));
+		result->setChecksumCRC32C(response->getHeader("x-amz-checksum-crc32c"));
+		if (result->getErrorCode().isEmpty()
+				&& response->getStatusCode() / 100 != 2) {
+			result->setErrorCode(
+					String::format("HTTP%d", response->getStatusCode()));
+		}
+		result->autorelease();
+	} else {
+		result = NULL;
+	}
+
+	return result;
+}
+
+static const AWSElementRule completeMultipartUploadRules[] = {
+	{ AWSElementRule::ROOT, E_CompleteMultipartUploadResult, NULL, NULL,
+			NULL },
+	{ E_CompleteMultipartUploadResult, E_Location, NULL,
+			&AWSElementRule::setBy<S3CompleteMultipartUploadResult,
+					&S3CompleteMultipartUploadResult::setLocation>, NULL },
+	{ E_CompleteMultipartUploadResult, E_ETag, NULL,
+			&AWSElementRule::setBy<S3CompleteMultipartUploadResult,
+					&S3CompleteMultipartUploadResult::setETag>, NULL },
+};
+S3_RULE_SET(completeMultipartUploadRuleSet, completeMultipartUploadRules);
+
+S3CompleteMultipartUploadResultUnmarshaller::S3CompleteMultipartUploadResultUnmarshaller() :
+		S3ResultUnmarshaller(&completeMultipartUploadRuleSet) {
+}
+
+S3CompleteMultipartUploadResult* S3CompleteMultipartUploadResultUnmarshaller::unmarshall(
+		AWSHttpResponse* response) {
+	REF<S3CompleteMultipartUploadResult> result =
+			new S3CompleteMultipartUploadResult();
+	if (unmarshaller(response, result))
+		result->autorelease();
+	else
+		result = NULL;
+
+	return result;
+}
+
+S3AbortMultipartUploadResultUnmarshaller::S3AbortMultipartUploadResultUnmarshaller() :
+		S3ResultUnmarshaller(&errorRuleSet) {
+}
+
+S3AbortMultipartUploadResult* S3AbortMultipartUploadResultUnmarshaller::unmarshall(
+		AWSHttpResponse* response) {
+	REF<S3AbortMultipartUploadResult> result =
+			new S3AbortMultipartUploadResult();
+	if (unmarshaller(response, result))
+		result->autorelease();
+	else
+		result = NULL;
+
+	return result;
+}
+
+S3DeleteObjectResultUnmarshaller::S3DeleteObjectResultUnmarshaller() :
+		S3ResultUnmarshaller(&errorRuleSet) {
+}
+
+S3DeleteObjectResult* S3DeleteObjectResultUnmarshaller::unmarshall(
+		AWSHttpResponse* response) {
+	REF<S3DeleteObjectResult> result = new S3DeleteObjectResult();
+	if (unmarshaller(response, result))
+		result->autorelease();
+	else
+		result = NULL;
+
+	return result;
+}
+
+// A key deleted, or one failed to be deleted. The errors of the keys are
+// results of their own, so that the common rules fill them in as they do the
+// error of a response, which is then copied to the result.
+struct S3DeletedKey: REFObject {
+	String key;
+};
+
+struct S3KeyError: S3Result {
+	String key;
+};
+
+static REFObject* openDeletedKey(REFObject* target) {
+	return new S3DeletedKey();
+}
+
+static void closeDeletedKey(REFObject* target, REFObject* parentTarget) {
+	static_cast<S3DeleteObjectsResult*>(parentTarget)->addDeletedKey(
+			static_cast<S3DeletedKey*>(target)->key);
+}
+
+static REFObject* openKeyError(REFObject* target) {
+	return new S3KeyError();
+}
+
+static void closeKeyError(REFObject* target, REFObject* parentTarget) {
+	S3KeyError* error = static_cast<S3KeyError*>(target);
+	static_cast<S3DeleteObjectsResult*>(parentTarget)->addFailedKey(
+			error->key, error->getErrorCode(), error->getErrorMessage());
+}
+
+static void closeResponseError(REFObject* target, REFObject* parentTarget) {
+	S3KeyError* error = static_cast<S3KeyError*>(target);
+	S3Result* result = static_cast<S3Result*>(parentTarget);
+	result->setErrorCode(error->getErrorCode());
+	result->setErrorMessage(error->getErrorMessage());
+	result->setRequestId(error->getRequestId());
+}
+
+// Every Error is read as the one of a key, the Key of an error response
+// having nowhere else to go.
+static const AWSElementRule deleteObjectsRules[] = {
+	{ AWSElementRule::ROOT, E_Error, &openKeyError, NULL,
+			&closeResponseError },
+	{ AWSElementRule::ROOT, E_DeleteResult, NULL, NULL, NULL },
+	{ E_DeleteResult, E_Deleted, &openDeletedKey, NULL, &closeDeletedKey },
+	{ E_Deleted, E_Key, NULL,
+			&AWSElementRule::setField<S3DeletedKey, &S3DeletedKey::key>, NULL },
+	{ E_DeleteResult, E_Error, &openKeyError, NULL, &closeKeyError },
+	{ E_Error, E_Key, NULL,
+			&AWSElementRule::setField<S3KeyError, &S3KeyError::key>, NULL },
+};
+S3_RULE_SET(deleteObjectsRuleSet, deleteObjectsRules);
+
+S3DeleteObjectsResultUnmarshaller::S3DeleteObjectsResultUnmarshaller() :
+		S3ResultUnmarshaller(&deleteObjectsRuleSet) {
+}
+
+S3DeleteObjectsResult* S3DeleteObjectsResultUnmarshaller::unmarshall(
+		AWSHttpResponse* response) {
+	REF<S3DeleteObjectsResult> result = new S3DeleteObjectsResult();
+	if (unmarshaller(response, result)) {
+		// e.g. a 503 without a body.
+		if (result->getErrorCode().isEmpty()
+				&& response->getStatusCode() / 100 != 2) {
+			result->setErrorCode(
+					String::format("HTTP%d", response->getStatusCode()));
+		}
+		result->autorelease();
+	} else {
+		result = NULL;
+	}
+
+	return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// The page being parsed, which tells its unmarshaller of the token of the
+// next one, and whether the keys are URL encoded.
+class S3ListObjectsV2Page: public S3ListObjectsV2Result {
+public:
+	S3ListObjectsV2Page(S3ListObjectsV2ResultUnmarshaller* owner) :
+			unmarshaller(owner), urlEncoded(false) {
+	}
+
+	static void closeNextContinuationToken(REFObject* target,
+			REFObject* parentTarget) {
+		S3ListObjectsV2Page* page = static_cast<S3ListObjectsV2Page*>(target);
+		page->unmarshaller->onNextContinuationToken(
+				page->getNextContinuationToken());
+	}
+
+	S3ListObjectsV2ResultUnmarshaller* unmarshaller;
+	bool urlEncoded;
+};
+
+// The objects of the page are the target of the elements of Contents, their
+// keys and ETags are appended to the list as they are parsed.
+
+static REFObject* openObject(REFObject* target) {
+	S3ObjectList* objects =
+			static_cast<S3ListObjectsV2Result*>(target)->getObjects();
+	objects->addObject();
+	return objects;
+}
+
+static void appendObjectText(REFObject* target, const char* chars,
+		int numChars) {
+	static_cast<S3ObjectList*>(target)->appendText(chars, numChars);
+}
+
+static void closeObjectKey(REFObject* target, REFObject* parentTarget) {
+	static_cast<S3ObjectList*>(target)->endKey();
+}
+
+static void closeObjectETag(REFObject* target, REFObject* parentTarget) {
+	static_cast<S3ObjectList*>(target)->endETag();
+}
+
+static void setObjectSize(REFObject* target, const String& value) {
+	static_cast<S3ObjectList*>(target)->setObjectSize(
+			strtoll(value.cstr(), NULL, 10));
+}
+
+static void setObjectLastModified(REFObject* target, const String& value) {
+	DateTime lastModified;
+	if (lastModified.parseISO8601(value.cstr(), value.getLength())) {
+		static_cast<S3ObjectList*>(target)->setLastModified(
+				(int64_t) lastModified.getMillisecndsSince1970());
+	}
+}
+
+static void addCommonPrefix(REFObject* target, const String& value) {
+	static_cast<S3ListObjectsV2Result*>(target)->getCommonPrefixes()->addLast(
+			value);
+}
+
+static void setTruncated(REFObject* target, const String& value) {
+	static_cast<S3ListObjectsV2Result*>(target)->setTruncated(value == "true");
+}
+
+static void setEncodingType(REFObject* target, const String& value) {
+	static_cast<S3ListObjectsV2Page*>(target)->urlEncoded = (value == "url");
+}
+
+static const AWSElementRule listObjectsV2Rules[] = {
+	{ AWSElementRule::ROOT, E_ListBucketResult, NULL, NULL, NULL, NULL },
+	{ E_ListBucketResult, E_Contents, &openObject, NULL, NULL, NULL },
+	{ E_Contents, E_Key, NULL, NULL, &closeObjectKey, &appendObjectText },
+	{ E_Contents, E_ETag, NULL, NULL, &closeObjectETag, &appendObjectText },
+	{ E_Contents, E_Size, NULL, &setObjectSize, NULL, NULL },
+	{ E_Contents, E_LastModified, NULL, &setObjectLastModified, NULL, NULL },
+	{ E_ListBucketResult, E_CommonPrefixes, NULL, NULL, NULL, NULL },
+	{ E_CommonPrefixes, E_Prefix, NULL, &addCommonPrefix, NULL, NULL },
+	{ E_ListBucketResult, E_IsTruncated, NULL, &setTruncated, NULL, NULL },
+	{ E_ListBucketResult, E_NextContinuationToken, NULL,
+			&AWSElementRule::setBy<S3ListObjectsV2Result,
+					&S3ListObjectsV2Result::setNextContinuationToken>,
+			&S3ListObjectsV2Page::closeNextContinuationToken, NULL },
+	{ E_ListBucketResult, E_EncodingType, NULL, &setEncodingType, NULL, NULL },
+};
+S3_RULE_SET(listObjectsV2RuleSet, listObjectsV2Rules);
+
+S3ListObjectsV2ResultUnmarshaller::S3ListObjectsV2ResultUnmarshaller() :
+		S3ResultUnmarshaller(&listObjectsV2RuleSet) {
+}
+
+S3ListObjectsV2Result* S3ListObjectsV2ResultUnmarshaller::unmarshall(
+		AWSHttpResponse* response) {
+	REF<S3ListObjectsV2Page> result = new S3ListObjectsV2Page(this);
+	// The keys and the ETags are never longer than the response.
+	String content = response->getContent();
+	result->setObjects(new S3ObjectList(content.getLength() + 1));
+	bool parsed = parse(content, result);
+	result->unmarshaller = NULL;
+	if (parsed && result->urlEncoded) {
+		result->getObjects()->decodeKeys();
+		AWSStringList* prefixes = result->getCommonPrefixes();
+		for (AWSStringList::PENTRY entry = prefixes->getFirstEntry();
+				entry != NULL; entry = prefixes->getNextEntry(entry))
+			prefixes->setAt(entry, HttpUtils::urlDecode(entry->value));
+	}
+	if (!parsed)
+		return NULL;
+
+	result->autorelease();
+	return result;
+}
@@ -0,0 +1,642 @@
+/*
+ * S3Result.h
+ */
+
+#ifndef AWS_S3RESULT_H_
+#define AWS_S3RESULT_H_
+
+#include "AWSResult.h"
+
+class AWSHttpResponse;
+
+class S3Result: public AWSResult {
+public:
+	S3Result() {
+	}
+	virtual ~S3Result() {
+	}
+
+	const String& getErrorCode() const {
+		return _errorCode;
+	}
+	const String& getErrorMessage() const {
+		return _errorMessage;
+	}
+	const String& getRequestId() const {
+		return _requestId;
+	}
+	void setErrorCode(const String& errorCode) {
+		_errorCode = errorCode;
+	}
+	void setErrorMessage(const String& errorMessage) {
+		_errorMessage = errorMessage;
+	}
+	void setRequestId(const String& requestId) {
+		_requestId = requestId;
+	}
+	/// Gets a value indicating whether the error is transient, e.g. SlowDown
+	/// or a status of 5xx, so that the request may be retried.
+	bool isRetryable() const {
+		return isRetryableError(_errorCode);
+	}
+	/// Gets a value indicating whether given error code is transient, e.g.
+	/// the one of a key DeleteObjects failed to delete.
+	static bool isRetryableError(const String& errorCode) {
+		return errorCode == "InternalError" || errorCode == "SlowDown"
+				|| errorCode == "ServiceUnavailable"
+				|| errorCode == "RequestTimeout"
+				|| errorCode.startsWith("HTTP5");
+	}
+
+protected:
+	String _errorCode;
+	String _errorMessage;
+	String _requestId;
+};
+
+/// The result contains the ETag header on PutObject.
+class S3PutObjectResult: public S3Result {
+public:
+	S3PutObjectResult() {
+	}
+	virtual ~S3PutObjectResult() {
+	}
+	/// Gets the entity tag of the uploaded object.
+	const String& getETag() const {
+		return _eTag;
+	}
+	void setETag(const String& eTag) {
+		_eTag = eTag;
+	}
+private:
+	String _eTag;
+};
+
+/// The result contains the data of the object on GetObject.
+class S3GetObjectResult: public S3Result {
+public:
+	S3GetObjectResult() {
+	}
+	virtual ~S3GetObjectResult() {
+	}
+	/// Gets the data of the object, which may be binary.
+	const String& getContent() const {
+		return _content;
+	}
+	void setContent(const String& content) {
+		_content = content;
+	}
+	/// Gets the standard MIME type of the object data.
+	const String& getContentType() const {
+		return _contentType;
+	}
+	void setContentType(const String& contentType) {
+		_contentType = contentType;
+	}
+	/// Gets the entity tag of the object.
+	const String& getETag() const {
+		return _eTag;
+	}
+	void setETag(const String& eTag) {
+		_eTag = eTag;
+	}
+private:
+	String _content;
+	String _contentType;
+	String _eTag;
+};
+
+/// The result contains the headers describing an object on HeadObject.
+class S3HeadObjectResult: public S3Result {
+public:
+	S3HeadObjectResult() {
+		_contentLength = 0;
+	}
+	virtual ~S3HeadObjectResult() {
+	}
+	/// Gets the size of the object in bytes.
+	int64_t getContentLength() const {
+		return _contentLength;
+	}
+	void setContentLength(int64_t contentLength) {
+		_contentLength = contentLength;
+	}
+	/// Gets the standard MIME type of the object data.
+	const String& getContentType() const {
+		return _contentType;
+	}
+	void setContentType(const String& contentType) {
+		_contentType = contentType;
+	}
+	/// Gets the entity tag of the object.
+	const String& getETag() const {
+		return _eTag;
+	}
+	void setETag(const String& eTag) {
+		_eTag = eTag;
+	}
+private:
+	int64_t _contentLength;
+	String _contentType;
+	String _eTag;
+};
+
+/// The result of S3Client::downloadParallel(), which tells the parts written
+/// so far, to resume the download from if it is not complete.
+class S3DownloadResult: public S3Result {
+public:
+	S3DownloadResult(const String& eTag, int64_t objectSize, int partSize) {
+		BFX_ASSERT(objectSize >= 0 && partSize > 0);
+		_eTag = eTag;
+		_objectSize = objectSize;
+		_partSize = partSize;
+		_completedBytes = 0;
+		int count = (int) ((objectSize + partSize - 1) / partSize);
+		for (int i = 0; i < count; i++)
+			_completedParts.add(false);
+	}
+	virtual ~S3DownloadResult() {
+	}
+	/// Gets the entity tag of the object downloaded.
+	const String& getETag() const {
+		return _eTag;
+	}
+	/// Gets the size of the object in bytes.
+	int64_t getObjectSize() const {
+		return _objectSize;
+	}
+	int getPartSize() const {
+		return _partSize;
+	}
+	int getPartCount() const {
+		return _completedParts.getSize();
+	}
+	/// Gets the number of bytes of a part.
+	int getPartLength(int index) const {
+		BFX_ASSERT(index >= 0 && index < getPartCount());
+		return (int) BFX_MIN((int64_t ) _partSize,
+				_objectSize - (int64_t) index * _partSize);
+	}
+	/// Gets a value indicating whether a part has been written to the sink.
+	bool isPartCompleted(int index) const {
+		return _completedParts[index];
+	}
+	void setPartCompleted(int index) {
+		if (!_completedParts[index]) {
+			_completedParts[index] = true;
+			_completedBytes += getPartLength(index);
+		}
+	}
+	/// Gets the number of bytes written to the sink.
+	int64_t getCompletedBytes() const {
+		return _completedBytes;
+	}
+	/// Gets a value indicating whether the whole object has been written.
+	bool isComplete() const {
+		return _errorCode.isEmpty() && _completedBytes == _objectSize;
+	}
+private:
+	String _eTag;
+	int64_t _objectSize;
+	int _partSize;
+	ArrayListT<bool> _completedParts;
+	int64_t _completedBytes;
+};
+
+/// The result contains the ID of the upload on CreateMultipartUpload.
+class S3CreateMultipartUploadResult: public S3Result {
+public:
+	S3CreateMultipartUploadResult() {
+	}
+	virtual ~S3CreateMultipartUploadResult() {
+	}
+	/// Gets the ID the parts of the upload are sent with.
+	const String& getUploadId() const {
+		return _uploadId;
+	}
+	void setUploadId(const String& uploadId) {
+		_uploadId = uploadId;
+	}
+private:
+	String _uploadId;
+};
+
+/// The result contains the ETag header on UploadPart.
+class S3UploadPartResult: public S3Result {
+public:
+	S3UploadPartResult() {
+	}
+	virtual ~S3UploadPartResult() {
+	}
+	/// Gets the entity tag of the part, to complete the upload with.
+	const String& getETag() const {
+		return _eTag;
+	}
+	void setETag(const String& eTag) {
+		_eTag = eTag;
+	}
+	/// Gets the CRC-32C checksum S3 computed of the part, if it was sent
+	/// with one.
+	const String& getChecksumCRC32C() const {
+		return _checksumCRC32C;
+	}
+	void setChecksumCRC32C(const String& checksumCRC32C) {
+		_checksumCRC32C = checksumCRC32C;
+	}
+private:
+	String _eTag;
+	String _checksumCRC32C;
+};
+
+/// The result contains the object assembled on CompleteMultipartUpload.
+class S3CompleteMultipartUploadResult: public S3Result {
+public:
+	S3CompleteMultipartUploadResult() {
+	}
+	virtual ~S3CompleteMultipartUploadResult() {
+	}
+	/// Gets the URI of the object.
+	const String& getLocation() const {
+		return _location;
+	}
+	void setLocation(const String& location) {
+		_location = location;
+	}
+	/// Gets the entity tag of the object.
+	const String& getETag() const {
+		return _eTag;
+	}
+	void setETag(const String& eTag) {
+		_eTag = eTag;
+	}
+private:
+	String _location;
+	String _eTag;
+};
+
+/// The result has no element on AbortMultipartUpload.
+class S3AbortMultipartUploadResult: public S3Result {
+public:
+	S3AbortMultipartUploadResult() {
+	}
+	virtual ~S3AbortMultipartUploadResult() {
+	}
+};
+
+/// The result of S3Client::uploadMultipart().
+class S3UploadResult: public S3Result {
+public:
+	S3UploadResult() {
+		_partCount = 0;
+		_size = 0;
+	}
+	virtual ~S3UploadResult() {
+	}
+	/// Gets the entity tag of the object.
+	const String& getETag() const {
+		return _eTag;
+	}
+	void setETag(const String& eTag) {
+		_eTag = eTag;
+	}
+	/// Gets the ID of the multipart upload, empty if the source fit in a
+	/// single PutObject.
+	const String& getUploadId() const {
+		return _uploadId;
+	}
+	void setUploadId(const String& uploadId) {
+		_uploadId = uploadId;
+	}
+	/// Gets the number of parts uploaded.
+	int getPartCount() const {
+		return _partCount;
+	}
+	void setPartCount(int partCount) {
+		_partCount = partCount;
+	}
+	/// Gets the number of bytes read from the source.
+	int64_t getSize() const {
+		return _size;
+	}
+	void setSize(int64_t size) {
+		_size = size;
+	}
+private:
+	String _eTag;
+	String _uploadId;
+	int _partCount;
+	int64_t _size;
+};
+
+/// The result has no element on DeleteObject.
+class S3DeleteObjectResult: public S3Result {
+public:
+	S3DeleteObjectResult() {
+	}
+	virtual ~S3DeleteObjectResult() {
+	}
+};
+
+/// The keys of the objects which failed to be deleted, along with their
+/// errors, e.g. AccessDenied.
+class S3FailedKeyList {
+public:
+	int getFailedKeyCount() const {
+		return _failedKeys.getSize();
+	}
+	const String& getFailedKey(int index) const {
+		return _failedKeys[index].key;
+	}
+	const String& getFailedKeyErrorCode(int index) const {
+		return _failedKeys[index].errorCode;
+	}
+	const String& getFailedKeyErrorMessage(int index) const {
+		return _failedKeys[index].errorMessage;
+	}
+	void addFailedKey(const String& key, const String& errorCode,
+			const String& errorMessage) {
+		FailedKey failedKey;
+		failedKey.key = key;
+		failedKey.errorCode = errorCode;
+		failedKey.errorMessage = errorMessage;
+		_failedKeys.add(failedKey);
+	}
+
+private:
+	struct FailedKey {
+		String key;
+		String errorCode;
+		String errorMessage;
+	};
+
+	ArrayListT<FailedKey> _failedKeys;
+};
+
+/// The result contains the keys deleted, unless the request is quiet, and
+/// the keys failed to be deleted on DeleteObjects. A key may fail while the
+/// others are deleted, so that the result has no error code of its own.
+class S3DeleteObjectsResult: public S3Result, public S3FailedKeyList {
+public:
+	S3DeleteObjectsResult() {
+	}
+	virtual ~S3DeleteObjectsResult() {
+	}
+	int getDeletedCount() const {
+		return _deletedKeys.getSize();
+	}
+	const String& getDeletedKey(int index) const {
+		return _deletedKeys[index];
+	}
+	void addDeletedKey(const String& key) {
+		_deletedKeys.add(key);
+	}
+private:
+	ArrayListT<String> _deletedKeys;
+};
+
+/// The result of S3Client::deletePrefix(), which tells the number of objects
+/// deleted and the keys failed to be deleted. The error code is set if S3
+/// failed the listing or a whole batch, which ends the deletion.
+class S3DeletePrefixResult: public S3Result, public S3FailedKeyList {
+public:
+	S3DeletePrefixResult() {
+		_deletedCount = 0;
+		_throttledCount = 0;
+	}
+	virtual ~S3DeletePrefixResult() {
+	}
+	/// Gets the number of objects deleted.
+	int64_t getDeletedCount() const {
+		return _deletedCount;
+	}
+	void setDeletedCount(int64_t deletedCount) {
+		_deletedCount = deletedCount;
+	}
+	/// Gets the number of requests S3 throttled, wholly or for some of their
+	/// keys.
+	int getThrottledCount() const {
+		return _throttledCount;
+	}
+	void setThrottledCount(int throttledCount) {
+		_throttledCount = throttledCount;
+	}
+private:
+	int64_t _deletedCount;
+	int _throttledCount;
+};
+
+/// The objects of a ListObjectsV2 page held in one text buffer, as a compact
+/// alternative to an object per entry: the key and the ETag are
+/// NUL-terminated slices of the buffer, the size and the modification time
+/// are numbers. The buffer is sized by the response up front, so that a page
+/// takes the same few allocations whatever the number of keys.
+class S3ObjectList: public REFObject {
+public:
+	/// Reserves given number of characters for the keys and the ETags.
+	S3ObjectList(int capacity = 0);
+	virtual ~S3ObjectList();
+
+	int getSize() const {
+		return _objects.getSize();
+	}
+	/// Gets the key of an object. The text belongs to the list.
+	const char* getKey(int index) const {
+		return getText(_objects[index].key);
+	}
+	int getKeyLength(int index) const {
+		return _objects[index].key.length;
+	}
+	/// Gets the entity tag of an object, quotes included.
+	const char* getETag(int index) const {
+		return getText(_objects[index].eTag);
+	}
+	/// Gets the size of an object in bytes.
+	int64_t getObjectSize(int index) const {
+		return _objects[index].size;
+	}
+	/// Gets the time an object was last modified, in milliseconds since
+	/// January 1, 1970 UTC.
+	int64_t getLastModified(int index) const {
+		return _objects[index].lastModified;
+	}
+
+	/// Starts an object, the fields to come belong to it.
+	void addObject();
+	/// Appends the text of the key or of the ETag being parsed.
+	void appendText(const char* chars, int length);
+	/// Ends the key or the ETag being parsed, with the text appended since
+	/// the last end.
+	void endKey();
+	void endETag();
+	/// Decodes the keys S3 sent URL encoded, in place.
+	void decodeKeys();
+	void setObjectSize(int64_t size) {
+		BFX_ASSERT(getSize() > 0);
+		_objects[getSize() - 1].size = size;
+	}
+	void setLastModified(int64_t lastModified) {
+		BFX_ASSERT(getSize() > 0);
+		_objects[getSize() - 1].lastModified = lastModified;
+	}
+
+private:
+	struct Slice {
+		int offset;
+		int length;
+	};
+	struct Object {
+		Slice key;
+		Slice eTag;
+		int64_t size;
+		int64_t lastModified;
+	};
+
+	const char* getText(const Slice& slice) const {
+		return (slice.offset >= 0) ? (_text + slice.offset) : "";
+	}
+	// Ends the text being parsed, NUL-terminated, and returns its slice.
+	Slice endText();
+
+	char* _text;
+	int _length;
+	int _capacity;
+	// The offset the text being parsed starts at.
+	int _start;
+	ArrayListT<Object> _objects;
+};
+
+/// The result contains a page of the objects of a bucket on ListObjectsV2.
+class S3ListObjectsV2Result: public S3Result {
+public:
+	S3ListObjectsV2Result() {
+		_truncated = false;
+	}
+	virtual ~S3ListObjectsV2Result() {
+	}
+	/// Gets the objects of the page.
+	S3ObjectList* getObjects() const {
+		if (_objects == NULL)
+			const_cast<S3ListObjectsV2Result*>(this)->_objects =
+					new S3ObjectList();
+		return _objects;
+	}
+	void setObjects(S3ObjectList* objects) {
+		_objects = objects;
+	}
+	/// Gets the prefixes the keys are rolled up into, if a delimiter is
+	/// given.
+	AWSStringList* getCommonPrefixes() const {
+		if (_commonPrefixes == NULL)
+			const_cast<S3ListObjectsV2Result*>(this)->_commonPrefixes =
+					new AWSStringList();
+		return _commonPrefixes;
+	}
+	/// Gets a value indicating whether more pages follow.
+	bool isTruncated() const {
+		return _truncated;
+	}
+	void setTruncated(bool truncated) {
+		_truncated = truncated;
+	}
+	/// Gets the token to list the next page by.
+	const String& getNextContinuationToken() const {
+		return _nextContinuationToken;
+	}
+	void setNextContinuationToken(const String& nextContinuationToken) {
+		_nextContinuationToken = nextContinuationToken;
+	}
+private:
+	REF<S3ObjectList> _objects;
+	REF<AWSStringList> _commonPrefixes;
+	bool _truncated;
+	String _nextContinuationToken;
+};
+
+class S3ResultUnmarshaller: public AWSRuleResultUnmarshaller {
+public:
+	S3ResultUnmarshaller(const AWSElementRuleSet* rules) :
+			AWSRuleResultUnmarshaller(rules) {
+	}
+	virtual ~S3ResultUnmarshaller() {
+	}
+
+protected:
+	bool unmarshaller(AWSHttpResponse* response, S3Result* result);
+};
+
+class S3PutObjectResultUnmarshaller: public S3ResultUnmarshaller {
+public:
+	S3PutObjectResultUnmarshaller();
+	S3PutObjectResult* unmarshall(AWSHttpResponse* response);
+};
+
+class S3GetObjectResultUnmarshaller: public S3ResultUnmarshaller {
+public:
+	S3GetObjectResultUnmarshaller();
+	S3GetObjectResult* unmarshall(AWSHttpResponse* response);
+};
+
+class S3HeadObjectResultUnmarshaller: public S3ResultUnmarshaller {
+public:
+	S3HeadObjectResultUnmarshaller();
+	S3HeadObjectResult* unmarshall(AWSHttpResponse* response);
+};
+
+/// Reads the keys deleted and the errors of the keys failed to be deleted,
+/// which S3 sends as Error elements within DeleteResult, rather than as the
+/// error of the response.
+class S3DeleteObjectsResultUnmarshaller: public S3ResultUnmarshaller {
+public:
+	S3DeleteObjectsResultUnmarshaller();
+	S3DeleteObjectsResult* unmarshall(AWSHttpResponse* response);
+};
+
+class S3CreateMultipartUploadResultUnmarshaller: public S3ResultUnmarshaller {
+public:
+	S3CreateMultipartUploadResultUnmarshaller();
+	S3CreateMultipartUploadResult* unmarshall(AWSHttpResponse* response);
+};
+
+class S3UploadPartResultUnmarshaller: public S3ResultUnmarshaller {
+public:
+	S3UploadPartResultUnmarshaller();
+	S3UploadPartResult* unmarshall(AWSHttpResponse* response);
+};
+
+/// S3 may fail the completion after responding 200, the error is then in
+/// the body.
+class S3CompleteMultipartUploadResultUnmarshaller: public S3ResultUnmarshaller {
+public:
+	S3CompleteMultipartUploadResultUnmarshaller();
+	S3CompleteMultipartUploadResult* unmarshall(AWSHttpResponse* response);
+};
+
+class S3AbortMultipartUploadResultUnmarshaller: public S3ResultUnmarshaller {
+public:
+	S3AbortMultipartUploadResultUnmarshaller();
+	S3AbortMultipartUploadResult* unmarshall(AWSHttpResponse* response);
+};
+
+class S3DeleteObjectResultUnmarshaller: public S3ResultUnmarshaller {
+public:
+	S3DeleteObjectResultUnmarshaller();
+	S3DeleteObjectResult* unmarshall(AWSHttpResponse* response);
+};
+
+/// Unmarshalls a ListObjectsV2 page by rules, straight into an S3ObjectList.
+class S3ListObjectsV2ResultUnmarshaller: public S3ResultUnmarshaller {
+public:
+	S3ListObjectsV2ResultUnmarshaller();
+	S3ListObjectsV2Result* unmarshall(AWSHttpResponse* response);
+
+protected:
+	/// Called as soon as the token of the next page has been parsed, which
+	/// S3 sends ahead of the objects of the page.
+	virtual void onNextContinuationToken(const String& token) {
+	}
+
+private:
+	friend class S3ListObjectsV2Page;
+};
+
+#endif /* AWS_S3RESULT_H_ */
@@ -0,0 +1,65 @@
+/*
+ * S3UploadSource.cpp
+ */
+
+#include "AWS.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define LOG_TAG "S3UploadSource"
+
+S3FileUploadSource::S3FileUploadSource(const String& fileName) :
+		_owned(true) {
+	_fd = ::open(fileName, O_RDONLY);
+	if (_fd < 0) {
+		LOGE("Unable to open '%s': %s", fileName.cstr(), strerror(errno));
+		return;
+	}
+#ifdef POSIX_FADV_SEQUENTIAL
+	posix_fadvise(_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+}
+
+S3FileUploadSource::S3FileUploadSource(int fd) :
+		_fd(fd), _owned(false) {
+}
+
+S3FileUploadSource::~S3FileUploadSource() {
+	if (_owned && _fd >= 0)
+		::close(_fd);
+}
+
+int S3FileUploadSource::read(uint8_t* buffer, int size) {
+	if (_fd < 0)
+		return -1;
+
+	while (true) {
+		ssize_t count = ::read(_fd, buffer, size);
+		if (count >= 0)
+			return (int) count;
+		if (errno != EINTR) {
+			LOGE("Unable to read: %s", strerror(errno));
+			return -1;
+		}
+	}
+}
+
+int64_t S3FileUploadSource::getSize() {
+	struct stat st;
+	if (_fd < 0 || fstat(_fd, &st) != 0 || !S_ISREG(st.st_mode))
+		return -1;
+	// The data left to read, in case the descriptor has been read from.
+	off_t offset = lseek(_fd, 0, SEEK_CUR);
+	return (int64_t) st.st_size - ((offset > 0) ? offset : 0);
+}
+
+int S3MemoryUploadSource::read(uint8_t* buffer, int size) {
+	int count = (int) BFX_MIN((int64_t ) size, _size - _offset);
+	memcpy(buffer, _data + _offset, count);
+	_offset += count;
+	return count;
+}
@@ -0,0 +1,65 @@
+/*
+ * S3UploadSource.h
+ */
+
+#ifndef AWS_S3UPLOADSOURCE_H_
+#define AWS_S3UPLOADSOURCE_H_
+
+/// Provides the data S3Client::uploadMultipart() streams into parts. The data
+/// is read once, in order, by a single thread.
+class S3UploadSource: public REFObject {
+public:
+	virtual ~S3UploadSource() {
+	}
+
+	/// Reads up to given number of bytes, returns the number read, 0 at the
+	/// end of the data, or -1 on failure.
+	virtual int read(uint8_t* buffer, int size) = 0;
+	/// Gets the number of bytes of the data if known, -1 otherwise.
+	virtual int64_t getSize() {
+		return -1;
+	}
+};
+
+/// Reads the data from a file, or from a pipe or a socket, which have no
+/// size known up front.
+class S3FileUploadSource: public S3UploadSource {
+public:
+	/// Opens given file, see isOpen().
+	S3FileUploadSource(const String& fileName);
+	/// Reads from given descriptor, which is not closed.
+	S3FileUploadSource(int fd);
+	virtual ~S3FileUploadSource();
+
+	bool isOpen() const {
+		return _fd >= 0;
+	}
+	virtual int read(uint8_t* buffer, int size);
+	virtual int64_t getSize();
+
+private:
+	int _fd;
+	bool _owned;
+};
+
+/// Reads the data from memory, e.g. a file mapped by mmap().
+class S3MemoryUploadSource: public S3UploadSource {
+public:
+	/// The data is neither copied nor released.
+	S3MemoryUploadSource(const uint8_t* data, int64_t size) :
+			_data(data), _size(size), _offset(0) {
+		BFX_ASSERT(data || size == 0);
+	}
+
+	virtual int read(uint8_t* buffer, int size);
+	virtual int64_t getSize() {
+		return _size;
+	}
+
+private:
+	const uint8_t* _data;
+	int64_t _size;
+	int64_t _offset;
+};
+
+#endif /* AWS_S3UPLOADSOURCE_H_ */
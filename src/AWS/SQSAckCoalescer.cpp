@@ -0,0 +1,330 @@
+/*
+ * SQSAckCoalescer.cpp
+ */
+
+#include "AWS.h"
+
+#define LOG_TAG "SQSAckCoalescer"
+
+// Gets a value indicating whether given error of a whole request is
+// transient, so that its entries may be retried.
+static bool isTransientError(const String& errorCode) {
+	return errorCode == "InternalError" || errorCode == "InternalFailure"
+			|| errorCode == "ServiceUnavailable"
+			|| errorCode == "RequestThrottled"
+			|| errorCode == "ThrottlingException"
+			|| errorCode == "Throttling" || errorCode == "RequestTimeout";
+}
+
+// Acknowledgements of a queue waiting to be batched.
+class SQSAckQueue: public REFObject {
+public:
+	SQSAckQueue(const String& url) :
+			queueUrl(url), deadline(0) {
+	}
+
+	String queueUrl;
+	ArrayListT<SQSAckCoalescer::Ack> pending;
+	// Failed acknowledgements waiting for their backoff to be pending again.
+	ArrayListT<SQSAckCoalescer::Ack> retries;
+	// The tick count the pending acknowledgements must be sent at.
+	int64_t deadline;
+};
+
+// Acknowledgements sent by a single DeleteMessageBatch request.
+class SQSAckBatch: public REFObject {
+public:
+	SQSAckBatch(SQSAckQueue* q) :
+			queue(q) {
+	}
+
+	REF<SQSAckQueue> queue;
+	ArrayListT<SQSAckCoalescer::Ack> acks;
+};
+
+// A thread sending the ready batches of a coalescer.
+class SQSAckSender: public Thread {
+public:
+	SQSAckSender(SQSAckCoalescer* coalescer) :
+			_coalescer(coalescer) {
+	}
+
+protected:
+	virtual void run() {
+		_coalescer->runSender();
+	}
+
+private:
+	// The coalescer stops the thread before being destroyed.
+	SQSAckCoalescer* _coalescer;
+};
+
+SQSAckCoalescer::SQSAckCoalescer(SQSClient* client, int lingerTime,
+		int senders) :
+		_workEvent(false), _idleEvent(true, true) {
+	BFX_ASSERT(client);
+	BFX_ASSERT(lingerTime >= 0);
+	BFX_ASSERT(senders > 0);
+
+	_client = client;
+	_lingerTime = lingerTime;
+	_outstanding = 0;
+	_flushing = 0;
+	_closed = false;
+	_deletedCount = 0;
+	_failedCount = 0;
+
+	for (int i = 0; i < senders; i++) {
+		REF<SQSAckSender> sender = new SQSAckSender(this);
+		if (!sender->start()) {
+			LOGE("Unable to start a sending thread.");
+			break;
+		}
+		_senders.add(sender);
+	}
+}
+
+SQSAckCoalescer::~SQSAckCoalescer() {
+	close();
+}
+
+bool SQSAckCoalescer::ack(const String& queueUrl,
+		const String& receiptHandle) {
+	BFX_ASSERT(!queueUrl.isEmpty());
+	BFX_ASSERT(!receiptHandle.isEmpty());
+
+	MutexHolder holder(&_lock);
+	if (_closed) {
+		LOGE("Unable to acknowledge a message by a closed coalescer.");
+		return false;
+	}
+
+	TreeMapT<String, REF<SQSAckQueue> >::PENTRY entry = _queues.getEntry(
+			queueUrl);
+	SQSAckQueue* queue;
+	if (entry != NULL) {
+		queue = entry->value;
+	} else {
+		REF<SQSAckQueue> newQueue = new SQSAckQueue(queueUrl);
+		_queues.set(queueUrl, newQueue);
+		queue = newQueue;
+	}
+	Ack ack;
+	ack.receiptHandle = receiptHandle;
+	ack.attempts = 0;
+	ack.notBefore = 0;
+	enqueue(queue, ack);
+
+	if (_outstanding++ == 0)
+		_idleEvent.reset();
+	return true;
+}
+
+void SQSAckCoalescer::enqueue(SQSAckQueue* queue, const Ack& ack) {
+	if (queue->pending.getSize() == 0) {
+		queue->deadline = Thread::getTickCount() + _lingerTime;
+		// Wakes a sender up to wait for the linger time.
+		_workEvent.set();
+	}
+	queue->pending.add(ack);
+	if (queue->pending.getSize() >= MAX_BATCH_ENTRIES)
+		seal(queue);
+}
+
+void SQSAckCoalescer::seal(SQSAckQueue* queue) {
+	REF<SQSAckBatch> batch = new SQSAckBatch(queue);
+	int count = BFX_MIN(queue->pending.getSize(), (int) MAX_BATCH_ENTRIES);
+	for (int i = 0; i < count; i++)
+		batch->acks.add(queue->pending[i]);
+	for (int i = 0; i < count; i++)
+		queue->pending.removeAt(0);
+	_readyBatches.add(batch);
+	_workEvent.set();
+}
+
+void SQSAckCoalescer::flush() {
+	{
+		MutexHolder holder(&_lock);
+		_flushing++;
+		_workEvent.set();
+	}
+	_idleEvent.wait();
+
+	MutexHolder holder(&_lock);
+	_flushing--;
+}
+
+void SQSAckCoalescer::close() {
+	{
+		MutexHolder holder(&_lock);
+		if (_closed)
+			return;
+		_closed = true;
+		// The senders exit once nothing is outstanding, each one wakes the
+		// next one up.
+		_workEvent.set();
+	}
+	for (int i = 0; i < _senders.getSize(); i++)
+		_senders[i]->join();
+	_senders.clear();
+}
+
+void SQSAckCoalescer::runSender() {
+	_lock.lock();
+	while (true) {
+		if (_readyBatches.getSize() > 0) {
+			REF<SQSAckBatch> batch = _readyBatches[0];
+			_readyBatches.removeAt(0);
+			// Lets another sender take the next batch meanwhile.
+			_workEvent.set();
+			_lock.unlock();
+			{
+				REFAutoreleasePool pool;
+				sendBatch(batch);
+			}
+			_lock.lock();
+			continue;
+		}
+
+		// Seals the queues whose linger time is over.
+		int64_t now = Thread::getTickCount();
+		int timeout = -1;
+		bool sealed = false;
+		for (TreeMapT<String, REF<SQSAckQueue> >::PENTRY entry =
+				_queues.getFirstEntry(); entry != NULL;
+				entry = _queues.getNextEntry(entry)) {
+			SQSAckQueue* queue = entry->value;
+			// Makes the retries pending again once backed off, even when
+			// flushing or closing.
+			for (int i = 0; i < queue->retries.getSize();) {
+				if (now >= queue->retries[i].notBefore) {
+					Ack ack = queue->retries[i];
+					queue->retries.removeAt(i);
+					enqueue(queue, ack);
+				} else {
+					if (timeout == -1
+							|| queue->retries[i].notBefore - now < timeout)
+						timeout = (int) (queue->retries[i].notBefore - now);
+					i++;
+				}
+			}
+			if (queue->pending.getSize() == 0)
+				continue;
+			if (_closed || _flushing > 0 || now >= queue->deadline) {
+				seal(queue);
+				sealed = true;
+			} else if (timeout == -1 || queue->deadline - now < timeout) {
+				timeout = (int) (queue->deadline - now);
+			}
+		}
+		if (sealed)
+			continue;
+		if (_closed && _outstanding == 0) {
+			_workEvent.set();
+			break;
+		}
+
+		_lock.unlock();
+		_workEvent.wait(timeout);
+		_lock.lock();
+	}
+	_lock.unlock();
+}
+
+void SQSAckCoalescer::sendBatch(SQSAckBatch* batch) {
+	int count = batch->acks.getSize();
+	REF<SQSDeleteMessageBatchParams> params = new SQSDeleteMessageBatchParams(
+			batch->queue->queueUrl);
+	for (int i = 0; i < count; i++) {
+		REF<SQSDeleteMessageBatchRequestEntry> entry =
+				new SQSDeleteMessageBatchRequestEntry();
+		// The IDs only have to be unique within a batch.
+		entry->id = String::format("%d", i);
+		entry->receiptHandle = batch->acks[i].receiptHandle;
+		params->getEntries()->addLast(entry);
+		batch->acks[i].attempts++;
+	}
+
+	// Entries not reported as deleted, nor failed by the sender's fault, are
+	// retried.
+	ArrayListT<bool> done(count);
+	for (int i = 0; i < count; i++)
+		done.add(false);
+	int deleted = 0;
+	int failed = 0;
+	SQSDeleteMessageBatchResult* result = _client->deleteMessageBatch(params);
+	if (result == NULL || !result->getErrorCode().isEmpty()) {
+		LOGE("Failed to delete %d message(s) from '%s': %s", count,
+				batch->queue->queueUrl.cstr(),
+				(result == NULL) ? "request failed" :
+						result->getErrorMessage().cstr());
+		if (result != NULL && !isTransientError(result->getErrorCode())) {
+			// e.g. AWS.SimpleQueueService.NonExistentQueue or AccessDenied,
+			// retrying is pointless.
+			for (int i = 0; i < count; i++)
+				done[i] = true;
+			failed = count;
+		}
+	} else {
+		SQSDeleteMessageBatchResultEntryList* successful =
+				result->getSuccessful();
+		for (SQSDeleteMessageBatchResultEntryList::PENTRY entry =
+				successful->getFirstEntry(); entry != NULL;
+				entry = successful->getNextEntry(entry)) {
+			int index = atoi(entry->value->id);
+			if (index >= 0 && index < count && !done[index]) {
+				done[index] = true;
+				deleted++;
+			}
+		}
+		SQSBatchResultErrorEntryList* errors = result->getFailed();
+		for (SQSBatchResultErrorEntryList::PENTRY entry =
+				errors->getFirstEntry(); entry != NULL;
+				entry = errors->getNextEntry(entry)) {
+			int index = atoi(entry->value->id);
+			if (index < 0 || index >= count || done[index])
+				continue;
+			if (entry->value->senderFault) {
+				// e.g. ReceiptHandleIsInvalid, retrying is pointless.
+				LOGW("Failed to delete message: %s, %s",
+						entry->value->code.cstr(),
+						entry->value->message.cstr());
+				done[index] = true;
+				failed++;
+			}
+		}
+	}
+
+	MutexHolder holder(&_lock);
+	int64_t now = Thread::getTickCount();
+	bool retried = false;
+	for (int i = 0; i < count; i++) {
+		if (done[i])
+			continue;
+		Ack& ack = batch->acks[i];
+		if (ack.attempts < MAX_ATTEMPTS) {
+			// Backs off so that a throttled or unavailable queue is not
+			// retried at once.
+			ack.notBefore = now
+					+ (RETRY_INTERVAL << BFX_MIN(ack.attempts - 1, 5));
+			batch->queue->retries.add(ack);
+			retried = true;
+		} else {
+			LOGW("Gave up deleting message after %d attempts.",
+					batch->acks[i].attempts);
+			done[i] = true;
+			failed++;
+		}
+	}
+	_deletedCount += deleted;
+	_failedCount += failed;
+	_outstanding -= deleted + failed;
+	if (_outstanding == 0) {
+		_idleEvent.set();
+		// Lets the senders of a closed coalescer exit.
+		_workEvent.set();
+	} else if (retried) {
+		// Wakes a sender up to wait for the backoff.
+		_workEvent.set();
+	}
+}
@@ -0,0 +1,93 @@
+/*
+ * SQSAckCoalescer.h
+ */
+
+#ifndef AWS_SQSACKCOALESCER_H_
+#define AWS_SQSACKCOALESCER_H_
+
+class SQSAckQueue;
+class SQSAckBatch;
+class SQSAckSender;
+
+/// Deletes processed messages asynchronously, coalescing the acknowledgements
+/// of each queue into DeleteMessageBatch requests of up to 10 entries. A
+/// batch is sent as soon as it is full, or once its first acknowledgement has
+/// waited for the linger time. Entries which fail but not by the sender's
+/// fault, nor by a request error which is not transient, are retried in later
+/// batches after a backoff doubled per attempt.
+class SQSAckCoalescer: public REFObject {
+public:
+	enum {
+		MAX_BATCH_ENTRIES = 10,	/// Maximum number of entries of a batch
+		DEFAULT_LINGER_TIME = 50,	/// Default linger time in milliseconds
+		DEFAULT_SENDERS = 2,	/// Default number of sending threads
+		MAX_ATTEMPTS = 3,	/// Maximum number of attempts of an entry
+		RETRY_INTERVAL = 500,	/// Backoff of the first retry in milliseconds
+	};
+
+	/// Creates a coalescer deleting messages by the client.
+	SQSAckCoalescer(SQSClient* client, int lingerTime = DEFAULT_LINGER_TIME,
+			int senders = DEFAULT_SENDERS);
+	virtual ~SQSAckCoalescer();
+
+	/// Queues a message of given queue to be deleted. Returns false if the
+	/// coalescer has been closed.
+	bool ack(const String& queueUrl, const String& receiptHandle);
+	/// Sends the queued acknowledgements without lingering, and waits until
+	/// all of them have been deleted or given up.
+	void flush();
+	/// Flushes the queued acknowledgements and stops the sending threads, no
+	/// more acknowledgements are accepted.
+	void close();
+
+	/// Gets the number of messages deleted so far.
+	int64_t getDeletedCount() const {
+		return _deletedCount;
+	}
+	/// Gets the number of acknowledgements given up so far.
+	int64_t getFailedCount() const {
+		return _failedCount;
+	}
+
+private:
+	friend class SQSAckQueue;
+	friend class SQSAckBatch;
+	friend class SQSAckSender;
+
+	struct Ack {
+		String receiptHandle;
+		int attempts;
+		// The tick count the entry may be retried at.
+		int64_t notBefore;
+	};
+
+	// Queues an acknowledgement, the lock must be held.
+	void enqueue(SQSAckQueue* queue, const Ack& ack);
+	// Moves up to a batch of pending acknowledgements of the queue to the
+	// ready batches, the lock must be held.
+	void seal(SQSAckQueue* queue);
+	// The loop of each sending thread.
+	void runSender();
+	// Sends a batch, and queues the entries to retry once backed off.
+	void sendBatch(SQSAckBatch* batch);
+
+	REF<SQSClient> _client;
+	int _lingerTime;
+
+	Mutex _lock;
+	TreeMapT<String, REF<SQSAckQueue> > _queues;
+	ArrayListT<REF<SQSAckBatch> > _readyBatches;
+	int _outstanding;
+	// The number of threads waiting in flush().
+	int _flushing;
+	bool _closed;
+	int64_t _deletedCount;
+	int64_t _failedCount;
+	// Signaled when there may be a batch to send.
+	Event _workEvent;
+	// Signaled when no acknowledgement is outstanding.
+	Event _idleEvent;
+	ArrayListT<REF<SQSAckSender> > _senders;
+};
+
+#endif /* AWS_SQSACKCOALESCER_H_ */
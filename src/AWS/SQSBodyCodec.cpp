@@ -0,0 +1,87 @@
+/*
+ * SQSBodyCodec.cpp
+ */
+
+#include "AWS.h"
+#include "HttpUtils.h"
+
+#include <zlib.h>
+
+#define LOG_TAG "SQSBodyCodec"
+
+const char SQSBodyCodec::ATTRIBUTE_NAME[] = "awsfx.BodyCodec";
+const char SQSBodyCodec::ZLIB[] = "zlib";
+
+bool SQSBodyCodec::compress(const String& body, int level, String& encoded) {
+	BFX_ASSERT(level >= -1 && level <= 9);
+
+	uLongf compressedSize = compressBound(body.getLength());
+	uint8_t* compressed = new uint8_t[compressedSize];
+	int rc = compress2(compressed, &compressedSize,
+			(const Bytef*) body.cstr(), body.getLength(), level);
+	if (rc != Z_OK) {
+		LOGE("Failed to compress message body: %d", rc);
+		delete[] compressed;
+		return false;
+	}
+	// The attribute is counted against the size limit as well.
+	int overhead = (int) (sizeof(ATTRIBUTE_NAME) - 1 + sizeof(ZLIB) - 1
+			+ sizeof("String") - 1);
+	int encodedSize = ((int) compressedSize + 2) / 3 * 4;
+	if (encodedSize + overhead >= body.getLength()) {
+		delete[] compressed;
+		return false;
+	}
+	encoded = HttpUtils::base64Encode(compressed, (int) compressedSize);
+	delete[] compressed;
+	return true;
+}
+
+bool SQSBodyCodec::decompress(const String& encoded, const String& codec,
+		String& body, int maxBodySize) {
+	BFX_ASSERT(maxBodySize >= 0);
+
+	if (codec != ZLIB) {
+		LOGE("Unknown message body codec '%s'.", codec.cstr());
+		return false;
+	}
+	SharedBufferT<uint8_t> compressed = HttpUtils::base64Decode(encoded);
+	if (compressed.isEmpty())
+		return false;
+
+	z_stream stream;
+	memset(&stream, 0, sizeof(stream));
+	if (inflateInit(&stream) != Z_OK)
+		return false;
+	stream.next_in = (Bytef*) compressed.getRawData();
+	stream.avail_in = compressed.getSize();
+
+	String result;
+	char buf[16384];
+	int rc;
+	do {
+		// Leaves room for a terminating NULL, which append() expects.
+		stream.next_out = (Bytef*) buf;
+		stream.avail_out = sizeof(buf) - 1;
+		rc = inflate(&stream, Z_NO_FLUSH);
+		if (rc != Z_OK && rc != Z_STREAM_END)
+			break;
+		int length = (int) (sizeof(buf) - 1 - stream.avail_out);
+		// Stops a tiny body inflating to a huge one early.
+		if (length > maxBodySize - result.getLength()) {
+			LOGE("Message body decompresses to more than %d bytes.",
+					maxBodySize);
+			inflateEnd(&stream);
+			return false;
+		}
+		buf[length] = '\0';
+		result.append(buf, length);
+	} while (rc != Z_STREAM_END);
+	inflateEnd(&stream);
+	if (rc != Z_STREAM_END) {
+		LOGE("Failed to decompress message body: %d", rc);
+		return false;
+	}
+	body = result;
+	return true;
+}
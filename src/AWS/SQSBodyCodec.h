@@ -0,0 +1,39 @@
+/*
+ * SQSBodyCodec.h
+ */
+
+#ifndef AWS_SQSBODYCODEC_H_
+#define AWS_SQSBODYCODEC_H_
+
+/// Compresses message bodies for SQSClient. A compressed body is deflated by
+/// zlib, then encoded in base64 since SQS only takes text, and is tagged by a
+/// message attribute naming the codec, so that the receiver knows to
+/// decompress it. The attribute name is namespaced by the library, so that
+/// the attributes other producers set aren't mistaken for it.
+class SQSBodyCodec {
+private:
+	SQSBodyCodec();
+
+public:
+	enum {
+		/// Default maximum size in bytes of a decompressed body
+		DEFAULT_MAX_BODY_SIZE = 16 * 1024 * 1024,
+	};
+
+	/// Name of the message attribute naming the codec of the body.
+	static const char ATTRIBUTE_NAME[];
+	/// Codec of zlib compressed, base64 encoded bodies.
+	static const char ZLIB[];
+
+	/// Compresses a body by given zlib level, -1 for the default one. Returns
+	/// false if the encoded body along with its attribute isn't smaller than
+	/// the original body.
+	static bool compress(const String& body, int level, String& encoded);
+	/// Decompresses a body encoded by given codec. Returns false if the codec
+	/// is unknown, the body is corrupt, or it decompresses to more than given
+	/// size in bytes.
+	static bool decompress(const String& encoded, const String& codec,
+			String& body, int maxBodySize = DEFAULT_MAX_BODY_SIZE);
+};
+
+#endif /* AWS_SQSBODYCODEC_H_ */
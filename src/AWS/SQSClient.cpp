@@ -7,24 +7,319 @@
 
 #include "AWS.h"
 #include "SQSResult.h"
+#include "HttpUtils.h"
+
+#include <openssl/rand.h>
 
 #define LOG_TAG "SQSClient"
 
+// The format of the Amazon SQS Extended Client Library. A message whose body
+// is stored in S3 carries a pointer to the object as its body, and the size
+// of the stored body as a reserved attribute.
+static const char __payloadPointerClass[] =
+		"software.amazon.payloadoffloading.PayloadS3Pointer";
+static const char __legacyPayloadPointerClass[] =
+		"com.amazon.sqs.javamessaging.MessageS3Pointer";
+static const char __payloadSizeAttribute[] = "ExtendedPayloadSize";
+// The receipt handle of such a message embeds the location of the object.
+static const char __bucketNameMarker[] = "-..s3BucketName..-";
+static const char __keyMarker[] = "-..s3Key..-";
+
+// Gets the size of a message counted against the limit, which includes the
+// names, types and values of its attributes.
+static int getMessageSize(const String& messageBody,
+		const AWSStringMap* attributes) {
+	int size = messageBody.getLength();
+	if (attributes != NULL) {
+		for (AWSStringMap::PENTRY attr = attributes->getFirstEntry();
+				attr != NULL; attr = attributes->getNextEntry(attr)) {
+			size += attr->key.getLength() + attr->value.getLength()
+					+ (int) sizeof("String") - 1;
+		}
+	}
+	return size;
+}
+
+// Makes a content-based deduplication ID from the digest of a body.
+static String makeDeduplicationId(const uint8_t digest[AWSSHA256::DIGEST_SIZE]) {
+	return HttpUtils::toHexString(digest, AWSSHA256::DIGEST_SIZE);
+}
+
+// Copies message attributes, adding one.
+static AWSStringMap* copyAttributes(const AWSStringMap* attributes,
+		const char* name, const String& value) {
+	AWSStringMap* copy = new AWSStringMap();
+	if (attributes != NULL) {
+		for (AWSStringMap::PENTRY attr = attributes->getFirstEntry();
+				attr != NULL; attr = attributes->getNextEntry(attr)) {
+			copy->set(attr->key, attr->value);
+		}
+	}
+	copy->set(name, value);
+	return copy;
+}
+
+// Gets the value of a string field of a JSON object, or an empty string.
+static String getJSONStringField(const String& json, const char* name) {
+	String quotedName = String::format("\"%s\"", name);
+	int pos = json.indexOf(quotedName);
+	if (pos == -1)
+		return String();
+	pos += quotedName.getLength();
+	while (pos < json.getLength() && (json[pos] == ' ' || json[pos] == ':'))
+		pos++;
+	if (pos >= json.getLength() || json[pos] != '"')
+		return String();
+	int end = json.indexOf('"', pos + 1);
+	if (end == -1)
+		return String();
+	return json.substring(pos + 1, end - pos - 1);
+}
+
+// Parses the pointer sent in place of a message body stored in S3. Returns
+// false if the body is an ordinary one.
+static bool parsePayloadPointer(const String& messageBody, String& bucketName,
+		String& key) {
+	if (!messageBody.startsWith("[\"")
+			|| (!messageBody.startsWith(__payloadPointerClass, 2)
+					&& !messageBody.startsWith(__legacyPayloadPointerClass, 2)))
+		return false;
+	bucketName = getJSONStringField(messageBody, "s3BucketName");
+	key = getJSONStringField(messageBody, "s3Key");
+	return !bucketName.isEmpty() && !key.isEmpty();
+}
+
+// Splits a receipt handle embedding the location of a message body stored in
+// S3. Returns false if the receipt handle is an ordinary one.
+static bool parseReceiptHandle(const String& receiptHandle, String* bucketName,
+		String* key, String* originalHandle) {
+	const int bucketNameMarkerLength = (int) sizeof(__bucketNameMarker) - 1;
+	const int keyMarkerLength = (int) sizeof(__keyMarker) - 1;
+	if (!receiptHandle.startsWith(__bucketNameMarker))
+		return false;
+	int bucketNameEnd = receiptHandle.indexOf(__bucketNameMarker,
+			bucketNameMarkerLength);
+	if (bucketNameEnd == -1)
+		return false;
+	int keyStart = bucketNameEnd + bucketNameMarkerLength;
+	if (!receiptHandle.startsWith(__keyMarker, keyStart))
+		return false;
+	keyStart += keyMarkerLength;
+	int keyEnd = receiptHandle.indexOf(__keyMarker, keyStart);
+	if (keyEnd == -1)
+		return false;
+
+	if (bucketName != NULL) {
+		*bucketName = receiptHandle.substring(bucketNameMarkerLength,
+				bucketNameEnd - bucketNameMarkerLength);
+	}
+	if (key != NULL)
+		*key = receiptHandle.substring(keyStart, keyEnd - keyStart);
+	if (originalHandle != NULL)
+		*originalHandle = receiptHandle.substring(keyEnd + keyMarkerLength);
+	return true;
+}
+
+// Gets the receipt handle known by SQS.
+static String getOriginalReceiptHandle(const String& receiptHandle) {
+	String originalHandle;
+	if (parseReceiptHandle(receiptHandle, NULL, NULL, &originalHandle))
+		return originalHandle;
+	return receiptHandle;
+}
+
 SQSClient::SQSClient(const String& accessKeyId,
 		const String& secretAccessKey, AWSRegion* region) :
 		AWSClient("sqs", new AWSCredentials(accessKeyId, secretAccessKey),
 				region) {
-	_webClient = new AWSHttpClient();
+	_payloadThreshold = MAX_MESSAGE_SIZE;
+	_compressionThreshold = -1;
+	_compressionLevel = -1;
+	_maxDecompressedBodySize = SQSBodyCodec::DEFAULT_MAX_BODY_SIZE;
+	_contentDeduplication = false;
+	_protocol = SQSP_Query;
+	// Initializes the first web client, and the HTTP library by the way.
+	REF<AWSHttpClient> webClient = new AWSHttpClient();
+	releaseWebClient(webClient);
 }
 
 SQSClient::SQSClient(AWSCredentials* credentials, AWSRegion* region) :
 		AWSClient("sqs", credentials, region) {
-	_webClient = new AWSHttpClient();
+	_payloadThreshold = MAX_MESSAGE_SIZE;
+	_compressionThreshold = -1;
+	_compressionLevel = -1;
+	_maxDecompressedBodySize = SQSBodyCodec::DEFAULT_MAX_BODY_SIZE;
+	_contentDeduplication = false;
+	_protocol = SQSP_Query;
+	// Initializes the first web client, and the HTTP library by the way.
+	REF<AWSHttpClient> webClient = new AWSHttpClient();
+	releaseWebClient(webClient);
+}
+
+SQSClient::SQSClient(AWSCredentialsProvider* credentialsProvider,
+		AWSRegion* region) :
+		AWSClient("sqs", credentialsProvider, region) {
+	_payloadThreshold = MAX_MESSAGE_SIZE;
+	_compressionThreshold = -1;
+	_compressionLevel = -1;
+	_maxDecompressedBodySize = SQSBodyCodec::DEFAULT_MAX_BODY_SIZE;
+	_contentDeduplication = false;
+	_protocol = SQSP_Query;
+	// Initializes the first web client, and the HTTP library by the way.
+	REF<AWSHttpClient> webClient = new AWSHttpClient();
+	releaseWebClient(webClient);
 }
 
 SQSClient::~SQSClient() {
 }
 
+void SQSClient::setPayloadOffload(S3Client* s3Client,
+		const String& bucketName, int threshold) {
+	BFX_ASSERT(s3Client);
+	BFX_ASSERT(!bucketName.isEmpty());
+	BFX_ASSERT(threshold >= 0 && threshold <= MAX_MESSAGE_SIZE);
+
+	_payloadS3Client = s3Client;
+	_payloadBucketName = bucketName;
+	_payloadThreshold = threshold;
+}
+
+void SQSClient::setBodyCompression(int threshold, int level) {
+	BFX_ASSERT(threshold >= 0);
+	BFX_ASSERT(level >= -1 && level <= 9);
+
+	_compressionThreshold = threshold;
+	_compressionLevel = level;
+}
+
+String SQSClient::offloadPayload(const String& messageBody) {
+	// Names the object by a random (version 4) UUID.
+	uint8_t bytes[16];
+	if (RAND_bytes(bytes, sizeof(bytes)) != 1) {
+		_lastError = AWSE_HttpRequestFailed;
+		LOGE("Unable to generate the key of the message payload.");
+		return String();
+	}
+	bytes[6] = (bytes[6] & 0x0f) | 0x40;
+	bytes[8] = (bytes[8] & 0x3f) | 0x80;
+	String key = String::format(
+			"%02x%02x%02x%02x-%02x%02x-%02x%02x-%02x%02x-%02x%02x%02x%02x%02x%02x",
+			bytes[0], bytes[1], bytes[2], bytes[3], bytes[4], bytes[5], bytes[6],
+			bytes[7], bytes[8], bytes[9], bytes[10], bytes[11], bytes[12],
+			bytes[13], bytes[14], bytes[15]);
+
+	S3PutObjectResult* result = _payloadS3Client->putObject(_payloadBucketName,
+			key, (const uint8_t*) messageBody.cstr(), messageBody.getLength());
+	if (result == NULL || !result->getErrorCode().isEmpty()) {
+		_lastError = (result == NULL) ?
+				_payloadS3Client->getLastError() : AWSE_HttpRequestFailed;
+		LOGE("Failed to store the message payload to '%s/%s': %s",
+				_payloadBucketName.cstr(), key.cstr(),
+				(result == NULL) ? "request failed" :
+						result->getErrorMessage().cstr());
+		return String();
+	}
+	return String::format("[\"%s\",{\"s3BucketName\":\"%s\",\"s3Key\":\"%s\"}]",
+			__payloadPointerClass, _payloadBucketName.cstr(), key.cstr());
+}
+
+void SQSClient::loadPayloads(SQSReceiveMessageResult* result) {
+	SQSMessageList* messages = result->getMessages();
+	SQSMessageList::PENTRY entry = messages->getFirstEntry();
+	while (entry != NULL) {
+		SQSMessageList::PENTRY next = messages->getNextEntry(entry);
+		SQSMessage* message = entry->value;
+		String bucketName, key;
+		if (parsePayloadPointer(message->body, bucketName, key)) {
+			S3GetObjectResult* object = _payloadS3Client->getObject(bucketName,
+					key);
+			if (object == NULL || !object->getErrorCode().isEmpty()) {
+				// Leaves the message to be delivered again.
+				LOGE("Failed to load the payload of message '%s' from '%s/%s': %s",
+						message->messageId.cstr(), bucketName.cstr(), key.cstr(),
+						(object == NULL) ? "request failed" :
+								object->getErrorMessage().cstr());
+				messages->removeAt(entry);
+			} else {
+				message->body = object->getContent();
+				message->receiptHandle = String(__bucketNameMarker) + bucketName
+						+ __bucketNameMarker + __keyMarker + key + __keyMarker
+						+ message->receiptHandle;
+			}
+		}
+		entry = next;
+	}
+}
+
+bool SQSClient::encodeMessage(String& messageBody,
+		REF<AWSStringMap>& messageAttributes) {
+	// Compresses first, so that a compressed body may need no offloading,
+	// and an offloaded one takes less room in S3.
+	String compressedBody;
+	if (_compressionThreshold != -1
+			&& messageBody.getLength() > _compressionThreshold
+			&& (messageAttributes == NULL
+					|| messageAttributes->getEntry(SQSBodyCodec::ATTRIBUTE_NAME)
+							== NULL)
+			&& SQSBodyCodec::compress(messageBody, _compressionLevel,
+					compressedBody)) {
+		messageBody = compressedBody;
+		messageAttributes = copyAttributes(messageAttributes,
+				SQSBodyCodec::ATTRIBUTE_NAME, SQSBodyCodec::ZLIB);
+	}
+	if (isPayloadOffloaded(getMessageSize(messageBody, messageAttributes))) {
+		String pointer = offloadPayload(messageBody);
+		if (pointer.isEmpty())
+			return false;
+		messageAttributes = copyAttributes(messageAttributes,
+				__payloadSizeAttribute,
+				String::format("%d", messageBody.getLength()));
+		messageBody = pointer;
+	}
+	return true;
+}
+
+void SQSClient::decodeMessages(SQSReceiveMessageResult* result) {
+	SQSMessageList* messages = result->getMessages();
+	SQSMessageList::PENTRY entry = messages->getFirstEntry();
+	for (; entry != NULL; entry = messages->getNextEntry(entry)) {
+		SQSMessage* message = entry->value;
+		AWSStringMap::PENTRY codec = (message->messageAttributes == NULL) ?
+				NULL :
+				message->messageAttributes->getEntry(
+						SQSBodyCodec::ATTRIBUTE_NAME);
+		String body;
+		if (codec != NULL) {
+			if (SQSBodyCodec::decompress(message->body, codec->value, body,
+					_maxDecompressedBodySize)) {
+				message->body = body;
+			} else {
+				// Hands the message over as received, it would be received
+				// again and again otherwise.
+				LOGE("Failed to decompress the body of message '%s'.",
+						message->messageId.cstr());
+				message->bodyEncoded = true;
+			}
+		}
+	}
+}
+
+void SQSClient::deletePayload(const String& receiptHandle) {
+	String bucketName, key;
+	if (_payloadS3Client == NULL
+			|| !parseReceiptHandle(receiptHandle, &bucketName, &key, NULL))
+		return;
+	S3DeleteObjectResult* result = _payloadS3Client->deleteObject(bucketName,
+			key);
+	if (result == NULL || !result->getErrorCode().isEmpty()) {
+		// The message is gone anyway, so leaves the object behind.
+		LOGW("Failed to delete the message payload '%s/%s': %s",
+				bucketName.cstr(), key.cstr(),
+				(result == NULL) ? "request failed" :
+						result->getErrorMessage().cstr());
+	}
+}
+
 SQSCreateQueueResult* SQSClient::createQueue(const String& queueName,
 		int defaultVisibilityTimeout) {
 	BFX_ASSERT(false);	// not implemented.
@@ -43,7 +338,9 @@ SQSListQueuesResult* SQSClient::listQueues(const String& queueNamePrefix) {
 
 SQSListQueuesResult* SQSClient::listQueues(const SQSListQueuesParams* params) {
 	BFX_ASSERT(params);
-	AWSHttpRequest* request = SQSListQueuesParmsMarshaller().marshall(params);
+	AWSHttpRequest* request = (_protocol == SQSP_JSON) ?
+			SQSJSONParamsMarshaller().marshall(params) :
+			SQSListQueuesParmsMarshaller().marshall(params);
 	if (request == NULL) {
 		_lastError = AWSE_InvalidArguments;
 		LOGE("Failed to initialize request, invalid argument(s).");
@@ -56,9 +353,42 @@ SQSListQueuesResult* SQSClient::listQueues(const SQSListQueuesParams* params) {
 		return NULL;
 	}
 
-	SQSListQueuesResultUnmarshaller().unmarshall(response);
-	SQSListQueuesResult* result = SQSListQueuesResultUnmarshaller().unmarshall(
-			response);
+	SQSListQueuesResult* result = (_protocol == SQSP_JSON) ?
+			SQSJSONResultUnmarshaller().unmarshallListQueues(response) :
+			SQSListQueuesResultUnmarshaller().unmarshall(response);
+	if (result == NULL) {
+		_lastError = AWSE_ParseXMLFailed;
+		LOGE("Error occurs during parse response body.");
+	}
+
+	return result;
+}
+
+SQSGetQueueUrlResult* SQSClient::getQueueUrl(const String& queueName) {
+	REF<SQSGetQueueUrlParams> params = new SQSGetQueueUrlParams(queueName);
+	return getQueueUrl(params);
+}
+
+SQSGetQueueUrlResult* SQSClient::getQueueUrl(
+		const SQSGetQueueUrlParams* params) {
+	BFX_ASSERT(params);
+	AWSHttpRequest* request = (_protocol == SQSP_JSON) ?
+			SQSJSONParamsMarshaller().marshall(params) :
+			SQSGetQueueUrlParamsMarshaller().marshall(params);
+	if (request == NULL) {
+		_lastError = AWSE_InvalidArguments;
+		LOGE("Failed to initialize request, invalid argument(s).");
+		return NULL;
+	}
+
+	AWSHttpResponse* response = invoke(request);
+	if (response == NULL) {
+		return NULL;	// NOTE The error code already been set.
+	}
+
+	SQSGetQueueUrlResult* result = (_protocol == SQSP_JSON) ?
+			SQSJSONResultUnmarshaller().unmarshallGetQueueUrl(response) :
+			SQSGetQueueUrlResultUnmarshaller().unmarshall(response);
 	if (result == NULL) {
 		_lastError = AWSE_ParseXMLFailed;
 		LOGE("Error occurs during parse response body.");
@@ -67,6 +397,10 @@ SQSListQueuesResult* SQSClient::listQueues(const SQSListQueuesParams* params) {
 	return result;
 }
 
+String SQSClient::resolveQueueUrl(const String& queueName) {
+	return SQSQueueUrlCache::getDefault()->getQueueUrl(this, queueName);
+}
+
 SQSSendMessageResult* SQSClient::sendMessage(const String& queueUrl,
 		const String &messageBody, int delaySeconds) {
 	REF<SQSSendMessageParams> params = new SQSSendMessageParams(queueUrl);
@@ -78,8 +412,42 @@ SQSSendMessageResult* SQSClient::sendMessage(const String& queueUrl,
 SQSSendMessageResult* SQSClient::sendMessage(
 		const SQSSendMessageParams* params) {
 	BFX_ASSERT(params);
-	REF<AWSHttpRequest> request = SQSSendMessageParamsMarshaller().marshall(
-			params);
+	String messageBody = params->getMessageBody();
+	// Hashes the original body, so that the ID doesn't depend on encoding.
+	String deduplicationId = params->getMessageDeduplicationId();
+	if (isDeduplicationIdComputed(params->getMessageGroupId(),
+			deduplicationId)) {
+		uint8_t digest[AWSSHA256::DIGEST_SIZE];
+		AWSSHA256::compute((const uint8_t*) messageBody.cstr(),
+				messageBody.getLength(), digest);
+		deduplicationId = makeDeduplicationId(digest);
+	}
+	AWSStringMap* originalAttributes =
+			params->hasMessageAttributes() ?
+					params->getMessageAttributes() : NULL;
+	REF<AWSStringMap> messageAttributes = originalAttributes;
+	if (!encodeMessage(messageBody, messageAttributes))
+		return NULL;	// NOTE The error code already been set.
+	REF<SQSSendMessageParams> encoded;
+	if (messageAttributes != originalAttributes
+			|| deduplicationId != params->getMessageDeduplicationId()) {
+		encoded = new SQSSendMessageParams(params->getQueueUrl());
+		encoded->setMessageBody(messageBody);
+		encoded->setDelaySeconds(params->getDelaySeconds());
+		if (messageAttributes != NULL) {
+			for (AWSStringMap::PENTRY attr = messageAttributes->getFirstEntry();
+					attr != NULL; attr = messageAttributes->getNextEntry(attr)) {
+				encoded->getMessageAttributes()->set(attr->key, attr->value);
+			}
+		}
+		encoded->setMessageGroupId(params->getMessageGroupId());
+		encoded->setMessageDeduplicationId(deduplicationId);
+		params = encoded;
+	}
+
+	REF<AWSHttpRequest> request = (_protocol == SQSP_JSON) ?
+			SQSJSONParamsMarshaller().marshall(params) :
+			SQSSendMessageParamsMarshaller().marshall(params);
 	if (request == NULL) {
 		_lastError = AWSE_InvalidArguments;
 		LOGE("Failed to initialize request, invalid argument(s).");
@@ -91,7 +459,8 @@ SQSSendMessageResult* SQSClient::sendMessage(
 		return NULL;	// NOTE The error code already been set.
 	}
 
-	SQSSendMessageResult* result =
+	SQSSendMessageResult* result = (_protocol == SQSP_JSON) ?
+			SQSJSONResultUnmarshaller().unmarshallSendMessage(response) :
 			SQSSendMessageResultUnmarshaller().unmarshall(response);
 	if (result == NULL) {
 		_lastError = AWSE_ParseXMLFailed;
@@ -102,6 +471,116 @@ SQSSendMessageResult* SQSClient::sendMessage(
 	return result;
 }
 
+SQSSendMessageBatchResult* SQSClient::sendMessageBatch(
+		const String &queueUrl,
+		const SQSSendMessageBatchRequestEntryList* entries) {
+	BFX_ASSERT(entries);
+
+	REF<SQSSendMessageBatchParams> params = new SQSSendMessageBatchParams(
+			queueUrl);
+	for (SQSSendMessageBatchRequestEntryList::PENTRY entry =
+			entries->getFirstEntry(); entry != NULL;
+			entry = entries->getNextEntry(entry)) {
+		params->getEntries()->addLast(entry->value);
+	}
+	return sendMessageBatch(params);
+}
+
+SQSSendMessageBatchResult* SQSClient::sendMessageBatch(
+		const SQSSendMessageBatchParams* params) {
+	BFX_ASSERT(params);
+	REF<SQSSendMessageBatchParams> encoded;
+	if (_payloadS3Client != NULL || _compressionThreshold != -1
+			|| _contentDeduplication) {
+		SQSSendMessageBatchRequestEntryList* entries = params->getEntries();
+		// Hashes the bodies needing deduplication IDs all at once, which is
+		// faster than one by one where multi-buffer hashing is supported.
+		int count = entries->getSize();
+		const uint8_t** data = new const uint8_t*[count];
+		int* dataSizes = new int[count];
+		uint8_t (*digests)[AWSSHA256::DIGEST_SIZE] =
+				new uint8_t[count][AWSSHA256::DIGEST_SIZE];
+		int hashCount = 0;
+		for (SQSSendMessageBatchRequestEntryList::PENTRY entry =
+				entries->getFirstEntry(); entry != NULL;
+				entry = entries->getNextEntry(entry)) {
+			if (isDeduplicationIdComputed(entry->value->messageGroupId,
+					entry->value->messageDeduplicationId)) {
+				data[hashCount] =
+						(const uint8_t*) entry->value->messageBody.cstr();
+				dataSizes[hashCount] = entry->value->messageBody.getLength();
+				hashCount++;
+			}
+		}
+		if (hashCount > 0)
+			AWSSHA256::computeBatch(data, dataSizes, hashCount, digests);
+
+		encoded = new SQSSendMessageBatchParams(params->getQueueUrl());
+		int hashIndex = 0;
+		bool failed = false;
+		for (SQSSendMessageBatchRequestEntryList::PENTRY entry =
+				entries->getFirstEntry(); entry != NULL;
+				entry = entries->getNextEntry(entry)) {
+			SQSSendMessageBatchRequestEntry* original = entry->value;
+			String deduplicationId = original->messageDeduplicationId;
+			if (isDeduplicationIdComputed(original->messageGroupId,
+					deduplicationId)) {
+				deduplicationId = makeDeduplicationId(digests[hashIndex++]);
+			}
+			String messageBody = original->messageBody;
+			REF<AWSStringMap> messageAttributes = original->messageAttributes;
+			if (!encodeMessage(messageBody, messageAttributes)) {
+				failed = true;	// NOTE The error code already been set.
+				break;
+			}
+			if (messageAttributes == original->messageAttributes
+					&& deduplicationId == original->messageDeduplicationId) {
+				encoded->getEntries()->addLast(original);
+				continue;
+			}
+			REF<SQSSendMessageBatchRequestEntry> replacement =
+					new SQSSendMessageBatchRequestEntry();
+			replacement->id = original->id;
+			replacement->messageBody = messageBody;
+			replacement->delaySeconds = original->delaySeconds;
+			replacement->messageAttributes = messageAttributes;
+			replacement->messageGroupId = original->messageGroupId;
+			replacement->messageDeduplicationId = deduplicationId;
+			encoded->getEntries()->addLast(replacement);
+		}
+		delete[] data;
+		delete[] dataSizes;
+		delete[] digests;
+		if (failed)
+			return NULL;
+		params = encoded;
+	}
+
+	AWSHttpRequest* request = (_protocol == SQSP_JSON) ?
+			SQSJSONParamsMarshaller().marshall(params) :
+			SQSSendMessageBatchParamsMarshaller().marshall(params);
+	if (request == NULL) {
+		_lastError = AWSE_InvalidArguments;
+		LOGE("Failed to initialize request, invalid argument(s).");
+		return NULL;
+	}
+
+	AWSHttpResponse* response = invoke(request);
+	if (response == NULL) {
+		return NULL;	// NOTE The error code already been set.
+	}
+
+	SQSSendMessageBatchResult* result = (_protocol == SQSP_JSON) ?
+			SQSJSONResultUnmarshaller().unmarshallSendMessageBatch(response) :
+			SQSSendMessageBatchResultUnmarshaller().unmarshall(response);
+	if (result == NULL) {
+		_lastError = AWSE_ParseXMLFailed;
+		LOGE("Error occurs during parse response body.");
+	}
+
+	return result;
+}
+
 SQSReceiveMessageResult* SQSClient::receiveMessage(const String& queueUrl,
 		int mumberOfMessages, int visibilityTimeout) {
 	REF<SQSReceiveMessageParams> params = new SQSReceiveMessageParams(queueUrl);
@@ -114,8 +593,32 @@ SQSReceiveMessageResult* SQSClient::receiveMessage(
 		const SQSReceiveMessageParams* params) {
 	BFX_ASSERT(params != NULL);
 
-	AWSHttpRequest* request = SQSReceiveMessageParamsMarshaller().marshall(
-			params);
+	// Asks for the codec of the bodies as well, unless asked already.
+	int attributeNameCount = 0;
+	bool codecRequested = false;
+	if (params->hasMessageAttributeNames()) {
+		AWSStringMap* attrNames = params->getMessageAttributeNames();
+		attributeNameCount = attrNames->getSize();
+		for (AWSStringMap::PENTRY entry = attrNames->getFirstEntry();
+				entry != NULL; entry = attrNames->getNextEntry(entry)) {
+			if (entry->value == "All" || entry->value == ".*"
+					|| entry->value == SQSBodyCodec::ATTRIBUTE_NAME)
+				codecRequested = true;
+		}
+	}
+	AWSHttpRequest* request;
+	if (_protocol == SQSP_JSON) {
+		request = SQSJSONParamsMarshaller().marshall(params,
+				codecRequested ? "" : SQSBodyCodec::ATTRIBUTE_NAME);
+	} else {
+		request = SQSReceiveMessageParamsMarshaller().marshall(params);
+		if (request != NULL && !codecRequested) {
+			request->getParameters()->set(
+					String::format("MessageAttributeName.%d",
+							attributeNameCount + 1),
+					SQSBodyCodec::ATTRIBUTE_NAME);
+		}
+	}
 	if (request == NULL) {
 		_lastError = AWSE_InvalidArguments;
 		LOGE("Failed to initialize request, invalid argument(s).");
@@ -127,11 +630,54 @@ SQSReceiveMessageResult* SQSClient::receiveMessage(
 		return NULL;	// NOTE The error code already set in invoke(...).
 	}
 
-	SQSReceiveMessageResult* result =
+	SQSReceiveMessageResult* result = (_protocol == SQSP_JSON) ?
+			SQSJSONResultUnmarshaller().unmarshallReceiveMessage(response) :
 			SQSReceiveMessageResultUnmarshaller().unmarshall(response);
 	if (result == NULL) {
 		_lastError = AWSE_ParseXMLFailed;
 		LOGE("Error occurs during parse response body.");
+	} else if (result->hasMessages()) {
+		if (_payloadS3Client != NULL)
+			loadPayloads(result);
+		decodeMessages(result);
+	}
+
+	return result;
+}
+
+SQSReceiveMessageBatchResult* SQSClient::receiveMessageBatch(
+		const SQSReceiveMessageParams* params) {
+	BFX_ASSERT(params != NULL);
+
+	// The bodies would be pointers or compressed, and deleting the messages
+	// would leave their payloads behind in S3.
+	if (_payloadS3Client != NULL || _compressionThreshold != -1) {
+		_lastError = AWSE_InvalidArguments;
+		LOGE("Batches can't be received with payload offload or body "
+				"compression enabled.");
+		return NULL;
+	}
+
+	AWSHttpRequest* request = (_protocol == SQSP_JSON) ?
+			SQSJSONParamsMarshaller().marshall(params) :
+			SQSReceiveMessageParamsMarshaller().marshall(params);
+	if (request == NULL) {
+		_lastError = AWSE_InvalidArguments;
+		LOGE("Failed to initialize request, invalid argument(s).");
+		return NULL;
+	}
+
+	AWSHttpResponse* response = invoke(request);
+	if (response == NULL) {
+		return NULL;	// NOTE The error code already set in invoke(...).
+	}
+
+	SQSReceiveMessageBatchResult* result = (_protocol == SQSP_JSON) ?
+			SQSJSONResultUnmarshaller().unmarshallReceiveMessageBatch(response) :
+			SQSReceiveMessageBatchResultUnmarshaller().unmarshall(response);
+	if (result == NULL) {
+		_lastError = AWSE_ParseXMLFailed;
+		LOGE("Error occurs during parse response body.");
 	}
 
 	return result;
@@ -154,8 +700,36 @@ SQSDeleteMessageBatchResult* SQSClient::deleteMessageBatch(
 SQSDeleteMessageBatchResult* SQSClient::deleteMessageBatch(
 		const SQSDeleteMessageBatchParams* params) {
 	BFX_ASSERT(params);
-	AWSHttpRequest* request = SQSDeleteMessageBatchParamsMarshaller().marshall(
-			params);
+	REF<SQSDeleteMessageBatchParams> stripped;
+	SQSDeleteMessageBatchRequestEntryList* entries = params->getEntries();
+	for (SQSDeleteMessageBatchRequestEntryList::PENTRY entry =
+			entries->getFirstEntry(); entry != NULL;
+			entry = entries->getNextEntry(entry)) {
+		String originalHandle;
+		if (!parseReceiptHandle(entry->value->receiptHandle, NULL, NULL,
+				&originalHandle)) {
+			continue;
+		}
+		if (stripped == NULL) {
+			// Copies the entries with the receipt handles known by SQS.
+			stripped = new SQSDeleteMessageBatchParams(params->getQueueUrl());
+			for (SQSDeleteMessageBatchRequestEntryList::PENTRY other =
+					entries->getFirstEntry(); other != NULL;
+					other = entries->getNextEntry(other)) {
+				REF<SQSDeleteMessageBatchRequestEntry> copy =
+						new SQSDeleteMessageBatchRequestEntry();
+				copy->id = other->value->id;
+				copy->receiptHandle = getOriginalReceiptHandle(
+						other->value->receiptHandle);
+				stripped->getEntries()->addLast(copy);
+			}
+			params = stripped;
+		}
+	}
+
+	AWSHttpRequest* request = (_protocol == SQSP_JSON) ?
+			SQSJSONParamsMarshaller().marshall(params) :
+			SQSDeleteMessageBatchParamsMarshaller().marshall(params);
 	if (request == NULL) {
 		_lastError = AWSE_InvalidArguments;
 		LOGE("Failed to initialize request, invalid argument(s).");
@@ -167,11 +741,28 @@ SQSDeleteMessageBatchResult* SQSClient::deleteMessageBatch(
 		return NULL;	// NOTE The error code already been set.
 	}
 
-	SQSDeleteMessageBatchResult* result =
+	SQSDeleteMessageBatchResult* result = (_protocol == SQSP_JSON) ?
+			SQSJSONResultUnmarshaller().unmarshallDeleteMessageBatch(response) :
 			SQSDeleteMessageBatchResultUnmarshaller().unmarshall(response);
 	if (result == NULL) {
 		_lastError = AWSE_ParseXMLFailed;
 		LOGE("Error occurs during parse response body.");
+	} else if (stripped != NULL && result->getErrorCode().isEmpty()) {
+		// Deletes the stored bodies of the messages deleted.
+		SQSDeleteMessageBatchResultEntryList* successful =
+				result->getSuccessful();
+		for (SQSDeleteMessageBatchResultEntryList::PENTRY deleted =
+				successful->getFirstEntry(); deleted != NULL;
+				deleted = successful->getNextEntry(deleted)) {
+			for (SQSDeleteMessageBatchRequestEntryList::PENTRY entry =
+					entries->getFirstEntry(); entry != NULL;
+					entry = entries->getNextEntry(entry)) {
+				if (entry->value->id == deleted->value->id) {
+					deletePayload(entry->value->receiptHandle);
+					break;
+				}
+			}
+		}
 	}
 
 	return result;
@@ -179,23 +770,206 @@ SQSDeleteMessageBatchResult* SQSClient::deleteMessageBatch(
 
 SQSDeleteMessageResult* SQSClient::deleteMessage(const String &queueUrl,
 		const String& receiptHandle) {
-	BFX_ASSERT(false);	// not implemented.
-	return NULL;
+	REF<SQSDeleteMessageParams> params = new SQSDeleteMessageParams(queueUrl,
+			receiptHandle);
+	return deleteMessage(params);
+}
+
+SQSDeleteMessageResult* SQSClient::deleteMessage(
+		const SQSDeleteMessageParams* params) {
+	BFX_ASSERT(params);
+	String receiptHandle = params->getReceiptHandle();
+	REF<SQSDeleteMessageParams> stripped;
+	String originalHandle;
+	if (parseReceiptHandle(receiptHandle, NULL, NULL, &originalHandle)) {
+		stripped = new SQSDeleteMessageParams(params->getQueueUrl(),
+				originalHandle);
+		params = stripped;
+	}
+
+	AWSHttpRequest* request = (_protocol == SQSP_JSON) ?
+			SQSJSONParamsMarshaller().marshall(params) :
+			SQSDeleteMessageParamsMarshaller().marshall(params);
+	if (request == NULL) {
+		_lastError = AWSE_InvalidArguments;
+		LOGE("Failed to initialize request, invalid argument(s).");
+		return NULL;
+	}
+
+	AWSHttpResponse* response = invoke(request);
+	if (response == NULL) {
+		return NULL;	// NOTE The error code already been set.
+	}
+
+	SQSDeleteMessageResult* result = (_protocol == SQSP_JSON) ?
+			SQSJSONResultUnmarshaller().unmarshallDeleteMessage(response) :
+			SQSDeleteMessageResultUnmarshaller().unmarshall(response);
+	if (result == NULL) {
+		_lastError = AWSE_ParseXMLFailed;
+		LOGE("Error occurs during parse response body.");
+	} else if (stripped != NULL && result->getErrorCode().isEmpty()) {
+		deletePayload(receiptHandle);
+	}
+
+	return result;
+}
+
+SQSChangeMessageVisibilityResult* SQSClient::changeMessageVisibility(
+		const String& queueUrl, const String& receiptHandle,
+		int visibilityTimeout) {
+	REF<SQSChangeMessageVisibilityParams> params =
+			new SQSChangeMessageVisibilityParams(queueUrl, receiptHandle,
+					visibilityTimeout);
+	return changeMessageVisibility(params);
+}
+
+SQSChangeMessageVisibilityResult* SQSClient::changeMessageVisibility(
+		const SQSChangeMessageVisibilityParams* params) {
+	BFX_ASSERT(params);
+	REF<SQSChangeMessageVisibilityParams> stripped;
+	String originalHandle;
+	if (parseReceiptHandle(params->getReceiptHandle(), NULL, NULL,
+			&originalHandle)) {
+		stripped = new SQSChangeMessageVisibilityParams(params->getQueueUrl(),
+				originalHandle, params->getVisibilityTimeout());
+		params = stripped;
+	}
+
+	AWSHttpRequest* request = (_protocol == SQSP_JSON) ?
+			SQSJSONParamsMarshaller().marshall(params) :
+			SQSChangeMessageVisibilityParamsMarshaller().marshall(params);
+	if (request == NULL) {
+		_lastError = AWSE_InvalidArguments;
+		LOGE("Failed to initialize request, invalid argument(s).");
+		return NULL;
+	}
+
+	AWSHttpResponse* response = invoke(request);
+	if (response == NULL) {
+		return NULL;	// NOTE The error code already been set.
+	}
+
+	SQSChangeMessageVisibilityResult* result = (_protocol == SQSP_JSON) ?
+			SQSJSONResultUnmarshaller().unmarshallChangeMessageVisibility(
+					response) :
+			SQSChangeMessageVisibilityResultUnmarshaller().unmarshall(response);
+	if (result == NULL) {
+		_lastError = AWSE_ParseXMLFailed;
+		LOGE("Error occurs during parse response body.");
+	}
+
+	return result;
+}
+
+SQSChangeMessageVisibilityBatchResult* SQSClient::changeMessageVisibilityBatch(
+		const String& queueUrl,
+		const SQSChangeMessageVisibilityBatchRequestEntryList* entries) {
+	REF<SQSChangeMessageVisibilityBatchParams> params =
+			new SQSChangeMessageVisibilityBatchParams(queueUrl);
+	for (SQSChangeMessageVisibilityBatchRequestEntryList::PENTRY entry =
+			entries->getFirstEntry(); entry != NULL;
+			entry = entries->getNextEntry(entry)) {
+		params->getEntries()->addLast(entry->value);
+	}
+	return changeMessageVisibilityBatch(params);
+}
+
+SQSChangeMessageVisibilityBatchResult* SQSClient::changeMessageVisibilityBatch(
+		const SQSChangeMessageVisibilityBatchParams* params) {
+	BFX_ASSERT(params);
+	REF<SQSChangeMessageVisibilityBatchParams> stripped;
+	SQSChangeMessageVisibilityBatchRequestEntryList* entries =
+			params->getEntries();
+	for (SQSChangeMessageVisibilityBatchRequestEntryList::PENTRY entry =
+			entries->getFirstEntry(); entry != NULL;
+			entry = entries->getNextEntry(entry)) {
+		if (!parseReceiptHandle(entry->value->receiptHandle, NULL, NULL, NULL))
+			continue;
+		// Copies the entries with the receipt handles known by SQS.
+		stripped = new SQSChangeMessageVisibilityBatchParams(
+				params->getQueueUrl());
+		for (SQSChangeMessageVisibilityBatchRequestEntryList::PENTRY other =
+				entries->getFirstEntry(); other != NULL;
+				other = entries->getNextEntry(other)) {
+			REF<SQSChangeMessageVisibilityBatchRequestEntry> copy =
+					new SQSChangeMessageVisibilityBatchRequestEntry();
+			copy->id = other->value->id;
+			copy->receiptHandle = getOriginalReceiptHandle(
+					other->value->receiptHandle);
+			copy->visibilityTimeout = other->value->visibilityTimeout;
+			stripped->getEntries()->addLast(copy);
+		}
+		params = stripped;
+		break;
+	}
+
+	AWSHttpRequest* request = (_protocol == SQSP_JSON) ?
+			SQSJSONParamsMarshaller().marshall(params) :
+			SQSChangeMessageVisibilityBatchParamsMarshaller().marshall(params);
+	if (request == NULL) {
+		_lastError = AWSE_InvalidArguments;
+		LOGE("Failed to initialize request, invalid argument(s).");
+		return NULL;
+	}
+
+	AWSHttpResponse* response = invoke(request);
+	if (response == NULL) {
+		return NULL;	// NOTE The error code already been set.
+	}
+
+	SQSChangeMessageVisibilityBatchResult* result = (_protocol == SQSP_JSON) ?
+			SQSJSONResultUnmarshaller().unmarshallChangeMessageVisibilityBatch(
+					response) :
+			SQSChangeMessageVisibilityBatchResultUnmarshaller().unmarshall(
+					response);
+	if (result == NULL) {
+		_lastError = AWSE_ParseXMLFailed;
+		LOGE("Error occurs during parse response body.");
+	}
+
+	return result;
 }
 
 AWSHttpResponse* SQSClient::invoke(AWSHttpRequest* request) {
 	request->setEndpoint(getEndpoint());
 	// TODO more initialization here
-	_webClient->setCredentials(_credentials);
-	_webClient->setSigner(_signer);
-	AWSHttpResponse* response = _webClient->execute(request);
+	// Keeps the credentials alive during retries, even if they are rotated.
+	REF<AWSCredentials> credentials = getCredentials();
+	REF<AWSHttpClient> webClient = acquireWebClient();
+	webClient->setCredentials(credentials);
+	webClient->setSigner(_signer);
+	AWSHttpResponse* response = webClient->execute(request);
 	if (response == NULL) {
-		_lastError = _webClient->getLastError();
+		_lastError = webClient->getLastError();
 		LOGE("Failed to send request.");
+		releaseWebClient(webClient);
 		return NULL;
 	}
+	releaseWebClient(webClient);
 
 	LOGT("RESP_CONTENT=%s", response->getContent().cstr());
 
 	return response;
 }
+
+AWSHttpClient* SQSClient::acquireWebClient() {
+	MutexHolder holder(&_webClientsLock);
+
+	int count = _idleWebClients.getSize();
+	if (count == 0) {
+		REF<AWSHttpClient> webClient = new AWSHttpClient();
+		webClient->autorelease();
+		return webClient;
+	}
+	REF<AWSHttpClient> webClient = _idleWebClients[count - 1];
+	_idleWebClients.removeAt(count - 1);
+	webClient->autorelease();
+	return webClient;
+}
+
+void SQSClient::releaseWebClient(AWSHttpClient* webClient) {
+	BFX_ASSERT(webClient);
+
+	MutexHolder holder(&_webClientsLock);
+	_idleWebClients.add(webClient);
+}
@@ -10,18 +10,90 @@
 
 #include "AWSHttpClient.h"
 
+class S3Client;
+
 /// Providers a client for accessing SQS service
 /// Refer to:
 /// http://docs.aws.amazon.com/AWSSimpleQueueService/latest/APIReference/API_Operations.html
 class SQSClient: public AWSClient {
 public:
+	enum {
+		MAX_MESSAGE_SIZE = 262144,	/// Maximum size of a message in bytes
+		/// Maximum size in bytes of a message sent in place of a body stored
+		/// in S3
+		MAX_POINTER_SIZE = 1024,
+		/// Default size in bytes of the bodies to compress
+		DEFAULT_COMPRESSION_THRESHOLD = 2048,
+	};
+
 	/// Creates a new instance by using given access key id, secret key and region
 	SQSClient(const String& accessKeyId, const String& secretAccessKey,
 			AWSRegion* region);
 	/// Creates a new instance by using given credentials and region
 	SQSClient(AWSCredentials* credentials, AWSRegion* region);
+	/// Creates a new instance by using given credentials provider and region
+	SQSClient(AWSCredentialsProvider* credentialsProvider, AWSRegion* region);
 	virtual ~SQSClient();
 
+	/// Enables storing message bodies in an S3 bucket, for messages larger
+	/// than given size in bytes including their attributes. A small pointer
+	/// to the object is sent instead. Received pointers are replaced with the
+	/// stored bodies, and the objects are deleted along with the messages.
+	/// The format is compatible with the Amazon SQS Extended Client Library.
+	void setPayloadOffload(S3Client* s3Client, const String& bucketName,
+			int threshold = MAX_MESSAGE_SIZE);
+	/// Gets a value indicating whether the body of a message of given size is
+	/// stored in S3.
+	bool isPayloadOffloaded(int messageSize) const {
+		return (_payloadS3Client != NULL) && (messageSize > _payloadThreshold);
+	}
+	/// Gets the size in bytes of the messages whose bodies are stored in S3.
+	int getPayloadThreshold() const {
+		return _payloadThreshold;
+	}
+
+	/// Enables compressing message bodies larger than given size in bytes, by
+	/// given zlib level, -1 for the default one. Bodies are only sent
+	/// compressed if that makes them smaller. Compressed bodies are received
+	/// decompressed whether this is enabled or not. See SQSBodyCodec.
+	void setBodyCompression(int threshold = DEFAULT_COMPRESSION_THRESHOLD,
+			int level = -1);
+	/// Disables compressing message bodies.
+	void disableBodyCompression() {
+		_compressionThreshold = -1;
+	}
+	/// Sets the maximum size in bytes of the bodies received compressed once
+	/// decompressed, SQSBodyCodec::DEFAULT_MAX_BODY_SIZE by default. Larger
+	/// bodies are received as they are, see SQSMessage::bodyEncoded.
+	void setMaxDecompressedBodySize(int maxBodySize) {
+		BFX_ASSERT(maxBodySize >= 0);
+		_maxDecompressedBodySize = maxBodySize;
+	}
+
+	/// Enables computing content-based deduplication IDs locally, for the
+	/// messages sent with a group ID but no deduplication ID, i.e. to FIFO
+	/// queues. The ID is the hex SHA-256 digest of the body, as SQS computes
+	/// it for queues with content-based deduplication, so that such queues
+	/// aren't required.
+	void setContentDeduplication(bool contentDeduplication) {
+		_contentDeduplication = contentDeduplication;
+	}
+
+	/// Sets the protocol the requests are made in, the query one by default.
+	/// The JSON protocol takes fewer bytes on the wire and less parsing, the
+	/// results read the same either way.
+	void setProtocol(SQSProtocol protocol) {
+		_protocol = protocol;
+	}
+	SQSProtocol getProtocol() const {
+		return _protocol;
+	}
+
+	/// Gets a value indicating whether the queue of given URL is a FIFO one.
+	static bool isFifoQueue(const String& queueUrl) {
+		return queueUrl.endsWith(".fifo");
+	}
+
 	/// Creates a new queue, or returns the URL of an existing one. When you
 	/// request CreateQueue, you provide a name for the queue. To successfully
 	/// create a new queue, you must provide a name that is unique within the
@@ -39,24 +111,47 @@ public:
 	SQSListQueuesResult* listQueues(const String &queueNamePrefix = "");
 	SQSListQueuesResult* listQueues(const SQSListQueuesParams* params);
 
+	/// Returns the URL of an existing queue.
+	SQSGetQueueUrlResult* getQueueUrl(const String& queueName);
+	SQSGetQueueUrlResult* getQueueUrl(const SQSGetQueueUrlParams* params);
+	/// Returns the URL of an existing queue through the cache shared by the
+	/// process, or an empty string if the queue doesn't exist or the lookup
+	/// failed. See SQSQueueUrlCache.
+	String resolveQueueUrl(const String& queueName);
+
 	/// Delivers a message to the specified queue. You now have the ability to
 	/// send large payload messages that are up to 256KB (262,144 bytes) in size.
 	SQSSendMessageResult* sendMessage(const String &queueUrl,
 			const String &messageBody, int delaySeconds = 0);
 	SQSSendMessageResult* sendMessage(const SQSSendMessageParams* params);
 
+	/// Delivers up to ten messages to the specified queue. The result of the
+	/// send action on each message is reported individually in the response.
+	SQSSendMessageBatchResult* sendMessageBatch(const String &queueUrl,
+			const SQSSendMessageBatchRequestEntryList* entries);
+	SQSSendMessageBatchResult* sendMessageBatch(
+			const SQSSendMessageBatchParams* params);
+
 	/// Retrieves one or more messages, with a maximum limit of 10 messages,
 	/// from the specified queue.
 	SQSReceiveMessageResult* receiveMessage(const String &queueUrl,
 			int mumberOfMessages = 1, int visibilityTimeout = -1);
 	SQSReceiveMessageResult* receiveMessage(
 			const SQSReceiveMessageParams* params);
+	/// Retrieves messages as receiveMessage() does, into one compact batch
+	/// rather than a list of objects. The bodies are as received, neither
+	/// decompressed nor loaded from S3, so the call fails with
+	/// AWSE_InvalidArguments if payload offload or body compression is
+	/// enabled. Use receiveMessage() for such queues.
+	SQSReceiveMessageBatchResult* receiveMessageBatch(
+			const SQSReceiveMessageParams* params);
 
 	/// Deletes the specified message from the specified queue. You specify the
 	/// message by using the message's receipt handle and not the message ID
 	/// you received when you sent the message.
 	SQSDeleteMessageResult* deleteMessage(const String &queueUrl,
 			const String& receiptHandle);
+	SQSDeleteMessageResult* deleteMessage(const SQSDeleteMessageParams* params);
 
 	/// Deletes up to ten messages from the specified queue. The result of the
 	/// delete action on each message is reported individually in the response.
@@ -65,12 +160,68 @@ public:
 	SQSDeleteMessageBatchResult* deleteMessageBatch(
 			const SQSDeleteMessageBatchParams* params);
 
+	/// Changes the visibility timeout of the specified message in a queue to a
+	/// new value, counted from now.
+	SQSChangeMessageVisibilityResult* changeMessageVisibility(
+			const String& queueUrl, const String& receiptHandle,
+			int visibilityTimeout);
+	SQSChangeMessageVisibilityResult* changeMessageVisibility(
+			const SQSChangeMessageVisibilityParams* params);
+
+	/// Changes the visibility timeout of up to ten messages. The result of the
+	/// action on each message is reported individually in the response.
+	SQSChangeMessageVisibilityBatchResult* changeMessageVisibilityBatch(
+			const String& queueUrl,
+			const SQSChangeMessageVisibilityBatchRequestEntryList* entries);
+	SQSChangeMessageVisibilityBatchResult* changeMessageVisibilityBatch(
+			const SQSChangeMessageVisibilityBatchParams* params);
+
 protected:
-	// Invokes a request and returns a response.
+	// Invokes a request and returns a response. Requests may be invoked by
+	// many threads at once, each one uses a web client of its own.
 	AWSHttpResponse* invoke(AWSHttpRequest* request);
 
 private:
-	REF<AWSHttpClient> _webClient;
+	// Takes an idle web client, or creates a new one.
+	AWSHttpClient* acquireWebClient();
+	// Returns a web client to the idle ones.
+	void releaseWebClient(AWSHttpClient* webClient);
+
+	// Stores a message body in S3. Returns the pointer to send instead, or an
+	// empty string on failure.
+	String offloadPayload(const String& messageBody);
+	// Replaces the pointers received with the bodies stored in S3. Messages
+	// whose bodies can't be loaded are left out, to be received again.
+	void loadPayloads(SQSReceiveMessageResult* result);
+	// Deletes the body stored in S3 of a message, if the message has one.
+	void deletePayload(const String& receiptHandle);
+	// Compresses and offloads a message body to send as enabled, replacing
+	// the body and the attributes, the latter with a copy. Returns false on
+	// failure.
+	bool encodeMessage(String& messageBody,
+			REF<AWSStringMap>& messageAttributes);
+	// Decompresses the compressed bodies received. Messages whose bodies
+	// can't be decompressed are kept as received, and flagged.
+	void decodeMessages(SQSReceiveMessageResult* result);
+	// Gets a value indicating whether to compute the deduplication ID of a
+	// message.
+	bool isDeduplicationIdComputed(const String& messageGroupId,
+			const String& messageDeduplicationId) const {
+		return _contentDeduplication && !messageGroupId.isEmpty()
+				&& messageDeduplicationId.isEmpty();
+	}
+
+	ArrayListT<REF<AWSHttpClient> > _idleWebClients;
+	Mutex _webClientsLock;
+
+	REF<S3Client> _payloadS3Client;
+	String _payloadBucketName;
+	int _payloadThreshold;
+	int _compressionThreshold;
+	int _compressionLevel;
+	int _maxDecompressedBodySize;
+	bool _contentDeduplication;
+	SQSProtocol _protocol;
 };
 
 #endif /* TestTest1_AWS_SQSCLIENT_H_ */
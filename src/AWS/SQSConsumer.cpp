@@ -0,0 +1,465 @@
+/*
+ * SQSConsumer.cpp
+ */
+
+#include "AWS.h"
+
+#define LOG_TAG "SQSConsumer"
+
+// A queue being consumed.
+class SQSConsumerQueue: public REFObject {
+public:
+	SQSConsumerQueue(const String& url, int timeout) :
+			queueUrl(url), visibilityTimeout(timeout), fifo(
+					SQSClient::isFifoQueue(url)), outstanding(0), pollers(0), roomEvent(
+					false) {
+	}
+
+	String queueUrl;
+	int visibilityTimeout;
+	bool fifo;
+	// The number of messages being received or waiting to be handled.
+	int outstanding;
+	// The number of polling threads running.
+	int pollers;
+	// Signaled when the queue may have room for more messages, or on stop.
+	Event roomEvent;
+};
+
+// A thread receiving messages of a queue.
+class SQSConsumerPoller: public Thread {
+public:
+	SQSConsumerPoller(SQSConsumer* consumer, SQSConsumerQueue* queue) :
+			_consumer(consumer), _queue(queue) {
+	}
+
+protected:
+	virtual void run() {
+		_consumer->runPoller(_queue);
+	}
+
+private:
+	// The consumer stops the thread before being destroyed.
+	SQSConsumer* _consumer;
+	REF<SQSConsumerQueue> _queue;
+};
+
+// A message group of a FIFO queue, whose messages are handled one at a time.
+// It is ready while not being handled and having messages waiting.
+class SQSConsumerGroup: public REFObject {
+public:
+	SQSConsumerGroup(const String& groupKey) :
+			key(groupKey) {
+	}
+
+	String key;
+	LinkedListT<REF<SQSMessage> > pending;
+	REF<SQSConsumerQueue> queue;
+};
+
+// A thread handling messages, with its own deque of messages.
+class SQSConsumerWorker: public Thread {
+public:
+	SQSConsumerWorker(SQSConsumer* consumer) :
+			_consumer(consumer) {
+	}
+
+	struct Item {
+		REF<SQSConsumerQueue> queue;
+		REF<SQSMessage> message;
+	};
+
+	// Guards the deque, taken after the lock of the consumer if both are.
+	Mutex dequeLock;
+	LinkedListT<Item> deque;
+
+protected:
+	virtual void run() {
+		_consumer->runWorker(this);
+	}
+
+private:
+	// The consumer stops the thread before being destroyed.
+	SQSConsumer* _consumer;
+};
+
+SQSConsumer::SQSConsumer(SQSClient* client, SQSMessageHandler* handler) :
+		_workEvent(false) {
+	BFX_ASSERT(client);
+	BFX_ASSERT(handler);
+
+	_client = client;
+	_handler = handler;
+	_acks = new SQSAckCoalescer(client);
+	_waitTimeSeconds = DEFAULT_WAIT_TIME_SECONDS;
+	_pollerCount = DEFAULT_POLLERS;
+	_handlerCount = DEFAULT_HANDLERS;
+	_prefetch = DEFAULT_PREFETCH;
+	_running = false;
+	_draining = false;
+	_nextWorker = 0;
+	_handledCount = 0;
+	_receiveAttemptCount = 0;
+}
+
+SQSConsumer::~SQSConsumer() {
+	stop();
+	_acks->close();
+}
+
+bool SQSConsumer::addQueue(const String& queueUrl, int visibilityTimeout) {
+	BFX_ASSERT(!queueUrl.isEmpty());
+	BFX_ASSERT(visibilityTimeout >= -1);
+
+	MutexHolder holder(&_lock);
+	if (_running) {
+		LOGE("Unable to add a queue to a running consumer.");
+		return false;
+	}
+	_queues.add(new SQSConsumerQueue(queueUrl, visibilityTimeout));
+	return true;
+}
+
+void SQSConsumer::setPollers(int pollers) {
+	BFX_ASSERT(pollers > 0);
+
+	MutexHolder holder(&_lock);
+	_pollerCount = pollers;
+	if (!_running)
+		return;
+	for (int i = 0; i < _queues.getSize(); i++) {
+		SQSConsumerQueue* queue = _queues[i];
+		while (queue->pollers < _pollerCount) {
+			if (!startPoller(queue))
+				break;
+		}
+		// The extra pollers exit on their own once woken up.
+		queue->roomEvent.set();
+	}
+}
+
+void SQSConsumer::setHandlers(int handlers) {
+	BFX_ASSERT(handlers > 0);
+
+	MutexHolder holder(&_lock);
+	_handlerCount = handlers;
+	if (!_running)
+		return;
+	while (_workers.getSize() < _handlerCount) {
+		if (!startWorker())
+			break;
+	}
+	// The extra handlers exit on their own once woken up.
+	_workEvent.set();
+}
+
+void SQSConsumer::setPrefetch(int prefetch) {
+	BFX_ASSERT(prefetch > 0);
+
+	MutexHolder holder(&_lock);
+	_prefetch = prefetch;
+	for (int i = 0; i < _queues.getSize(); i++)
+		_queues[i]->roomEvent.set();
+}
+
+bool SQSConsumer::start() {
+	MutexHolder holder(&_lock);
+	if (_running || _queues.getSize() == 0)
+		return false;
+
+	_running = true;
+	for (int i = 0; i < _handlerCount; i++) {
+		if (!startWorker())
+			break;
+	}
+	for (int i = 0; i < _queues.getSize(); i++) {
+		for (int j = 0; j < _pollerCount; j++) {
+			if (!startPoller(_queues[i]))
+				break;
+		}
+	}
+	return _workers.getSize() > 0;
+}
+
+void SQSConsumer::stop() {
+	{
+		MutexHolder holder(&_lock);
+		if (!_running)
+			return;
+		_running = false;
+		for (int i = 0; i < _queues.getSize(); i++)
+			_queues[i]->roomEvent.set();
+	}
+	for (int i = 0; i < _pollerThreads.getSize(); i++)
+		_pollerThreads[i]->join();
+	_pollerThreads.clear();
+
+	// Nothing is received any more, the handlers exit once the deques are
+	// drained, each one wakes the next one up.
+	{
+		MutexHolder holder(&_lock);
+		_draining = true;
+		_workEvent.set();
+	}
+	for (int i = 0; i < _workerThreads.getSize(); i++)
+		_workerThreads[i]->join();
+	_workerThreads.clear();
+	_acks->flush();
+
+	MutexHolder holder(&_lock);
+	_workers.clear();
+	_groups.clear();
+	_readyGroups.clear();
+	_draining = false;
+	_workEvent.reset();
+}
+
+bool SQSConsumer::startPoller(SQSConsumerQueue* queue) {
+	REF<SQSConsumerPoller> poller = new SQSConsumerPoller(this, queue);
+	if (!poller->start()) {
+		LOGE("Unable to start a polling thread.");
+		return false;
+	}
+	_pollerThreads.add((SQSConsumerPoller*) poller);
+	queue->pollers++;
+	return true;
+}
+
+bool SQSConsumer::startWorker() {
+	REF<SQSConsumerWorker> worker = new SQSConsumerWorker(this);
+	if (!worker->start()) {
+		LOGE("Unable to start a handler thread.");
+		return false;
+	}
+	_workerThreads.add((SQSConsumerWorker*) worker);
+	_workers.add(worker);
+	return true;
+}
+
+void SQSConsumer::dispatch(SQSConsumerQueue* queue, SQSMessageList* messages) {
+	if (queue->fifo) {
+		// Queues the messages by group, in the order received.
+		for (SQSMessageList::PENTRY entry = messages->getFirstEntry();
+				entry != NULL; entry = messages->getNextEntry(entry)) {
+			SQSMessage* message = entry->value;
+			AWSStringMap::PENTRY groupId = (message->attributes == NULL) ?
+					NULL : message->attributes->getEntry("MessageGroupId");
+			String key = queue->queueUrl + "\n"
+					+ ((groupId != NULL) ? groupId->value : message->messageId);
+			TreeMapT<String, REF<SQSConsumerGroup> >::PENTRY group =
+					_groups.getEntry(key);
+			if (group == NULL) {
+				group = _groups.set(key, new SQSConsumerGroup(key));
+				group->value->queue = queue;
+				_readyGroups.addLast(group->value);
+			}
+			group->value->pending.addLast(message);
+		}
+		_workEvent.set();
+		return;
+	}
+
+	// Round robin, idle threads steal from the busy ones anyway.
+	SQSConsumerWorker* worker = _workers[_nextWorker++ % _workers.getSize()];
+	{
+		MutexHolder holder(&worker->dequeLock);
+		for (SQSMessageList::PENTRY entry = messages->getFirstEntry();
+				entry != NULL; entry = messages->getNextEntry(entry)) {
+			SQSConsumerWorker::Item item;
+			item.queue = queue;
+			item.message = entry->value;
+			worker->deque.addLast(item);
+		}
+	}
+	_workEvent.set();
+}
+
+bool SQSConsumer::takeMessage(SQSConsumerWorker* worker,
+		REF<SQSConsumerGroup>& group, REF<SQSConsumerQueue>& queue,
+		REF<SQSMessage>& message) {
+	{
+		MutexHolder holder(&worker->dequeLock);
+		if (worker->deque.getSize() > 0) {
+			SQSConsumerWorker::Item& item = worker->deque.getFirstEntry()->value;
+			queue = item.queue;
+			message = item.message;
+			worker->deque.removeFirst();
+			// Lets an idle thread steal the rest meanwhile.
+			if (worker->deque.getSize() > 0)
+				_workEvent.set();
+			return true;
+		}
+	}
+
+	MutexHolder holder(&_lock);
+	if (_readyGroups.getSize() > 0) {
+		// The group isn't taken again until the message is finished.
+		group = _readyGroups.getFirstEntry()->value;
+		_readyGroups.removeFirst();
+		queue = group->queue;
+		message = group->pending.getFirstEntry()->value;
+		group->pending.removeFirst();
+		if (_readyGroups.getSize() > 0)
+			_workEvent.set();
+		return true;
+	}
+
+	// Steals the message the owner would take last.
+	int count = _workers.getSize();
+	int start = _workers.indexOf(worker) + 1;
+	for (int i = 0; i < count; i++) {
+		SQSConsumerWorker* victim = _workers[(start + i) % count];
+		if (victim == worker)
+			continue;
+		MutexHolder victimHolder(&victim->dequeLock);
+		if (victim->deque.getSize() > 0) {
+			SQSConsumerWorker::Item& item = victim->deque.getLastEntry()->value;
+			queue = item.queue;
+			message = item.message;
+			victim->deque.removeLast();
+			if (victim->deque.getSize() > 0)
+				_workEvent.set();
+			return true;
+		}
+	}
+	return false;
+}
+
+int SQSConsumer::finishGroupMessage(SQSConsumerGroup* group, bool deleted) {
+	int givenUp = 0;
+	if (!deleted && group->pending.getSize() > 0) {
+		// The rest would be out of order, they become visible again after
+		// the message anyway.
+		givenUp = group->pending.getSize();
+		LOGW("Giving up %d message(s) following an undeleted one of group '%s'.",
+				givenUp, group->key.cstr());
+		group->pending.clear();
+	}
+	if (group->pending.getSize() > 0) {
+		// Goes to the back, so that the groups take turns.
+		_readyGroups.addLast(group);
+		_workEvent.set();
+	} else {
+		_groups.remove(group->key);
+	}
+	return givenUp;
+}
+
+void SQSConsumer::runPoller(SQSConsumerQueue* queue) {
+	// A receive retried by the same attempt ID after a failure returns the
+	// same messages of a FIFO queue, rather than hiding them until timeout.
+	String receiveRequestAttemptId;
+	_lock.lock();
+	while (true) {
+		if (!_running || queue->pollers > _pollerCount) {
+			queue->pollers--;
+			// Lets another extra poller exit.
+			queue->roomEvent.set();
+			break;
+		}
+		int room = _prefetch - queue->outstanding;
+		if (room <= 0) {
+			// Handlers wake a poller up as they finish messages.
+			_lock.unlock();
+			queue->roomEvent.wait(RETRY_INTERVAL);
+			_lock.lock();
+			continue;
+		}
+		int count = BFX_MIN(room, (int) MAX_RECEIVE_MESSAGES);
+		queue->outstanding += count;
+		if (room > count)
+			queue->roomEvent.set();
+		_lock.unlock();
+
+		REFAutoreleasePool pool;
+		REF<SQSReceiveMessageParams> params = new SQSReceiveMessageParams(
+				queue->queueUrl);
+		params->setMaxNumberOfMessages(count);
+		if (queue->visibilityTimeout != -1)
+			params->setVisibilityTimeout(queue->visibilityTimeout);
+		params->setWaitTimeSeconds(_waitTimeSeconds);
+		if (queue->fifo) {
+			params->getAttributeNames()->addLast("MessageGroupId");
+			if (receiveRequestAttemptId.isEmpty()) {
+				receiveRequestAttemptId = String::format("%p-%ld-%lld", this,
+						InterlockedIncrement(&_receiveAttemptCount),
+						(long long) Thread::getTickCount());
+			}
+			params->setReceiveRequestAttemptId(receiveRequestAttemptId);
+		}
+		SQSReceiveMessageResult* result = _client->receiveMessage(params);
+		bool failed = (result == NULL || !result->getErrorCode().isEmpty());
+		if (!failed)
+			receiveRequestAttemptId = String();
+		if (failed) {
+			LOGE("Failed to receive messages of '%s': %s",
+					queue->queueUrl.cstr(),
+					(result == NULL) ? "request failed" :
+							result->getErrorMessage().cstr());
+			Thread::sleep(RETRY_INTERVAL);
+		}
+
+		_lock.lock();
+		int received = 0;
+		if (!failed && result->hasMessages()) {
+			received = result->getMessages()->getSize();
+			dispatch(queue, result->getMessages());
+		}
+		// Gives back the reserved room not used.
+		queue->outstanding -= count - received;
+		if (received < count)
+			queue->roomEvent.set();
+	}
+	_lock.unlock();
+}
+
+void SQSConsumer::runWorker(SQSConsumerWorker* worker) {
+	while (true) {
+		REF<SQSConsumerGroup> group;
+		REF<SQSConsumerQueue> queue;
+		REF<SQSMessage> message;
+		if (takeMessage(worker, group, queue, message)) {
+			REFAutoreleasePool pool;
+			bool deleted = _handler->handleMessage(queue->queueUrl, message);
+			if (deleted)
+				_acks->ack(queue->queueUrl, message->receiptHandle);
+			InterlockedIncrement(&_handledCount);
+
+			MutexHolder holder(&_lock);
+			queue->outstanding--;
+			if (group != NULL)
+				queue->outstanding -= finishGroupMessage(group, deleted);
+			queue->roomEvent.set();
+			continue;
+		}
+
+		_lock.lock();
+		if (_workers.getSize() > _handlerCount) {
+			// Retires, handing the messages left over to another thread.
+			_workers.remove(worker);
+			SQSConsumerWorker* heir = _workers[0];
+			{
+				MutexHolder holder(&worker->dequeLock);
+				MutexHolder heirHolder(&heir->dequeLock);
+				for (LinkedListT<SQSConsumerWorker::Item>::PENTRY entry =
+						worker->deque.getFirstEntry(); entry != NULL;
+						entry = worker->deque.getNextEntry(entry)) {
+					heir->deque.addLast(entry->value);
+				}
+				worker->deque.clear();
+			}
+			_workEvent.set();
+			_lock.unlock();
+			break;
+		}
+		if (_draining) {
+			_workEvent.set();
+			_lock.unlock();
+			break;
+		}
+		_lock.unlock();
+		// The time-out covers a message dispatched between the failed take
+		// and the wait.
+		_workEvent.wait(RETRY_INTERVAL);
+	}
+}
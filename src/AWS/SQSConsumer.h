@@ -0,0 +1,146 @@
+/*
+ * SQSConsumer.h
+ */
+
+#ifndef AWS_SQSCONSUMER_H_
+#define AWS_SQSCONSUMER_H_
+
+/// Processes the messages received by SQSConsumer.
+class SQSMessageHandler {
+public:
+	virtual ~SQSMessageHandler() {
+	}
+	/// Processes a message of given queue, on one of the handler threads.
+	/// Returns true to delete the message, or false to leave it to be
+	/// delivered again once its visibility timeout expires.
+	virtual bool handleMessage(const String& queueUrl, SQSMessage* message) = 0;
+};
+
+class SQSConsumerQueue;
+class SQSConsumerPoller;
+class SQSConsumerWorker;
+class SQSConsumerGroup;
+
+/// Consumes messages of one or more queues by a pool of threads. Polling
+/// threads run long-poll receives per queue, and hand the messages out to
+/// handler threads. Each handler thread has its own deque of messages, it
+/// takes messages from the front of its own deque, and steals from the back
+/// of the others' when it runs out. Handled messages are deleted through an
+/// SQSAckCoalescer.
+///
+/// Messages of FIFO queues are handled in order within each message group
+/// instead: a group is handled by one thread at a time, while different groups
+/// are handled in parallel. Once a message of a group isn't deleted, the
+/// messages of the group received after it are given up, so that they are
+/// delivered again in order.
+///
+/// Each queue may have up to a prefetch count of messages received but not
+/// handled yet. Its pollers stop receiving when the budget is used up, so that
+/// slow handlers push back on the pollers, and a busy queue can't crowd the
+/// handlers out of the messages of the others.
+///
+/// The numbers of pollers and handlers, and the prefetch count, can be changed
+/// while running.
+class SQSConsumer: public REFObject {
+public:
+	enum {
+		MAX_RECEIVE_MESSAGES = 10,	/// Maximum number of messages per receive
+		DEFAULT_POLLERS = 1,	/// Default number of pollers per queue
+		DEFAULT_HANDLERS = 4,	/// Default number of handler threads
+		DEFAULT_PREFETCH = 20,	/// Default prefetch count per queue
+		DEFAULT_WAIT_TIME_SECONDS = 20,	/// Default long-poll duration
+		/// Time in milliseconds to wait before retrying a failed receive
+		RETRY_INTERVAL = 1000,
+	};
+
+	/// Creates a consumer passing the messages received by the client to the
+	/// handler. The handler must outlive the consumer.
+	SQSConsumer(SQSClient* client, SQSMessageHandler* handler);
+	virtual ~SQSConsumer();
+
+	/// Adds a queue to consume, the received messages are hidden for the
+	/// visibility timeout in seconds, or -1 to use the default of the queue.
+	/// Queues can only be added while the consumer isn't running.
+	bool addQueue(const String& queueUrl, int visibilityTimeout = -1);
+
+	/// Sets the number of polling threads per queue.
+	void setPollers(int pollers);
+	/// Sets the number of handler threads.
+	void setHandlers(int handlers);
+	/// Sets the maximum number of messages per queue received but not handled
+	/// yet.
+	void setPrefetch(int prefetch);
+	void setWaitTimeSeconds(int waitTimeSeconds) {
+		_waitTimeSeconds = waitTimeSeconds;
+	}
+
+	/// Starts the threads.
+	bool start();
+	/// Stops receiving, waits for the received messages to be handled and
+	/// their deletions to be sent, then stops the threads. This may take as
+	/// long as a long poll.
+	void stop();
+
+	/// Gets the number of messages handled so far.
+	int64_t getHandledCount() const {
+		return _handledCount;
+	}
+	/// Gets the number of messages deleted so far.
+	int64_t getDeletedCount() const {
+		return _acks->getDeletedCount();
+	}
+
+private:
+	friend class SQSConsumerQueue;
+	friend class SQSConsumerPoller;
+	friend class SQSConsumerWorker;
+
+	// Starts a polling thread of the queue, the lock must be held.
+	bool startPoller(SQSConsumerQueue* queue);
+	// Starts a handler thread, the lock must be held.
+	bool startWorker();
+	// Hands received messages out to a handler thread, the lock must be held.
+	void dispatch(SQSConsumerQueue* queue, SQSMessageList* messages);
+	// Takes a message from the deque of the thread, or the next one of a
+	// ready message group, or steals one from another thread. Returns false
+	// if there is none.
+	bool takeMessage(SQSConsumerWorker* worker, REF<SQSConsumerGroup>& group,
+			REF<SQSConsumerQueue>& queue, REF<SQSMessage>& message);
+	// Lets the next message of the group be taken, or gives up the rest of
+	// the group if the message wasn't deleted. The lock must be held.
+	// Returns the number of messages given up.
+	int finishGroupMessage(SQSConsumerGroup* group, bool deleted);
+	// The loop of each polling thread.
+	void runPoller(SQSConsumerQueue* queue);
+	// The loop of each handler thread.
+	void runWorker(SQSConsumerWorker* worker);
+
+	REF<SQSClient> _client;
+	SQSMessageHandler* _handler;
+	REF<SQSAckCoalescer> _acks;
+	int _waitTimeSeconds;
+
+	Mutex _lock;
+	ArrayListT<REF<SQSConsumerQueue> > _queues;
+	int _pollerCount;
+	int _handlerCount;
+	int _prefetch;
+	bool _running;
+	bool _draining;
+	// The handler threads taking messages, and the one to hand out to next.
+	ArrayListT<REF<SQSConsumerWorker> > _workers;
+	int _nextWorker;
+	volatile long _handledCount;
+	volatile long _receiveAttemptCount;
+	// The message groups of FIFO queues with messages being handled or
+	// waiting, by queue URL and group ID, and the ones waiting to be taken.
+	TreeMapT<String, REF<SQSConsumerGroup> > _groups;
+	LinkedListT<REF<SQSConsumerGroup> > _readyGroups;
+	// Signaled when there may be a message to handle, or on stop.
+	Event _workEvent;
+	// All threads started, including the retired ones, to be joined on stop.
+	ArrayListT<REF<Thread> > _pollerThreads;
+	ArrayListT<REF<Thread> > _workerThreads;
+};
+
+#endif /* AWS_SQSCONSUMER_H_ */
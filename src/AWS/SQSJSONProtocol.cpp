@@ -0,0 +1,896 @@
+/*
+ * SQSJSONProtocol.cpp
+ */
+
+#include "AWS.h"
+#include "../JSON/JSON.h"
+
+// Writes the compact JSON object of a request, putting the separators
+// between the members and between the elements.
+class SQSJSONRequestWriter {
+public:
+	SQSJSONRequestWriter() :
+			_separated(true) {
+		_textWriter = new StringWriter();
+		_writer = new JSONWriter(_textWriter);
+		_writer->setCompactMode(true);
+		_writer->writeObjectBegin();
+	}
+
+	// Starts an object, as a member of given name or as an element.
+	void beginObject(const char* name = NULL) {
+		writeName(name);
+		_writer->writeObjectBegin();
+		_separated = true;
+	}
+	void endObject() {
+		_writer->writeEndObject();
+		_separated = false;
+	}
+	void beginArray(const char* name) {
+		writeName(name);
+		_writer->writeStartArray();
+		_separated = true;
+	}
+	void endArray() {
+		_writer->writeEndArray();
+		_separated = false;
+	}
+	void writeString(const char* name, const String& value) {
+		writeName(name);
+		_writer->writeString(value);
+		_separated = false;
+	}
+	void writeNumber(const char* name, int value) {
+		writeName(name);
+		_writer->writeNumber(String::format("%d", value));
+		_separated = false;
+	}
+	// Writes the string message attributes, as a MessageAttributes member.
+	void writeMessageAttributes(const AWSStringMap* attrs) {
+		beginObject("MessageAttributes");
+		for (AWSStringMap::PENTRY attr = attrs->getFirstEntry(); attr != NULL;
+				attr = attrs->getNextEntry(attr)) {
+			beginObject(attr->key);
+			writeString("DataType", "String");
+			writeString("StringValue", attr->value);
+			endObject();
+		}
+		endObject();
+	}
+
+	// Ends the request object, and gets its text.
+	String getString() {
+		_writer->writeEndObject();
+		return _textWriter->getString();
+	}
+
+private:
+	void writeName(const char* name) {
+		if (!_separated)
+			_writer->writeArraySeparator();
+		if (name != NULL) {
+			_writer->writeString(name);
+			_writer->writeMemberSeparator();
+		}
+	}
+
+	REF<StringWriter> _textWriter;
+	REF<JSONWriter> _writer;
+	// Whether the next member or element follows a '{' or a '['.
+	bool _separated;
+};
+
+AWSHttpRequest* SQSJSONParamsMarshaller::createHttpRequest(const char* action,
+		const String& content) {
+	REF<AWSHttpRequest> request = new AWSHttpRequest("AmazonSQS");
+	request->getHeaders()->set("Content-Type", "application/x-amz-json-1.0");
+	request->getHeaders()->set("X-Amz-Target",
+			String::format("AmazonSQS.%s", action));
+	// Asks for the error codes of the query protocol in x-amzn-query-error.
+	request->getHeaders()->set("x-amzn-query-mode", "true");
+	request->setContent((const uint8_t*) content.cstr(), content.getLength());
+	request->autorelease();
+	return request;
+}
+
+AWSHttpRequest* SQSJSONParamsMarshaller::marshall(
+		const SQSListQueuesParams* params) {
+	BFX_ASSERT(params);
+	SQSJSONRequestWriter writer;
+	if (!params->getQueueNamePrefix().isEmpty())
+		writer.writeString("QueueNamePrefix", params->getQueueNamePrefix());
+	return createHttpRequest("ListQueues", writer.getString());
+}
+
+AWSHttpRequest* SQSJSONParamsMarshaller::marshall(
+		const SQSGetQueueUrlParams* params) {
+	BFX_ASSERT(params);
+	SQSJSONRequestWriter writer;
+	writer.writeString("QueueName", params->getQueueName());
+	if (!params->getQueueOwnerAWSAccountId().isEmpty()) {
+		writer.writeString("QueueOwnerAWSAccountId",
+				params->getQueueOwnerAWSAccountId());
+	}
+	return createHttpRequest("GetQueueUrl", writer.getString());
+}
+
+AWSHttpRequest* SQSJSONParamsMarshaller::marshall(
+		const SQSSendMessageParams* params) {
+	BFX_ASSERT(params);
+	SQSJSONRequestWriter writer;
+	writer.writeString("QueueUrl", params->getQueueUrl());
+	writer.writeString("MessageBody", params->getMessageBody());
+	if (params->getDelaySeconds() != -1)
+		writer.writeNumber("DelaySeconds", params->getDelaySeconds());
+	if (params->hasMessageAttributes())
+		writer.writeMessageAttributes(params->getMessageAttributes());
+	if (!params->getMessageGroupId().isEmpty())
+		writer.writeString("MessageGroupId", params->getMessageGroupId());
+	if (!params->getMessageDeduplicationId().isEmpty()) {
+		writer.writeString("MessageDeduplicationId",
+				params->getMessageDeduplicationId());
+	}
+	return createHttpRequest("SendMessage", writer.getString());
+}
+
+AWSHttpRequest* SQSJSONParamsMarshaller::marshall(
+		const SQSSendMessageBatchParams* params) {
+	BFX_ASSERT(params);
+	SQSJSONRequestWriter writer;
+	writer.writeString("QueueUrl", params->getQueueUrl());
+	writer.beginArray("Entries");
+	if (params->hasEntries()) {
+		SQSSendMessageBatchRequestEntryList* entries = params->getEntries();
+		for (SQSSendMessageBatchRequestEntryList::PENTRY entry =
+				entries->getFirstEntry(); entry != NULL;
+				entry = entries->getNextEntry(entry)) {
+			writer.beginObject();
+			writer.writeString("Id", entry->value->id);
+			writer.writeString("MessageBody", entry->value->messageBody);
+			if (entry->value->delaySeconds != -1)
+				writer.writeNumber("DelaySeconds", entry->value->delaySeconds);
+			if (entry->value->messageAttributes != NULL)
+				writer.writeMessageAttributes(entry->value->messageAttributes);
+			if (!entry->value->messageGroupId.isEmpty()) {
+				writer.writeString("MessageGroupId",
+						entry->value->messageGroupId);
+			}
+			if (!entry->value->messageDeduplicationId.isEmpty()) {
+				writer.writeString("MessageDeduplicationId",
+						entry->value->messageDeduplicationId);
+			}
+			writer.endObject();
+		}
+	}
+	writer.endArray();
+	return createHttpRequest("SendMessageBatch", writer.getString());
+}
+
+AWSHttpRequest* SQSJSONParamsMarshaller::marshall(
+		const SQSReceiveMessageParams* params,
+		const String& extraAttributeName) {
+	BFX_ASSERT(params);
+	SQSJSONRequestWriter writer;
+	writer.writeString("QueueUrl", params->getQueueUrl());
+	if (params->getMaxNumberOfMessages() != -1) {
+		writer.writeNumber("MaxNumberOfMessages",
+				params->getMaxNumberOfMessages());
+	}
+	if (params->getVisibilityTimeout() != -1)
+		writer.writeNumber("VisibilityTimeout", params->getVisibilityTimeout());
+	if (params->getWaitTimeSeconds() != -1)
+		writer.writeNumber("WaitTimeSeconds", params->getWaitTimeSeconds());
+	if (params->hasMessageAttributeNames() || !extraAttributeName.isEmpty()) {
+		writer.beginArray("MessageAttributeNames");
+		if (params->hasMessageAttributeNames()) {
+			AWSStringMap* attrNames = params->getMessageAttributeNames();
+			for (AWSStringMap::PENTRY entry = attrNames->getFirstEntry();
+					entry != NULL; entry = attrNames->getNextEntry(entry)) {
+				writer.writeString(NULL, entry->value);
+			}
+		}
+		if (!extraAttributeName.isEmpty())
+			writer.writeString(NULL, extraAttributeName);
+		writer.endArray();
+	}
+	if (params->hasAttributeNames()) {
+		writer.beginArray("AttributeNames");
+		AWSStringList* attrNames = params->getAttributeNames();
+		for (AWSStringList::PENTRY entry = attrNames->getFirstEntry();
+				entry != NULL; entry = attrNames->getNextEntry(entry)) {
+			writer.writeString(NULL, entry->value);
+		}
+		writer.endArray();
+	}
+	if (!params->getReceiveRequestAttemptId().isEmpty()) {
+		writer.writeString("ReceiveRequestAttemptId",
+				params->getReceiveRequestAttemptId());
+	}
+	return createHttpRequest("ReceiveMessage", writer.getString());
+}
+
+AWSHttpRequest* SQSJSONParamsMarshaller::marshall(
+		const SQSDeleteMessageParams* params) {
+	BFX_ASSERT(params);
+	SQSJSONRequestWriter writer;
+	writer.writeString("QueueUrl", params->getQueueUrl());
+	writer.writeString("ReceiptHandle", params->getReceiptHandle());
+	return createHttpRequest("DeleteMessage", writer.getString());
+}
+
+AWSHttpRequest* SQSJSONParamsMarshaller::marshall(
+		const SQSDeleteMessageBatchParams* params) {
+	BFX_ASSERT(params);
+	SQSJSONRequestWriter writer;
+	writer.writeString("QueueUrl", params->getQueueUrl());
+	writer.beginArray("Entries");
+	if (params->hasEntries()) {
+		SQSDeleteMessageBatchRequestEntryList* entries = params->getEntries();
+		for (SQSDeleteMessageBatchRequestEntryList::PENTRY entry =
+				entries->getFirstEntry(); entry != NULL;
+				entry = entries->getNextEntry(entry)) {
+			writer.beginObject();
+			writer.writeString("Id", entry->value->id);
+			writer.writeString("ReceiptHandle", entry->value->receiptHandle);
+			writer.endObject();
+		}
+	}
+	writer.endArray();
+	return createHttpRequest("DeleteMessageBatch", writer.getString());
+}
+
+AWSHttpRequest* SQSJSONParamsMarshaller::marshall(
+		const SQSChangeMessageVisibilityParams* params) {
+	BFX_ASSERT(params);
+	SQSJSONRequestWriter writer;
+	writer.writeString("QueueUrl", params->getQueueUrl());
+	writer.writeString("ReceiptHandle", params->getReceiptHandle());
+	writer.writeNumber("VisibilityTimeout", params->getVisibilityTimeout());
+	return createHttpRequest("ChangeMessageVisibility", writer.getString());
+}
+
+AWSHttpRequest* SQSJSONParamsMarshaller::marshall(
+		const SQSChangeMessageVisibilityBatchParams* params) {
+	BFX_ASSERT(params);
+	SQSJSONRequestWriter writer;
+	writer.writeString("QueueUrl", params->getQueueUrl());
+	writer.beginArray("Entries");
+	if (params->hasEntries()) {
+		SQSChangeMessageVisibilityBatchRequestEntryList* entries =
+				params->getEntries();
+		for (SQSChangeMessageVisibilityBatchRequestEntryList::PENTRY entry =
+				entries->getFirstEntry(); entry != NULL;
+				entry = entries->getNextEntry(entry)) {
+			writer.beginObject();
+			writer.writeString("Id", entry->value->id);
+			writer.writeString("ReceiptHandle", entry->value->receiptHandle);
+			if (entry->value->visibilityTimeout != -1) {
+				writer.writeNumber("VisibilityTimeout",
+						entry->value->visibilityTimeout);
+			}
+			writer.endObject();
+		}
+	}
+	writer.endArray();
+	return createHttpRequest("ChangeMessageVisibilityBatch",
+			writer.getString());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Reads a response by the tokens of JSONReader, with one token of
+// look-ahead, so that the members and the elements are read into the results
+// as they come rather than into a tree of JSONNode. Each read returns false
+// on a malformed response, and so does every read after.
+class SQSJSONResponseReader {
+public:
+	SQSJSONResponseReader(const String& content) :
+			_content(content), _pending(false), _failed(false) {
+		_reader = new JSONReader(_content);
+	}
+
+	bool isFailed() const {
+		return _failed;
+	}
+
+	bool beginObject() {
+		return expect(JSONReader::JT_ObjectBegin);
+	}
+	// Reads the name of the next member of the object begun, which is the
+	// first one if first is set. Returns false at the end of the object.
+	bool nextMember(bool& first, String& name) {
+		JSONReader::JSONTokenType type = next();
+		if (type == JSONReader::JT_ObjectEnd)
+			return false;
+		if (!first) {
+			if (type != JSONReader::JT_ArraySeparator)
+				return fail();
+			type = next();
+		}
+		first = false;
+		if (type != JSONReader::JT_String)
+			return fail();
+		name = _reader->getRawValue();
+		return expect(JSONReader::JT_MemberSeparator);
+	}
+
+	bool beginArray() {
+		return expect(JSONReader::JT_ArrayBegin);
+	}
+	// Moves to the next element of the array begun, which is the first one
+	// if first is set. Returns false at the end of the array.
+	bool nextElement(bool& first) {
+		JSONReader::JSONTokenType type = next();
+		if (type == JSONReader::JT_ArrayEnd)
+			return false;
+		if (first) {
+			_pending = true;
+			_pendingType = type;
+		} else if (type != JSONReader::JT_ArraySeparator) {
+			return fail();
+		}
+		first = false;
+		return !_failed;
+	}
+
+	// Reads a string, null reads as an empty one.
+	bool readString(String& value) {
+		JSONReader::JSONTokenType type = next();
+		if (type == JSONReader::JT_String)
+			value = _reader->getRawValue();
+		else if (type == JSONReader::JT_Null)
+			value.setEmpty();
+		else
+			return fail();
+		return true;
+	}
+	bool readBool(bool& value) {
+		JSONReader::JSONTokenType type = next();
+		if (type != JSONReader::JT_True && type != JSONReader::JT_False)
+			return fail();
+		value = (type == JSONReader::JT_True);
+		return true;
+	}
+	// Skips a value of any type.
+	bool skipValue() {
+		bool first = true;
+		String name;
+		switch (next()) {
+		case JSONReader::JT_ObjectBegin:
+			while (nextMember(first, name)) {
+				if (!skipValue())
+					return false;
+			}
+			return !_failed;
+		case JSONReader::JT_ArrayBegin:
+			while (nextElement(first)) {
+				if (!skipValue())
+					return false;
+			}
+			return !_failed;
+		case JSONReader::JT_String:
+		case JSONReader::JT_Number:
+		case JSONReader::JT_True:
+		case JSONReader::JT_False:
+		case JSONReader::JT_Null:
+			return true;
+		default:
+			return fail();
+		}
+	}
+	// Reads the end of the document.
+	bool endDocument() {
+		return expect(JSONReader::JT_EOF);
+	}
+
+private:
+	JSONReader::JSONTokenType next() {
+		if (_failed)
+			return JSONReader::JT_Error;
+		if (_pending) {
+			_pending = false;
+			return _pendingType;
+		}
+		return _reader->next();
+	}
+	bool expect(JSONReader::JSONTokenType type) {
+		return (next() == type) || fail();
+	}
+	bool fail() {
+		_failed = true;
+		return false;
+	}
+
+	String _content;
+	REF<JSONReader> _reader;
+	bool _pending;
+	JSONReader::JSONTokenType _pendingType;
+	bool _failed;
+};
+
+// Reads a member of the result of an operation. Returns false if it is
+// malformed.
+typedef bool (*SQSJSONMemberReader)(SQSJSONResponseReader& reader,
+		const String& name, SQSResult* result);
+
+// Reads a response into a result by given member reader, and the members of
+// an error response into the error of the result.
+static bool unmarshallResult(AWSHttpResponse* response, SQSResult* result,
+		SQSJSONMemberReader readMember) {
+	result->setRequestId(response->getHeader("x-amzn-RequestId"));
+	String content = response->getContent();
+	bool succeeded = (response->getStatusCode() >= 200
+			&& response->getStatusCode() < 300);
+	if (content.isEmpty())
+		return succeeded;
+
+	SQSJSONResponseReader reader(content);
+	if (!reader.beginObject())
+		return false;
+	bool first = true;
+	String name;
+	String type;
+	while (reader.nextMember(first, name)) {
+		bool read;
+		if (name == "__type") {
+			read = reader.readString(type);
+		} else if (!succeeded && (name == "message" || name == "Message")) {
+			String message;
+			read = reader.readString(message);
+			result->setErrorMessage(message);
+		} else {
+			read = readMember(reader, name, result);
+		}
+		if (!read)
+			return false;
+	}
+	if (reader.isFailed() || !reader.endDocument())
+		return false;
+
+	if (!type.isEmpty()) {
+		// Prefers the code of the query protocol, e.g.
+		// AWS.SimpleQueueService.NonExistentQueue;Sender, to the name of the
+		// type, e.g. com.amazonaws.sqs#QueueDoesNotExist.
+		String code = response->getHeader("x-amzn-query-error");
+		int end = code.indexOf(';');
+		if (end != -1)
+			code = code.substring(0, end);
+		if (code.isEmpty())
+			code = type.substring(type.indexOf('#') + 1);
+		result->setErrorCode(code);
+	} else if (!succeeded) {
+		return false;
+	}
+	return true;
+}
+
+// Reads an array of strings into a list.
+static bool readStringList(SQSJSONResponseReader& reader,
+		AWSStringList* list) {
+	if (!reader.beginArray())
+		return false;
+	bool first = true;
+	while (reader.nextElement(first)) {
+		String value;
+		if (!reader.readString(value))
+			return false;
+		list->addLast(value);
+	}
+	return !reader.isFailed();
+}
+
+// Reads the value object of a message attribute, for its string value.
+static bool readMessageAttributeValue(SQSJSONResponseReader& reader,
+		String& value) {
+	if (!reader.beginObject())
+		return false;
+	bool first = true;
+	String name;
+	while (reader.nextMember(first, name)) {
+		if (!((name == "StringValue") ?
+				reader.readString(value) : reader.skipValue()))
+			return false;
+	}
+	return !reader.isFailed();
+}
+
+// Reads the system attributes, or the message attributes, of a message into
+// a map.
+static bool readAttributes(SQSJSONResponseReader& reader,
+		REF<AWSStringMap>& attributes, bool system) {
+	if (!reader.beginObject())
+		return false;
+	bool first = true;
+	String name;
+	while (reader.nextMember(first, name)) {
+		String value;
+		if (!(system ?
+				reader.readString(value) :
+				readMessageAttributeValue(reader, value)))
+			return false;
+		// Binary attributes are left out, string ones can't be empty.
+		if (!system && value.isEmpty())
+			continue;
+		if (attributes == NULL)
+			attributes = new AWSStringMap();
+		attributes->set(name, value);
+	}
+	return !reader.isFailed();
+}
+
+static bool readMessage(SQSJSONResponseReader& reader, SQSMessage* message) {
+	if (!reader.beginObject())
+		return false;
+	bool first = true;
+	String name;
+	while (reader.nextMember(first, name)) {
+		bool read;
+		if (name == "MessageId")
+			read = reader.readString(message->messageId);
+		else if (name == "ReceiptHandle")
+			read = reader.readString(message->receiptHandle);
+		else if (name == "MD5OfBody")
+			read = reader.readString(message->MD5OfBody);
+		else if (name == "Body")
+			read = reader.readString(message->body);
+		else if (name == "Attributes")
+			read = readAttributes(reader, message->attributes, true);
+		else if (name == "MessageAttributes")
+			read = readAttributes(reader, message->messageAttributes, false);
+		else
+			read = reader.skipValue();
+		if (!read)
+			return false;
+	}
+	return !reader.isFailed();
+}
+
+// Reads a message into the batch, the text of its fields appended as the
+// query protocol does.
+static bool readBatchMessage(SQSJSONResponseReader& reader,
+		SQSMessageBatch* batch) {
+	if (!reader.beginObject())
+		return false;
+	batch->addMessage();
+	bool first = true;
+	String name;
+	String value;
+	while (reader.nextMember(first, name)) {
+		int field = -1;
+		if (name == "MessageId")
+			field = SQSMessageBatch::F_MessageId;
+		else if (name == "ReceiptHandle")
+			field = SQSMessageBatch::F_ReceiptHandle;
+		else if (name == "MD5OfBody")
+			field = SQSMessageBatch::F_MD5OfBody;
+		else if (name == "Body")
+			field = SQSMessageBatch::F_Body;
+		if (field != -1) {
+			if (!reader.readString(value))
+				return false;
+			batch->appendText(value, value.getLength());
+			batch->endField((SQSMessageBatch::Field) field);
+			continue;
+		}
+		bool system = (name == "Attributes");
+		if (!system && name != "MessageAttributes") {
+			if (!reader.skipValue())
+				return false;
+			continue;
+		}
+		if (!reader.beginObject())
+			return false;
+		bool firstAttribute = true;
+		String attributeName;
+		while (reader.nextMember(firstAttribute, attributeName)) {
+			value.setEmpty();
+			if (!(system ?
+					reader.readString(value) :
+					readMessageAttributeValue(reader, value)))
+				return false;
+			batch->beginAttribute();
+			batch->appendText(attributeName, attributeName.getLength());
+			batch->endAttributeName();
+			batch->appendText(value, value.getLength());
+			batch->endAttributeValue();
+			batch->endAttribute(system);
+		}
+		if (reader.isFailed())
+			return false;
+	}
+	return !reader.isFailed();
+}
+
+// Reads the Failed array of a batch result.
+static bool readBatchErrorEntries(SQSJSONResponseReader& reader,
+		SQSBatchResultErrorEntryList* list) {
+	if (!reader.beginArray())
+		return false;
+	bool first = true;
+	while (reader.nextElement(first)) {
+		REF<SQSBatchResultErrorEntry> entry = new SQSBatchResultErrorEntry();
+		entry->senderFault = false;
+		if (!reader.beginObject())
+			return false;
+		bool firstMember = true;
+		String name;
+		while (reader.nextMember(firstMember, name)) {
+			bool read;
+			if (name == "Id")
+				read = reader.readString(entry->id);
+			else if (name == "SenderFault")
+				read = reader.readBool(entry->senderFault);
+			else if (name == "Code")
+				read = reader.readString(entry->code);
+			else if (name == "Message")
+				read = reader.readString(entry->message);
+			else
+				read = reader.skipValue();
+			if (!read)
+				return false;
+		}
+		if (reader.isFailed())
+			return false;
+		list->addLast(entry);
+	}
+	return !reader.isFailed();
+}
+
+// Reads the Successful array of a batch result whose entries have nothing
+// but their IDs.
+template<typename TList, typename TEntry>
+static bool readBatchIdEntries(SQSJSONResponseReader& reader, TList* list) {
+	if (!reader.beginArray())
+		return false;
+	bool first = true;
+	while (reader.nextElement(first)) {
+		REF<TEntry> entry = new TEntry();
+		if (!reader.beginObject())
+			return false;
+		bool firstMember = true;
+		String name;
+		while (reader.nextMember(firstMember, name)) {
+			if (!((name == "Id") ?
+					reader.readString(entry->id) : reader.skipValue()))
+				return false;
+		}
+		if (reader.isFailed())
+			return false;
+		list->addLast(entry);
+	}
+	return !reader.isFailed();
+}
+
+static bool readListQueuesMember(SQSJSONResponseReader& reader,
+		const String& name, SQSResult* target) {
+	SQSListQueuesResult* result = static_cast<SQSListQueuesResult*>(target);
+	if (name == "QueueUrls")
+		return readStringList(reader, result->getQueueUrls());
+	return reader.skipValue();
+}
+
+static bool readGetQueueUrlMember(SQSJSONResponseReader& reader,
+		const String& name, SQSResult* target) {
+	SQSGetQueueUrlResult* result = static_cast<SQSGetQueueUrlResult*>(target);
+	if (name == "QueueUrl") {
+		String queueUrl;
+		if (!reader.readString(queueUrl))
+			return false;
+		result->setQueueUrl(queueUrl);
+		return true;
+	}
+	return reader.skipValue();
+}
+
+static bool readSendMessageMember(SQSJSONResponseReader& reader,
+		const String& name, SQSResult* target) {
+	SQSSendMessageResult* result = static_cast<SQSSendMessageResult*>(target);
+	String value;
+	if (name == "MessageId") {
+		if (!reader.readString(value))
+			return false;
+		result->setMessageId(value);
+	} else if (name == "MD5OfMessageBody") {
+		if (!reader.readString(value))
+			return false;
+		result->setMD5OfMessageBody(value);
+	} else if (name == "MD5OfMessageAttributes") {
+		if (!reader.readString(value))
+			return false;
+		result->setMD5OfMessageAttributes(value);
+	} else {
+		return reader.skipValue();
+	}
+	return true;
+}
+
+static bool readSendMessageBatchMember(SQSJSONResponseReader& reader,
+		const String& name, SQSResult* target) {
+	SQSSendMessageBatchResult* result =
+			static_cast<SQSSendMessageBatchResult*>(target);
+	if (name == "Failed")
+		return readBatchErrorEntries(reader, result->getFailed());
+	if (name != "Successful")
+		return reader.skipValue();
+
+	if (!reader.beginArray())
+		return false;
+	bool first = true;
+	while (reader.nextElement(first)) {
+		REF<SQSSendMessageBatchResultEntry> entry =
+				new SQSSendMessageBatchResultEntry();
+		if (!reader.beginObject())
+			return false;
+		bool firstMember = true;
+		String memberName;
+		while (reader.nextMember(firstMember, memberName)) {
+			bool read;
+			if (memberName == "Id")
+				read = reader.readString(entry->id);
+			else if (memberName == "MessageId")
+				read = reader.readString(entry->messageId);
+			else if (memberName == "MD5OfMessageBody")
+				read = reader.readString(entry->MD5OfMessageBody);
+			else if (memberName == "MD5OfMessageAttributes")
+				read = reader.readString(entry->MD5OfMessageAttributes);
+			else
+				read = reader.skipValue();
+			if (!read)
+				return false;
+		}
+		if (reader.isFailed())
+			return false;
+		result->getSuccessful()->addLast(entry);
+	}
+	return !reader.isFailed();
+}
+
+static bool readReceiveMessageMember(SQSJSONResponseReader& reader,
+		const String& name, SQSResult* target) {
+	SQSReceiveMessageResult* result =
+			static_cast<SQSReceiveMessageResult*>(target);
+	if (name != "Messages")
+		return reader.skipValue();
+
+	if (!reader.beginArray())
+		return false;
+	bool first = true;
+	while (reader.nextElement(first)) {
+		REF<SQSMessage> message = new SQSMessage();
+		if (!readMessage(reader, message))
+			return false;
+		result->getMessages()->addLast(message);
+	}
+	return !reader.isFailed();
+}
+
+static bool readReceiveMessageBatchMember(SQSJSONResponseReader& reader,
+		const String& name, SQSResult* target) {
+	SQSReceiveMessageBatchResult* result =
+			static_cast<SQSReceiveMessageBatchResult*>(target);
+	if (name != "Messages")
+		return reader.skipValue();
+
+	if (!reader.beginArray())
+		return false;
+	bool first = true;
+	while (reader.nextElement(first)) {
+		if (!readBatchMessage(reader, result->getBatch()))
+			return false;
+	}
+	return !reader.isFailed();
+}
+
+static bool readEmptyResultMember(SQSJSONResponseReader& reader,
+		const String& name, SQSResult* target) {
+	return reader.skipValue();
+}
+
+static bool readDeleteMessageBatchMember(SQSJSONResponseReader& reader,
+		const String& name, SQSResult* target) {
+	SQSDeleteMessageBatchResult* result =
+			static_cast<SQSDeleteMessageBatchResult*>(target);
+	if (name == "Successful") {
+		return readBatchIdEntries<SQSDeleteMessageBatchResultEntryList,
+				SQSDeleteMessageBatchResultEntry>(reader,
+				result->getSuccessful());
+	}
+	if (name == "Failed")
+		return readBatchErrorEntries(reader, result->getFailed());
+	return reader.skipValue();
+}
+
+static bool readChangeMessageVisibilityBatchMember(
+		SQSJSONResponseReader& reader, const String& name,
+		SQSResult* target) {
+	SQSChangeMessageVisibilityBatchResult* result =
+			static_cast<SQSChangeMessageVisibilityBatchResult*>(target);
+	if (name == "Successful") {
+		return readBatchIdEntries<
+				SQSChangeMessageVisibilityBatchResultEntryList,
+				SQSChangeMessageVisibilityBatchResultEntry>(reader,
+				result->getSuccessful());
+	}
+	if (name == "Failed")
+		return readBatchErrorEntries(reader, result->getFailed());
+	return reader.skipValue();
+}
+
+// Creates a result, and unmarshalls a response into it by given member
+// reader. Returns NULL if the response is malformed.
+template<typename TResult>
+static TResult* unmarshallAs(AWSHttpResponse* response,
+		SQSJSONMemberReader readMember) {
+	REF<TResult> result = new TResult();
+	if (!unmarshallResult(response, result, readMember))
+		return NULL;
+	result->autorelease();
+	return result;
+}
+
+SQSListQueuesResult* SQSJSONResultUnmarshaller::unmarshallListQueues(
+		AWSHttpResponse* response) {
+	return unmarshallAs<SQSListQueuesResult>(response, &readListQueuesMember);
+}
+
+SQSGetQueueUrlResult* SQSJSONResultUnmarshaller::unmarshallGetQueueUrl(
+		AWSHttpResponse* response) {
+	return unmarshallAs<SQSGetQueueUrlResult>(response,
+			&readGetQueueUrlMember);
+}
+
+SQSSendMessageResult* SQSJSONResultUnmarshaller::unmarshallSendMessage(
+		AWSHttpResponse* response) {
+	return unmarshallAs<SQSSendMessageResult>(response,
+			&readSendMessageMember);
+}
+
+SQSSendMessageBatchResult* SQSJSONResultUnmarshaller::unmarshallSendMessageBatch(
+		AWSHttpResponse* response) {
+	return unmarshallAs<SQSSendMessageBatchResult>(response,
+			&readSendMessageBatchMember);
+}
+
+SQSReceiveMessageResult* SQSJSONResultUnmarshaller::unmarshallReceiveMessage(
+		AWSHttpResponse* response) {
+	return unmarshallAs<SQSReceiveMessageResult>(response,
+			&readReceiveMessageMember);
+}
+
+SQSReceiveMessageBatchResult* SQSJSONResultUnmarshaller::unmarshallReceiveMessageBatch(
+		AWSHttpResponse* response) {
+	REF<SQSReceiveMessageBatchResult> result =
+			new SQSReceiveMessageBatchResult();
+	// The text of the messages is never longer than the response.
+	result->setBatch(
+			new SQSMessageBatch(response->getContent().getLength() + 1));
+	if (!unmarshallResult(response, result, &readReceiveMessageBatchMember))
+		return NULL;
+	result->autorelease();
+	return result;
+}
+
+SQSDeleteMessageResult* SQSJSONResultUnmarshaller::unmarshallDeleteMessage(
+		AWSHttpResponse* response) {
+	return unmarshallAs<SQSDeleteMessageResult>(response,
+			&readEmptyResultMember);
+}
+
+SQSDeleteMessageBatchResult* SQSJSONResultUnmarshaller::unmarshallDeleteMessageBatch(
+		AWSHttpResponse* response) {
+	return unmarshallAs<SQSDeleteMessageBatchResult>(response,
+			&readDeleteMessageBatchMember);
+}
+
+SQSChangeMessageVisibilityResult* SQSJSONResultUnmarshaller::unmarshallChangeMessageVisibility(
+		AWSHttpResponse* response) {
+	return unmarshallAs<SQSChangeMessageVisibilityResult>(response,
+			&readEmptyResultMember);
+}
+
+SQSChangeMessageVisibilityBatchResult* SQSJSONResultUnmarshaller::unmarshallChangeMessageVisibilityBatch(
+		AWSHttpResponse* response) {
+	return unmarshallAs<SQSChangeMessageVisibilityBatchResult>(response,
+			&readChangeMessageVisibilityBatchMember);
+}
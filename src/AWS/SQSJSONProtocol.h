@@ -0,0 +1,63 @@
+/*
+ * SQSJSONProtocol.h
+ */
+
+#ifndef AWS_SQSJSONPROTOCOL_H_
+#define AWS_SQSJSONPROTOCOL_H_
+
+/// Specifies the protocol SQSClient speaks to SQS.
+enum SQSProtocol {
+	SQSP_Query = 0,	/// Form-encoded parameters, XML responses
+	SQSP_JSON,	/// JSON requests and responses (application/x-amz-json-1.0)
+};
+
+/// Marshalls the parameters of the SQS operations into requests of the JSON
+/// protocol: a compact JSON object posted as the payload, with the action
+/// named by the X-Amz-Target header. The requests ask for the error codes of
+/// the query protocol, so that the results read the same in either protocol.
+class SQSJSONParamsMarshaller {
+public:
+	AWSHttpRequest* marshall(const SQSListQueuesParams* params);
+	AWSHttpRequest* marshall(const SQSGetQueueUrlParams* params);
+	AWSHttpRequest* marshall(const SQSSendMessageParams* params);
+	AWSHttpRequest* marshall(const SQSSendMessageBatchParams* params);
+	/// Asks for given message attribute too, unless it is empty.
+	AWSHttpRequest* marshall(const SQSReceiveMessageParams* params,
+			const String& extraAttributeName = String());
+	AWSHttpRequest* marshall(const SQSDeleteMessageParams* params);
+	AWSHttpRequest* marshall(const SQSDeleteMessageBatchParams* params);
+	AWSHttpRequest* marshall(const SQSChangeMessageVisibilityParams* params);
+	AWSHttpRequest* marshall(
+			const SQSChangeMessageVisibilityBatchParams* params);
+
+protected:
+	AWSHttpRequest* createHttpRequest(const char* action,
+			const String& content);
+};
+
+/// Unmarshalls the JSON responses of the SQS operations into the results the
+/// query protocol has, by the tokens of JSONReader. An error response sets
+/// the error code of the query protocol if SQS sent it, or else the name of
+/// the error type, e.g. QueueDoesNotExist. Returns NULL if the response is
+/// malformed.
+class SQSJSONResultUnmarshaller {
+public:
+	SQSListQueuesResult* unmarshallListQueues(AWSHttpResponse* response);
+	SQSGetQueueUrlResult* unmarshallGetQueueUrl(AWSHttpResponse* response);
+	SQSSendMessageResult* unmarshallSendMessage(AWSHttpResponse* response);
+	SQSSendMessageBatchResult* unmarshallSendMessageBatch(
+			AWSHttpResponse* response);
+	SQSReceiveMessageResult* unmarshallReceiveMessage(
+			AWSHttpResponse* response);
+	SQSReceiveMessageBatchResult* unmarshallReceiveMessageBatch(
+			AWSHttpResponse* response);
+	SQSDeleteMessageResult* unmarshallDeleteMessage(AWSHttpResponse* response);
+	SQSDeleteMessageBatchResult* unmarshallDeleteMessageBatch(
+			AWSHttpResponse* response);
+	SQSChangeMessageVisibilityResult* unmarshallChangeMessageVisibility(
+			AWSHttpResponse* response);
+	SQSChangeMessageVisibilityBatchResult* unmarshallChangeMessageVisibilityBatch(
+			AWSHttpResponse* response);
+};
+
+#endif /* AWS_SQSJSONPROTOCOL_H_ */
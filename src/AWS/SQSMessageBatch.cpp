@@ -0,0 +1,142 @@
+/*
+ * SQSMessageBatch.cpp
+ */
+
+#include "AWS.h"
+
+#include <string.h>
+
+SQSMessageBatch::SQSMessageBatch(int capacity) :
+		_text(NULL), _length(0), _capacity(0), _start(0) {
+	BFX_ASSERT(capacity >= 0);
+
+	if (capacity > 0) {
+		_text = new char[capacity];
+		_capacity = capacity;
+	}
+	_attributeName.offset = _attributeValue.offset = -1;
+	_attributeName.length = _attributeValue.length = 0;
+}
+
+SQSMessageBatch::~SQSMessageBatch() {
+	delete[] _text;
+}
+
+SQSMessage* SQSMessageBatch::toMessage(int index) const {
+	BFX_ASSERT(index >= 0 && index < getSize());
+
+	REF<SQSMessage> message = new SQSMessage();
+	message->messageId = String(getMessageId(index),
+			getFieldLength(index, F_MessageId));
+	message->receiptHandle = String(getReceiptHandle(index),
+			getFieldLength(index, F_ReceiptHandle));
+	message->MD5OfBody = String(getMD5OfBody(index),
+			getFieldLength(index, F_MD5OfBody));
+	message->body = String(getBody(index), getBodyLength(index));
+	const Message& record = _messages[index];
+	for (int i = record.firstAttribute;
+			i < record.firstAttribute + record.attributeCount; i++) {
+		const Attribute& attribute = _attributes[i];
+		REF<AWSStringMap>& map =
+				attribute.system ?
+						message->attributes : message->messageAttributes;
+		if (map == NULL)
+			map = new AWSStringMap();
+		map->set(String(_text + attribute.name.offset, attribute.name.length),
+				String(_text + attribute.value.offset, attribute.value.length));
+	}
+	message->autorelease();
+	return message;
+}
+
+void SQSMessageBatch::addMessage() {
+	Message message;
+	for (int i = 0; i < F_Count; i++) {
+		message.fields[i].offset = -1;
+		message.fields[i].length = 0;
+	}
+	message.firstAttribute = _attributes.getSize();
+	message.attributeCount = 0;
+	_messages.add(message);
+	_start = _length;
+}
+
+void SQSMessageBatch::appendText(const char* chars, int length) {
+	// Keeps room for the terminating NUL, which is rarely needed as the
+	// capacity is the size of the response.
+	if (_length + length + 1 > _capacity) {
+		int capacity = BFX_MAX(_capacity * 2, 256);
+		while (capacity < _length + length + 1)
+			capacity *= 2;
+		char* text = new char[capacity];
+		if (_length > 0)
+			memcpy(text, _text, _length);
+		delete[] _text;
+		_text = text;
+		_capacity = capacity;
+	}
+	memcpy(_text + _length, chars, length);
+	_length += length;
+}
+
+void SQSMessageBatch::endField(Field field) {
+	BFX_ASSERT(getSize() > 0);
+	BFX_ASSERT(field >= 0 && field < F_Count);
+
+	_messages[getSize() - 1].fields[field] = endText();
+}
+
+void SQSMessageBatch::beginAttribute() {
+	_attributeName.offset = _attributeValue.offset = -1;
+	_attributeName.length = _attributeValue.length = 0;
+	_start = _length;
+}
+
+void SQSMessageBatch::endAttributeName() {
+	_attributeName = endText();
+}
+
+void SQSMessageBatch::endAttributeValue() {
+	_attributeValue = endText();
+}
+
+void SQSMessageBatch::endAttribute(bool system) {
+	BFX_ASSERT(getSize() > 0);
+
+	if (_attributeName.offset < 0
+			|| (!system && _attributeValue.length == 0))
+		return;
+	if (_attributeValue.offset < 0)
+		_attributeValue = endText();
+	Attribute attribute;
+	attribute.system = system;
+	attribute.name = _attributeName;
+	attribute.value = _attributeValue;
+	_attributes.add(attribute);
+	_messages[getSize() - 1].attributeCount++;
+}
+
+SQSMessageBatch::Slice SQSMessageBatch::endText() {
+	Slice slice;
+	slice.offset = _start;
+	slice.length = _length - _start;
+	appendText("", 0);
+	_text[_length++] = 0;
+	_start = _length;
+	return slice;
+}
+
+const char* SQSMessageBatch::findAttribute(int index, const char* name,
+		bool system) const {
+	BFX_ASSERT(index >= 0 && index < getSize());
+
+	const Message& record = _messages[index];
+	for (int i = record.firstAttribute;
+			i < record.firstAttribute + record.attributeCount; i++) {
+		const Attribute& attribute = _attributes[i];
+		if (attribute.system == system
+				&& strcmp(_text + attribute.name.offset, name) == 0)
+			return _text + attribute.value.offset;
+	}
+	return NULL;
+}
@@ -0,0 +1,116 @@
+/*
+ * SQSMessageBatch.h
+ */
+
+#ifndef AWS_SQSMESSAGEBATCH_H_
+#define AWS_SQSMESSAGEBATCH_H_
+
+/// The messages of a receive held in one text buffer, as a compact
+/// alternative to a list of SQSMessage. Each field of a message is a
+/// NUL-terminated slice of the buffer, which is sized by the response up
+/// front, so that a receive takes the same few allocations whatever the
+/// size of the bodies. The text is decoded by the parser as it is copied,
+/// e.g. &amp; is stored as &.
+class SQSMessageBatch: public REFObject {
+public:
+	enum Field {
+		F_MessageId = 0,	/// The message ID
+		F_ReceiptHandle,	/// The handle to delete the message by
+		F_MD5OfBody,	/// The MD5 digest of the body
+		F_Body,	/// The body
+		F_Count
+	};
+
+	/// Reserves given number of characters for the text of the messages.
+	SQSMessageBatch(int capacity = 0);
+	virtual ~SQSMessageBatch();
+
+	int getSize() const {
+		return _messages.getSize();
+	}
+	/// Gets a field of a message, an empty string if it is missing. The text
+	/// belongs to the batch.
+	const char* getField(int index, Field field) const {
+		const Slice& slice = _messages[index].fields[field];
+		return (slice.offset >= 0) ? (_text + slice.offset) : "";
+	}
+	/// Gets the length of a field of a message.
+	int getFieldLength(int index, Field field) const {
+		return _messages[index].fields[field].length;
+	}
+	const char* getMessageId(int index) const {
+		return getField(index, F_MessageId);
+	}
+	const char* getReceiptHandle(int index) const {
+		return getField(index, F_ReceiptHandle);
+	}
+	const char* getMD5OfBody(int index) const {
+		return getField(index, F_MD5OfBody);
+	}
+	const char* getBody(int index) const {
+		return getField(index, F_Body);
+	}
+	int getBodyLength(int index) const {
+		return getFieldLength(index, F_Body);
+	}
+	/// Gets a system attribute of a message requested on receive, e.g.
+	/// ApproximateReceiveCount, or NULL if it is missing.
+	const char* getAttribute(int index, const char* name) const {
+		return findAttribute(index, name, true);
+	}
+	/// Gets a string message attribute requested on receive, or NULL if it
+	/// is missing.
+	const char* getMessageAttribute(int index, const char* name) const {
+		return findAttribute(index, name, false);
+	}
+	/// Copies a message out, for the code taking SQSMessage.
+	SQSMessage* toMessage(int index) const;
+
+	/// Starts a message, the fields and attributes to come belong to it.
+	void addMessage();
+	/// Appends the text of the field or of the attribute being parsed.
+	void appendText(const char* chars, int length);
+	/// Ends the field being parsed, with the text appended since the last
+	/// end.
+	void endField(Field field);
+	/// Starts an attribute of the last message.
+	void beginAttribute();
+	/// Ends the name or the value of the attribute being parsed.
+	void endAttributeName();
+	void endAttributeValue();
+	/// Ends the attribute being parsed, a message attribute is left out if
+	/// its value is empty, e.g. a binary one.
+	void endAttribute(bool system);
+
+private:
+	struct Slice {
+		int offset;
+		int length;
+	};
+	struct Message {
+		Slice fields[F_Count];
+		int firstAttribute;
+		int attributeCount;
+	};
+	struct Attribute {
+		bool system;
+		Slice name;
+		Slice value;
+	};
+
+	// Ends the text being parsed, NUL-terminated, and returns its slice.
+	Slice endText();
+	const char* findAttribute(int index, const char* name, bool system) const;
+
+	char* _text;
+	int _length;
+	int _capacity;
+	// The offset the text being parsed starts at.
+	int _start;
+	ArrayListT<Message> _messages;
+	ArrayListT<Attribute> _attributes;
+	Slice _attributeName;
+	Slice _attributeValue;
+};
+
+#endif /* AWS_SQSMESSAGEBATCH_H_ */
@@ -9,10 +9,22 @@
 
 /// An SQS message.
 struct SQSMessage: REFObject {
+	SQSMessage() :
+			bodyEncoded(false) {
+	}
 	String body;
 	String MD5OfBody;
 	String receiptHandle;
 	String messageId;
+	/// The string attributes requested on receive, NULL if there is none.
+	REF<AWSStringMap> messageAttributes;
+	/// The system attributes requested on receive, e.g. MessageGroupId, NULL
+	/// if there is none.
+	REF<AWSStringMap> attributes;
+	/// Whether the body is left as received, since its codec, named by the
+	/// SQSBodyCodec::ATTRIBUTE_NAME attribute, is unknown or it couldn't be
+	/// decompressed.
+	bool bodyEncoded;
 };
 
 /// Encloses a receipt handle and an identifier for it.
@@ -26,6 +38,46 @@ struct SQSDeleteMessageBatchResultEntry : REFObject {
 	String id;
 };
 
+/// Contains the details of a single message in SendMessageBatch.
+struct SQSSendMessageBatchRequestEntry: REFObject {
+	SQSSendMessageBatchRequestEntry() :
+			delaySeconds(-1) {
+	}
+	String id;
+	String messageBody;
+	int delaySeconds;
+	REF<AWSStringMap> messageAttributes;
+	/// The tag of the message group, required by FIFO queues.
+	String messageGroupId;
+	/// The token to drop duplicates by on FIFO queues.
+	String messageDeduplicationId;
+};
+
+/// Encloses a message ID for successfully enqueued message of a
+/// SendMessageBatch.
+struct SQSSendMessageBatchResultEntry: REFObject {
+	String id;
+	String messageId;
+	String MD5OfMessageBody;
+	String MD5OfMessageAttributes;
+};
+
+/// Encloses a receipt handle and a new visibility timeout for an entry in
+/// ChangeMessageVisibilityBatch.
+struct SQSChangeMessageVisibilityBatchRequestEntry: REFObject {
+	SQSChangeMessageVisibilityBatchRequestEntry() :
+			visibilityTimeout(-1) {
+	}
+	String id;
+	String receiptHandle;
+	int visibilityTimeout;
+};
+
+/// Encloses the id of an entry in ChangeMessageVisibilityBatch.
+struct SQSChangeMessageVisibilityBatchResultEntry: REFObject {
+	String id;
+};
+
 /// This is used in the responses of batch API to give a detailed description
 /// of the result of an action on each entry in the request.
 struct SQSBatchResultErrorEntry: REFObject {
@@ -42,5 +94,9 @@ typedef REFWrapper<LinkedListT<REF<SQSMessage> > > SQSMessageList;
 typedef REFWrapper<LinkedListT<REF<SQSDeleteMessageBatchRequestEntry> > > SQSDeleteMessageBatchRequestEntryList;
 typedef REFWrapper<LinkedListT<REF<SQSDeleteMessageBatchResultEntry> > > SQSDeleteMessageBatchResultEntryList;
 typedef REFWrapper<LinkedListT<REF<SQSBatchResultErrorEntry> > > SQSBatchResultErrorEntryList;
+typedef REFWrapper<LinkedListT<REF<SQSSendMessageBatchRequestEntry> > > SQSSendMessageBatchRequestEntryList;
+typedef REFWrapper<LinkedListT<REF<SQSSendMessageBatchResultEntry> > > SQSSendMessageBatchResultEntryList;
+typedef REFWrapper<LinkedListT<REF<SQSChangeMessageVisibilityBatchRequestEntry> > > SQSChangeMessageVisibilityBatchRequestEntryList;
+typedef REFWrapper<LinkedListT<REF<SQSChangeMessageVisibilityBatchResultEntry> > > SQSChangeMessageVisibilityBatchResultEntryList;
 
 #endif	// __AWS_SQSMODELS_H__
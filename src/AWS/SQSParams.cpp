@@ -44,6 +44,21 @@ AWSHttpRequest* SQSReceiveMessageParamsMarshaller::marshall(
 			attributeIndex++;
 		}
 	}
+	if (params->hasAttributeNames()) {
+		int attributeIndex = 1;
+		AWSStringList* attrNames = params->getAttributeNames();
+		for (AWSStringList::PENTRY entry = attrNames->getFirstEntry();
+				entry != NULL; entry = attrNames->getNextEntry(entry)) {
+			request->getParameters()->set(
+					String::format("AttributeName.%d", attributeIndex),
+					entry->value);
+			attributeIndex++;
+		}
+	}
+	if (!params->getReceiveRequestAttemptId().isEmpty()) {
+		request->getParameters()->set("ReceiveRequestAttemptId",
+				params->getReceiveRequestAttemptId());
+	}
 	return request;
 }
 
@@ -60,6 +75,21 @@ AWSHttpRequest* SQSListQueuesParmsMarshaller::marshall(
 	return request;
 }
 
+AWSHttpRequest* SQSGetQueueUrlParamsMarshaller::marshall(
+		const SQSGetQueueUrlParams* params) {
+	BFX_ASSERT(params);
+	AWSHttpRequest* request = createHttpRequest();
+	if (request == NULL)
+		return NULL;
+	request->getParameters()->set("Action", "GetQueueUrl");
+	request->getParameters()->set("QueueName", params->getQueueName());
+	if (!params->getQueueOwnerAWSAccountId().isEmpty()) {
+		request->getParameters()->set("QueueOwnerAWSAccountId",
+				params->getQueueOwnerAWSAccountId());
+	}
+	return request;
+}
+
 AWSHttpRequest* SQSSendMessageParamsMarshaller::marshall(
 		const SQSSendMessageParams* params) {
 	AWSHttpRequest* request = createHttpRequest();
@@ -86,11 +116,86 @@ AWSHttpRequest* SQSSendMessageParamsMarshaller::marshall(
 			request->getParameters()->set(
 					String::format("MessageAttribute.%d.Value.DataType",
 							messageAttributeIndex), "String");
+			messageAttributeIndex++;
+		}
+	}
+	if (!params->getMessageGroupId().isEmpty()) {
+		request->getParameters()->set("MessageGroupId",
+				params->getMessageGroupId());
+	}
+	if (!params->getMessageDeduplicationId().isEmpty()) {
+		request->getParameters()->set("MessageDeduplicationId",
+				params->getMessageDeduplicationId());
+	}
+	return request;
+}
+
+AWSHttpRequest* SQSSendMessageBatchParamsMarshaller::marshall(
+		const SQSSendMessageBatchParams* params) {
+	BFX_ASSERT(params);
+	AWSHttpRequest* request = createHttpRequest();
+	if (request == NULL)
+		return NULL;
+	request->getParameters()->set("Action", "SendMessageBatch");
+	request->getParameters()->set("QueueUrl", params->getQueueUrl());
+	if (params->hasEntries()) {
+		SQSSendMessageBatchRequestEntryList* entries = params->getEntries();
+		int entryIndex = 1;
+		for (SQSSendMessageBatchRequestEntryList::PENTRY entry =
+				entries->getFirstEntry(); entry != NULL;
+				entry = entries->getNextEntry(entry)) {
+			String prefix = String::format("SendMessageBatchRequestEntry.%d.",
+					entryIndex);
+			request->getParameters()->set(prefix + "Id", entry->value->id);
+			request->getParameters()->set(prefix + "MessageBody",
+					entry->value->messageBody);
+			if (entry->value->delaySeconds != -1) {
+				request->getParameters()->set(prefix + "DelaySeconds",
+						String::format("%d", entry->value->delaySeconds));
+			}
+			AWSStringMap* attrs = entry->value->messageAttributes;
+			if (attrs != NULL) {
+				int messageAttributeIndex = 1;
+				for (AWSStringMap::PENTRY attr = attrs->getFirstEntry();
+						attr != NULL; attr = attrs->getNextEntry(attr)) {
+					String attrPrefix = prefix
+							+ String::format("MessageAttribute.%d.",
+									messageAttributeIndex);
+					request->getParameters()->set(attrPrefix + "Name",
+							attr->key);
+					request->getParameters()->set(
+							attrPrefix + "Value.StringValue", attr->value);
+					request->getParameters()->set(
+							attrPrefix + "Value.DataType", "String");
+					messageAttributeIndex++;
+				}
+			}
+			if (!entry->value->messageGroupId.isEmpty()) {
+				request->getParameters()->set(prefix + "MessageGroupId",
+						entry->value->messageGroupId);
+			}
+			if (!entry->value->messageDeduplicationId.isEmpty()) {
+				request->getParameters()->set(prefix + "MessageDeduplicationId",
+						entry->value->messageDeduplicationId);
+			}
+			entryIndex++;
 		}
 	}
 	return request;
 }
 
+AWSHttpRequest* SQSDeleteMessageParamsMarshaller::marshall(
+		const SQSDeleteMessageParams* params) {
+	BFX_ASSERT(params);
+	AWSHttpRequest* request = createHttpRequest();
+	if (request == NULL)
+		return NULL;
+	request->getParameters()->set("Action", "DeleteMessage");
+	request->getParameters()->set("QueueUrl", params->getQueueUrl());
+	request->getParameters()->set("ReceiptHandle", params->getReceiptHandle());
+	return request;
+}
+
 AWSHttpRequest* SQSDeleteMessageBatchParamsMarshaller::marshall(
 		const SQSDeleteMessageBatchParams* params) {
 	BFX_ASSERT(params);
@@ -101,18 +206,62 @@ AWSHttpRequest* SQSDeleteMessageBatchParamsMarshaller::marshall(
 	request->getParameters()->set("QueueUrl", params->getQueueUrl());
 	if (params->hasEntries()) {
 		SQSDeleteMessageBatchRequestEntryList* entries = params->getEntries();
-		int messageAttributeIndex = 1;
+		int entryIndex = 1;
 		for (SQSDeleteMessageBatchRequestEntryList::PENTRY entry =
 				entries->getFirstEntry(); entry != NULL;
 				entry = entries->getNextEntry(entry)) {
 			request->getParameters()->set(
 					String::format("DeleteMessageBatchRequestEntry.%d.Id",
-							messageAttributeIndex), entry->value->id);
+							entryIndex), entry->value->id);
 			request->getParameters()->set(
 					String::format(
 							"DeleteMessageBatchRequestEntry.%d.ReceiptHandle",
-							messageAttributeIndex),
+							entryIndex), entry->value->receiptHandle);
+			entryIndex++;
+		}
+	}
+	return request;
+}
+
+AWSHttpRequest* SQSChangeMessageVisibilityParamsMarshaller::marshall(
+		const SQSChangeMessageVisibilityParams* params) {
+	BFX_ASSERT(params);
+	AWSHttpRequest* request = createHttpRequest();
+	if (request == NULL)
+		return NULL;
+	request->getParameters()->set("Action", "ChangeMessageVisibility");
+	request->getParameters()->set("QueueUrl", params->getQueueUrl());
+	request->getParameters()->set("ReceiptHandle", params->getReceiptHandle());
+	request->getParameters()->set("VisibilityTimeout",
+			String::format("%d", params->getVisibilityTimeout()));
+	return request;
+}
+
+AWSHttpRequest* SQSChangeMessageVisibilityBatchParamsMarshaller::marshall(
+		const SQSChangeMessageVisibilityBatchParams* params) {
+	BFX_ASSERT(params);
+	AWSHttpRequest* request = createHttpRequest();
+	if (request == NULL)
+		return NULL;
+	request->getParameters()->set("Action", "ChangeMessageVisibilityBatch");
+	request->getParameters()->set("QueueUrl", params->getQueueUrl());
+	if (params->hasEntries()) {
+		SQSChangeMessageVisibilityBatchRequestEntryList* entries =
+				params->getEntries();
+		int entryIndex = 1;
+		for (SQSChangeMessageVisibilityBatchRequestEntryList::PENTRY entry =
+				entries->getFirstEntry(); entry != NULL;
+				entry = entries->getNextEntry(entry)) {
+			String entryPrefix = String::format(
+					"ChangeMessageVisibilityBatchRequestEntry.%d.", entryIndex);
+			request->getParameters()->set(entryPrefix + "Id", entry->value->id);
+			request->getParameters()->set(entryPrefix + "ReceiptHandle",
 					entry->value->receiptHandle);
+			if (entry->value->visibilityTimeout != -1) {
+				request->getParameters()->set(entryPrefix + "VisibilityTimeout",
+						String::format("%d", entry->value->visibilityTimeout));
+			}
+			entryIndex++;
 		}
 	}
 	return request;
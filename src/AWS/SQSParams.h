@@ -30,6 +30,36 @@ private:
 	String _queueNamePrefix;
 };
 
+class SQSGetQueueUrlParams : public SQSParams {
+public:
+	SQSGetQueueUrlParams(const String& queueName) {
+		setQueueName(queueName);
+	}
+	/// Sets the name of the queue whose URL must be fetched. Maximum 80
+	/// characters; alphanumeric characters, hyphens (-), and underscores (_)
+	/// are allowed.
+	void setQueueName(const String& queueName) {
+		BFX_ASSERT(!queueName.isEmpty());
+		_queueName = queueName;
+	}
+	/// Gets the name of the queue whose URL must be fetched.
+	const String& getQueueName() const {
+		return _queueName;
+	}
+	/// Sets the AWS account ID of the account that created the queue, if it
+	/// isn't the one of the credentials.
+	void setQueueOwnerAWSAccountId(const String& queueOwnerAWSAccountId) {
+		_queueOwnerAWSAccountId = queueOwnerAWSAccountId;
+	}
+	/// Gets the AWS account ID of the account that created the queue.
+	const String& getQueueOwnerAWSAccountId() const {
+		return _queueOwnerAWSAccountId;
+	}
+private:
+	String _queueName;
+	String _queueOwnerAWSAccountId;
+};
+
 class SQSSendMessageParams: public SQSParams {
 public:
 	SQSSendMessageParams(const String& queueUrl) {
@@ -75,11 +105,31 @@ public:
 					new AWSStringMap();
 		return _messageAttributes;
 	}
+	/// Sets the tag of the group the message belongs to, required by FIFO
+	/// queues. Messages of the same group are delivered in order.
+	void setMessageGroupId(const String& messageGroupId) {
+		_messageGroupId = messageGroupId;
+	}
+	/// Gets the tag of the group the message belongs to.
+	const String& getMessageGroupId() const {
+		return _messageGroupId;
+	}
+	/// Sets the token used by FIFO queues to drop duplicates of the message
+	/// sent within the deduplication interval (5 minutes).
+	void setMessageDeduplicationId(const String& messageDeduplicationId) {
+		_messageDeduplicationId = messageDeduplicationId;
+	}
+	/// Gets the token used by FIFO queues to drop duplicates of the message.
+	const String& getMessageDeduplicationId() const {
+		return _messageDeduplicationId;
+	}
 private:
 	String _queueUrl;
 	String _messageBody;
 	int _delaySeconds;
 	REF<AWSStringMap> _messageAttributes;
+	String _messageGroupId;
+	String _messageDeduplicationId;
 };
 
 class SQSReceiveMessageParams: public SQSParams {
@@ -105,8 +155,8 @@ public:
 
 	/// Gets a value that indicating whether has message attribute names.
 	bool hasMessageAttributeNames() const {
-		return ((_messageAttributeNames == NULL)
-				|| (_messageAttributeNames->getSize() == 0));
+		return ((_messageAttributeNames != NULL)
+				&& (_messageAttributeNames->getSize() > 0));
 	}
 	/// Gets a pointer of map that containing message attribute names.
 	AWSStringMap* getMessageAttributeNames() const {
@@ -116,6 +166,28 @@ public:
 		}
 		return _messageAttributeNames;
 	}
+	/// Gets a value that indicating whether has attribute names.
+	bool hasAttributeNames() const {
+		return ((_attributeNames != NULL) && (_attributeNames->getSize() > 0));
+	}
+	/// Gets the names of the system attributes to return along with each
+	/// message, e.g. MessageGroupId, SequenceNumber or All.
+	AWSStringList* getAttributeNames() const {
+		if (_attributeNames == NULL) {
+			const_cast<SQSReceiveMessageParams*>(this)->_attributeNames =
+					new AWSStringList();
+		}
+		return _attributeNames;
+	}
+	/// Sets the token of a receive attempt on a FIFO queue. A receive retried
+	/// by the same token after a failure returns the same messages.
+	void setReceiveRequestAttemptId(const String& receiveRequestAttemptId) {
+		_receiveRequestAttemptId = receiveRequestAttemptId;
+	}
+	/// Gets the token of a receive attempt on a FIFO queue.
+	const String& getReceiveRequestAttemptId() const {
+		return _receiveRequestAttemptId;
+	}
 	/// Gets the maximum number of messages to return.
 	/// SQS will never returns more messages than this value but may return
 	/// fewer. Values can be from 1 to 10. Default is 1.
@@ -155,6 +227,10 @@ private:
 	String _queueUrl;
 	// The list of message attribute names
 	REF<AWSStringMap> _messageAttributeNames;
+	// The list of system attribute names
+	REF<AWSStringList> _attributeNames;
+	// The token of the receive attempt on a FIFO queue
+	String _receiveRequestAttemptId;
 	// The maximum number of messages to return
 	int _maxNumberOfMessages;
 	// The duration (in seconds) that the received messages are hidden from
@@ -166,6 +242,37 @@ private:
 	int _waitTimeSeconds;
 };
 
+class SQSDeleteMessageParams: public SQSParams {
+public:
+	SQSDeleteMessageParams(const String& queueUrl,
+			const String& receiptHandle) {
+		setQueueUrl(queueUrl);
+		setReceiptHandle(receiptHandle);
+	}
+	/// Sets the URL of the Amazon SQS queue to take action on.
+	void setQueueUrl(const String& queueUrl) {
+		BFX_ASSERT(!queueUrl.isEmpty());
+		_queueUrl = queueUrl;
+	}
+	/// Gets the URL of the Amazon SQS queue to take action on.
+	const String& getQueueUrl() const {
+		return _queueUrl;
+	}
+	/// Sets the receipt handle associated with the message to delete.
+	void setReceiptHandle(const String& receiptHandle) {
+		BFX_ASSERT(!receiptHandle.isEmpty());
+		_receiptHandle = receiptHandle;
+	}
+	/// Gets the receipt handle associated with the message to delete.
+	const String& getReceiptHandle() const {
+		return _receiptHandle;
+	}
+
+private:
+	String _queueUrl;
+	String _receiptHandle;
+};
+
 class SQSDeleteMessageBatchParams: public SQSParams {
 public:
 	SQSDeleteMessageBatchParams(const String& queueUrl) {
@@ -195,6 +302,109 @@ private:
 	REF<SQSDeleteMessageBatchRequestEntryList> _entries;
 };
 
+class SQSSendMessageBatchParams: public SQSParams {
+public:
+	SQSSendMessageBatchParams(const String& queueUrl) {
+		setQueueUrl(queueUrl);
+	}
+	/// Sets the URL of the Amazon SQS queue to take action on.
+	void setQueueUrl(const String& queueUrl) {
+		_queueUrl = queueUrl;
+	}
+	/// Gets the URL of the Amazon SQS queue to take action on.
+	const String& getQueueUrl() const {
+		return _queueUrl;
+	}
+	/// Gets a list of up to ten messages to be sent.
+	SQSSendMessageBatchRequestEntryList* getEntries() const {
+		if (_entries == NULL)
+			const_cast<SQSSendMessageBatchParams*>(this)->_entries =
+					new SQSSendMessageBatchRequestEntryList();
+		return _entries;
+	}
+	bool hasEntries() const {
+		return ((_entries != NULL) && (_entries->getSize() > 0));
+	}
+
+private:
+	String _queueUrl;
+	REF<SQSSendMessageBatchRequestEntryList> _entries;
+};
+
+class SQSChangeMessageVisibilityParams: public SQSParams {
+public:
+	SQSChangeMessageVisibilityParams(const String& queueUrl,
+			const String& receiptHandle, int visibilityTimeout) {
+		setQueueUrl(queueUrl);
+		setReceiptHandle(receiptHandle);
+		setVisibilityTimeout(visibilityTimeout);
+	}
+	/// Sets the URL of the Amazon SQS queue to take action on.
+	void setQueueUrl(const String& queueUrl) {
+		BFX_ASSERT(!queueUrl.isEmpty());
+		_queueUrl = queueUrl;
+	}
+	/// Gets the URL of the Amazon SQS queue to take action on.
+	const String& getQueueUrl() const {
+		return _queueUrl;
+	}
+	/// Sets the receipt handle associated with the message whose visibility
+	/// timeout should be changed.
+	void setReceiptHandle(const String& receiptHandle) {
+		BFX_ASSERT(!receiptHandle.isEmpty());
+		_receiptHandle = receiptHandle;
+	}
+	/// Gets the receipt handle associated with the message.
+	const String& getReceiptHandle() const {
+		return _receiptHandle;
+	}
+	/// Sets the new value (in seconds) for the message's visibility timeout,
+	/// counted from now. Values can be from 0 to 43200 (12 hours).
+	void setVisibilityTimeout(int visibilityTimeout) {
+		BFX_ASSERT(visibilityTimeout >= 0);
+		_visibilityTimeout = visibilityTimeout;
+	}
+	/// Gets the new value (in seconds) for the message's visibility timeout.
+	int getVisibilityTimeout() const {
+		return _visibilityTimeout;
+	}
+
+private:
+	String _queueUrl;
+	String _receiptHandle;
+	int _visibilityTimeout;
+};
+
+class SQSChangeMessageVisibilityBatchParams: public SQSParams {
+public:
+	SQSChangeMessageVisibilityBatchParams(const String& queueUrl) {
+		setQueueUrl(queueUrl);
+	}
+	/// Sets the URL of the Amazon SQS queue to take action on.
+	void setQueueUrl(const String& queueUrl) {
+		_queueUrl = queueUrl;
+	}
+	/// Gets the URL of the Amazon SQS queue to take action on.
+	const String& getQueueUrl() const {
+		return _queueUrl;
+	}
+	/// Gets a list of up to ten receipt handles of the messages whose
+	/// visibility timeout should be changed.
+	SQSChangeMessageVisibilityBatchRequestEntryList* getEntries() const {
+		if (_entries == NULL)
+			const_cast<SQSChangeMessageVisibilityBatchParams*>(this)->_entries =
+					new SQSChangeMessageVisibilityBatchRequestEntryList();
+		return _entries;
+	}
+	bool hasEntries() const {
+		return ((_entries != NULL) && (_entries->getSize() > 0));
+	}
+
+private:
+	String _queueUrl;
+	REF<SQSChangeMessageVisibilityBatchRequestEntryList> _entries;
+};
+
 class SQSParamsMarshaller {
 protected:
 	AWSHttpRequest* createHttpRequest();
@@ -210,14 +420,40 @@ public:
 	AWSHttpRequest* marshall(const SQSListQueuesParams* params);
 };
 
+class SQSGetQueueUrlParamsMarshaller: public SQSParamsMarshaller {
+public:
+	AWSHttpRequest* marshall(const SQSGetQueueUrlParams* params);
+};
+
 class SQSSendMessageParamsMarshaller: public SQSParamsMarshaller {
 public:
 	AWSHttpRequest* marshall(const SQSSendMessageParams* params);
 };
 
+class SQSSendMessageBatchParamsMarshaller: public SQSParamsMarshaller {
+public:
+	AWSHttpRequest* marshall(const SQSSendMessageBatchParams* params);
+};
+
+class SQSDeleteMessageParamsMarshaller: public SQSParamsMarshaller {
+public:
+	AWSHttpRequest* marshall(const SQSDeleteMessageParams* params);
+};
+
 class SQSDeleteMessageBatchParamsMarshaller: public SQSParamsMarshaller {
 public:
 	AWSHttpRequest* marshall(const SQSDeleteMessageBatchParams* params);
 };
 
+class SQSChangeMessageVisibilityParamsMarshaller: public SQSParamsMarshaller {
+public:
+	AWSHttpRequest* marshall(const SQSChangeMessageVisibilityParams* params);
+};
+
+class SQSChangeMessageVisibilityBatchParamsMarshaller: public SQSParamsMarshaller {
+public:
+	AWSHttpRequest* marshall(
+			const SQSChangeMessageVisibilityBatchParams* params);
+};
+
 #endif /* AWS_SQSPARAMS_H_ */
@@ -0,0 +1,218 @@
+/*
+ * SQSPrefetcher.cpp
+ */
+
+#include "AWS.h"
+
+#define LOG_TAG "SQSPrefetcher"
+
+// A thread receiving messages into the buffer of a prefetcher.
+class SQSPrefetchPoller: public Thread {
+public:
+	SQSPrefetchPoller(SQSPrefetcher* prefetcher) :
+			_prefetcher(prefetcher) {
+	}
+
+protected:
+	virtual void run() {
+		_prefetcher->runPoller();
+	}
+
+private:
+	// The prefetcher stops the thread before being destroyed.
+	SQSPrefetcher* _prefetcher;
+};
+
+SQSPrefetcher::SQSPrefetcher(SQSClient* client, const String& queueUrl,
+		int visibilityTimeout, int pollers) :
+		_pollEvent(false), _messageEvent(false) {
+	BFX_ASSERT(client);
+	BFX_ASSERT(!queueUrl.isEmpty());
+	BFX_ASSERT(visibilityTimeout > 0);
+	BFX_ASSERT(pollers > 0);
+
+	_client = client;
+	_queueUrl = queueUrl;
+	_visibilityTimeout = visibilityTimeout;
+	_pollerCount = pollers;
+	_waitTimeSeconds = DEFAULT_WAIT_TIME_SECONDS;
+	_highWatermark = DEFAULT_HIGH_WATERMARK;
+	_lowWatermark = DEFAULT_LOW_WATERMARK;
+	_processingTime = DEFAULT_PROCESSING_TIME;
+	_receiving = 0;
+	_paused = false;
+	_stopped = false;
+	_popInterval = 0;
+	_lastPopTime = 0;
+}
+
+SQSPrefetcher::~SQSPrefetcher() {
+	stop();
+}
+
+bool SQSPrefetcher::start() {
+	if (_pollers.getSize() > 0)
+		return false;
+
+	_stopped = false;
+	for (int i = 0; i < _pollerCount; i++) {
+		REF<SQSPrefetchPoller> poller = new SQSPrefetchPoller(this);
+		if (!poller->start()) {
+			LOGE("Unable to start a polling thread.");
+			break;
+		}
+		_pollers.add(poller);
+	}
+	return _pollers.getSize() > 0;
+}
+
+void SQSPrefetcher::stop() {
+	{
+		MutexHolder holder(&_lock);
+		_stopped = true;
+		// Each waiting thread wakes the next one up.
+		_pollEvent.set();
+		_messageEvent.set();
+	}
+	for (int i = 0; i < _pollers.getSize(); i++)
+		_pollers[i]->join();
+	_pollers.clear();
+}
+
+SQSMessage* SQSPrefetcher::receiveMessage(int milliseconds) {
+	int64_t waitDeadline = Thread::getTickCount() + milliseconds;
+	bool waited = false;
+
+	MutexHolder holder(&_lock);
+	while (true) {
+		while (_buffer.getSize() > 0) {
+			BufferedMessage buffered = _buffer.getFirst();
+			_buffer.removeFirst();
+			int64_t now = Thread::getTickCount();
+			if (now > buffered.deadline) {
+				// It would become visible again while being processed.
+				LOGW("Dropped message '%s' short of visibility time.",
+						buffered.message->messageId.cstr());
+				continue;
+			}
+
+			// Only pops of a non-empty buffer tell how fast consumers are.
+			if (!waited && _lastPopTime != 0) {
+				int interval = (int) (now - _lastPopTime);
+				_popInterval =
+						(_popInterval == 0) ?
+								interval : (_popInterval * 7 + interval) / 8;
+			}
+			_lastPopTime = now;
+			if (_buffer.getSize() > 0)
+				_messageEvent.set();
+			_pollEvent.set();
+
+			buffered.message->autorelease();
+			return buffered.message;
+		}
+		if (_stopped && _receiving == 0) {
+			_messageEvent.set();
+			return NULL;
+		}
+
+		int timeout = -1;
+		if (milliseconds >= 0) {
+			int64_t now = Thread::getTickCount();
+			if (now >= waitDeadline)
+				return NULL;
+			timeout = (int) (waitDeadline - now);
+		}
+		waited = true;
+		_lock.unlock();
+		_messageEvent.wait(timeout);
+		_lock.lock();
+	}
+}
+
+int SQSPrefetcher::getBufferedCount() {
+	MutexHolder holder(&_lock);
+	return _buffer.getSize();
+}
+
+int SQSPrefetcher::getReceiveCount() {
+	if (_stopped)
+		return 0;
+
+	// Pauses at the high watermark until drained down to the low one.
+	int buffered = _buffer.getSize();
+	if (_paused && buffered > _lowWatermark)
+		return 0;
+	_paused = (buffered >= _highWatermark);
+	if (_paused)
+		return 0;
+
+	int ahead = buffered + _receiving * MAX_RECEIVE_MESSAGES;
+	if (ahead == 0)
+		return MAX_RECEIVE_MESSAGES;
+	// Stays a single receive ahead until the consumers' pace is known.
+	if (_popInterval == 0)
+		return 0;
+	// Receives no more messages than consumers can take in time, given
+	// those ahead of them.
+	int64_t available = (int64_t) _visibilityTimeout * 1000 - _processingTime;
+	int64_t count = available / _popInterval - ahead;
+	return (int) BFX_MAX(BFX_MIN(count, (int64_t ) MAX_RECEIVE_MESSAGES),
+			(int64_t ) 0);
+}
+
+void SQSPrefetcher::runPoller() {
+	_lock.lock();
+	while (!_stopped) {
+		int count = getReceiveCount();
+		if (count == 0) {
+			// Consumers popping messages wake a poller up, the time-out
+			// re-evaluates the visibility guard.
+			_lock.unlock();
+			_pollEvent.wait(RETRY_INTERVAL);
+			_lock.lock();
+			continue;
+		}
+		_receiving++;
+		if (getReceiveCount() > 0)
+			_pollEvent.set();
+		_lock.unlock();
+
+		REFAutoreleasePool pool;
+		// The visibility timeout starts no earlier than the request.
+		int64_t deadline = Thread::getTickCount()
+				+ (int64_t) _visibilityTimeout * 1000 - _processingTime;
+		REF<SQSReceiveMessageParams> params = new SQSReceiveMessageParams(
+				_queueUrl);
+		params->setMaxNumberOfMessages(count);
+		params->setVisibilityTimeout(_visibilityTimeout);
+		params->setWaitTimeSeconds(_waitTimeSeconds);
+		SQSReceiveMessageResult* result = _client->receiveMessage(params);
+		bool failed = (result == NULL || !result->getErrorCode().isEmpty());
+		if (failed) {
+			LOGE("Failed to receive messages: %s",
+					(result == NULL) ? "request failed" :
+							result->getErrorMessage().cstr());
+			Thread::sleep(RETRY_INTERVAL);
+		}
+
+		_lock.lock();
+		_receiving--;
+		if (!failed && result->hasMessages()) {
+			SQSMessageList* messages = result->getMessages();
+			for (SQSMessageList::PENTRY entry = messages->getFirstEntry();
+					entry != NULL; entry = messages->getNextEntry(entry)) {
+				BufferedMessage buffered;
+				buffered.message = entry->value;
+				buffered.deadline = deadline;
+				_buffer.addLast(buffered);
+			}
+			_messageEvent.set();
+		}
+		// Lets consumers see the end of the stream.
+		if (_stopped && _receiving == 0)
+			_messageEvent.set();
+	}
+	_pollEvent.set();
+	_lock.unlock();
+}
@@ -0,0 +1,108 @@
+/*
+ * SQSPrefetcher.h
+ */
+
+#ifndef AWS_SQSPREFETCHER_H_
+#define AWS_SQSPREFETCHER_H_
+
+class SQSPrefetchPoller;
+
+/// Receives messages of a queue ahead of the consumers, so that the network
+/// wait overlaps with processing. Background threads run long-poll receives
+/// into a bounded local buffer, consumers pop messages from memory.
+///
+/// Prefetching pauses once the buffer reaches the high watermark, and resumes
+/// when it drains down to the low watermark. It also pauses while messages
+/// received now would wait in the buffer for longer than their visibility
+/// timeout allows, judging by the rate consumers pop messages. Until that
+/// rate is known, it stays a single receive ahead of the consumers.
+class SQSPrefetcher: public REFObject {
+public:
+	enum {
+		MAX_RECEIVE_MESSAGES = 10,	/// Maximum number of messages per receive
+		DEFAULT_POLLERS = 2,	/// Default number of polling threads
+		DEFAULT_WAIT_TIME_SECONDS = 20,	/// Default long-poll duration
+		DEFAULT_HIGH_WATERMARK = 100,	/// Default buffer high watermark
+		DEFAULT_LOW_WATERMARK = 50,	/// Default buffer low watermark
+		/// Default time in milliseconds a consumer needs to process a message
+		DEFAULT_PROCESSING_TIME = 5000,
+		/// Time in milliseconds to wait before retrying a failed receive
+		RETRY_INTERVAL = 1000,
+	};
+
+	/// Creates a prefetcher of given queue, the received messages are hidden
+	/// for the visibility timeout in seconds.
+	SQSPrefetcher(SQSClient* client, const String& queueUrl,
+			int visibilityTimeout, int pollers = DEFAULT_POLLERS);
+	virtual ~SQSPrefetcher();
+
+	void setWaitTimeSeconds(int waitTimeSeconds) {
+		_waitTimeSeconds = waitTimeSeconds;
+	}
+	/// Sets the buffer watermarks, the buffer never holds more messages than
+	/// the high watermark plus a receive per poller.
+	void setWatermarks(int highWatermark, int lowWatermark) {
+		BFX_ASSERT(lowWatermark >= 0 && lowWatermark <= highWatermark);
+		_highWatermark = highWatermark;
+		_lowWatermark = lowWatermark;
+	}
+	/// Sets the time in milliseconds a consumer needs to process a message.
+	/// Messages having less visibility time left are never handed out.
+	void setProcessingTime(int milliseconds) {
+		_processingTime = milliseconds;
+	}
+
+	/// Starts the polling threads.
+	bool start();
+	/// Stops the polling threads and waits for them to exit, which may take
+	/// as long as a long poll. The buffered messages can still be popped.
+	void stop();
+
+	/// Pops a message, waiting up to given time in milliseconds for one to
+	/// arrive. Returns an autoreleased message, or NULL on time-out or if the
+	/// prefetcher has been stopped and drained.
+	SQSMessage* receiveMessage(int milliseconds = -1);
+
+	/// Gets the number of buffered messages.
+	int getBufferedCount();
+
+private:
+	friend class SQSPrefetchPoller;
+
+	struct BufferedMessage {
+		REF<SQSMessage> message;
+		// The tick count the message must be handed out before.
+		int64_t deadline;
+	};
+
+	// Returns the number of messages a poller may receive now, the lock must
+	// be held.
+	int getReceiveCount();
+	// The loop of each polling thread.
+	void runPoller();
+
+	REF<SQSClient> _client;
+	String _queueUrl;
+	int _visibilityTimeout;
+	int _pollerCount;
+	int _waitTimeSeconds;
+	int _highWatermark;
+	int _lowWatermark;
+	int _processingTime;
+
+	Mutex _lock;
+	LinkedListT<BufferedMessage> _buffer;
+	int _receiving;
+	bool _paused;
+	bool _stopped;
+	// Average milliseconds between pops of a non-empty buffer.
+	int _popInterval;
+	int64_t _lastPopTime;
+	// Signaled when a poller may receive, or on stop.
+	Event _pollEvent;
+	// Signaled when a message is buffered, or on stop.
+	Event _messageEvent;
+	ArrayListT<REF<SQSPrefetchPoller> > _pollers;
+};
+
+#endif /* AWS_SQSPREFETCHER_H_ */
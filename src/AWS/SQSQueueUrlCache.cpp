@@ -0,0 +1,137 @@
+/*
+ * SQSQueueUrlCache.cpp
+ */
+
+#include "AWS.h"
+
+#define LOG_TAG "SQSQueueUrlCache"
+
+// The URL of a queue, or a lookup of it in progress.
+class SQSQueueUrlEntry: public REFObject {
+public:
+	SQSQueueUrlEntry() :
+			expiry(0), loading(true), loadedEvent(true, false) {
+	}
+
+	// Empty if the queue doesn't exist, or the lookup failed.
+	String queueUrl;
+	// The tick count the entry expires at.
+	int64_t expiry;
+	bool loading;
+	// Signaled when the lookup has completed.
+	Event loadedEvent;
+};
+
+SQSQueueUrlCache::SQSQueueUrlCache(int ttl, int negativeTtl) {
+	BFX_ASSERT(ttl >= 0);
+	BFX_ASSERT(negativeTtl >= 0);
+
+	_ttl = ttl;
+	_negativeTtl = negativeTtl;
+	_lookupCount = 0;
+}
+
+SQSQueueUrlCache::~SQSQueueUrlCache() {
+}
+
+SQSQueueUrlCache* SQSQueueUrlCache::getDefault() {
+	static REF<SQSQueueUrlCache> __default = new SQSQueueUrlCache();
+	return __default;
+}
+
+String SQSQueueUrlCache::getQueueUrl(SQSClient* client,
+		const String& queueName, const String& queueOwnerAWSAccountId) {
+	BFX_ASSERT(client);
+	BFX_ASSERT(!queueName.isEmpty());
+
+	String key = makeKey(client, queueName, queueOwnerAWSAccountId);
+	REF<SQSQueueUrlEntry> entry;
+	bool lookup = false;
+	{
+		MutexHolder holder(&_lock);
+		TreeMapT<String, REF<SQSQueueUrlEntry> >::PENTRY node =
+				_entries.getEntry(key);
+		if (node != NULL) {
+			entry = node->value;
+			if (!entry->loading && Thread::getTickCount() < entry->expiry)
+				return entry->queueUrl;
+		}
+		if (entry == NULL || !entry->loading) {
+			// Looks the queue up, concurrent callers wait for the result.
+			entry = new SQSQueueUrlEntry();
+			_entries.set(key, entry);
+			_lookupCount++;
+			lookup = true;
+		}
+	}
+	if (!lookup) {
+		entry->loadedEvent.wait();
+		return entry->queueUrl;
+	}
+
+	String queueUrl;
+	// The time in seconds to keep the result, or -1 not to cache it.
+	int ttl = -1;
+	{
+		REFAutoreleasePool pool;
+		REF<SQSGetQueueUrlParams> params = new SQSGetQueueUrlParams(queueName);
+		params->setQueueOwnerAWSAccountId(queueOwnerAWSAccountId);
+		SQSGetQueueUrlResult* result = client->getQueueUrl(params);
+		if (result == NULL) {
+			LOGE("Failed to look up queue '%s': request failed.",
+					queueName.cstr());
+		} else if (result->getErrorCode().isEmpty()) {
+			queueUrl = result->getQueueUrl();
+			ttl = _ttl;
+		} else if (result->getErrorCode()
+				== "AWS.SimpleQueueService.NonExistentQueue") {
+			ttl = _negativeTtl;
+		} else {
+			LOGE("Failed to look up queue '%s': %s", queueName.cstr(),
+					result->getErrorMessage().cstr());
+		}
+	}
+
+	MutexHolder holder(&_lock);
+	entry->queueUrl = queueUrl;
+	entry->loading = false;
+	if (ttl != -1) {
+		entry->expiry = Thread::getTickCount() + (int64_t) ttl * 1000;
+	} else {
+		// Lets the next caller try again, unless invalidated meanwhile.
+		TreeMapT<String, REF<SQSQueueUrlEntry> >::PENTRY node =
+				_entries.getEntry(key);
+		if (node != NULL && node->value == entry)
+			_entries.deleteEntry(node);
+	}
+	entry->loadedEvent.set();
+	return queueUrl;
+}
+
+void SQSQueueUrlCache::invalidate(SQSClient* client, const String& queueName,
+		const String& queueOwnerAWSAccountId) {
+	BFX_ASSERT(client);
+	BFX_ASSERT(!queueName.isEmpty());
+
+	String key = makeKey(client, queueName, queueOwnerAWSAccountId);
+	MutexHolder holder(&_lock);
+	TreeMapT<String, REF<SQSQueueUrlEntry> >::PENTRY node = _entries.getEntry(
+			key);
+	// A lookup in progress is as fresh as a new one.
+	if (node != NULL && !node->value->loading)
+		_entries.deleteEntry(node);
+}
+
+void SQSQueueUrlCache::clear() {
+	MutexHolder holder(&_lock);
+	_entries.clear();
+}
+
+String SQSQueueUrlCache::makeKey(SQSClient* client, const String& queueName,
+		const String& queueOwnerAWSAccountId) {
+	// Different accounts may have queues of the same name.
+	AWSCredentials* credentials = client->getCredentials();
+	return String::format("%s\n%s\n%s\n%s", client->getEndpoint().cstr(),
+			(credentials == NULL) ? "" : credentials->getAccessKeyId().cstr(),
+			queueOwnerAWSAccountId.cstr(), queueName.cstr());
+}
@@ -0,0 +1,62 @@
+/*
+ * SQSQueueUrlCache.h
+ */
+
+#ifndef AWS_SQSQUEUEURLCACHE_H_
+#define AWS_SQSQUEUEURLCACHE_H_
+
+class SQSQueueUrlEntry;
+
+/// Caches queue URLs by queue name, so that resolving a queue costs a single
+/// GetQueueUrl request until the entry expires. Queues which don't exist are
+/// cached too, for a shorter time. Concurrent lookups of the same queue share
+/// one request.
+///
+/// The entries are kept per endpoint and access key, so that a cache can be
+/// shared by all clients of a process. The cache is thread-safe.
+class SQSQueueUrlCache: public REFObject {
+public:
+	enum {
+		DEFAULT_TTL = 300,	/// Default time in seconds to keep a URL
+		/// Default time in seconds to remember a queue doesn't exist
+		DEFAULT_NEGATIVE_TTL = 10,
+	};
+
+	SQSQueueUrlCache(int ttl = DEFAULT_TTL, int negativeTtl =
+			DEFAULT_NEGATIVE_TTL);
+	virtual ~SQSQueueUrlCache();
+
+	/// Gets the cache shared by the process.
+	static SQSQueueUrlCache* getDefault();
+
+	/// Gets the URL of the named queue, looking it up by the client on a miss.
+	/// Returns an empty string if the queue doesn't exist, or the lookup
+	/// failed.
+	String getQueueUrl(SQSClient* client, const String& queueName,
+			const String& queueOwnerAWSAccountId = "");
+	/// Forgets the URL of the named queue, e.g. after the queue has been
+	/// reported as deleted.
+	void invalidate(SQSClient* client, const String& queueName,
+			const String& queueOwnerAWSAccountId = "");
+	/// Forgets all URLs.
+	void clear();
+
+	/// Gets the number of GetQueueUrl requests sent so far.
+	int64_t getLookupCount() const {
+		return _lookupCount;
+	}
+
+private:
+	// Returns the key of a queue in the entries.
+	static String makeKey(SQSClient* client, const String& queueName,
+			const String& queueOwnerAWSAccountId);
+
+	int _ttl;
+	int _negativeTtl;
+
+	Mutex _lock;
+	TreeMapT<String, REF<SQSQueueUrlEntry> > _entries;
+	int64_t _lookupCount;
+};
+
+#endif /* AWS_SQSQUEUEURLCACHE_H_ */
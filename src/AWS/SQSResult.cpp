@@ -7,80 +7,202 @@
 
 #include "AWS.h"
 
-#undef LOGT
-#define LOGT(...)
-#define LOG_TAG "SQSResult"
+// The elements of the SQS responses, by their indexes in sqsElementNames.
+enum SQSElement {
+	E_ErrorResponse,
+	E_Error,
+	E_Code,
+	E_Message,
+	E_RequestId,
+	E_ResponseMetadata,
+	E_ReceiveMessageResponse,
+	E_ReceiveMessageResult,
+	E_MessageId,
+	E_ReceiptHandle,
+	E_MD5OfBody,
+	E_Body,
+	E_Attribute,
+	E_MessageAttribute,
+	E_Name,
+	E_Value,
+	E_StringValue,
+	E_ListQueuesResponse,
+	E_ListQueuesResult,
+	E_GetQueueUrlResponse,
+	E_GetQueueUrlResult,
+	E_QueueUrl,
+	E_SendMessageResponse,
+	E_SendMessageResult,
+	E_MD5OfMessageBody,
+	E_MD5OfMessageAttributes,
+	E_SendMessageBatchResponse,
+	E_SendMessageBatchResult,
+	E_SendMessageBatchResultEntry,
+	E_BatchResultErrorEntry,
+	E_Id,
+	E_SenderFault,
+	E_DeleteMessageResponse,
+	E_DeleteMessageBatchResponse,
+	E_DeleteMessageBatchResult,
+	E_DeleteMessageBatchResultEntry,
+	E_ChangeMessageVisibilityResponse,
+	E_ChangeMessageVisibilityBatchResponse,
+	E_ChangeMessageVisibilityBatchResult,
+	E_ChangeMessageVisibilityBatchResultEntry,
+	E_Count
+};
 
-////////////////////////////////////////////////////////////////////////////////
+static const char* const sqsElementNames[] = {
+	"ErrorResponse",
+	"Error",
+	"Code",
+	"Message",
+	"RequestId",
+	"ResponseMetadata",
+	"ReceiveMessageResponse",
+	"ReceiveMessageResult",
+	"MessageId",
+	"ReceiptHandle",
+	"MD5OfBody",
+	"Body",
+	"Attribute",
+	"MessageAttribute",
+	"Name",
+	"Value",
+	"StringValue",
+	"ListQueuesResponse",
+	"ListQueuesResult",
+	"GetQueueUrlResponse",
+	"GetQueueUrlResult",
+	"QueueUrl",
+	"SendMessageResponse",
+	"SendMessageResult",
+	"MD5OfMessageBody",
+	"MD5OfMessageAttributes",
+	"SendMessageBatchResponse",
+	"SendMessageBatchResult",
+	"SendMessageBatchResultEntry",
+	"BatchResultErrorEntry",
+	"Id",
+	"SenderFault",
+	"DeleteMessageResponse",
+	"DeleteMessageBatchResponse",
+	"DeleteMessageBatchResult",
+	"DeleteMessageBatchResultEntry",
+	"ChangeMessageVisibilityResponse",
+	"ChangeMessageVisibilityBatchResponse",
+	"ChangeMessageVisibilityBatchResult",
+	"ChangeMessageVisibilityBatchResultEntry",
+};
 
-bool SQSResultUnmarshaller::unmarshaller(AWSHttpResponse* response,
-		SQSResult* result) {
-	BFX_ASSERT(_result == NULL);
-
-	_result = result;
-	REF<TextReader> reader = new StringReader(response->getContent());
-	bool retval = parse(reader);
-	_result = NULL;
-
-	return retval;
-}
-
-void SQSResultUnmarshaller::onStartElement(const char* localname,
-		const char* prefix, const char* URI, int numNamespaces,
-		const char** namespaces, int numAttributes, int numDefaulted,
-		const char** attributes) {
-	LOGT("onStartElement: %s", localname);
-
-	if (stringEquals(localname, "ErrorResponse")) {
-		_successful = false;
-	} else if (_successful) {
-		handleStartElement(localname, attributes, numAttributes);
-	} else if (stringEquals(localname, "Code")) {
-		setState(S_ErrorCode);
-	} else if (stringEquals(localname, "Message")) {
-		setState(S_ErrorMessage);
-	} else if (stringEquals(localname, "RequestID")) {
-		setState(S_RequestId);
-	}
+typedef char SQSElementNamesCheck[
+		(sizeof(sqsElementNames) / sizeof(sqsElementNames[0]) == E_Count) ?
+				1 : -1];
+
+static const AWSElementTable sqsElements(sqsElementNames, E_Count);
+
+#define SQS_RULE_COUNT(rules)	((int) (sizeof(rules) / sizeof(rules[0])))
+
+// A name and a value being parsed, of a message attribute or of a system
+// one.
+struct SQSAttributeEntry: REFObject {
+	String name;
+	String value;
+};
+
+static void setSenderFault(REFObject* target, const String& value) {
+	static_cast<SQSBatchResultErrorEntry*>(target)->senderFault =
+			(value.compareTo("true", true) == 0);
 }
-void SQSResultUnmarshaller::onCharacters(const char* chars, int numChars) {
-	LOGT("onCharacters: %s", String(chars, numChars).cstr())
-	;
-	BFX_ASSERT(_result);
-
-	if (_successful) {
-		handleCharacters(chars, numChars);
-	} else {
-		String value(chars, numChars);
-		if (hasState(S_ErrorCode)) {
-			_result->setErrorCode(value);
-		} else if (hasState(S_ErrorMessage)) {
-			_result->setErrorMessage(value);
-		} else if (hasState(S_RequestId)) {
-			_result->setRequestId(value);
-		}
-	}
+
+static void addQueueUrl(REFObject* target, const String& value) {
+	static_cast<SQSListQueuesResult*>(target)->getQueueUrls()->addLast(value);
+}
+
+static REFObject* openAttribute(REFObject* target) {
+	return new SQSAttributeEntry();
 }
-void SQSResultUnmarshaller::onEndElement(const char*localname,
-		const char* prefix, const char* URI) {
-	BFX_ASSERT(_result);
-	LOGT("onEndElement: %s", localname);
-
-	if (_successful) {
-		handleEndElement(localname);
-	} else {
-		if (stringEquals(localname, "Code")) {
-			unsetState(S_ErrorCode);
-		} else if (stringEquals(localname, "Message")) {
-			unsetState(S_ErrorMessage);
-		} else if (stringEquals(localname, "RequestID")) {
-			unsetState(S_RequestId);
-		}
+
+static void closeMessageAttribute(REFObject* target, REFObject* parentTarget) {
+	SQSAttributeEntry* entry = static_cast<SQSAttributeEntry*>(target);
+	SQSMessage* message = static_cast<SQSMessage*>(parentTarget);
+	// Binary attributes are left out, string ones can't be empty.
+	if (!entry->value.isEmpty()) {
+		if (message->messageAttributes == NULL)
+			message->messageAttributes = new AWSStringMap();
+		message->messageAttributes->set(entry->name, entry->value);
 	}
 }
 
+static void closeAttribute(REFObject* target, REFObject* parentTarget) {
+	SQSAttributeEntry* entry = static_cast<SQSAttributeEntry*>(target);
+	SQSMessage* message = static_cast<SQSMessage*>(parentTarget);
+	if (message->attributes == NULL)
+		message->attributes = new AWSStringMap();
+	message->attributes->set(entry->name, entry->value);
+}
+
+// The rules of the error responses, and of the metadata of all responses.
+static const AWSElementRule commonRules[] = {
+	{ AWSElementRule::ROOT, E_ErrorResponse, NULL, NULL, NULL },
+	{ E_ErrorResponse, E_Error, NULL, NULL, NULL },
+	{ E_Error, E_Code, NULL,
+			&AWSElementRule::setBy<SQSResult, &SQSResult::setErrorCode>, NULL },
+	{ E_Error, E_Message, NULL,
+			&AWSElementRule::setBy<SQSResult, &SQSResult::setErrorMessage>, NULL },
+	{ E_ErrorResponse, E_RequestId, NULL,
+			&AWSElementRule::setBy<SQSResult, &SQSResult::setRequestId>, NULL },
+	{ AWSElementRule::ANY, E_ResponseMetadata, NULL, NULL, NULL },
+	{ E_ResponseMetadata, E_RequestId, NULL,
+			&AWSElementRule::setBy<SQSResult, &SQSResult::setRequestId>, NULL },
+};
+
+#define SQS_RULE_SET(name, rules)	\
+	static const AWSElementRuleSet name(&sqsElements, rules,	\
+			SQS_RULE_COUNT(rules), commonRules, SQS_RULE_COUNT(commonRules))
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool SQSResultUnmarshaller::unmarshaller(AWSHttpResponse* response,
+		SQSResult* result) {
+	return parse(response->getContent(), result);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
+static const AWSElementRule receiveMessageRules[] = {
+	{ AWSElementRule::ROOT, E_ReceiveMessageResponse, NULL, NULL, NULL },
+	{ E_ReceiveMessageResponse, E_ReceiveMessageResult, NULL, NULL, NULL },
+	{ E_ReceiveMessageResult, E_Message, &AWSElementRule::addEntry<
+			SQSReceiveMessageResult, SQSMessageList,
+			&SQSReceiveMessageResult::getMessages, SQSMessage>, NULL, NULL },
+	{ E_Message, E_MessageId, NULL, &AWSElementRule::setField<SQSMessage,
+			&SQSMessage::messageId>, NULL },
+	{ E_Message, E_ReceiptHandle, NULL, &AWSElementRule::setField<SQSMessage,
+			&SQSMessage::receiptHandle>, NULL },
+	{ E_Message, E_MD5OfBody, NULL, &AWSElementRule::setField<SQSMessage,
+			&SQSMessage::MD5OfBody>, NULL },
+	{ E_Message, E_Body, NULL,
+			&AWSElementRule::setField<SQSMessage, &SQSMessage::body>, NULL },
+	{ E_Message, E_Attribute, &openAttribute, NULL, &closeAttribute },
+	{ E_Attribute, E_Name, NULL, &AWSElementRule::setField<SQSAttributeEntry,
+			&SQSAttributeEntry::name>, NULL },
+	{ E_Attribute, E_Value, NULL, &AWSElementRule::setField<SQSAttributeEntry,
+			&SQSAttributeEntry::value>, NULL },
+	{ E_Message, E_MessageAttribute, &openAttribute, NULL,
+			&closeMessageAttribute },
+	{ E_MessageAttribute, E_Name, NULL, &AWSElementRule::setField<
+			SQSAttributeEntry, &SQSAttributeEntry::name>, NULL },
+	{ E_MessageAttribute, E_Value, NULL, NULL, NULL },
+	{ E_Value, E_StringValue, NULL, &AWSElementRule::setField<
+			SQSAttributeEntry, &SQSAttributeEntry::value>, NULL },
+};
+SQS_RULE_SET(receiveMessageRuleSet, receiveMessageRules);
+
+SQSReceiveMessageResultUnmarshaller::SQSReceiveMessageResultUnmarshaller() :
+		SQSResultUnmarshaller(&receiveMessageRuleSet) {
+}
+
 SQSReceiveMessageResult* SQSReceiveMessageResultUnmarshaller::unmarshall(
 		AWSHttpResponse* response) {
 	REF<SQSReceiveMessageResult> result = new SQSReceiveMessageResult();
@@ -92,62 +214,116 @@ SQSReceiveMessageResult* SQSReceiveMessageResultUnmarshaller::unmarshall(
 	return result;
 }
 
-void SQSReceiveMessageResultUnmarshaller::handleStartElement(
-		const char* localname, const char** attributes, int numAttributes) {
-	SQSReceiveMessageResult* result = (SQSReceiveMessageResult*) _result;
-	if (stringEquals(localname, "ReceiveMessageResponse")) {
-		// XXX Nothing to do
-	} else if (stringEquals(localname, "Message")) {
-		_curMessage = new SQSMessage();
-		result->getMessages()->addLast(_curMessage);
-	} else if (stringEquals(localname, "MessageId")) {
-		setState(S_MessageId);
-	} else if (stringEquals(localname, "ReceiptHandle")) {
-		setState(S_ReceiptHandle);
-	} else if (stringEquals(localname, "MD5OfBody")) {
-		setState(S_MD5OfMessageBody);
-	} else if (stringEquals(localname, "Body")) {
-		setState(S_Body);
-	} else if (stringEquals(localname, "MetaData")) {
-		setState(S_MetaData);
-	}
+////////////////////////////////////////////////////////////////////////////////
+
+// The receive into a batch appends the text of the fields to the batch,
+// which is the target of all the elements of the result.
+
+static REFObject* openBatch(REFObject* target) {
+	return static_cast<SQSReceiveMessageBatchResult*>(target)->getBatch();
+}
+
+static REFObject* openBatchMessage(REFObject* target) {
+	static_cast<SQSMessageBatch*>(target)->addMessage();
+	return target;
+}
+
+static REFObject* openBatchAttribute(REFObject* target) {
+	static_cast<SQSMessageBatch*>(target)->beginAttribute();
+	return target;
 }
-void SQSReceiveMessageResultUnmarshaller::handleCharacters(const char* chars,
+
+static void appendBatchText(REFObject* target, const char* chars,
 		int numChars) {
-	String value(chars, numChars);
-	if (hasState(S_MessageId)) {
-		_curMessage->messageId = value;
-	} else if (hasState(S_ReceiptHandle)) {
-		_curMessage->receiptHandle = value;
-	} else if (hasState(S_MD5OfMessageBody)) {
-		_curMessage->MD5OfBody = value;
-	} else if (hasState(S_MetaData)) {
-		// TODO :)
-		// uint64_t lMetaData = strtoul(value.cstr(), NULL, 0);
-		// _curMessage._metaData = value;
-	} else if (hasState(S_Body)) {
-		// TODO partial & base64 decode support
-		_curMessage->body += value;
-	}
+	static_cast<SQSMessageBatch*>(target)->appendText(chars, numChars);
 }
-void SQSReceiveMessageResultUnmarshaller::handleEndElement(
-		const char* localname) {
-	if (stringEquals(localname, "MessageId")) {
-		unsetState(S_MessageId);
-	} else if (stringEquals(localname, "ReceiptHandle")) {
-		unsetState(S_ReceiptHandle);
-	} else if (stringEquals(localname, "MD5OfBody")) {
-		unsetState(S_MD5OfMessageBody);
-	} else if (stringEquals(localname, "MetaData")) {
-		unsetState(S_MetaData);
-	} else if (stringEquals(localname, "Body")) {
-		unsetState(S_Body);
-		// TODO partial & base64 decode support
-	}
+
+template<SQSMessageBatch::Field field>
+static void closeBatchField(REFObject* target, REFObject* parentTarget) {
+	static_cast<SQSMessageBatch*>(target)->endField(field);
+}
+
+static void closeBatchAttributeName(REFObject* target,
+		REFObject* parentTarget) {
+	static_cast<SQSMessageBatch*>(target)->endAttributeName();
+}
+
+static void closeBatchAttributeValue(REFObject* target,
+		REFObject* parentTarget) {
+	static_cast<SQSMessageBatch*>(target)->endAttributeValue();
+}
+
+static void closeBatchAttribute(REFObject* target, REFObject* parentTarget) {
+	static_cast<SQSMessageBatch*>(target)->endAttribute(true);
+}
+
+static void closeBatchMessageAttribute(REFObject* target,
+		REFObject* parentTarget) {
+	static_cast<SQSMessageBatch*>(target)->endAttribute(false);
+}
+
+static const AWSElementRule receiveMessageBatchRules[] = {
+	{ AWSElementRule::ROOT, E_ReceiveMessageResponse, NULL, NULL, NULL, NULL },
+	{ E_ReceiveMessageResponse, E_ReceiveMessageResult, &openBatch, NULL, NULL,
+			NULL },
+	{ E_ReceiveMessageResult, E_Message, &openBatchMessage, NULL, NULL, NULL },
+	{ E_Message, E_MessageId, NULL, NULL,
+			&closeBatchField<SQSMessageBatch::F_MessageId>, &appendBatchText },
+	{ E_Message, E_ReceiptHandle, NULL, NULL,
+			&closeBatchField<SQSMessageBatch::F_ReceiptHandle>,
+			&appendBatchText },
+	{ E_Message, E_MD5OfBody, NULL, NULL,
+			&closeBatchField<SQSMessageBatch::F_MD5OfBody>, &appendBatchText },
+	{ E_Message, E_Body, NULL, NULL, &closeBatchField<SQSMessageBatch::F_Body>,
+			&appendBatchText },
+	{ E_Message, E_Attribute, &openBatchAttribute, NULL, &closeBatchAttribute,
+			NULL },
+	{ E_Attribute, E_Name, NULL, NULL, &closeBatchAttributeName,
+			&appendBatchText },
+	{ E_Attribute, E_Value, NULL, NULL, &closeBatchAttributeValue,
+			&appendBatchText },
+	{ E_Message, E_MessageAttribute, &openBatchAttribute, NULL,
+			&closeBatchMessageAttribute, NULL },
+	{ E_MessageAttribute, E_Name, NULL, NULL, &closeBatchAttributeName,
+			&appendBatchText },
+	{ E_MessageAttribute, E_Value, NULL, NULL, NULL, NULL },
+	{ E_Value, E_StringValue, NULL, NULL, &closeBatchAttributeValue,
+			&appendBatchText },
+};
+SQS_RULE_SET(receiveMessageBatchRuleSet, receiveMessageBatchRules);
+
+SQSReceiveMessageBatchResultUnmarshaller::SQSReceiveMessageBatchResultUnmarshaller() :
+		SQSResultUnmarshaller(&receiveMessageBatchRuleSet) {
+}
+
+SQSReceiveMessageBatchResult* SQSReceiveMessageBatchResultUnmarshaller::unmarshall(
+		AWSHttpResponse* response) {
+	REF<SQSReceiveMessageBatchResult> result =
+			new SQSReceiveMessageBatchResult();
+	// The text of the messages is never longer than the response.
+	String content = response->getContent();
+	result->setBatch(new SQSMessageBatch(content.getLength() + 1));
+	if (parse(content, result))
+		result->autorelease();
+	else
+		result = NULL;
+
+	return result;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
+static const AWSElementRule listQueuesRules[] = {
+	{ AWSElementRule::ROOT, E_ListQueuesResponse, NULL, NULL, NULL },
+	{ E_ListQueuesResponse, E_ListQueuesResult, NULL, NULL, NULL },
+	{ E_ListQueuesResult, E_QueueUrl, NULL, &addQueueUrl, NULL },
+};
+SQS_RULE_SET(listQueuesRuleSet, listQueuesRules);
+
+SQSListQueuesResultUnmarshaller::SQSListQueuesResultUnmarshaller() :
+		SQSResultUnmarshaller(&listQueuesRuleSet) {
+}
+
 SQSListQueuesResult* SQSListQueuesResultUnmarshaller::unmarshall(
 		AWSHttpResponse* response) {
 	REF<SQSListQueuesResult> result = new SQSListQueuesResult();
@@ -159,26 +335,45 @@ SQSListQueuesResult* SQSListQueuesResultUnmarshaller::unmarshall(
 	return result;
 }
 
-void SQSListQueuesResultUnmarshaller::handleStartElement(const char* localname,
-		const char** attributes, int numAttributes) {
-	if (stringEquals(localname, "ListQueuesResponse")) {
-		// XXX Nothing to do
-	} else if (stringEquals(localname, "QueueUrl")) {
-		setState(S_QueueUrl);
-	}
+static const AWSElementRule getQueueUrlRules[] = {
+	{ AWSElementRule::ROOT, E_GetQueueUrlResponse, NULL, NULL, NULL },
+	{ E_GetQueueUrlResponse, E_GetQueueUrlResult, NULL, NULL, NULL },
+	{ E_GetQueueUrlResult, E_QueueUrl, NULL, &AWSElementRule::setBy<
+			SQSGetQueueUrlResult, &SQSGetQueueUrlResult::setQueueUrl>, NULL },
+};
+SQS_RULE_SET(getQueueUrlRuleSet, getQueueUrlRules);
+
+SQSGetQueueUrlResultUnmarshaller::SQSGetQueueUrlResultUnmarshaller() :
+		SQSResultUnmarshaller(&getQueueUrlRuleSet) {
 }
-void SQSListQueuesResultUnmarshaller::handleCharacters(const char* chars,
-		int numChars) {
-	if (hasState(S_QueueUrl)) {
-		String queueURL((const char*) chars, numChars);
-		SQSListQueuesResult* result = (SQSListQueuesResult*) _result;
-		result->getQueueUrls()->addLast(queueURL);
-	}
+
+SQSGetQueueUrlResult* SQSGetQueueUrlResultUnmarshaller::unmarshall(
+		AWSHttpResponse* response) {
+	REF<SQSGetQueueUrlResult> result = new SQSGetQueueUrlResult();
+	if (unmarshaller(response, result))
+		result->autorelease();
+	else
+		result = NULL;
+
+	return result;
 }
-void SQSListQueuesResultUnmarshaller::handleEndElement(const char* localname) {
-	if (stringEquals(localname, "QueueUrl")) {
-		unsetState(S_QueueUrl);
-	}
+
+static const AWSElementRule sendMessageRules[] = {
+	{ AWSElementRule::ROOT, E_SendMessageResponse, NULL, NULL, NULL },
+	{ E_SendMessageResponse, E_SendMessageResult, NULL, NULL, NULL },
+	{ E_SendMessageResult, E_MessageId, NULL, &AWSElementRule::setBy<
+			SQSSendMessageResult, &SQSSendMessageResult::setMessageId>, NULL },
+	{ E_SendMessageResult, E_MD5OfMessageBody, NULL, &AWSElementRule::setBy<
+			SQSSendMessageResult, &SQSSendMessageResult::setMD5OfMessageBody>,
+			NULL },
+	{ E_SendMessageResult, E_MD5OfMessageAttributes, NULL,
+			&AWSElementRule::setBy<SQSSendMessageResult,
+					&SQSSendMessageResult::setMD5OfMessageAttributes>, NULL },
+};
+SQS_RULE_SET(sendMessageRuleSet, sendMessageRules);
+
+SQSSendMessageResultUnmarshaller::SQSSendMessageResultUnmarshaller() :
+		SQSResultUnmarshaller(&sendMessageRuleSet) {
 }
 
 SQSSendMessageResult* SQSSendMessageResultUnmarshaller::unmarshall(
@@ -192,32 +387,99 @@ SQSSendMessageResult* SQSSendMessageResultUnmarshaller::unmarshall(
 	return result;
 }
 
-void SQSSendMessageResultUnmarshaller::handleStartElement(const char* localname,
-		const char** attributes, int numAttributes) {
-	if (stringEquals(localname, "SendMessageResponse")) {
-		// XXX Nothing to do
-	} else if (stringEquals(localname, "MessageId")) {
-		setState(S_MessageId);
-	} else if (stringEquals(localname, "MD5OfMessageBody")) {
-		setState(S_MD5OfMessageBody);
-	}
+// The failed entries are the same to all the batches.
+#define SQS_BATCH_ERROR_RULES(Result)	\
+	{ E_##Result, E_BatchResultErrorEntry, &AWSElementRule::addEntry<	\
+			SQS##Result, SQSBatchResultErrorEntryList,	\
+			&SQS##Result::getFailed, SQSBatchResultErrorEntry>, NULL, NULL },	\
+	{ E_BatchResultErrorEntry, E_Id, NULL, &AWSElementRule::setField<	\
+			SQSBatchResultErrorEntry, &SQSBatchResultErrorEntry::id>, NULL },	\
+	{ E_BatchResultErrorEntry, E_Code, NULL, &AWSElementRule::setField<	\
+			SQSBatchResultErrorEntry, &SQSBatchResultErrorEntry::code>, NULL },	\
+	{ E_BatchResultErrorEntry, E_Message, NULL, &AWSElementRule::setField<	\
+			SQSBatchResultErrorEntry, &SQSBatchResultErrorEntry::message>,	\
+			NULL },	\
+	{ E_BatchResultErrorEntry, E_SenderFault, NULL, &setSenderFault, NULL }
+
+static const AWSElementRule sendMessageBatchRules[] = {
+	{ AWSElementRule::ROOT, E_SendMessageBatchResponse, NULL, NULL, NULL },
+	{ E_SendMessageBatchResponse, E_SendMessageBatchResult, NULL, NULL, NULL },
+	{ E_SendMessageBatchResult, E_SendMessageBatchResultEntry,
+			&AWSElementRule::addEntry<SQSSendMessageBatchResult,
+					SQSSendMessageBatchResultEntryList,
+					&SQSSendMessageBatchResult::getSuccessful,
+					SQSSendMessageBatchResultEntry>, NULL, NULL },
+	{ E_SendMessageBatchResultEntry, E_Id, NULL, &AWSElementRule::setField<
+			SQSSendMessageBatchResultEntry, &SQSSendMessageBatchResultEntry::id>,
+			NULL },
+	{ E_SendMessageBatchResultEntry, E_MessageId, NULL,
+			&AWSElementRule::setField<SQSSendMessageBatchResultEntry,
+					&SQSSendMessageBatchResultEntry::messageId>, NULL },
+	{ E_SendMessageBatchResultEntry, E_MD5OfMessageBody, NULL,
+			&AWSElementRule::setField<SQSSendMessageBatchResultEntry,
+					&SQSSendMessageBatchResultEntry::MD5OfMessageBody>, NULL },
+	{ E_SendMessageBatchResultEntry, E_MD5OfMessageAttributes, NULL,
+			&AWSElementRule::setField<SQSSendMessageBatchResultEntry,
+					&SQSSendMessageBatchResultEntry::MD5OfMessageAttributes>,
+			NULL },
+	SQS_BATCH_ERROR_RULES(SendMessageBatchResult),
+};
+SQS_RULE_SET(sendMessageBatchRuleSet, sendMessageBatchRules);
+
+SQSSendMessageBatchResultUnmarshaller::SQSSendMessageBatchResultUnmarshaller() :
+		SQSResultUnmarshaller(&sendMessageBatchRuleSet) {
 }
-void SQSSendMessageResultUnmarshaller::handleCharacters(const char* chars,
-		int numChars) {
-	SQSSendMessageResult* result = (SQSSendMessageResult*) _result;
-	String value(chars, numChars);
-	if (hasState(S_MessageId)) {
-		result->setMessageId(value);
-	} else if (hasState(S_MD5OfMessageBody)) {
-		result->setMD5OfMessageBody(value);
-	}
+
+SQSSendMessageBatchResult* SQSSendMessageBatchResultUnmarshaller::unmarshall(
+		AWSHttpResponse* response) {
+	REF<SQSSendMessageBatchResult> result = new SQSSendMessageBatchResult();
+	if (unmarshaller(response, result))
+		result->autorelease();
+	else
+		result = NULL;
+
+	return result;
 }
-void SQSSendMessageResultUnmarshaller::handleEndElement(const char* localname) {
-	if (stringEquals(localname, "MessageId")) {
-		unsetState(S_MessageId);
-	} else if (stringEquals(localname, "MD5OfMessageBody")) {
-		unsetState(S_MD5OfMessageBody);
-	}
+
+// The response has metadata only.
+static const AWSElementRule deleteMessageRules[] = {
+	{ AWSElementRule::ROOT, E_DeleteMessageResponse, NULL, NULL, NULL },
+};
+SQS_RULE_SET(deleteMessageRuleSet, deleteMessageRules);
+
+SQSDeleteMessageResultUnmarshaller::SQSDeleteMessageResultUnmarshaller() :
+		SQSResultUnmarshaller(&deleteMessageRuleSet) {
+}
+
+SQSDeleteMessageResult* SQSDeleteMessageResultUnmarshaller::unmarshall(
+		AWSHttpResponse* response) {
+	REF<SQSDeleteMessageResult> result = new SQSDeleteMessageResult();
+	if (unmarshaller(response, result))
+		result->autorelease();
+	else
+		result = NULL;
+
+	return result;
+}
+
+static const AWSElementRule deleteMessageBatchRules[] = {
+	{ AWSElementRule::ROOT, E_DeleteMessageBatchResponse, NULL, NULL, NULL },
+	{ E_DeleteMessageBatchResponse, E_DeleteMessageBatchResult, NULL, NULL,
+			NULL },
+	{ E_DeleteMessageBatchResult, E_DeleteMessageBatchResultEntry,
+			&AWSElementRule::addEntry<SQSDeleteMessageBatchResult,
+					SQSDeleteMessageBatchResultEntryList,
+					&SQSDeleteMessageBatchResult::getSuccessful,
+					SQSDeleteMessageBatchResultEntry>, NULL, NULL },
+	{ E_DeleteMessageBatchResultEntry, E_Id, NULL, &AWSElementRule::setField<
+			SQSDeleteMessageBatchResultEntry,
+			&SQSDeleteMessageBatchResultEntry::id>, NULL },
+	SQS_BATCH_ERROR_RULES(DeleteMessageBatchResult),
+};
+SQS_RULE_SET(deleteMessageBatchRuleSet, deleteMessageBatchRules);
+
+SQSDeleteMessageBatchResultUnmarshaller::SQSDeleteMessageBatchResultUnmarshaller() :
+		SQSResultUnmarshaller(&deleteMessageBatchRuleSet) {
 }
 
 SQSDeleteMessageBatchResult* SQSDeleteMessageBatchResultUnmarshaller::unmarshall(
@@ -231,64 +493,60 @@ SQSDeleteMessageBatchResult* SQSDeleteMessageBatchResultUnmarshaller::unmarshall
 	return result;
 }
 
-void SQSDeleteMessageBatchResultUnmarshaller::handleStartElement(
-		const char* localname, const char** attributes, int numAttributes) {
-	if (stringEquals(localname, "DeleteMessageBatchResponse")) {
-		// XXX Nothing to do
-	} else if (stringEquals(localname, "DeleteMessageBatchResultEntry")) {
-		_curResultEntry = new SQSDeleteMessageBatchResultEntry();
-		setState(S_BatchResultEntry);
-	} else if (stringEquals(localname, "BatchResultErrorEntry")) {
-		_curErrorResultEntry = new SQSBatchResultErrorEntry();
-		setState(S_BatchResultErrorEntry);
-	} else if (stringEquals(localname, "Id")) {
-		setState(S_MessageId);
-	} else if (stringEquals(localname, "Code")) {
-		setState(S_BatchResultErrorCode);
-	} else if (stringEquals(localname, "Message")) {
-		setState(S_BatchResultErrorMessage);
-	} else if (stringEquals(localname, "SenderFault")) {
-		setState(S_BatchResultErrorSenderFault);
-	}
+// The response has metadata only.
+static const AWSElementRule changeMessageVisibilityRules[] = {
+	{ AWSElementRule::ROOT, E_ChangeMessageVisibilityResponse, NULL, NULL,
+			NULL },
+};
+SQS_RULE_SET(changeMessageVisibilityRuleSet, changeMessageVisibilityRules);
+
+SQSChangeMessageVisibilityResultUnmarshaller::SQSChangeMessageVisibilityResultUnmarshaller() :
+		SQSResultUnmarshaller(&changeMessageVisibilityRuleSet) {
 }
 
-void SQSDeleteMessageBatchResultUnmarshaller::handleCharacters(
-		const char* chars, int numChars) {
-	String value(chars, numChars);
-	if (hasState(S_BatchResultErrorEntry)) {
-		if (hasState(S_MessageId)) {
-			_curErrorResultEntry->id = value;
-		} else if (hasState(S_BatchResultErrorCode)) {
-			_curErrorResultEntry->code = value;
-		} else if (hasState(S_BatchResultErrorMessage)) {
-			_curErrorResultEntry->message = value;
-		} else if (hasState(S_BatchResultErrorSenderFault)) {
-			LOGW("SenderFault=%s", (const char*)value);
-			_curErrorResultEntry->senderFault = (value.compareTo("true", true)
-					== 0);
-		}
-	} else if (hasState(S_BatchResultEntry)) {
-		if (hasState(S_MessageId)) {
-			_curResultEntry->id = value;
-		}
-	}
+SQSChangeMessageVisibilityResult* SQSChangeMessageVisibilityResultUnmarshaller::unmarshall(
+		AWSHttpResponse* response) {
+	REF<SQSChangeMessageVisibilityResult> result =
+			new SQSChangeMessageVisibilityResult();
+	if (unmarshaller(response, result))
+		result->autorelease();
+	else
+		result = NULL;
+
+	return result;
 }
 
-void SQSDeleteMessageBatchResultUnmarshaller::handleEndElement(
-		const char* localname) {
-	if (stringEquals(localname, "DeleteMessageBatchResultEntry")) {
-		unsetState(S_BatchResultEntry);
-		_curResultEntry = NULL;
-	} else if (stringEquals(localname, "BatchResultErrorEntry")) {
-		unsetState(S_BatchResultErrorEntry);
-		_curErrorResultEntry = NULL;
-	} else if (stringEquals(localname, "Id")) {
-		unsetState(S_MessageId);
-	} else if (stringEquals(localname, "Code")) {
-		unsetState(S_BatchResultErrorCode);
-	} else if (stringEquals(localname, "Message")) {
-		unsetState(S_BatchResultErrorMessage);
-	} else if (stringEquals(localname, "SenderFault")) {
-		unsetState(S_BatchResultErrorSenderFault);
-	}
+static const AWSElementRule changeMessageVisibilityBatchRules[] = {
+	{ AWSElementRule::ROOT, E_ChangeMessageVisibilityBatchResponse, NULL, NULL,
+			NULL },
+	{ E_ChangeMessageVisibilityBatchResponse,
+			E_ChangeMessageVisibilityBatchResult, NULL, NULL, NULL },
+	{ E_ChangeMessageVisibilityBatchResult,
+			E_ChangeMessageVisibilityBatchResultEntry,
+			&AWSElementRule::addEntry<SQSChangeMessageVisibilityBatchResult,
+					SQSChangeMessageVisibilityBatchResultEntryList,
+					&SQSChangeMessageVisibilityBatchResult::getSuccessful,
+					SQSChangeMessageVisibilityBatchResultEntry>, NULL, NULL },
+	{ E_ChangeMessageVisibilityBatchResultEntry, E_Id, NULL,
+			&AWSElementRule::setField<SQSChangeMessageVisibilityBatchResultEntry,
+					&SQSChangeMessageVisibilityBatchResultEntry::id>, NULL },
+	SQS_BATCH_ERROR_RULES(ChangeMessageVisibilityBatchResult),
+};
+SQS_RULE_SET(changeMessageVisibilityBatchRuleSet,
+		changeMessageVisibilityBatchRules);
+
+SQSChangeMessageVisibilityBatchResultUnmarshaller::SQSChangeMessageVisibilityBatchResultUnmarshaller() :
+		SQSResultUnmarshaller(&changeMessageVisibilityBatchRuleSet) {
+}
+
+SQSChangeMessageVisibilityBatchResult* SQSChangeMessageVisibilityBatchResultUnmarshaller::unmarshall(
+		AWSHttpResponse* response) {
+	REF<SQSChangeMessageVisibilityBatchResult> result =
+			new SQSChangeMessageVisibilityBatchResult();
+	if (unmarshaller(response, result))
+		result->autorelease();
+	else
+		result = NULL;
+
+	return result;
 }
@@ -82,6 +82,23 @@ private:
 	REF<AWSStringList> _queueUrls;
 };
 
+/// The result contains QueueUrl element on GetQueueUrl.
+class SQSGetQueueUrlResult: public SQSResult {
+public:
+	SQSGetQueueUrlResult() {
+	}
+	virtual ~SQSGetQueueUrlResult() {
+	}
+	const String& getQueueUrl() const {
+		return _queueUrl;
+	}
+	void setQueueUrl(const String& queueUrl) {
+		_queueUrl = queueUrl;
+	}
+private:
+	String _queueUrl;
+};
+
 /// The result contains MessageId/MD5OfMessageBody/MD5OfMessageAttributes on
 /// SendMessage.
 class SQSSendMessageResult: public SQSResult {
@@ -137,8 +154,35 @@ private:
 	REF<SQSMessageList> _messages;
 };
 
-class SQSDeleteMessageResult: public SQSResult {
+/// The result of SQSClient::receiveMessageBatch(), with the messages in
+/// compact form.
+class SQSReceiveMessageBatchResult: public SQSResult {
+public:
+	SQSReceiveMessageBatchResult() {
+	}
+	virtual ~SQSReceiveMessageBatchResult() {
+	}
+	/// Gets the messages, never NULL.
+	SQSMessageBatch* getBatch() const {
+		if (_batch == NULL)
+			const_cast<SQSReceiveMessageBatchResult*>(this)->_batch =
+					new SQSMessageBatch();
+		return _batch;
+	}
+	void setBatch(SQSMessageBatch* batch) {
+		_batch = batch;
+	}
+
+private:
+	REF<SQSMessageBatch> _batch;
+};
 
+class SQSDeleteMessageResult: public SQSResult {
+public:
+	SQSDeleteMessageResult() {
+	}
+	virtual ~SQSDeleteMessageResult() {
+	}
 };
 
 /// The result contains both successful and failed tags on DeleteMessageBatch.
@@ -165,116 +209,134 @@ private:
 	REF<SQSBatchResultErrorEntryList> _failed;
 };
 
-
-class SQSResultUnmarshaller: public AWSResultUnmarshaller {
+/// The result contains both successful and failed tags on SendMessageBatch.
+class SQSSendMessageBatchResult: public SQSResult {
 public:
-	SQSResultUnmarshaller() :
-			_state(0), _successful(true), _result(NULL) {
+	SQSSendMessageBatchResult() {
 	}
-	virtual ~SQSResultUnmarshaller() {
+	virtual ~SQSSendMessageBatchResult() {
 	}
+	SQSSendMessageBatchResultEntryList* getSuccessful() const {
+		if (_successful == NULL)
+			const_cast<SQSSendMessageBatchResult*>(this)->_successful =
+					new SQSSendMessageBatchResultEntryList();
+		return _successful;
+	}
+	SQSBatchResultErrorEntryList* getFailed() const {
+		if (_failed == NULL)
+			const_cast<SQSSendMessageBatchResult*>(this)->_failed =
+					new SQSBatchResultErrorEntryList();
+		return _failed;
+	}
+private:
+	REF<SQSSendMessageBatchResultEntryList> _successful;
+	REF<SQSBatchResultErrorEntryList> _failed;
+};
 
-protected:
-	bool unmarshaller(AWSHttpResponse* response, SQSResult* result);
-
-	void setState(uint64_t state) {
-		_state |= state;
+class SQSChangeMessageVisibilityResult: public SQSResult {
+public:
+	SQSChangeMessageVisibilityResult() {
+	}
+	virtual ~SQSChangeMessageVisibilityResult() {
 	}
-	bool hasState(uint64_t state) {
-		return (_state & state) == state;
+};
+
+/// The result contains both successful and failed tags on
+/// ChangeMessageVisibilityBatch.
+class SQSChangeMessageVisibilityBatchResult: public SQSResult {
+public:
+	SQSChangeMessageVisibilityBatchResult() {
 	}
-	void unsetState(uint64_t state) {
-		_state ^= state;
+	virtual ~SQSChangeMessageVisibilityBatchResult() {
 	}
-	bool isSuccessful() const {
+	SQSChangeMessageVisibilityBatchResultEntryList* getSuccessful() const {
+		if (_successful == NULL)
+			const_cast<SQSChangeMessageVisibilityBatchResult*>(this)->_successful =
+					new SQSChangeMessageVisibilityBatchResultEntryList();
 		return _successful;
 	}
+	SQSBatchResultErrorEntryList* getFailed() const {
+		if (_failed == NULL)
+			const_cast<SQSChangeMessageVisibilityBatchResult*>(this)->_failed =
+					new SQSBatchResultErrorEntryList();
+		return _failed;
+	}
+private:
+	REF<SQSChangeMessageVisibilityBatchResultEntryList> _successful;
+	REF<SQSBatchResultErrorEntryList> _failed;
+};
 
-	virtual void handleStartElement(const char* localname,
-			const char** attributes, int numAttributes) = 0;
-	virtual void handleCharacters(const char* value, int len) = 0;
-	virtual void handleEndElement(const char* localname) = 0;
-
-	virtual void onStartElement(const char* localname, const char* prefix,
-			const char* URI, int numNamespaces, const char** namespaces,
-			int numAttributes, int numDefaulted, const char** attributes);
-	virtual void onCharacters(const char* value, int len);
-	virtual void onEndElement(const char*localname, const char* prefix,
-			const char* URI);
+class SQSResultUnmarshaller: public AWSRuleResultUnmarshaller {
+public:
+	SQSResultUnmarshaller(const AWSElementRuleSet* rules) :
+			AWSRuleResultUnmarshaller(rules) {
+	}
+	virtual ~SQSResultUnmarshaller() {
+	}
 
 protected:
-	enum State {
-		S_ErrorCode = 1, //
-		S_ErrorMessage = 2, //
-		S_RequestId = 4, //
-		S_HostId = 8, //
-		S_QueueUrl = 16, //
-		S_MessageId = 32, //
-		S_MD5OfMessageBody = 64, //
-		S_ReceiptHandle = 128, //
-		S_Body = 256, //
-		S_MetaData = 512, //
-		S_BatchResultEntry = 1024, //
-		S_BatchResultErrorEntry = 2048, //
-		S_BatchResultErrorCode = 4096, //
-		S_BatchResultErrorMessage = 8192, //
-		S_BatchResultErrorSenderFault = 16384, //
-	};
-
-	uint64_t _state;
-	bool _successful;
-
-	SQSResult* _result;
+	bool unmarshaller(AWSHttpResponse* response, SQSResult* result);
 };
 
-class SQSReceiveMessageResultUnmarshaller : public SQSResultUnmarshaller {
+class SQSReceiveMessageResultUnmarshaller: public SQSResultUnmarshaller {
 public:
+	SQSReceiveMessageResultUnmarshaller();
 	SQSReceiveMessageResult* unmarshall(AWSHttpResponse* response);
+};
 
-protected:
-	virtual void handleStartElement(const char* localname,
-			const char** attributes, int numAttributes);
-	virtual void handleCharacters(const char* chars, int numChars);
-	virtual void handleEndElement(const char* localname);
-
-protected:
-	REF<SQSMessage> _curMessage;
+class SQSReceiveMessageBatchResultUnmarshaller: public SQSResultUnmarshaller {
+public:
+	SQSReceiveMessageBatchResultUnmarshaller();
+	SQSReceiveMessageBatchResult* unmarshall(AWSHttpResponse* response);
 };
 
-class SQSListQueuesResultUnmarshaller : public SQSResultUnmarshaller {
+class SQSListQueuesResultUnmarshaller: public SQSResultUnmarshaller {
 public:
+	SQSListQueuesResultUnmarshaller();
 	SQSListQueuesResult* unmarshall(AWSHttpResponse* response);
+};
 
-protected:
-	virtual void handleStartElement(const char* localname,
-			const char** attributes, int numAttributes);
-	virtual void handleCharacters(const char* chars, int numChars);
-	virtual void handleEndElement(const char* localname);
+class SQSGetQueueUrlResultUnmarshaller: public SQSResultUnmarshaller {
+public:
+	SQSGetQueueUrlResultUnmarshaller();
+	SQSGetQueueUrlResult* unmarshall(AWSHttpResponse* response);
 };
 
-class SQSSendMessageResultUnmarshaller : public SQSResultUnmarshaller {
+class SQSSendMessageResultUnmarshaller: public SQSResultUnmarshaller {
 public:
+	SQSSendMessageResultUnmarshaller();
 	SQSSendMessageResult* unmarshall(AWSHttpResponse* response);
+};
 
-protected:
-	virtual void handleStartElement(const char* localname,
-			const char** attributes, int numAttributes);
-	virtual void handleCharacters(const char* chars, int numChars);
-	virtual void handleEndElement(const char* localname);
+class SQSSendMessageBatchResultUnmarshaller: public SQSResultUnmarshaller {
+public:
+	SQSSendMessageBatchResultUnmarshaller();
+	SQSSendMessageBatchResult* unmarshall(AWSHttpResponse* response);
 };
 
-class SQSDeleteMessageBatchResultUnmarshaller : public SQSResultUnmarshaller {
+class SQSDeleteMessageResultUnmarshaller: public SQSResultUnmarshaller {
 public:
+	SQSDeleteMessageResultUnmarshaller();
+	SQSDeleteMessageResult* unmarshall(AWSHttpResponse* response);
+};
+
+class SQSDeleteMessageBatchResultUnmarshaller: public SQSResultUnmarshaller {
+public:
+	SQSDeleteMessageBatchResultUnmarshaller();
 	SQSDeleteMessageBatchResult* unmarshall(AWSHttpResponse* response);
+};
 
-protected:
-	virtual void handleStartElement(const char* localname,
-			const char** attributes, int numAttributes);
-	virtual void handleCharacters(const char* chars, int numChars);
-	virtual void handleEndElement(const char* localname);
-protected:
-	REF<SQSDeleteMessageBatchResultEntry> _curResultEntry;
-	REF<SQSBatchResultErrorEntry> _curErrorResultEntry;
+class SQSChangeMessageVisibilityResultUnmarshaller: public SQSResultUnmarshaller {
+public:
+	SQSChangeMessageVisibilityResultUnmarshaller();
+	SQSChangeMessageVisibilityResult* unmarshall(AWSHttpResponse* response);
+};
+
+class SQSChangeMessageVisibilityBatchResultUnmarshaller: public SQSResultUnmarshaller {
+public:
+	SQSChangeMessageVisibilityBatchResultUnmarshaller();
+	SQSChangeMessageVisibilityBatchResult* unmarshall(
+			AWSHttpResponse* response);
 };
 
 #endif /* TestTest1_AWS_SQSRESULT_H_ */
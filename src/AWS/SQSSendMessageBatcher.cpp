@@ -0,0 +1,331 @@
+/*
+ * SQSSendMessageBatcher.cpp
+ */
+
+#include "AWS.h"
+
+#define LOG_TAG "SQSSendMessageBatcher"
+
+SQSSendMessageFuture::SQSSendMessageFuture() :
+		_senderFault(false), _done(false), _doneEvent(true) {
+}
+
+SQSSendMessageFuture::~SQSSendMessageFuture() {
+}
+
+bool SQSSendMessageFuture::wait(int milliseconds) {
+	return _done || _doneEvent.wait(milliseconds);
+}
+
+void SQSSendMessageFuture::setSuccessful(const String& messageId,
+		const String& MD5OfMessageBody) {
+	_messageId = messageId;
+	_MD5OfMessageBody = MD5OfMessageBody;
+	MemoryBarrier();
+	_done = true;
+	_doneEvent.set();
+}
+
+void SQSSendMessageFuture::setFailed(const String& errorCode,
+		const String& errorMessage, bool senderFault) {
+	BFX_ASSERT(!errorCode.isEmpty());
+
+	_errorCode = errorCode;
+	_errorMessage = errorMessage;
+	_senderFault = senderFault;
+	MemoryBarrier();
+	_done = true;
+	_doneEvent.set();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+// A message waiting to be sent.
+struct SQSSendMessageItem {
+	REF<SQSSendMessageBatchRequestEntry> entry;
+	REF<SQSSendMessageFuture> future;
+	SQSSendMessageListener* listener;
+};
+
+// Messages sent by a single SendMessageBatch request.
+class SQSSendMessageBatch: public REFObject {
+public:
+	SQSSendMessageBatch() :
+			size(0) {
+	}
+
+	ArrayListT<SQSSendMessageItem> items;
+	int size;
+};
+
+// A thread sending the ready batches of a batcher.
+class SQSSendMessageSender: public Thread {
+public:
+	SQSSendMessageSender(SQSSendMessageBatcher* batcher) :
+			_batcher(batcher) {
+	}
+
+protected:
+	virtual void run() {
+		_batcher->runSender();
+	}
+
+private:
+	// The batcher stops the thread before being destroyed.
+	SQSSendMessageBatcher* _batcher;
+};
+
+SQSSendMessageBatcher::SQSSendMessageBatcher(SQSClient* client,
+		const String& queueUrl, int lingerTime, int maxBatchesInFlight) :
+		_workEvent(false), _idleEvent(true, true) {
+	BFX_ASSERT(client);
+	BFX_ASSERT(!queueUrl.isEmpty());
+	BFX_ASSERT(lingerTime >= 0);
+	BFX_ASSERT(maxBatchesInFlight > 0);
+
+	_client = client;
+	_queueUrl = queueUrl;
+	_lingerTime = lingerTime;
+	_openBatchDeadline = 0;
+	_outstanding = 0;
+	_closed = false;
+
+	// Batches sent at once may land out of order, which FIFO queues forbid.
+	if (SQSClient::isFifoQueue(queueUrl))
+		maxBatchesInFlight = 1;
+	for (int i = 0; i < maxBatchesInFlight; i++) {
+		REF<SQSSendMessageSender> sender = new SQSSendMessageSender(this);
+		if (!sender->start()) {
+			LOGE("Unable to start a sending thread.");
+			break;
+		}
+		_senders.add(sender);
+	}
+}
+
+SQSSendMessageBatcher::~SQSSendMessageBatcher() {
+	close();
+}
+
+SQSSendMessageFuture* SQSSendMessageBatcher::sendMessage(
+		const String& messageBody, int delaySeconds,
+		SQSSendMessageListener* listener) {
+	REF<SQSSendMessageBatchRequestEntry> entry =
+			new SQSSendMessageBatchRequestEntry();
+	entry->messageBody = messageBody;
+	entry->delaySeconds = delaySeconds;
+	return enqueue(entry, messageBody.getLength(), listener);
+}
+
+SQSSendMessageFuture* SQSSendMessageBatcher::sendMessage(
+		const SQSSendMessageParams* params, SQSSendMessageListener* listener) {
+	BFX_ASSERT(params);
+	BFX_ASSERT(params->getQueueUrl() == _queueUrl);
+
+	REF<SQSSendMessageBatchRequestEntry> entry =
+			new SQSSendMessageBatchRequestEntry();
+	entry->messageBody = params->getMessageBody();
+	entry->delaySeconds = params->getDelaySeconds();
+	entry->messageGroupId = params->getMessageGroupId();
+	entry->messageDeduplicationId = params->getMessageDeduplicationId();
+	// The size of a message includes the names, types and values of its
+	// attributes.
+	int entrySize = entry->messageBody.getLength();
+	if (params->hasMessageAttributes()) {
+		entry->messageAttributes = new AWSStringMap();
+		AWSStringMap* attrs = params->getMessageAttributes();
+		for (AWSStringMap::PENTRY attr = attrs->getFirstEntry(); attr != NULL;
+				attr = attrs->getNextEntry(attr)) {
+			entry->messageAttributes->set(attr->key, attr->value);
+			entrySize += attr->key.getLength() + attr->value.getLength()
+					+ (int) sizeof("String") - 1;
+		}
+	}
+	return enqueue(entry, entrySize, listener);
+}
+
+SQSSendMessageFuture* SQSSendMessageBatcher::enqueue(
+		SQSSendMessageBatchRequestEntry* entry, int entrySize,
+		SQSSendMessageListener* listener) {
+	// A body stored in S3 by the client leaves only a pointer in the batch,
+	// unless compressing makes it small enough to be sent as is.
+	if (_client->isPayloadOffloaded(entrySize)) {
+		entrySize = BFX_MAX((int) SQSClient::MAX_POINTER_SIZE,
+				_client->getPayloadThreshold());
+	}
+	REF<SQSSendMessageFuture> future = new SQSSendMessageFuture();
+	{
+		MutexHolder holder(&_lock);
+		if (_closed) {
+			LOGE("Unable to send a message by a closed batcher.");
+			return NULL;
+		}
+
+		// Seals the open batch if the message doesn't fit in.
+		if (_openBatch != NULL && _openBatch->size + entrySize > MAX_BATCH_SIZE)
+			sealOpenBatch();
+		if (_openBatch == NULL) {
+			_openBatch = new SQSSendMessageBatch();
+			_openBatchDeadline = Thread::getTickCount() + _lingerTime;
+			// Wakes a sender up to wait for the linger time.
+			_workEvent.set();
+		}
+		SQSSendMessageItem item;
+		item.entry = entry;
+		item.future = future;
+		item.listener = listener;
+		_openBatch->items.add(item);
+		_openBatch->size += entrySize;
+		if (_openBatch->items.getSize() == MAX_BATCH_MESSAGES)
+			sealOpenBatch();
+
+		if (_outstanding++ == 0)
+			_idleEvent.reset();
+	}
+	future->autorelease();
+	return future;
+}
+
+void SQSSendMessageBatcher::sealOpenBatch() {
+	if (_openBatch == NULL)
+		return;
+
+	// The IDs only have to be unique within a batch.
+	for (int i = 0; i < _openBatch->items.getSize(); i++)
+		_openBatch->items[i].entry->id = String::format("%d", i);
+	_readyBatches.add(_openBatch);
+	_openBatch = NULL;
+	_workEvent.set();
+}
+
+void SQSSendMessageBatcher::flush() {
+	{
+		MutexHolder holder(&_lock);
+		sealOpenBatch();
+	}
+	_idleEvent.wait();
+}
+
+void SQSSendMessageBatcher::close() {
+	{
+		MutexHolder holder(&_lock);
+		if (_closed)
+			return;
+		_closed = true;
+		sealOpenBatch();
+		// The senders exit once there is nothing left to send, each one wakes
+		// the next one up.
+		_workEvent.set();
+	}
+	for (int i = 0; i < _senders.getSize(); i++)
+		_senders[i]->join();
+	_senders.clear();
+}
+
+void SQSSendMessageBatcher::runSender() {
+	_lock.lock();
+	while (true) {
+		if (_readyBatches.getSize() > 0) {
+			REF<SQSSendMessageBatch> batch = _readyBatches[0];
+			_readyBatches.removeAt(0);
+			// Lets another sender take the next batch meanwhile.
+			if (_readyBatches.getSize() > 0 || _openBatch != NULL)
+				_workEvent.set();
+			_lock.unlock();
+			{
+				REFAutoreleasePool pool;
+				sendBatch(batch);
+			}
+			_lock.lock();
+			continue;
+		}
+		int timeout = -1;
+		if (_openBatch != NULL) {
+			int64_t now = Thread::getTickCount();
+			if (_closed || now >= _openBatchDeadline) {
+				sealOpenBatch();
+				continue;
+			}
+			timeout = (int) (_openBatchDeadline - now);
+		} else if (_closed) {
+			_workEvent.set();
+			break;
+		}
+		_lock.unlock();
+		_workEvent.wait(timeout);
+		_lock.lock();
+	}
+	_lock.unlock();
+}
+
+void SQSSendMessageBatcher::sendBatch(SQSSendMessageBatch* batch) {
+	int count = batch->items.getSize();
+	REF<SQSSendMessageBatchParams> params = new SQSSendMessageBatchParams(
+			_queueUrl);
+	for (int i = 0; i < count; i++)
+		params->getEntries()->addLast(batch->items[i].entry);
+
+	SQSSendMessageBatchResult* result = _client->sendMessageBatch(params);
+	if (result == NULL || !result->getErrorCode().isEmpty()) {
+		// The whole batch failed.
+		String errorCode = "RequestFailed";
+		String errorMessage = "Failed to send the batch request.";
+		if (result != NULL) {
+			errorCode = result->getErrorCode();
+			errorMessage = result->getErrorMessage();
+		}
+		LOGE("Failed to send %d message(s): %s, %s", count, errorCode.cstr(),
+				errorMessage.cstr());
+		for (int i = 0; i < count; i++) {
+			batch->items[i].future->setFailed(errorCode, errorMessage, false);
+			complete(batch->items[i].future, batch->items[i].listener);
+		}
+		return;
+	}
+
+	// Each entry is reported individually by its ID, i.e. its index.
+	SQSSendMessageBatchResultEntryList* successful = result->getSuccessful();
+	for (SQSSendMessageBatchResultEntryList::PENTRY entry =
+			successful->getFirstEntry(); entry != NULL;
+			entry = successful->getNextEntry(entry)) {
+		int index = atoi(entry->value->id);
+		if (index < 0 || index >= count
+				|| batch->items[index].future->isDone()) {
+			LOGW("Unexpected entry ID: '%s'.", entry->value->id.cstr());
+			continue;
+		}
+		batch->items[index].future->setSuccessful(entry->value->messageId,
+				entry->value->MD5OfMessageBody);
+		complete(batch->items[index].future, batch->items[index].listener);
+	}
+	SQSBatchResultErrorEntryList* failed = result->getFailed();
+	for (SQSBatchResultErrorEntryList::PENTRY entry = failed->getFirstEntry();
+			entry != NULL; entry = failed->getNextEntry(entry)) {
+		int index = atoi(entry->value->id);
+		if (index < 0 || index >= count
+				|| batch->items[index].future->isDone()) {
+			LOGW("Unexpected entry ID: '%s'.", entry->value->id.cstr());
+			continue;
+		}
+		batch->items[index].future->setFailed(entry->value->code,
+				entry->value->message, entry->value->senderFault);
+		complete(batch->items[index].future, batch->items[index].listener);
+	}
+	for (int i = 0; i < count; i++) {
+		if (!batch->items[i].future->isDone()) {
+			batch->items[i].future->setFailed("MissingResult",
+					"The response doesn't report the message.", false);
+			complete(batch->items[i].future, batch->items[i].listener);
+		}
+	}
+}
+
+void SQSSendMessageBatcher::complete(SQSSendMessageFuture* future,
+		SQSSendMessageListener* listener) {
+	if (listener != NULL)
+		listener->onSendMessageCompleted(future);
+
+	MutexHolder holder(&_lock);
+	if (--_outstanding == 0)
+		_idleEvent.set();
+}
@@ -0,0 +1,147 @@
+/*
+ * SQSSendMessageBatcher.h
+ */
+
+#ifndef AWS_SQSSENDMESSAGEBATCHER_H_
+#define AWS_SQSSENDMESSAGEBATCHER_H_
+
+/// The outcome of a message sent by SQSSendMessageBatcher, which becomes
+/// available once the batch containing the message has been sent.
+class SQSSendMessageFuture: public REFObject {
+public:
+	SQSSendMessageFuture();
+	virtual ~SQSSendMessageFuture();
+
+	/// Waits until the outcome is available, or the time-out interval elapses.
+	/// Returns false on time-out.
+	bool wait(int milliseconds = -1);
+	/// Gets a value indicating whether the outcome is available.
+	bool isDone() const {
+		return _done;
+	}
+	/// Gets a value indicating whether the message was enqueued.
+	bool isSuccessful() const {
+		return _done && _errorCode.isEmpty();
+	}
+
+	/// Gets the ID of the enqueued message.
+	const String& getMessageId() const {
+		return _messageId;
+	}
+	/// Gets the MD5 digest of the message body, computed by SQS.
+	const String& getMD5OfMessageBody() const {
+		return _MD5OfMessageBody;
+	}
+	/// Gets the error code if the message wasn't enqueued.
+	const String& getErrorCode() const {
+		return _errorCode;
+	}
+	/// Gets the error message if the message wasn't enqueued.
+	const String& getErrorMessage() const {
+		return _errorMessage;
+	}
+	/// Gets a value indicating whether the error was caused by the message,
+	/// rather than by the service, so that retrying is pointless.
+	bool isSenderFault() const {
+		return _senderFault;
+	}
+
+private:
+	friend class SQSSendMessageBatcher;
+
+	// Sets the outcome and signals the waiters.
+	void setSuccessful(const String& messageId, const String& MD5OfMessageBody);
+	void setFailed(const String& errorCode, const String& errorMessage,
+			bool senderFault);
+
+	String _messageId;
+	String _MD5OfMessageBody;
+	String _errorCode;
+	String _errorMessage;
+	bool _senderFault;
+	volatile bool _done;
+	Event _doneEvent;
+};
+
+/// Receives the outcomes of messages sent by SQSSendMessageBatcher, the
+/// callback runs on a sending thread of the batcher.
+class SQSSendMessageListener {
+public:
+	virtual ~SQSSendMessageListener() {
+	}
+	virtual void onSendMessageCompleted(SQSSendMessageFuture* future) = 0;
+};
+
+class SQSSendMessageBatch;
+class SQSSendMessageSender;
+
+/// Sends messages to a queue asynchronously, grouping them into
+/// SendMessageBatch requests. A batch is sent as soon as it is full, or once
+/// its first message has waited for the linger time. Several batches are sent
+/// at once by a pool of threads, each message gets a future carrying its
+/// outcome, including failures of single entries of a batch. Batches of a
+/// FIFO queue are sent one at a time to keep them in order.
+class SQSSendMessageBatcher: public REFObject {
+public:
+	enum {
+		MAX_BATCH_MESSAGES = 10,	/// Maximum number of messages of a batch
+		MAX_BATCH_SIZE = 262144,	/// Maximum payload size of a batch in bytes
+		DEFAULT_LINGER_TIME = 20,	/// Default linger time in milliseconds
+		DEFAULT_MAX_BATCHES_IN_FLIGHT = 4,	/// Default number of threads
+	};
+
+	/// Creates a batcher sending messages to given queue by the client.
+	SQSSendMessageBatcher(SQSClient* client, const String& queueUrl,
+			int lingerTime = DEFAULT_LINGER_TIME, int maxBatchesInFlight =
+					DEFAULT_MAX_BATCHES_IN_FLIGHT);
+	virtual ~SQSSendMessageBatcher();
+
+	/// Queues a message to be sent, the listener, if any, must stay alive
+	/// until it's called. Returns an autoreleased future, or NULL if the
+	/// batcher has been closed.
+	SQSSendMessageFuture* sendMessage(const String& messageBody,
+			int delaySeconds = -1, SQSSendMessageListener* listener = NULL);
+	SQSSendMessageFuture* sendMessage(const SQSSendMessageParams* params,
+			SQSSendMessageListener* listener = NULL);
+
+	/// Sends the queued messages without lingering, and waits until the
+	/// outcomes of all of them are available.
+	void flush();
+	/// Flushes the queued messages and stops the sending threads, no more
+	/// messages are accepted.
+	void close();
+
+private:
+	friend class SQSSendMessageSender;
+
+	// Queues an entry into the open batch.
+	SQSSendMessageFuture* enqueue(SQSSendMessageBatchRequestEntry* entry,
+			int entrySize, SQSSendMessageListener* listener);
+	// Moves the open batch to the ready ones, the lock must be held.
+	void sealOpenBatch();
+	// The loop of each sending thread.
+	void runSender();
+	// Sends a batch and completes the futures of its messages.
+	void sendBatch(SQSSendMessageBatch* batch);
+	// Completes a message, the lock must not be held.
+	void complete(SQSSendMessageFuture* future,
+			SQSSendMessageListener* listener);
+
+	REF<SQSClient> _client;
+	String _queueUrl;
+	int _lingerTime;
+
+	Mutex _lock;
+	REF<SQSSendMessageBatch> _openBatch;
+	int64_t _openBatchDeadline;
+	ArrayListT<REF<SQSSendMessageBatch> > _readyBatches;
+	int _outstanding;
+	bool _closed;
+	// Signaled when there may be a batch to send.
+	Event _workEvent;
+	// Signaled when no message is outstanding.
+	Event _idleEvent;
+	ArrayListT<REF<SQSSendMessageSender> > _senders;
+};
+
+#endif /* AWS_SQSSENDMESSAGEBATCHER_H_ */
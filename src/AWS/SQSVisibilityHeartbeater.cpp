@@ -0,0 +1,306 @@
+/*
+ * SQSVisibilityHeartbeater.cpp
+ */
+
+#include "AWS.h"
+
+#define LOG_TAG "SQSVisibilityHeartbeater"
+
+SQSInFlightMessage::SQSInFlightMessage(const String& queueUrl,
+		const String& receiptHandle) :
+		_queueUrl(queueUrl), _receiptHandle(receiptHandle), _expiry(0), _lost(
+				false), _tracked(true), _slot(-1), _rounds(0), _prev(NULL), _next(
+				NULL) {
+}
+
+SQSInFlightMessage::~SQSInFlightMessage() {
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+// A thread moving the timer wheel of a heartbeater, and sending extensions.
+class SQSHeartbeatWorker: public Thread {
+public:
+	SQSHeartbeatWorker(SQSVisibilityHeartbeater* heartbeater) :
+			_heartbeater(heartbeater) {
+	}
+
+protected:
+	virtual void run() {
+		_heartbeater->runWorker();
+	}
+
+private:
+	// The heartbeater stops the thread before being destroyed.
+	SQSVisibilityHeartbeater* _heartbeater;
+};
+
+SQSVisibilityHeartbeater::SQSVisibilityHeartbeater(SQSClient* client,
+		int extension, int margin, int workers) :
+		_workEvent(false) {
+	BFX_ASSERT(client);
+	BFX_ASSERT(extension > 0);
+	BFX_ASSERT(margin >= 0 && margin < extension * 1000);
+	BFX_ASSERT(workers > 0);
+
+	_client = client;
+	_extension = extension;
+	_margin = margin;
+	for (int i = 0; i < WHEEL_SLOTS; i++)
+		_slots[i] = NULL;
+	_startTime = Thread::getTickCount();
+	_currentTick = 0;
+	_trackedCount = 0;
+	_closed = false;
+
+	for (int i = 0; i < workers; i++) {
+		REF<SQSHeartbeatWorker> worker = new SQSHeartbeatWorker(this);
+		if (!worker->start()) {
+			LOGE("Unable to start a heartbeat thread.");
+			break;
+		}
+		_workers.add(worker);
+	}
+}
+
+SQSVisibilityHeartbeater::~SQSVisibilityHeartbeater() {
+	close();
+}
+
+SQSInFlightMessage* SQSVisibilityHeartbeater::track(const String& queueUrl,
+		const String& receiptHandle, int visibilityTimeout) {
+	BFX_ASSERT(!queueUrl.isEmpty());
+	BFX_ASSERT(!receiptHandle.isEmpty());
+	BFX_ASSERT(visibilityTimeout >= 0);
+
+	REF<SQSInFlightMessage> message = new SQSInFlightMessage(queueUrl,
+			receiptHandle);
+	message->_expiry = Thread::getTickCount()
+			+ (int64_t) visibilityTimeout * 1000;
+
+	MutexHolder holder(&_lock);
+	schedule(message, message->_expiry - _margin);
+	_trackedCount++;
+
+	message->autorelease();
+	return message;
+}
+
+void SQSVisibilityHeartbeater::untrack(SQSInFlightMessage* message) {
+	BFX_ASSERT(message);
+
+	MutexHolder holder(&_lock);
+	if (!message->_tracked)
+		return;
+	message->_tracked = false;
+	// A message being extended is out of the wheel, and won't get back.
+	if (message->_slot != -1)
+		unschedule(message);
+	_trackedCount--;
+}
+
+int SQSVisibilityHeartbeater::getTrackedCount() {
+	MutexHolder holder(&_lock);
+	return _trackedCount;
+}
+
+void SQSVisibilityHeartbeater::close() {
+	{
+		MutexHolder holder(&_lock);
+		if (_closed)
+			return;
+		_closed = true;
+		// Each thread wakes the next one up.
+		_workEvent.set();
+	}
+	for (int i = 0; i < _workers.getSize(); i++)
+		_workers[i]->join();
+	_workers.clear();
+
+	MutexHolder holder(&_lock);
+	for (int i = 0; i < WHEEL_SLOTS; i++) {
+		while (_slots[i] != NULL) {
+			_slots[i]->_tracked = false;
+			unschedule(_slots[i]);
+		}
+	}
+	_readyBatches.clear();
+	_trackedCount = 0;
+}
+
+void SQSVisibilityHeartbeater::schedule(SQSInFlightMessage* message,
+		int64_t due) {
+	BFX_ASSERT(message->_slot == -1);
+
+	// Rounds down to be early rather than late, but never into the past.
+	int64_t tick = (due - _startTime) / TICK_INTERVAL;
+	if (tick <= _currentTick)
+		tick = _currentTick + 1;
+	message->_rounds = (int) ((tick - _currentTick - 1) / WHEEL_SLOTS);
+	message->_slot = (int) (tick % WHEEL_SLOTS);
+
+	// The wheel holds a reference to each scheduled message.
+	message->addRef();
+	message->_prev = NULL;
+	message->_next = _slots[message->_slot];
+	if (message->_next != NULL)
+		message->_next->_prev = message;
+	_slots[message->_slot] = message;
+}
+
+void SQSVisibilityHeartbeater::unschedule(SQSInFlightMessage* message) {
+	BFX_ASSERT(message->_slot != -1);
+
+	if (message->_prev != NULL)
+		message->_prev->_next = message->_next;
+	else
+		_slots[message->_slot] = message->_next;
+	if (message->_next != NULL)
+		message->_next->_prev = message->_prev;
+	message->_prev = message->_next = NULL;
+	message->_slot = -1;
+	message->release();
+}
+
+void SQSVisibilityHeartbeater::advance() {
+	// Batches the due messages by queue.
+	TreeMapT<String, REF<SQSInFlightMessageBatch> > openBatches;
+	int64_t nowTick = (Thread::getTickCount() - _startTime) / TICK_INTERVAL;
+	while (_currentTick < nowTick) {
+		_currentTick++;
+		SQSInFlightMessage* message = _slots[_currentTick % WHEEL_SLOTS];
+		while (message != NULL) {
+			SQSInFlightMessage* next = message->_next;
+			if (message->_rounds > 0) {
+				message->_rounds--;
+				message = next;
+				continue;
+			}
+
+			TreeMapT<String, REF<SQSInFlightMessageBatch> >::PENTRY entry =
+					openBatches.getEntry(message->_queueUrl);
+			if (entry == NULL)
+				entry = openBatches.set(message->_queueUrl,
+						new SQSInFlightMessageBatch());
+			entry->value->add(message);
+			if (entry->value->getSize() == MAX_BATCH_ENTRIES) {
+				_readyBatches.add(entry->value);
+				openBatches.deleteEntry(entry);
+			}
+			unschedule(message);
+			message = next;
+		}
+	}
+	for (TreeMapT<String, REF<SQSInFlightMessageBatch> >::PENTRY entry =
+			openBatches.getFirstEntry(); entry != NULL;
+			entry = openBatches.getNextEntry(entry)) {
+		_readyBatches.add(entry->value);
+	}
+}
+
+void SQSVisibilityHeartbeater::runWorker() {
+	_lock.lock();
+	while (!_closed) {
+		if (_readyBatches.getSize() > 0) {
+			REF<SQSInFlightMessageBatch> batch = _readyBatches[0];
+			_readyBatches.removeAt(0);
+			// Lets another thread take the next batch meanwhile.
+			if (_readyBatches.getSize() > 0)
+				_workEvent.set();
+			_lock.unlock();
+			{
+				REFAutoreleasePool pool;
+				extendBatch(batch);
+			}
+			_lock.lock();
+			continue;
+		}
+
+		// Any idle thread moves the wheel on time.
+		int64_t now = Thread::getTickCount();
+		int64_t nextTickTime = _startTime + (_currentTick + 1) * TICK_INTERVAL;
+		if (now >= nextTickTime) {
+			advance();
+			continue;
+		}
+		_lock.unlock();
+		_workEvent.wait((int) (nextTickTime - now));
+		_lock.lock();
+	}
+	_workEvent.set();
+	_lock.unlock();
+}
+
+void SQSVisibilityHeartbeater::extendBatch(SQSInFlightMessageBatch* batch) {
+	int count = batch->getSize();
+	ArrayListT<REF<SQSInFlightMessage> >& messages = *batch;
+	REF<SQSChangeMessageVisibilityBatchParams> params =
+			new SQSChangeMessageVisibilityBatchParams(messages[0]->_queueUrl);
+	for (int i = 0; i < count; i++) {
+		REF<SQSChangeMessageVisibilityBatchRequestEntry> entry =
+				new SQSChangeMessageVisibilityBatchRequestEntry();
+		// The IDs only have to be unique within a batch.
+		entry->id = String::format("%d", i);
+		entry->receiptHandle = messages[i]->_receiptHandle;
+		entry->visibilityTimeout = _extension;
+		params->getEntries()->addLast(entry);
+	}
+
+	// 0: not reported, 1: extended, -1: failed by the sender's fault.
+	ArrayListT<int> outcomes(count);
+	for (int i = 0; i < count; i++)
+		outcomes.add(0);
+	// The new timeouts count from no earlier than the request.
+	int64_t expiry = Thread::getTickCount() + (int64_t) _extension * 1000;
+	SQSChangeMessageVisibilityBatchResult* result =
+			_client->changeMessageVisibilityBatch(params);
+	if (result == NULL || !result->getErrorCode().isEmpty()) {
+		LOGE("Failed to extend %d message(s) of '%s': %s", count,
+				messages[0]->_queueUrl.cstr(),
+				(result == NULL) ? "request failed" :
+						result->getErrorMessage().cstr());
+	} else {
+		SQSChangeMessageVisibilityBatchResultEntryList* successful =
+				result->getSuccessful();
+		for (SQSChangeMessageVisibilityBatchResultEntryList::PENTRY entry =
+				successful->getFirstEntry(); entry != NULL;
+				entry = successful->getNextEntry(entry)) {
+			int index = atoi(entry->value->id);
+			if (index >= 0 && index < count)
+				outcomes[index] = 1;
+		}
+		SQSBatchResultErrorEntryList* errors = result->getFailed();
+		for (SQSBatchResultErrorEntryList::PENTRY entry =
+				errors->getFirstEntry(); entry != NULL;
+				entry = errors->getNextEntry(entry)) {
+			int index = atoi(entry->value->id);
+			if (index >= 0 && index < count && entry->value->senderFault) {
+				// e.g. the message has been deleted, or the receipt handle
+				// has expired.
+				LOGW("Failed to extend message: %s, %s",
+						entry->value->code.cstr(), entry->value->message.cstr());
+				outcomes[index] = -1;
+			}
+		}
+	}
+
+	MutexHolder holder(&_lock);
+	int64_t now = Thread::getTickCount();
+	for (int i = 0; i < count; i++) {
+		SQSInFlightMessage* message = messages[i];
+		if (!message->_tracked)
+			continue;
+		if (outcomes[i] == 1) {
+			message->_expiry = expiry;
+			schedule(message, expiry - _margin);
+		} else if (outcomes[i] == 0 && now < message->_expiry) {
+			// Retries on the next tick while there is time left.
+			schedule(message, now);
+		} else {
+			LOGW("Lost message '%s'.", message->_receiptHandle.cstr());
+			message->_lost = true;
+			message->_tracked = false;
+			_trackedCount--;
+		}
+	}
+}
@@ -0,0 +1,119 @@
+/*
+ * SQSVisibilityHeartbeater.h
+ */
+
+#ifndef AWS_SQSVISIBILITYHEARTBEATER_H_
+#define AWS_SQSVISIBILITYHEARTBEATER_H_
+
+/// A message tracked by SQSVisibilityHeartbeater while being processed.
+class SQSInFlightMessage: public REFObject {
+public:
+	virtual ~SQSInFlightMessage();
+
+	const String& getQueueUrl() const {
+		return _queueUrl;
+	}
+	const String& getReceiptHandle() const {
+		return _receiptHandle;
+	}
+	/// Gets a value indicating whether the visibility timeout couldn't be
+	/// extended, so that the message may be delivered again.
+	bool isLost() const {
+		return _lost;
+	}
+
+private:
+	friend class SQSVisibilityHeartbeater;
+
+	SQSInFlightMessage(const String& queueUrl, const String& receiptHandle);
+
+	String _queueUrl;
+	String _receiptHandle;
+	// The tick count the message becomes visible again at.
+	int64_t _expiry;
+	volatile bool _lost;
+	bool _tracked;
+	// The position in the timer wheel, the slot is -1 if not scheduled.
+	int _slot;
+	int _rounds;
+	SQSInFlightMessage* _prev;
+	SQSInFlightMessage* _next;
+};
+
+class SQSHeartbeatWorker;
+
+typedef REFWrapper<ArrayListT<REF<SQSInFlightMessage> > > SQSInFlightMessageBatch;
+
+/// Keeps messages invisible while they are being processed, by extending
+/// their visibility timeouts shortly before expiry. The extensions due at the
+/// same time are batched into ChangeMessageVisibilityBatch requests per
+/// queue, which a pool of threads sends at once.
+///
+/// Messages are scheduled on a hashed timer wheel, so that tracking and
+/// untracking cost O(1), and each tick only visits the messages of its slot,
+/// no matter how many messages are in flight.
+class SQSVisibilityHeartbeater: public REFObject {
+public:
+	enum {
+		MAX_BATCH_ENTRIES = 10,	/// Maximum number of entries of a batch
+		WHEEL_SLOTS = 1024,	/// Number of slots of the timer wheel
+		TICK_INTERVAL = 500,	/// Time in milliseconds of a slot
+		DEFAULT_EXTENSION = 60,	/// Default extension in seconds
+		/// Default time in milliseconds before expiry to extend
+		DEFAULT_MARGIN = 10000,
+		DEFAULT_WORKERS = 4,	/// Default number of threads
+	};
+
+	/// Creates a heartbeater extending the visibility timeouts of messages by
+	/// given seconds, given milliseconds before they expire.
+	SQSVisibilityHeartbeater(SQSClient* client, int extension =
+			DEFAULT_EXTENSION, int margin = DEFAULT_MARGIN, int workers =
+			DEFAULT_WORKERS);
+	virtual ~SQSVisibilityHeartbeater();
+
+	/// Starts tracking a message just received with given visibility timeout
+	/// in seconds. Returns an autoreleased object to untrack the message by.
+	SQSInFlightMessage* track(const String& queueUrl,
+			const String& receiptHandle, int visibilityTimeout);
+	/// Stops tracking a message, e.g. when it has been processed.
+	void untrack(SQSInFlightMessage* message);
+	/// Gets the number of messages being tracked.
+	int getTrackedCount();
+
+	/// Stops the threads and untracks all messages.
+	void close();
+
+private:
+	friend class SQSHeartbeatWorker;
+
+	// Puts a message into the wheel to be due at given tick count, the lock
+	// must be held.
+	void schedule(SQSInFlightMessage* message, int64_t due);
+	// Takes a message out of the wheel, the lock must be held.
+	void unschedule(SQSInFlightMessage* message);
+	// Moves the wheel forward to now, batching the due messages by queue.
+	// The lock must be held.
+	void advance();
+	// The loop of each thread.
+	void runWorker();
+	// Extends a batch of messages of the same queue.
+	void extendBatch(SQSInFlightMessageBatch* batch);
+
+	REF<SQSClient> _client;
+	int _extension;
+	int _margin;
+
+	Mutex _lock;
+	SQSInFlightMessage* _slots[WHEEL_SLOTS];
+	int64_t _startTime;
+	int64_t _currentTick;
+	int _trackedCount;
+	ArrayListT<REF<SQSInFlightMessageBatch> > _readyBatches;
+	bool _closed;
+
+	// Signaled when there may be a batch to send, or on close.
+	Event _workEvent;
+	ArrayListT<REF<SQSHeartbeatWorker> > _workers;
+};
+
+#endif /* AWS_SQSVISIBILITYHEARTBEATER_H_ */
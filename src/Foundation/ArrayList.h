@@ -90,7 +90,7 @@ public:
 
 		if (iIndex < (_size - 1)) {
 			// shift old data down
-			memmove((void*) _data + iIndex, (const void*) _data + iIndex + 1,
+			memmove((void*) (_data + iIndex), (const void*) (_data + iIndex + 1),
 					(_size - iIndex - 1) * sizeof(TYPE));
 		}
 		_size--;
@@ -101,7 +101,7 @@ public:
 	 */
 	void remove(ARG_TYPE value) {
 		int iIndex;
-		while ((iIndex = indexOf(value)) == -1) {
+		while ((iIndex = indexOf(value)) != -1) {
 			removeAt(iIndex);
 		}
 	}
@@ -191,15 +191,15 @@ private:
 		}
 		// Increments the reference count.
 		long addRef() const {
-			return (++_refCount);
+			return InterlockedIncrement(&_refCount);
 		}
 		// Decrements the reference count.
 		long release() const {
-			if ((--_refCount) == 0) {
+			long refCount = InterlockedDecrement(&_refCount);
+			if (refCount == 0) {
 				delete this;
-				return 0;
 			}
-			return _refCount;
+			return refCount;
 		}
 		// Gets the current reference count.
 		long getRefCount() const {
@@ -40,6 +40,86 @@ static const int DaysToMonth365[] = { 0, 31, 59, 90, 120, 151, 181, 212, 243,
 static const int DaysToMonth366[] = { 0, 31, 60, 91, 121, 152, 182, 213, 244,
 		274, 305, 335, 366 };
 
+static const char MonthNames[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+// 1/1/0001 is a Monday.
+static const char DayOfWeekNames[] = "MonTueWedThuFriSatSun";
+
+// Splits the given ticks into year, month and day fields.
+static void splitDate(int64_t ticks, int& year, int& month, int& day) {
+	// Same as DateTime::getDateField(), but computes all fields at once.
+	int n = (int) (ticks / TicksPerDay);
+	int y400 = n / DaysPer400Years;
+	n -= y400 * DaysPer400Years;
+	int y100 = n / DaysPer100Years;
+	if (y100 == 4)
+		y100 = 3;
+	n -= y100 * DaysPer100Years;
+	int y4 = n / DaysPer4Years;
+	n -= y4 * DaysPer4Years;
+	int y1 = n / DaysPerYear;
+	if (y1 == 4)
+		y1 = 3;
+	year = y400 * 400 + y100 * 100 + y4 * 4 + y1 + 1;
+	n -= y1 * DaysPerYear;
+	bool leapYear = y1 == 3 && (y4 != 24 || y100 == 3);
+	const int* days = leapYear ? DaysToMonth366 : DaysToMonth365;
+	int m = (n >> 5) + 1;
+	while (n >= days[m])
+		m++;
+	month = m;
+	day = n - days[m - 1] + 1;
+}
+
+// Writes a zero-padded decimal number of given width, returns the end.
+static char* formatDigits(char* p, int value, int width) {
+	for (int i = width - 1; i >= 0; i--) {
+		p[i] = (char) ('0' + value % 10);
+		value /= 10;
+	}
+	return p + width;
+}
+
+// Reads a decimal number of given width.
+static bool parseDigits(const char*& p, const char* end, int width, int& value) {
+	if (end - p < width)
+		return false;
+	value = 0;
+	for (int i = 0; i < width; i++) {
+		if (p[i] < '0' || p[i] > '9')
+			return false;
+		value = value * 10 + (p[i] - '0');
+	}
+	p += width;
+	return true;
+}
+
+static bool parseChar(const char*& p, const char* end, char ch) {
+	if (p >= end || *p != ch)
+		return false;
+	p++;
+	return true;
+}
+
+// Reads a time zone offset like "+hh", "+hhmm" or "+hh:mm" in minutes.
+static bool parseZoneOffset(const char*& p, const char* end, int& minutes) {
+	if (p >= end || (*p != '+' && *p != '-'))
+		return false;
+	int sign = (*p++ == '-') ? -1 : 1;
+	int hour;
+	int minute = 0;
+	if (!parseDigits(p, end, 2, hour))
+		return false;
+	if (p < end) {
+		parseChar(p, end, ':');
+		if (!parseDigits(p, end, 2, minute))
+			return false;
+	}
+	if (hour > 23 || minute > 59)
+		return false;
+	minutes = sign * (hour * 60 + minute);
+	return true;
+}
+
 DateTime::DateTime() {
 	_ticks = (currentMillisecondsSince1970() * TicksPerMillisecond) + TicksTo1970;
 	_timezoneOffset = currentTimezoneOffset();
@@ -87,6 +167,10 @@ int DateTime::getDay() const {
 	return getDateField(DF_Day);
 }
 
+void DateTime::getDate(int& year, int& month, int& day) const {
+	splitDate(_ticks, year, month, day);
+}
+
 // Returns the hour field of this DateTime. The returned value is an integer between 0 and 23.
 int DateTime::getHour() const {
 	return (int) ((_ticks / TicksPerHour) % 24);
@@ -205,8 +289,215 @@ String DateTime::format(const char* format) const {
 	if (format == NULL)
 		format = DATETIME_DEFAULT_FORMAT;
 
-	return String::format(format, getYear(), getMonth(), getDay(), getHour(),
-			getMinute(), getSecond(), getMillisecond());
+	int year, month, day;
+	getDate(year, month, day);
+	return String::format(format, year, month, day, getHour(), getMinute(),
+			getSecond(), getMillisecond());
+}
+
+String DateTime::formatISO8601() const {
+	int64_t ticks = getUTCTicks();
+	int year, month, day;
+	splitDate(ticks, year, month, day);
+
+	// yyyy-MM-ddTHH:mm:ss.SSSZ
+	char buf[24];
+	char* p = formatDigits(buf, year, 4);
+	*p++ = '-';
+	p = formatDigits(p, month, 2);
+	*p++ = '-';
+	p = formatDigits(p, day, 2);
+	*p++ = 'T';
+	p = formatDigits(p, (int) ((ticks / TicksPerHour) % 24), 2);
+	*p++ = ':';
+	p = formatDigits(p, (int) ((ticks / TicksPerMinute) % 60), 2);
+	*p++ = ':';
+	p = formatDigits(p, (int) ((ticks / TicksPerSecond) % 60), 2);
+	*p++ = '.';
+	p = formatDigits(p, (int) ((ticks / TicksPerMillisecond) % 1000), 3);
+	*p++ = 'Z';
+	return String(buf, (int) (p - buf));
+}
+
+String DateTime::formatISO8601Basic() const {
+	int64_t ticks = getUTCTicks();
+	int year, month, day;
+	splitDate(ticks, year, month, day);
+
+	// yyyyMMddTHHmmssZ
+	char buf[16];
+	char* p = formatDigits(buf, year, 4);
+	p = formatDigits(p, month, 2);
+	p = formatDigits(p, day, 2);
+	*p++ = 'T';
+	p = formatDigits(p, (int) ((ticks / TicksPerHour) % 24), 2);
+	p = formatDigits(p, (int) ((ticks / TicksPerMinute) % 60), 2);
+	p = formatDigits(p, (int) ((ticks / TicksPerSecond) % 60), 2);
+	*p++ = 'Z';
+	return String(buf, (int) (p - buf));
+}
+
+String DateTime::formatRFC1123() const {
+	int64_t ticks = getUTCTicks();
+	int year, month, day;
+	splitDate(ticks, year, month, day);
+	int dayOfWeek = (int) ((ticks / TicksPerDay) % 7);
+
+	// ddd, dd MMM yyyy HH:mm:ss GMT
+	char buf[29];
+	char* p = buf;
+	memcpy(p, DayOfWeekNames + dayOfWeek * 3, 3);
+	p += 3;
+	*p++ = ',';
+	*p++ = ' ';
+	p = formatDigits(p, day, 2);
+	*p++ = ' ';
+	memcpy(p, MonthNames + (month - 1) * 3, 3);
+	p += 3;
+	*p++ = ' ';
+	p = formatDigits(p, year, 4);
+	*p++ = ' ';
+	p = formatDigits(p, (int) ((ticks / TicksPerHour) % 24), 2);
+	*p++ = ':';
+	p = formatDigits(p, (int) ((ticks / TicksPerMinute) % 60), 2);
+	*p++ = ':';
+	p = formatDigits(p, (int) ((ticks / TicksPerSecond) % 60), 2);
+	memcpy(p, " GMT", 4);
+	p += 4;
+	return String(buf, (int) (p - buf));
+}
+
+bool DateTime::parseISO8601(const char* str, int length) {
+	BFX_ASSERT(str);
+
+	const char* p = str;
+	const char* end = str + ((length < 0) ? strlen(str) : length);
+	int year, month, day;
+	int hour = 0, minute = 0, second = 0, millisecond = 0;
+	int zoneOffset = 0;
+
+	// yyyy-MM-dd or yyyyMMdd
+	if (!parseDigits(p, end, 4, year))
+		goto Failure;
+	bool extended;
+	extended = parseChar(p, end, '-');
+	if (!parseDigits(p, end, 2, month)
+			|| (extended && !parseChar(p, end, '-'))
+			|| !parseDigits(p, end, 2, day))
+		goto Failure;
+
+	// THH:mm:ss[.SSS] or THHmmss[.SSS]
+	if (p < end && (*p == 'T' || *p == 't' || *p == ' ')) {
+		p++;
+		if (!parseDigits(p, end, 2, hour)
+				|| (extended && !parseChar(p, end, ':'))
+				|| !parseDigits(p, end, 2, minute)
+				|| (extended && !parseChar(p, end, ':'))
+				|| !parseDigits(p, end, 2, second))
+			goto Failure;
+		if (p < end && (*p == '.' || *p == ',')) {
+			p++;
+			if (p >= end || *p < '0' || *p > '9')
+				goto Failure;
+			// Keeps milliseconds, ignores finer digits.
+			int scale = 100;
+			for (; p < end && *p >= '0' && *p <= '9'; p++) {
+				millisecond += (*p - '0') * scale;
+				scale /= 10;
+			}
+		}
+	}
+
+	// Z or +hh:mm
+	if (p < end) {
+		if (*p == 'Z' || *p == 'z')
+			p++;
+		else if (!parseZoneOffset(p, end, zoneOffset))
+			goto Failure;
+	}
+	if (p != end || !setUTC(year, month, day, hour, minute, second, millisecond))
+		goto Failure;
+
+	_ticks -= zoneOffset * TicksPerMinute;
+	return true;
+
+Failure:
+	LOGE("Failed to parse ISO-8601 datetime:'%.*s'.", (int ) (end - str), str);
+	return false;
+}
+
+bool DateTime::parseRFC1123(const char* str, int length) {
+	BFX_ASSERT(str);
+
+	const char* p = str;
+	const char* end = str + ((length < 0) ? strlen(str) : length);
+	int year, month = 0, day;
+	int hour, minute, second;
+	int zoneOffset = 0;
+
+	// The day of week is redundant, skips it.
+	if (end - p >= 4 && p[3] == ',') {
+		p += 4;
+		while (p < end && *p == ' ')
+			p++;
+	}
+	// d or dd
+	if (!parseDigits(p, end, 2, day)) {
+		if (!parseDigits(p, end, 1, day))
+			goto Failure;
+	}
+	if (!parseChar(p, end, ' ') || end - p < 3)
+		goto Failure;
+	for (int i = 0; i < 12; i++) {
+		if (memcmp(p, MonthNames + i * 3, 3) == 0) {
+			month = i + 1;
+			break;
+		}
+	}
+	if (month == 0)
+		goto Failure;
+	p += 3;
+	if (!parseChar(p, end, ' ') || !parseDigits(p, end, 4, year)
+			|| !parseChar(p, end, ' ') || !parseDigits(p, end, 2, hour)
+			|| !parseChar(p, end, ':') || !parseDigits(p, end, 2, minute)
+			|| !parseChar(p, end, ':') || !parseDigits(p, end, 2, second)
+			|| !parseChar(p, end, ' '))
+		goto Failure;
+	if (end - p == 3 && (memcmp(p, "GMT", 3) == 0 || memcmp(p, "UTC", 3) == 0))
+		p += 3;
+	else if (!parseZoneOffset(p, end, zoneOffset))
+		goto Failure;
+	if (p != end || !setUTC(year, month, day, hour, minute, second, 0))
+		goto Failure;
+
+	_ticks -= zoneOffset * TicksPerMinute;
+	return true;
+
+Failure:
+	LOGE("Failed to parse RFC-1123 datetime:'%.*s'.", (int ) (end - str), str);
+	return false;
+}
+
+int64_t DateTime::getUTCTicks() const {
+	return _ticks + (_timezoneOffset * TicksPerMinute);
+}
+
+bool DateTime::setUTC(int year, int month, int day, int hour, int minute,
+		int second, int millisecond) {
+	// Validates here, as dateToTicks() and timeToTicks() assert.
+	if (year < 1 || year > 9999 || month < 1 || month > 12)
+		return false;
+	const int* days = isLeapYear(year) ? DaysToMonth366 : DaysToMonth365;
+	if (day < 1 || day > days[month] - days[month - 1])
+		return false;
+	if (hour < 0 || hour > 23 || minute < 0 || minute > 59 || second < 0
+			|| second > 59 || millisecond < 0 || millisecond > 999)
+		return false;
+
+	_ticks = dateToTicks(year, month, day) + timeToTicks(hour, minute, second)
+			+ millisecond * TicksPerMillisecond;
+	_timezoneOffset = 0;
+	return true;
 }
 
 // Checks whether a given year is a leap year. This method returns true if
@@ -317,3 +608,75 @@ int DateTime::currentTimezoneOffset() {
 	gettimeofday(&tv, &tz);
 	return tz.tz_minuteswest;
 }
+
+// The stamps of the most recent second, guarded by a sequence lock. The
+// sequence is odd while a writer is updating the stamps.
+static volatile uint32_t __clockSequence = 0;
+static int64_t __clockSecond = -1;
+static char __clockDate[9];
+static char __clockDateTime[17];
+
+// Formats the stamps of given second since January 1, 1970 UTC.
+static void formatClockStamp(int64_t second, char* date, char* dateTime) {
+	int64_t ticks = second * TicksPerSecond + TicksTo1970;
+	int year, month, day;
+	splitDate(ticks, year, month, day);
+
+	char* p = formatDigits(date, year, 4);
+	p = formatDigits(p, month, 2);
+	p = formatDigits(p, day, 2);
+	*p = '\0';
+
+	memcpy(dateTime, date, 8);
+	p = dateTime + 8;
+	*p++ = 'T';
+	p = formatDigits(p, (int) ((ticks / TicksPerHour) % 24), 2);
+	p = formatDigits(p, (int) ((ticks / TicksPerMinute) % 60), 2);
+	p = formatDigits(p, (int) ((ticks / TicksPerSecond) % 60), 2);
+	*p++ = 'Z';
+	*p = '\0';
+}
+
+void UTCClock::now(Stamp& stamp) {
+	stamp.milliseconds = currentMilliseconds();
+	int64_t second = stamp.milliseconds / 1000;
+
+	uint32_t sequence = __clockSequence;
+	if ((sequence & 1) == 0) {
+		__sync_synchronize();
+		if (__clockSecond == second) {
+			memcpy(stamp.date, __clockDate, sizeof(stamp.date));
+			memcpy(stamp.dateTime, __clockDateTime, sizeof(stamp.dateTime));
+			__sync_synchronize();
+			if (__clockSequence == sequence)
+				return;
+		}
+	}
+
+	// The cached stamps are stale or being updated, formats by itself, then
+	// publishes them unless another thread is doing so.
+	formatClockStamp(second, stamp.date, stamp.dateTime);
+	if ((sequence & 1) == 0
+			&& __sync_bool_compare_and_swap(&__clockSequence, sequence,
+					sequence + 1)) {
+		__clockSecond = second;
+		memcpy(__clockDate, stamp.date, sizeof(stamp.date));
+		memcpy(__clockDateTime, stamp.dateTime, sizeof(stamp.dateTime));
+		__sync_fetch_and_add(&__clockSequence, 1);
+	}
+}
+
+void UTCClock::format(int64_t milliseconds, Stamp& stamp) {
+	stamp.milliseconds = milliseconds;
+	formatClockStamp(milliseconds / 1000, stamp.date, stamp.dateTime);
+}
+
+int64_t UTCClock::currentMilliseconds() {
+#ifdef CLOCK_REALTIME_COARSE
+	// Reads the time of last tick, which is much cheaper than a precise clock.
+	struct timespec ts;
+	if (clock_gettime(CLOCK_REALTIME_COARSE, &ts) == 0)
+		return ((int64_t) ts.tv_sec * 1000) + (ts.tv_nsec / 1000000);
+#endif
+	return DateTime::currentMillisecondsSince1970();
+}
@@ -32,6 +32,8 @@ public:
 	int getMinute() const;
 	int getSecond() const;
 	int getMillisecond() const;
+	// Returns the year, month and day fields, computed in one pass.
+	void getDate(int& year, int& month, int& day) const;
 	// Returns the number of milliseconds since January 1, 1970, 00:00:00 GMT
 	uint64_t getMillisecndsSince1970() const;
 	// Converts the string representation of a date and time to its DateTime equivalent.
@@ -39,6 +41,23 @@ public:
 	// Converts the value of the current DateTime to its equivalent string representation.
 	String format(const char* format = NULL) const;
 
+	// Converts the value to UTC and formats it as ISO-8601 extended format,
+	// yyyy-MM-dd'T'HH:mm:ss.SSS'Z', e.g. "2015-02-06T08:49:37.000Z".
+	String formatISO8601() const;
+	// Converts the value to UTC and formats it as ISO-8601 basic format,
+	// yyyyMMdd'T'HHmmss'Z', e.g. "20150206T084937Z".
+	String formatISO8601Basic() const;
+	// Converts the value to UTC and formats it as RFC-1123 format, e.g.
+	// "Fri, 06 Feb 2015 08:49:37 GMT".
+	String formatRFC1123() const;
+	// Parses an ISO-8601 date and time in either extended or basic format, with
+	// optional fraction of second and time zone designator (UTC if missing).
+	// The result is in UTC. Returns false if the string is malformed.
+	bool parseISO8601(const char* str, int length = -1);
+	// Parses an RFC-1123 date and time, e.g. "Fri, 06 Feb 2015 08:49:37 GMT".
+	// The result is in UTC. Returns false if the string is malformed.
+	bool parseRFC1123(const char* str, int length = -1);
+
 	// Returns the current time in milliseconds since midnight, January 1, 1970 UTC.
 	static int64_t currentMillisecondsSince1970();
 	// Returns the offset, measured in minutes, for the local time zone relative to UTC
@@ -58,6 +77,12 @@ private:
 		DF_Day = 3
 	};
 	int getDateField(DateField field) const;
+	// Returns the number of ticks since 1/1/0001 in UTC.
+	int64_t getUTCTicks() const;
+	// Sets the value from UTC date and time fields, returns false if any of
+	// them is out of range.
+	bool setUTC(int year, int month, int day, int hour, int minute, int second,
+			int millisecond);
 	// Returns the tick count corresponding to the given year, month, and day.
 	// Will check the if the parameters are valid.
 	int64_t dateToTicks(int year, int month, int day) const;
@@ -69,4 +94,30 @@ private:
 	int _timezoneOffset;
 };
 
+/// A clock providing the current UTC time and its AWS4 signing stamps with
+/// one second precision. The stamps are formatted once per second and shared
+/// by all threads, reading them costs a coarse clock read and a copy.
+class UTCClock {
+public:
+	struct Stamp {
+		/// Milliseconds since January 1, 1970, 00:00:00 UTC
+		int64_t milliseconds;
+		/// yyyyMMdd
+		char date[9];
+		/// yyyyMMdd'T'HHmmss'Z'
+		char dateTime[17];
+	};
+
+	/// Gets the stamp of current time.
+	static void now(Stamp& stamp);
+	/// Gets the stamp of given time in milliseconds since January 1, 1970 UTC.
+	static void format(int64_t milliseconds, Stamp& stamp);
+	/// Returns the current time in milliseconds since January 1, 1970 UTC,
+	/// read from the coarse clock.
+	static int64_t currentMilliseconds();
+
+private:
+	UTCClock();	// no implemented
+};
+
 #endif /* __TEST_MESSAGES_DATETIME_H_ */
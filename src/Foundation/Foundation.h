@@ -28,6 +28,7 @@
 
 #include "Logger.h"
 #include "Holder.h"
+#include "Interlocked.h"
 #include "Lock.h"
 #include "REF.h"
 #include "ArrayList.h"
@@ -38,5 +39,7 @@
 #include "HashMap.h"
 #include "TreeMap.h"
 #include "DateTime.h"
+#include "RCU.h"
+#include "Thread.h"
 
 #endif /* __BFX_FOUNDATION_H__ */
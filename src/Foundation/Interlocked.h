@@ -0,0 +1,110 @@
+/*
+ * Interlocked.h
+ */
+
+#ifndef __BFX_INTERLOCKED_H__
+#define __BFX_INTERLOCKED_H__
+
+//////////////////////////////////////////////////////////////////////////////
+// Atomic operations, named and behaving as the Win32 Interlocked APIs, which
+// are used directly on Windows.
+//
+
+#ifdef WIN32
+#include <Windows.h>
+#else
+
+/**
+ * Increments the value of the specified variable as an atomic operation.
+ * @see MSDN
+ * @param Addend
+ * @return The resulting incremented value.
+ */
+inline long InterlockedIncrement(long volatile * Addend) {
+	return __sync_add_and_fetch(Addend, 1);
+}
+
+/**
+ * Decrements the value of the specified variable as an atomic operation.
+ * @see MSDN
+ * @param Addend
+ * @return The resulting decremented value.
+ */
+inline long InterlockedDecrement(long volatile * Addend) {
+	return __sync_sub_and_fetch(Addend, 1);
+}
+
+/**
+ * Adds a value to the specified variable as an atomic operation.
+ * @see MSDN
+ * @param Addend
+ * @param Value
+ * @return The initial value of the variable.
+ */
+inline long InterlockedExchangeAdd(long volatile * Addend, long Value) {
+	return __sync_fetch_and_add(Addend, Value);
+}
+
+/**
+ * Performs an atomic compare-and-exchange operation on the specified values.
+ * @see MSDN
+ * @param Destination
+ * @param Exchange
+ * @param Comparand
+ * @return The initial value of the destination.
+ */
+inline long InterlockedCompareExchange(long volatile * Destination,
+		long Exchange, long Comparand) {
+	return __sync_val_compare_and_swap(Destination, Comparand, Exchange);
+}
+
+/**
+ * Sets a 32/64 bits variable to the specified value as an atomic operation.
+ * @see MSDN
+ * @param Target
+ * @param Value
+ * @return The initial value of the target.
+ */
+inline long InterlockedExchange(long volatile * Target, long Value) {
+	__sync_synchronize();
+	return __sync_lock_test_and_set(Target, Value);
+}
+
+/**
+ * Atomically exchanges a pair of pointer values.
+ * @see MSDN
+ * @param Target
+ * @param Value
+ * @return The initial value of the target.
+ */
+inline void* InterlockedExchangePointer(void* volatile * Target, void* Value) {
+	__sync_synchronize();
+	return __sync_lock_test_and_set(Target, Value);
+}
+
+/**
+ * Performs an atomic compare-and-exchange operation on the specified pointer
+ * values.
+ * @see MSDN
+ * @param Destination
+ * @param Exchange
+ * @param Comparand
+ * @return The initial value of the destination.
+ */
+inline void* InterlockedCompareExchangePointer(void* volatile * Destination,
+		void* Exchange, void* Comparand) {
+	return __sync_val_compare_and_swap(Destination, Comparand, Exchange);
+}
+
+/**
+ * Creates a hardware memory barrier (fence) that prevents the CPU from
+ * re-ordering read and write operations.
+ * @see MSDN
+ */
+inline void MemoryBarrier() {
+	__sync_synchronize();
+}
+
+#endif	// WIN32
+
+#endif	// __BFX_INTERLOCKED_H__
@@ -14,6 +14,7 @@
 #include <unistd.h>
 #include <sched.h>
 #include <pthread.h>
+#include <time.h>
 #endif
 /**
  * @see MSDN
@@ -40,33 +41,6 @@ static bool SwitchToThread(int32_t nMilliseconds) {
 #endif
 }
 
-#ifndef	WIN32
-
-/**
- * Performs an atomic compare-and-exchange operation on the specified values.
- * @see MSDN
- * @param Destination
- * @param Exchange
- * @param Comparand
- * @return
- */
-static long InterlockedCompareExchange(long volatile * Destination, long Exchange, long Comparand) {
-	return __sync_val_compare_and_swap(Destination, Comparand, Exchange);
-}
-
-/**
- * Sets a 32/64 bits variable to the specified value as an atomic operation.
- * @see MSDN
- * @param Target
- * @param Value
- */
-static long InterlockedExchange(long volatile * Target, long Value) {
-	__sync_synchronize();
-	return __sync_lock_test_and_set(Target, Value);
-}
-
-#endif	// !WIN32
-
 //////////////////////////////////////////////////////////////////////////////
 
 enum {
@@ -338,3 +312,92 @@ bool Mutex::isLocked() {
 	return _hOwningThread != 0;
 #endif
 }
+
+//////////////////////////////////////////////////////////////////////////////
+
+Event::Event(bool manualReset, bool initialState) {
+#ifdef	_WIN32
+	_hEvent = ::CreateEvent(NULL, manualReset, initialState, NULL);
+	BFX_ASSERT(_hEvent != NULL);
+#else
+	_manualReset = manualReset;
+	_signaled = initialState;
+
+	int nRetCode = pthread_mutex_init(&_mutex, NULL);
+	BFX_ASSERT(nRetCode == 0 && "Unable to initialize the mutex.");
+
+	// Time-outs are measured by the monotonic clock, so that they are not
+	// affected by adjustments of the system time.
+	pthread_condattr_t attr;
+	pthread_condattr_init(&attr);
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	nRetCode = pthread_cond_init(&_cond, &attr);
+	BFX_ASSERT(nRetCode == 0 && "Unable to initialize the condition.");
+	pthread_condattr_destroy(&attr);
+#endif
+}
+
+Event::~Event() {
+#ifdef	_WIN32
+	::CloseHandle(_hEvent);
+#else
+	pthread_cond_destroy(&_cond);
+	pthread_mutex_destroy(&_mutex);
+#endif
+}
+
+void Event::set() {
+#ifdef	_WIN32
+	::SetEvent(_hEvent);
+#else
+	pthread_mutex_lock(&_mutex);
+	_signaled = true;
+	if (_manualReset)
+		pthread_cond_broadcast(&_cond);
+	else
+		pthread_cond_signal(&_cond);
+	pthread_mutex_unlock(&_mutex);
+#endif
+}
+
+void Event::reset() {
+#ifdef	_WIN32
+	::ResetEvent(_hEvent);
+#else
+	pthread_mutex_lock(&_mutex);
+	_signaled = false;
+	pthread_mutex_unlock(&_mutex);
+#endif
+}
+
+bool Event::wait(int milliseconds) {
+#ifdef	_WIN32
+	DWORD dwTimeout = (milliseconds < 0) ? INFINITE : (DWORD) milliseconds;
+	return (::WaitForSingleObject(_hEvent, dwTimeout) == WAIT_OBJECT_0);
+#else
+	struct timespec deadline;
+	if (milliseconds >= 0) {
+		clock_gettime(CLOCK_MONOTONIC, &deadline);
+		deadline.tv_sec += milliseconds / 1000;
+		deadline.tv_nsec += (milliseconds % 1000) * 1000000L;
+		if (deadline.tv_nsec >= 1000000000L) {
+			deadline.tv_sec++;
+			deadline.tv_nsec -= 1000000000L;
+		}
+	}
+
+	pthread_mutex_lock(&_mutex);
+	int nRetCode = 0;
+	while (!_signaled && nRetCode != ETIMEDOUT) {
+		if (milliseconds < 0)
+			nRetCode = pthread_cond_wait(&_cond, &_mutex);
+		else
+			nRetCode = pthread_cond_timedwait(&_cond, &_mutex, &deadline);
+	}
+	bool signaled = _signaled;
+	if (signaled && !_manualReset)
+		_signaled = false;
+	pthread_mutex_unlock(&_mutex);
+	return signaled;
+#endif
+}
@@ -87,4 +87,48 @@ private:
 
 typedef Mutex::Holder MutexHolder;
 
+//////////////////////////////////////////////////////////////////////////////
+//
+
+/**
+ * A synchronization object which is signaled by set() and waited by wait(),
+ * behaves as the Win32 event objects.
+ */
+class Event {
+public:
+	/**
+	 * Creates an event object.
+	 * @param manualReset If false the event is reset automatically once a
+	 * 		single waiting thread has been released.
+	 * @param initialState Whether the event is initially signaled.
+	 */
+	Event(bool manualReset = false, bool initialState = false);
+	virtual ~Event();
+
+	/**
+	 * Sets the event to the signaled state.
+	 */
+	void set();
+	/**
+	 * Sets the event to the nonsignaled state.
+	 */
+	void reset();
+	/**
+	 * Waits until the event is signaled or the time-out interval elapses.
+	 * @param milliseconds The time-out interval, or -1 to wait indefinitely.
+	 * @return True if the event was signaled, false on time-out.
+	 */
+	bool wait(int milliseconds = -1);
+
+private:
+#ifdef	_WIN32
+	HANDLE _hEvent;
+#else
+	pthread_mutex_t _mutex;
+	pthread_cond_t _cond;
+	bool _manualReset;
+	bool _signaled;
+#endif
+};
+
 #endif	//	__BFX_LOCK_H__
@@ -0,0 +1,95 @@
+/*
+ * RCU.h
+ */
+
+#ifndef __BFX_RCU_H__
+#define __BFX_RCU_H__
+
+/**
+ * A shared pointer to an immutable object which readers access without any
+ * lock or reference counting (read-copy-update).
+ * Writers publish a new object by set(), the replaced one is retired rather
+ * than released, and only released by a later set() or the destructor after
+ * the grace period has elapsed. Thus a pointer returned by get() stays valid
+ * for at least the grace period, readers must not keep it any longer.
+ */
+template<class T>
+class RCUPointerT {
+public:
+	enum {
+		DEFAULT_GRACE_PERIOD = 60000,	/// Default grace period in milliseconds
+	};
+
+	/**
+	 * Initializes a new instance which points to NULL.
+	 * @param gracePeriod Minimum time in milliseconds a replaced object is
+	 * 		kept alive.
+	 */
+	RCUPointerT(int gracePeriod = DEFAULT_GRACE_PERIOD) :
+			_pt(NULL), _gracePeriod(gracePeriod) {
+	}
+	virtual ~RCUPointerT() {
+		if (_pt)
+			_pt->release();
+		for (int i = 0; i < _retired.getSize(); i++)
+			_retired[i].pt->release();
+	}
+
+	/**
+	 * Gets the current object, wait-free.
+	 * The object is immutable, and all its fields are initialized before it
+	 * is published, so that a reader dereferencing the pointer always sees
+	 * them.
+	 * @return
+	 */
+	T* get() const {
+		return (T*) _pt;
+	}
+	/**
+	 * Publishes a new object, writers are serialized.
+	 * @param pt
+	 */
+	void set(T* pt) {
+		MutexHolder holder(&_mutex);
+
+		if (pt)
+			pt->addRef();
+		T* ptOld = (T*) InterlockedExchangePointer((void* volatile *) &_pt,
+				(void*) pt);
+
+		// Releases objects retired before the grace period.
+		int64_t now = UTCClock::currentMilliseconds();
+		int n = 0;
+		for (int i = 0; i < _retired.getSize(); i++) {
+			if (now - _retired[i].time >= _gracePeriod)
+				_retired[i].pt->release();
+			else
+				_retired[n++] = _retired[i];
+		}
+		while (_retired.getSize() > n)
+			_retired.removeAt(_retired.getSize() - 1);
+
+		if (ptOld) {
+			Retired retired;
+			retired.pt = ptOld;
+			retired.time = now;
+			_retired.add(retired);
+		}
+	}
+
+private:
+	struct Retired {
+		T* pt;
+		int64_t time;
+	};
+
+	T* volatile _pt;
+	int _gracePeriod;
+	Mutex _mutex;
+	ArrayListT<Retired> _retired;
+
+	RCUPointerT(const RCUPointerT&);	// not implemented
+	RCUPointerT& operator=(const RCUPointerT&);	// not implemented
+};
+
+#endif	// __BFX_RCU_H__
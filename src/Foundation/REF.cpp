@@ -15,15 +15,17 @@ REFObject::~REFObject() {
 }
 
 long REFObject::addRef() const {
-	return (++_refCount);
+	return InterlockedIncrement(&_refCount);
 }
 
 long REFObject::release() const {
-	if ((--_refCount) == 0) {
+	// NOTE: Objects may be shared between threads, the count must be read
+	// from the atomic result, not reloaded.
+	long refCount = InterlockedDecrement(&_refCount);
+	if (refCount == 0) {
 		delete this;
-		return 0;
 	}
-	return _refCount;
+	return refCount;
 }
 
 long REFObject::getRefCount() const {
@@ -32,14 +32,14 @@ private:
 				delete[] _buffer;
 		}
 		long addRef() const {
-			return (++_refCount);
+			return InterlockedIncrement(&_refCount);
 		}
 		long release() const {
-			if ((--_refCount) == 0) {
+			long refCount = InterlockedDecrement(&_refCount);
+			if (refCount == 0) {
 				delete this;
-				return 0;
 			}
-			return _refCount;
+			return refCount;
 		}
 		long getRefCount() const {
 			return _refCount;
@@ -339,8 +339,8 @@ public:
 
 		PCXSTR pszStr = cstr() + iStart;
 		nLength -= iStart;
-		for (int i = 0; (i < nLength) && (psz[i] == 0); i ++) {
-			if (pszStr[i] != psz[i])
+		for (int i = 0; psz[i] != 0; i ++) {
+			if (i >= nLength || pszStr[i] != psz[i])
 				return false;
 		}
 		return true;
@@ -706,6 +706,24 @@ public:
 		return (str2.compareTo(psz1) != 0);
 	}
 
+	// Without these, strings would be compared as pointers through the
+	// implicit conversion, which breaks sorted containers.
+	friend bool operator<(const StringT& str1, const StringT& str2) throw () {
+		return (str1.compareTo(str2) < 0);
+	}
+
+	friend bool operator>(const StringT& str1, const StringT& str2) throw () {
+		return (str1.compareTo(str2) > 0);
+	}
+
+	friend bool operator<=(const StringT& str1, const StringT& str2) throw () {
+		return (str1.compareTo(str2) <= 0);
+	}
+
+	friend bool operator>=(const StringT& str1, const StringT& str2) throw () {
+		return (str1.compareTo(str2) >= 0);
+	}
+
 private:
 	PXSTR getBuffer() {
 		return getBuffer(getLength());
@@ -0,0 +1,96 @@
+/*
+ * Thread.cpp
+ */
+
+#include "Foundation.h"
+
+#ifndef _WIN32
+#include <time.h>
+#include <unistd.h>
+#endif
+
+Thread::Thread() {
+	_hThread = 0;
+	_started = false;
+	_joined = false;
+}
+
+Thread::~Thread() {
+	// The last reference of a running thread is released by itself.
+	if (_started && !_joined) {
+#ifdef	_WIN32
+		::CloseHandle(_hThread);
+#else
+		pthread_detach(_hThread);
+#endif
+	}
+}
+
+bool Thread::start() {
+	if (_started)
+		return false;
+
+	// Keeps the instance alive until run() returns.
+	addRef();
+#ifdef	_WIN32
+	_hThread = ::CreateThread(NULL, 0, threadProc, this, 0, NULL);
+	_started = (_hThread != NULL);
+#else
+	_started = (pthread_create(&_hThread, NULL, threadProc, this) == 0);
+#endif
+	if (!_started)
+		release();
+	return _started;
+}
+
+void Thread::join() {
+	BFX_ASSERT(_started);
+
+	if (!_started || _joined)
+		return;
+#ifdef	_WIN32
+	::WaitForSingleObject(_hThread, INFINITE);
+	::CloseHandle(_hThread);
+#else
+	pthread_join(_hThread, NULL);
+#endif
+	_joined = true;
+}
+
+bool Thread::isStarted() const {
+	return _started;
+}
+
+void Thread::sleep(int milliseconds) {
+	BFX_ASSERT(milliseconds >= 0);
+
+#ifdef	_WIN32
+	::Sleep(milliseconds);
+#else
+	::usleep(milliseconds * 1000);
+#endif
+}
+
+int64_t Thread::getTickCount() {
+#ifdef	_WIN32
+	return (int64_t) ::GetTickCount64();
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (int64_t) ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+#endif
+}
+
+#ifdef	_WIN32
+DWORD WINAPI Thread::threadProc(LPVOID param) {
+#else
+void* Thread::threadProc(void* param) {
+#endif
+	Thread* thread = (Thread*) param;
+	{
+		REFAutoreleasePool pool;
+		thread->run();
+	}
+	thread->release();
+	return 0;
+}
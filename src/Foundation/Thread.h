@@ -0,0 +1,64 @@
+/*
+ * Thread.h
+ */
+
+#ifndef __BFX_THREAD_H__
+#define __BFX_THREAD_H__
+
+/**
+ * Abstract base class for threads, subclasses implement run().
+ * A running thread holds a reference to itself, so the instance stays alive
+ * until run() returns even if all other references have been released.
+ */
+class Thread: public REFObject {
+public:
+	Thread();
+	virtual ~Thread();
+
+	/**
+	 * Starts the thread.
+	 * @return True if succeeded, false if the thread has been started or
+	 * 		failed to be created.
+	 */
+	bool start();
+	/**
+	 * Waits for the thread to terminate.
+	 */
+	void join();
+	/**
+	 * Gets a value indicating whether the thread has been started.
+	 * @return
+	 */
+	bool isStarted() const;
+
+	/**
+	 * Suspends the current thread for the specified time.
+	 * @param milliseconds
+	 */
+	static void sleep(int milliseconds);
+	/**
+	 * Gets the milliseconds elapsed since an arbitrary point, from a clock
+	 * which is not affected by adjustments of the system time.
+	 * @return
+	 */
+	static int64_t getTickCount();
+
+protected:
+	/**
+	 * The entry point of the thread, an autorelease pool is available.
+	 */
+	virtual void run() = 0;
+
+private:
+#ifdef	_WIN32
+	static DWORD WINAPI threadProc(LPVOID param);
+	HANDLE _hThread;
+#else
+	static void* threadProc(void* param);
+	pthread_t _hThread;
+#endif
+	bool _started;
+	bool _joined;
+};
+
+#endif	// __BFX_THREAD_H__
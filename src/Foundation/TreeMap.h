@@ -55,8 +55,10 @@ public:
 				t = t->_left;
 			else if (cmp > 0)
 				t = t->_right;
-			else
+			else {
 				t->value = value;
+				return t;
+			}
 		} while (t != NULL);
 		REF<Entry> e = new Entry(key, value, parent, this);
 		if (cmp < 0)
@@ -68,10 +70,12 @@ public:
 	}
 	void remove(ARG_KEY key) {
 		Entry* p = getEntry(key);
-		deleteEntry(p);
+		if (p != NULL)
+			deleteEntry(p);
 	}
 	void clear() {
 		_root = NULL;
+		_size = 0;
 	}
 	int getSize() const {
 		return _size;
@@ -168,6 +172,9 @@ public:
 			entry->value = s->value;
 			entry = s;
 		} // p has 2 children
+		// Keeps the entry alive while unlinking it from its parent, which
+		// holds the last reference to it.
+		REF<Entry> deleted = entry;
 
 		// Start fixup at replacement node, if it exists.
 		REF<Entry> replacement = (
@@ -191,9 +191,13 @@ bool JSONReader::parseNumber() {
 				LOGE(_lastErrorMessage);
 				return false;
 			}
+			pos++;
 			continue;
 			// XXX Need to validate the number format?
 		case '.':
+		case '+':
+		case 'e':
+		case 'E':
 		case '0':
 		case '1':
 		case '2':
@@ -207,7 +211,7 @@ bool JSONReader::parseNumber() {
 			pos++;
 			continue;
 		default:
-			if (c == ',' || c == '}' || isWhitespaceChar(c)) {
+			if (c == ',' || c == '}' || c == ']' || isWhitespaceChar(c)) {
 				_value = String(_chars + _charPos, pos - _charPos);
 				LOGI("_value=%s", (const char*)_value);
 				_charPos = pos;
@@ -492,17 +496,110 @@ bool JSONReader::isWhitespaceChar(char c) {
 	}
 }
 
+// Reads 4 hex digits of an \u escape, returns -1 if any is not.
+static int parseUnicodeEscape(const char* p, const char* end) {
+	if (end - p < 4)
+		return -1;
+	int code = 0;
+	for (int i = 0; i < 4; i++) {
+		char c = p[i];
+		code <<= 4;
+		if (c >= '0' && c <= '9')
+			code |= c - '0';
+		else if (c >= 'a' && c <= 'f')
+			code |= c - 'a' + 10;
+		else if (c >= 'A' && c <= 'F')
+			code |= c - 'A' + 10;
+		else
+			return -1;
+	}
+	return code;
+}
+
 String JSONReader::unescapeString(const char* chars, int offset, int length) {
-	String result;
-	for (int i = 0; i < length; i++) {
-		char c = chars[offset + i];
-		if (c == '\\') {
-			BFX_ASSERT((i + 1) < length);
-			result.append(chars[offset + (++i)]);
-		} else
-			result.append(c);
+	const char* p = chars + offset;
+	const char* end = p + length;
+	const char* backslash = (const char*) memchr(p, '\\', length);
+	if (backslash == NULL)
+		return String(p, length);
+
+	// The text never grows by decoding, an escape takes at least as many
+	// characters as the UTF-8 it stands for.
+	BufferT<char> buffer;
+	char* result = buffer.getBuffer(length + 1);
+	int resultLength = 0;
+	while (backslash != NULL) {
+		memcpy(result + resultLength, p, backslash - p);
+		resultLength += backslash - p;
+		p = backslash + 1;
+		BFX_ASSERT(p < end);
+		char c = *p++;
+		switch (c) {
+		case 'b':
+			result[resultLength++] = '\b';
+			break;
+		case 'f':
+			result[resultLength++] = '\f';
+			break;
+		case 'n':
+			result[resultLength++] = '\n';
+			break;
+		case 'r':
+			result[resultLength++] = '\r';
+			break;
+		case 't':
+			result[resultLength++] = '\t';
+			break;
+		case 'u': {
+			int code = parseUnicodeEscape(p, end);
+			if (code == -1) {
+				// Keeps a malformed escape as it is.
+				result[resultLength++] = c;
+				break;
+			}
+			p += 4;
+			if (code >= 0xd800 && code <= 0xdbff) {
+				// Joins a surrogate pair, a lone surrogate is replaced.
+				int low = (end - p >= 6 && p[0] == '\\' && p[1] == 'u') ?
+						parseUnicodeEscape(p + 2, end) : -1;
+				if (low >= 0xdc00 && low <= 0xdfff) {
+					code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+					p += 6;
+				} else {
+					code = 0xfffd;
+				}
+			} else if (code >= 0xdc00 && code <= 0xdfff) {
+				code = 0xfffd;
+			}
+			// Encodes the code point in UTF-8.
+			if (code < 0x80) {
+				result[resultLength++] = (char) code;
+			} else if (code < 0x800) {
+				result[resultLength++] = (char) (0xc0 | (code >> 6));
+				result[resultLength++] = (char) (0x80 | (code & 0x3f));
+			} else if (code < 0x10000) {
+				result[resultLength++] = (char) (0xe0 | (code >> 12));
+				result[resultLength++] = (char) (0x80 | ((code >> 6) & 0x3f));
+				result[resultLength++] = (char) (0x80 | (code & 0x3f));
+			} else {
+				result[resultLength++] = (char) (0xf0 | (code >> 18));
+				result[resultLength++] = (char) (0x80 | ((code >> 12) & 0x3f));
+				result[resultLength++] = (char) (0x80 | ((code >> 6) & 0x3f));
+				result[resultLength++] = (char) (0x80 | (code & 0x3f));
+			}
+			break;
+		}
+		default:
+			// \", \\ and \/, or an unknown escape kept as its character.
+			result[resultLength++] = c;
+			break;
+		}
+		backslash = (const char*) memchr(p, '\\', end - p);
 	}
-	return result;
+	memcpy(result + resultLength, p, end - p);
+	resultLength += end - p;
+	result[resultLength] = '\0';
+	return String(result, resultLength);
 }
 
 const char* JSONReader::getErrorMessageTemplate(JSONReadError error) {
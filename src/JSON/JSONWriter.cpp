@@ -60,11 +60,12 @@ bool JSONWriter::writeEndArray() {
 }
 
 bool JSONWriter::writeString(const String& value) {
-	int count;
-	if (value.isEmpty())
-		count = _textWriter->writeString("\"\"");
-	else
-		count = _textWriter->writeFormat("\"%s\"", (const char*) escapeString(value));
+	String escaped = escapeString(value);
+	int count = _textWriter->write('"');
+	if (count > 0 && !escaped.isEmpty())
+		count = _textWriter->write(escaped, 0, escaped.getLength());
+	if (count > 0)
+		count = _textWriter->write('"');
 	if (count <= 0) {
 		_lastError = JWE_IOError;
 		return false;
@@ -164,23 +165,55 @@ void JSONWriter::popIndent() {
 }
 
 String JSONWriter::escapeString(const String& str) {
+	static const char hexDigits[] = "0123456789abcdef";
+	const char* chars = str;
+	int length = str.getLength();
 	String result;
-	for (int i = 0; i < str.getLength(); i++) {
-		char c = str[i];
+	// Copies the runs of characters needing no escape as a whole.
+	int start = 0;
+	for (int i = 0; i < length; i++) {
+		unsigned char c = (unsigned char) chars[i];
+		char escape[7] = { '\\', 0, 0, 0, 0, 0, 0 };
 		switch (c) {
-		case '/':
-			result.append("\\/");
-			break;
 		case '\\':
-			result.append("\\\\");
-			break;
 		case '"':
-			result.append("\\\"");
+			escape[1] = c;
+			break;
+		case '\b':
+			escape[1] = 'b';
+			break;
+		case '\f':
+			escape[1] = 'f';
+			break;
+		case '\n':
+			escape[1] = 'n';
+			break;
+		case '\r':
+			escape[1] = 'r';
+			break;
+		case '\t':
+			escape[1] = 't';
 			break;
 		default:
-			result.append(c);
+			if (c >= 0x20)
+				continue;
+			// Other control characters are not allowed in a string.
+			escape[1] = 'u';
+			escape[2] = '0';
+			escape[3] = '0';
+			escape[4] = hexDigits[c >> 4];
+			escape[5] = hexDigits[c & 0x0f];
+			break;
 		}
+		if (i > start)
+			result.append(chars + start, i - start);
+		result.append(escape);
+		start = i + 1;
 	}
+	if (start == 0)
+		return str;
+	if (start < length)
+		result.append(chars + start, length - start);
 	return result;
 }
 